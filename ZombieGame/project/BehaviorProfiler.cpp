@@ -0,0 +1,183 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "BehaviorProfiler.h"
+#include "EBehaviorTree.h"
+
+bool BehaviorTreeProfile::Write(const std::string& path) const
+{
+	std::ofstream file{ path };
+	if (!file)
+	{
+		printf("WARNING: Could not write behavior tree profile to '%s' \n", path.c_str());
+		return false;
+	}
+
+	file << "frames\t" << frameCount << '\n';
+	for (const auto& node : nodes)
+	{
+		const BehaviorNodeStats& stats = node.second;
+		file << node.first << '\t' << stats.executions << '\t' << stats.successes << '\t' << stats.failures << '\t'
+			<< stats.runnings << '\t' << stats.inclusiveNs << '\t' << stats.exclusiveNs << '\n';
+	}
+	return true;
+}
+
+bool BehaviorTreeProfile::Read(const std::string& path)
+{
+	std::ifstream file{ path };
+	std::string line{};
+	unsigned long long frames{};
+	if (!file || !std::getline(file, line) || sscanf(line.c_str(), "frames\t%llu", &frames) != 1)
+	{
+		printf("WARNING: Could not read behavior tree profile '%s' \n", path.c_str());
+		return false;
+	}
+	frameCount = frames;
+
+	nodes.clear();
+	for (size_t lineNumber = 2; std::getline(file, line); ++lineNumber)
+	{
+		// The path is everything in front of the numbers
+		const size_t pathEnd = line.find('\t');
+		unsigned long long values[6]{};
+		if (pathEnd == std::string::npos || sscanf(line.c_str() + pathEnd, "\t%llu\t%llu\t%llu\t%llu\t%llu\t%llu", &values[0], &values[1], &values[2], &values[3], &values[4], &values[5]) != 6)
+		{
+			printf("WARNING: Behavior tree profile '%s' line %zu is not a node \n", path.c_str(), lineNumber);
+			return false;
+		}
+		nodes[line.substr(0, pathEnd)] = BehaviorNodeStats{ values[0], values[1], values[2], values[3], values[4], values[5] };
+	}
+	return true;
+}
+
+void BehaviorProfiler::Register(IBehavior* pRootBehavior)
+{
+	m_Nodes.clear();
+	m_ActiveNodes.clear();
+	m_FrameCount = 0;
+	if (pRootBehavior != nullptr)
+		RegisterNode(pRootBehavior, "", 0, 0);
+}
+
+void BehaviorProfiler::RegisterNode(IBehavior* pBehavior, const std::string& parentStack, uint32_t depth, size_t childOrdinal)
+{
+	std::string frame = GetFrameName(pBehavior, childOrdinal);
+	std::replace(frame.begin(), frame.end(), ';', ',');
+
+	// The index of the record pushed next
+	BEHAVIOR_PROFILE(pBehavior->SetProfiler(this, static_cast<uint32_t>(m_Nodes.size())));
+	const std::string stack = parentStack.empty() ? frame : parentStack + ';' + frame;
+	m_Nodes.push_back(NodeRecord{ stack, depth, BehaviorNodeStats{} });
+
+	for (size_t i{}; i < pBehavior->GetChildCount(); ++i)
+	{
+		RegisterNode(pBehavior->GetChild(i), stack, depth + 1, i);
+	}
+}
+
+std::string BehaviorProfiler::GetFrameName(const IBehavior* pBehavior, size_t childOrdinal)
+{
+	// Unnamed siblings of the same type would merge in a flame graph, their position keeps them apart
+	return pBehavior->GetName() != nullptr
+		? std::string{ pBehavior->GetName() }
+		: std::string{ pBehavior->GetTypeName() } + '[' + std::to_string(childOrdinal) + ']';
+}
+
+void BehaviorProfiler::OnEnter(uint32_t nodeIndex)
+{
+	m_ActiveNodes.push_back(ActiveNode{ nodeIndex, Clock::now(), 0 });
+}
+
+void BehaviorProfiler::OnExit(uint32_t nodeIndex, BehaviorState state)
+{
+	const uint64_t inclusiveNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_ActiveNodes.back().start).count());
+	const uint64_t childNs = m_ActiveNodes.back().childNs;
+	m_ActiveNodes.pop_back();
+	if (!m_ActiveNodes.empty())
+		m_ActiveNodes.back().childNs += inclusiveNs;
+
+	BehaviorNodeStats& stats = m_Nodes[nodeIndex].stats;
+	++stats.executions;
+	switch (state)
+	{
+	case BehaviorState::Success:
+		++stats.successes;
+		break;
+	case BehaviorState::Failure:
+		++stats.failures;
+		break;
+	case BehaviorState::Running:
+		++stats.runnings;
+		break;
+	}
+	stats.inclusiveNs += inclusiveNs;
+	stats.exclusiveNs += inclusiveNs > childNs ? inclusiveNs - childNs : 0;
+}
+
+void BehaviorProfiler::RenderImGui(const char* title) const
+{
+	const float frameCount = static_cast<float>(std::max<uint64_t>(m_FrameCount, 1));
+
+	ImGui::Begin(title);
+	ImGui::Text("Frames: %llu, averages per frame", static_cast<unsigned long long>(m_FrameCount));
+	ImGui::Separator();
+
+	ImGui::Columns(6, "BehaviorProfiler");
+	ImGui::Text("Node"); ImGui::NextColumn();
+	ImGui::Text("Runs"); ImGui::NextColumn();
+	ImGui::Text("S/F/R %%"); ImGui::NextColumn();
+	ImGui::Text("Incl us"); ImGui::NextColumn();
+	ImGui::Text("Excl us"); ImGui::NextColumn();
+	ImGui::Text("Tick %%"); ImGui::NextColumn();
+	ImGui::Separator();
+
+	// Share of the root's time, the root runs once per tick
+	const float rootNs = m_Nodes.empty() ? 1.f : static_cast<float>(std::max<uint64_t>(m_Nodes.front().stats.inclusiveNs, 1));
+	for (const NodeRecord& node : m_Nodes)
+	{
+		const BehaviorNodeStats& stats = node.stats;
+		const float executions = static_cast<float>(std::max<uint64_t>(stats.executions, 1));
+		const size_t frameStart = node.stack.find_last_of(';');
+
+		ImGui::Text("%*s%s", static_cast<int>(node.depth * 2), "", node.stack.c_str() + (frameStart == std::string::npos ? 0 : frameStart + 1)); ImGui::NextColumn();
+		ImGui::Text("%.2f", stats.executions / frameCount); ImGui::NextColumn();
+		ImGui::Text("%.0f/%.0f/%.0f", 100.f * stats.successes / executions, 100.f * stats.failures / executions, 100.f * stats.runnings / executions); ImGui::NextColumn();
+		ImGui::Text("%.2f", stats.inclusiveNs / frameCount / 1000.f); ImGui::NextColumn();
+		ImGui::Text("%.2f", stats.exclusiveNs / frameCount / 1000.f); ImGui::NextColumn();
+		ImGui::Text("%.1f", 100.f * stats.inclusiveNs / rootNs); ImGui::NextColumn();
+	}
+
+	ImGui::Columns(1);
+	ImGui::End();
+}
+
+bool BehaviorProfiler::WriteCollapsedStacks(const std::string& path) const
+{
+	std::ofstream file{ path };
+	if (!file)
+	{
+		printf("WARNING: Could not write behavior tree profile to '%s' \n", path.c_str());
+		return false;
+	}
+
+	for (const NodeRecord& node : m_Nodes)
+	{
+		if (node.stats.exclusiveNs > 0)
+			file << node.stack << ' ' << node.stats.exclusiveNs << '\n';
+	}
+	return true;
+}
+
+BehaviorTreeProfile BehaviorProfiler::CreateProfile() const
+{
+	BehaviorTreeProfile profile{};
+	profile.frameCount = m_FrameCount;
+	for (const NodeRecord& node : m_Nodes)
+	{
+		// Paths like the trace writes them
+		std::string path = node.stack;
+		std::replace(path.begin(), path.end(), ';', '/');
+		profile.nodes[path] = node.stats;
+	}
+	return profile;
+}
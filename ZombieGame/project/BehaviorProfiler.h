@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <chrono>
+
+//Per node statistics of a BehaviorTree, shown in an ImGui panel and written as collapsed stacks on shutdown.
+//When disabled the hooks compile to nothing and the nodes have no profiler members.
+#define CONFIG_PROFILE_BEHAVIOR_TREE 0
+
+#if CONFIG_PROFILE_BEHAVIOR_TREE
+#define BEHAVIOR_PROFILE(call) call
+#else
+#define BEHAVIOR_PROFILE(call)
+#endif
+
+class IBehavior;
+enum class BehaviorState;
+
+struct BehaviorNodeStats
+{
+	uint64_t executions{};
+	uint64_t successes{};
+	uint64_t failures{};
+	uint64_t runnings{};
+	uint64_t inclusiveNs{}; //Node and its subtree
+	uint64_t exclusiveNs{}; //Node without the children it ran
+};
+
+//Node statistics by path, "Agent/Items/Sequence[0]" like the trace names its nodes.
+//Made by the profiler or the trace, read by BehaviorTreeOptimizer. A trace profile has no times
+struct BehaviorTreeProfile
+{
+	uint64_t frameCount{};
+	std::unordered_map<std::string, BehaviorNodeStats> nodes{};
+
+	//One line per node: "<path>\t<executions>\t<successes>\t<failures>\t<runnings>\t<inclusive ns>\t<exclusive ns>"
+	bool Write(const std::string& path) const;
+	bool Read(const std::string& path);
+};
+
+class BehaviorProfiler final
+{
+public:
+	using Clock = std::chrono::high_resolution_clock;
+
+	//Gives every node of the tree a record, its path of names becomes its flame graph stack
+	void Register(IBehavior* pRootBehavior);
+
+	void OnEnter(uint32_t nodeIndex);
+	void OnExit(uint32_t nodeIndex, BehaviorState state);
+
+	//Call once per tick, the averages of the panel are per frame
+	void EndFrame() { ++m_FrameCount; }
+
+	void RenderImGui(const char* title) const;
+	//One line per node: "Root;Items;Sequence[1] <exclusive nanoseconds>", the input of flamegraph.pl
+	bool WriteCollapsedStacks(const std::string& path) const;
+	BehaviorTreeProfile CreateProfile() const;
+
+	//Name of a node in a stack, its type and position among its siblings when it has no name
+	static std::string GetFrameName(const IBehavior* pBehavior, size_t childOrdinal);
+
+	const BehaviorNodeStats& GetStats(uint32_t nodeIndex) const { return m_Nodes[nodeIndex].stats; }
+	const std::string& GetStack(uint32_t nodeIndex) const { return m_Nodes[nodeIndex].stack; }
+	size_t GetNodeCount() const { return m_Nodes.size(); }
+
+private:
+	struct NodeRecord
+	{
+		std::string stack;
+		uint32_t depth;
+		BehaviorNodeStats stats;
+	};
+
+	struct ActiveNode
+	{
+		uint32_t nodeIndex;
+		Clock::time_point start;
+		uint64_t childNs;
+	};
+
+	std::vector<NodeRecord> m_Nodes{}; //Pre-order, like the flat tree
+	std::vector<ActiveNode> m_ActiveNodes{};
+	uint64_t m_FrameCount = 0;
+
+	void RegisterNode(IBehavior* pBehavior, const std::string& parentStack, uint32_t depth, size_t childOrdinal);
+};
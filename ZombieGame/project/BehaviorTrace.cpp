@@ -0,0 +1,255 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "BehaviorTrace.h"
+#include "EBehaviorTree.h"
+
+#include <chrono>
+
+namespace
+{
+	const char* const g_StateNames[] = { "Failure", "Success", "Running" };
+	constexpr auto DrainInterval = std::chrono::milliseconds{ 100 };
+}
+
+BehaviorTrace::BehaviorTrace(size_t capacity)
+{
+	// A power of two, so a slot is a mask away from the write index
+	size_t roundedCapacity = 1;
+	while (roundedCapacity < capacity)
+	{
+		roundedCapacity <<= 1;
+	}
+
+	m_Mask = roundedCapacity - 1;
+	m_pSlots.reset(new std::atomic<uint64_t>[roundedCapacity]);
+	m_pFrameTimes.reset(new std::atomic<uint64_t>[FrameCapacity]);
+	for (size_t i{}; i < roundedCapacity; ++i)
+	{
+		m_pSlots[i].store(0, std::memory_order_relaxed);
+	}
+	for (size_t i{}; i < FrameCapacity; ++i)
+	{
+		m_pFrameTimes[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+BehaviorTrace::~BehaviorTrace()
+{
+	StopDrain();
+}
+
+void BehaviorTrace::Register(IBehavior* pRootBehavior)
+{
+	m_NodePaths.clear();
+	if (pRootBehavior != nullptr)
+		RegisterNode(pRootBehavior, "", 0);
+
+	if (m_NodePaths.size() > 0xFFFFFF)
+		printf("WARNING: Behavior tree has more nodes than a trace record can number, the trace mixes them up \n");
+}
+
+void BehaviorTrace::RegisterNode(IBehavior* pBehavior, const std::string& parentPath, size_t childOrdinal)
+{
+	const uint32_t nodeIndex = static_cast<uint32_t>(m_NodePaths.size());
+	const std::string path = parentPath.empty() ? BehaviorProfiler::GetFrameName(pBehavior, childOrdinal) : parentPath + '/' + BehaviorProfiler::GetFrameName(pBehavior, childOrdinal);
+	m_NodePaths.push_back(path);
+	BEHAVIOR_TRACE(pBehavior->SetTrace(this, nodeIndex));
+
+	for (size_t i{}; i < pBehavior->GetChildCount(); ++i)
+	{
+		RegisterNode(pBehavior->GetChild(i), path, i);
+	}
+}
+
+uint64_t BehaviorTrace::PackFrameTime(uint32_t frame, float time)
+{
+	uint32_t timeBits{};
+	memcpy(&timeBits, &time, sizeof(timeBits));
+	return uint64_t{ frame } | (uint64_t{ timeBits } << 32);
+}
+
+float BehaviorTrace::GetFrameTime(uint32_t frame) const
+{
+	const uint64_t frameTime = m_pFrameTimes[frame & (FrameCapacity - 1)].load(std::memory_order_relaxed);
+	if (static_cast<uint32_t>(frameTime) != frame)
+		return -1.f;
+
+	const uint32_t timeBits = static_cast<uint32_t>(frameTime >> 32);
+	float time{};
+	memcpy(&time, &timeBits, sizeof(time));
+	return time;
+}
+
+bool BehaviorTrace::WriteLastSeconds(float seconds, const std::string& path) const
+{
+	std::ofstream file{ path };
+	if (!file)
+	{
+		printf("WARNING: Could not write behavior trace to '%s' \n", path.c_str());
+		return false;
+	}
+
+	// First frame of the window whose time is still known
+	const float endTime = GetFrameTime(m_Frame);
+	uint32_t firstFrame = m_Frame;
+	while (firstFrame > 1 && m_Frame - firstFrame + 1 < FrameCapacity && GetFrameTime(firstFrame - 1) >= endTime - seconds)
+	{
+		--firstFrame;
+	}
+
+	// Only this thread writes, so every record in the ring is complete
+	const uint64_t oldestIndex = m_WriteIndex > m_Mask ? m_WriteIndex - m_Mask - 1 : 0;
+	uint64_t firstIndex = m_WriteIndex;
+	while (firstIndex > oldestIndex && UnpackRecord(m_pSlots[(firstIndex - 1) & m_Mask].load(std::memory_order_relaxed)).frame >= firstFrame)
+	{
+		--firstIndex;
+	}
+
+	file << "frame,time,node,state\n";
+	for (uint64_t i = firstIndex; i < m_WriteIndex; ++i)
+	{
+		WriteRecord(file, UnpackRecord(m_pSlots[i & m_Mask].load(std::memory_order_relaxed)));
+	}
+	return true;
+}
+
+BehaviorTreeProfile BehaviorTrace::CreateProfile() const
+{
+	BehaviorTreeProfile profile{};
+	const uint64_t oldestIndex = m_WriteIndex > m_Mask ? m_WriteIndex - m_Mask - 1 : 0;
+	if (oldestIndex == m_WriteIndex)
+		return profile;
+
+	std::vector<BehaviorNodeStats> nodeStats(m_NodePaths.size());
+	uint32_t firstFrame = UINT32_MAX;
+	uint32_t lastFrame = 0;
+	for (uint64_t i = oldestIndex; i < m_WriteIndex; ++i)
+	{
+		const BehaviorTraceRecord record = UnpackRecord(m_pSlots[i & m_Mask].load(std::memory_order_relaxed));
+		if (record.nodeIndex >= nodeStats.size())
+			continue;
+
+		BehaviorNodeStats& stats = nodeStats[record.nodeIndex];
+		++stats.executions;
+		switch (record.state)
+		{
+		case BehaviorState::Success:
+			++stats.successes;
+			break;
+		case BehaviorState::Failure:
+			++stats.failures;
+			break;
+		case BehaviorState::Running:
+			++stats.runnings;
+			break;
+		}
+		firstFrame = std::min(firstFrame, record.frame);
+		lastFrame = std::max(lastFrame, record.frame);
+	}
+
+	profile.frameCount = firstFrame <= lastFrame ? lastFrame - firstFrame + 1 : 0;
+	for (size_t nodeIndex{}; nodeIndex < nodeStats.size(); ++nodeIndex)
+	{
+		if (nodeStats[nodeIndex].executions > 0)
+			profile.nodes[m_NodePaths[nodeIndex]] = nodeStats[nodeIndex];
+	}
+	return profile;
+}
+
+bool BehaviorTrace::StartDrain(const std::string& path)
+{
+	StopDrain();
+
+	m_DrainFile.open(path);
+	if (!m_DrainFile)
+	{
+		printf("WARNING: Could not write behavior trace to '%s' \n", path.c_str());
+		return false;
+	}
+
+	// Records from before the drain are left to WriteLastSeconds
+	m_DrainFile << "frame,time,node,state\n";
+	m_ReadIndex = m_Head.load(std::memory_order_acquire);
+	m_IsDraining = true;
+	m_DrainThread = std::thread{ &BehaviorTrace::DrainLoop, this };
+	return true;
+}
+
+void BehaviorTrace::StopDrain()
+{
+	if (!m_DrainThread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock{ m_DrainMutex };
+		m_IsDraining = false;
+	}
+	m_DrainWake.notify_one();
+	m_DrainThread.join();
+	m_DrainFile.close();
+}
+
+void BehaviorTrace::DrainLoop()
+{
+	std::vector<uint64_t> batch{};
+	batch.reserve(m_Mask + 1);
+
+	bool isDraining = true;
+	while (isDraining)
+	{
+		{
+			std::unique_lock<std::mutex> lock{ m_DrainMutex };
+			m_DrainWake.wait_for(lock, DrainInterval, [this]() { return !m_IsDraining; });
+			isDraining = m_IsDraining;
+		}
+
+		// Also runs once after the stop, for the last records
+		Drain(batch);
+	}
+	m_DrainFile.flush();
+}
+
+void BehaviorTrace::Drain(std::vector<uint64_t>& batch)
+{
+	const uint64_t capacity = m_Mask + 1;
+	const uint64_t head = m_Head.load(std::memory_order_acquire);
+	if (head - m_ReadIndex > capacity)
+	{
+		m_LostCount.fetch_add(head - capacity - m_ReadIndex, std::memory_order_relaxed);
+		m_ReadIndex = head - capacity;
+	}
+
+	batch.clear();
+	for (uint64_t i = m_ReadIndex; i < head; ++i)
+	{
+		batch.push_back(m_pSlots[i & m_Mask].load(std::memory_order_relaxed));
+	}
+
+	// A slot that was overwritten while it was copied has its overwrite's head visible after this fence,
+	// the game thread may be writing the slot of index headAfter - capacity right now
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const uint64_t headAfter = m_Head.load(std::memory_order_relaxed);
+	const uint64_t firstValidIndex = headAfter >= capacity ? headAfter - capacity + 1 : 0;
+
+	for (uint64_t i = m_ReadIndex; i < head; ++i)
+	{
+		if (i < firstValidIndex)
+		{
+			m_LostCount.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+		WriteRecord(m_DrainFile, UnpackRecord(batch[i - m_ReadIndex]));
+	}
+	m_ReadIndex = head;
+}
+
+void BehaviorTrace::WriteRecord(std::ostream& stream, const BehaviorTraceRecord& record) const
+{
+	const size_t stateIndex = static_cast<size_t>(record.state);
+	stream << record.frame << ',';
+	const float time = GetFrameTime(record.frame);
+	if (time >= 0.f)
+		stream << time;
+	stream << ",\"" << (record.nodeIndex < m_NodePaths.size() ? m_NodePaths[record.nodeIndex] : std::to_string(record.nodeIndex)) << "\","
+		<< (stateIndex < std::extent<decltype(g_StateNames)>::value ? g_StateNames[stateIndex] : "Unknown") << '\n';
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//Flight recorder of every node a BehaviorTree runs, cheap enough to stay on in release builds.
+//When disabled the nodes have no trace members.
+#define CONFIG_TRACE_BEHAVIOR_TREE 1
+
+#if CONFIG_TRACE_BEHAVIOR_TREE
+#define BEHAVIOR_TRACE(call) call
+#else
+#define BEHAVIOR_TRACE(call)
+#endif
+
+class IBehavior;
+enum class BehaviorState;
+struct BehaviorTreeProfile;
+
+struct BehaviorTraceRecord
+{
+	uint32_t frame;
+	uint32_t nodeIndex; //Pre-order, like the profiler
+	BehaviorState state;
+};
+
+//-----------------------------------------------------------------
+// BEHAVIOR TRACE
+//-----------------------------------------------------------------
+//Ring of fixed size records, one per executed node. The game thread only packs a record into
+//a slot and publishes it, the oldest records are overwritten once the ring is full.
+//A drain thread can append the records to a file while the game runs, records that were
+//overwritten before it got to them are counted as lost. Parallel children that run on
+//workers are not recorded, their parallel node is.
+class BehaviorTrace final
+{
+public:
+	static constexpr size_t DefaultCapacity = size_t{ 1 } << 16; //Records, over a minute of the agent's tree at 60 ticks per second
+	static constexpr size_t FrameCapacity = size_t{ 1 } << 13; //Frames whose time is kept
+
+	explicit BehaviorTrace(size_t capacity = DefaultCapacity);
+	~BehaviorTrace();
+
+	BehaviorTrace(const BehaviorTrace& other) = delete;
+	BehaviorTrace& operator=(const BehaviorTrace& other) = delete;
+	BehaviorTrace(BehaviorTrace&& other) = delete;
+	BehaviorTrace& operator=(BehaviorTrace&& other) = delete;
+
+	//Numbers the nodes of the tree and hands them the trace, before the drain starts
+	void Register(IBehavior* pRootBehavior);
+
+	//Game thread, once per tick before the root runs
+	void BeginFrame(float time)
+	{
+		++m_Frame;
+		m_pFrameTimes[m_Frame & (FrameCapacity - 1)].store(PackFrameTime(m_Frame, time), std::memory_order_relaxed);
+	}
+	//Game thread, a store and a publish
+	void Record(uint32_t nodeIndex, BehaviorState state)
+	{
+		// Orders the publish of the previous record before the overwrite, see Drain
+		std::atomic_thread_fence(std::memory_order_release);
+		m_pSlots[m_WriteIndex & m_Mask].store(PackRecord(m_Frame, nodeIndex, state), std::memory_order_relaxed);
+		m_Head.store(++m_WriteIndex, std::memory_order_release);
+	}
+
+	//Game thread, CSV of the records of the last seconds that are still in the ring, e.g. when the agent died
+	bool WriteLastSeconds(float seconds, const std::string& path) const;
+	//Game thread, counts the results of every node over the records still in the ring. No times,
+	//and the oldest frame can be partly overwritten
+	BehaviorTreeProfile CreateProfile() const;
+
+	//Appends every record to a CSV file from a background thread until StopDrain
+	bool StartDrain(const std::string& path);
+	void StopDrain();
+
+	uint64_t GetRecordCount() const { return m_WriteIndex; }
+	uint64_t GetLostCount() const { return m_LostCount.load(std::memory_order_relaxed); }
+	size_t GetCapacity() const { return m_Mask + 1; }
+	size_t GetNodeCount() const { return m_NodePaths.size(); }
+
+private:
+	//Frame in the low half, node and state in the high half
+	static uint64_t PackRecord(uint32_t frame, uint32_t nodeIndex, BehaviorState state)
+	{
+		return uint64_t{ frame } | (uint64_t{ nodeIndex & 0xFFFFFF } << 32) | (uint64_t(static_cast<uint8_t>(state)) << 56);
+	}
+	static BehaviorTraceRecord UnpackRecord(uint64_t record)
+	{
+		return BehaviorTraceRecord{ static_cast<uint32_t>(record), static_cast<uint32_t>(record >> 32) & 0xFFFFFF, static_cast<BehaviorState>(record >> 56) };
+	}
+	static uint64_t PackFrameTime(uint32_t frame, float time);
+	//Negative when the frame is no longer kept
+	float GetFrameTime(uint32_t frame) const;
+
+	std::unique_ptr<std::atomic<uint64_t>[]> m_pSlots;
+	std::unique_ptr<std::atomic<uint64_t>[]> m_pFrameTimes;
+	size_t m_Mask;
+	uint64_t m_WriteIndex = 0; //Only the game thread writes, m_Head publishes it
+	uint32_t m_Frame = 0;
+	std::atomic<uint64_t> m_Head{ 0 };
+	std::atomic<uint64_t> m_LostCount{ 0 };
+
+	std::vector<std::string> m_NodePaths{};
+
+	std::thread m_DrainThread{};
+	std::mutex m_DrainMutex{};
+	std::condition_variable m_DrainWake{};
+	std::ofstream m_DrainFile{};
+	bool m_IsDraining = false;
+	uint64_t m_ReadIndex = 0; //Drain thread only
+
+	void RegisterNode(IBehavior* pBehavior, const std::string& parentPath, size_t childOrdinal);
+	void DrainLoop();
+	void Drain(std::vector<uint64_t>& batch);
+	void WriteRecord(std::ostream& stream, const BehaviorTraceRecord& record) const;
+};
@@ -1,11 +1,16 @@
+#pragma once
+
 #include "EliteMath/EMath.h"
 #include "EBehaviorTree.h"
+#include "EStaticBehaviorTree.h"
+#include "EBehaviorTreeLoader.h"
 
 #include "Plugin.h"
 #include "IExamInterface.h"
 #include "Structs.h"
+#include "BlackboardKeys.h"
 
-void PrintMessage(std::string message)
+inline void PrintMessage(std::string message)
 {
 	std::cout << "-----------------------" << "\n";
 	std::cout << message << "\n";
@@ -14,15 +19,15 @@ void PrintMessage(std::string message)
 
 namespace BT_Actions
 {
-	BehaviorState DropOldGun(Blackboard* blackboard)
+	inline BehaviorState DropOldGun(Blackboard* blackboard)
 	{
 		std::vector<EntityInfo>* items{};
 		Inventory inventory{};
 		IExamInterface* examInterface{};
 
-		blackboard->GetData(P_ITEMS_IN_FOV, items);
-		blackboard->GetData(P_INTERFACE, examInterface);
-		blackboard->GetData(P_INVENTORY, inventory);
+		blackboard->GetData(BB_Keys::ItemsInFOV, items);
+		blackboard->GetData(BB_Keys::Interface, examInterface);
+		blackboard->GetData(BB_Keys::Inventory, inventory);
 
 		auto item = items->front();
 
@@ -39,18 +44,18 @@ namespace BT_Actions
 
 		inventory.RemoveSlot(slot);
 
-		blackboard->ChangeData(P_INVENTORY, inventory);
+		blackboard->ChangeData(BB_Keys::Inventory, inventory);
 
 		return BehaviorState::Success;
 	}
 
-	BehaviorState DestroyGun(Blackboard* blackboard)
+	inline BehaviorState DestroyGun(Blackboard* blackboard)
 	{
 		std::vector<EntityInfo>* items{};
 		IExamInterface* examInterface{};
 
-		blackboard->GetData(P_ITEMS_IN_FOV, items);
-		blackboard->GetData(P_INTERFACE, examInterface);
+		blackboard->GetData(BB_Keys::ItemsInFOV, items);
+		blackboard->GetData(BB_Keys::Interface, examInterface);
 
 		auto item = items->front();
 
@@ -66,35 +71,33 @@ namespace BT_Actions
 		return BehaviorState::Success;
 	}
 
-	BehaviorState SetItemAsTarget(Blackboard* blackboard)
+	inline BehaviorState SetItemAsTarget(Blackboard* blackboard)
 	{
 		std::vector<EntityInfo>* items{};
 
-		blackboard->GetData(P_ITEMS_IN_FOV, items);
+		blackboard->GetData(BB_Keys::ItemsInFOV, items);
 
 
 		const auto item = items->front();
 		
-		blackboard->ChangeData(P_TARGETINFO, item.Location);
+		blackboard->ChangeData(BB_Keys::TargetInfo, item.Location);
 		return BehaviorState::Success;
 	}
 
-	BehaviorState SetHouseAsActive(Blackboard* blackboard)
+	inline BehaviorState SetHouseAsActive(Blackboard* blackboard)
 	{
-		std::vector<HouseInfo> houses{};
-		std::vector<KnownHouse> knownHouses{};
 		AgentInfo agentInfo{};
 
-		blackboard->GetData(P_HOUSES_IN_FOV, houses);
-		blackboard->GetData(P_PLAYERINFO, agentInfo);
-		blackboard->GetData(P_KNOWN_HOUSES, knownHouses);
+		const std::vector<HouseInfo>& houses = blackboard->ViewData(BB_Keys::HousesInFOV);
+		const std::vector<KnownHouse>& knownHouses = blackboard->ViewData(BB_Keys::KnownHouses);
+		blackboard->GetData(BB_Keys::PlayerInfo, agentInfo);
 
 		bool housesFound{ houses.size() > 0 };
 		bool shouldCheckoutHouse{};
 
 		auto newHouse = houses[0];
 
-		auto foundIt = std::find_if(knownHouses.begin(), knownHouses.end(), [newHouse](KnownHouse house) {
+		auto foundIt = std::find_if(knownHouses.begin(), knownHouses.end(), [&newHouse](const KnownHouse& house) {
 			float distance = Elite::Distance(house.housePosition, newHouse.Center);
 			return distance <= FLT_EPSILON;
 			});
@@ -102,9 +105,9 @@ namespace BT_Actions
 		// Found
 		if (foundIt != knownHouses.end())
 		{
-			KnownHouse house = *foundIt;
+			const KnownHouse& house = *foundIt;
 
-			if (house.lastSweepTime >= CONFIG_SWEEP_MAX_TIMEOUT)
+			if (house.isSweepDue)
 			{
 				shouldCheckoutHouse = true;
 			}
@@ -117,17 +120,17 @@ namespace BT_Actions
 		if (shouldCheckoutHouse)
 		{
 			// stop spinning like a silly geese
-			blackboard->ChangeData(P_IS_IN_HOUSE, true);
+			blackboard->ChangeData(BB_Keys::IsInHouse, true);
 
-			blackboard->ChangeData(P_TARGETINFO, houses[0].Center);
-			blackboard->ChangeData(P_SHOULDEXPLORE, false);
+			blackboard->ChangeData(BB_Keys::TargetInfo, newHouse.Center);
+			blackboard->ChangeData(BB_Keys::ShouldExplore, false);
 
 			// Set last position to later exit house
-			blackboard->ChangeData(P_LAST_POSITION, agentInfo.Position);
-			blackboard->ChangeData(P_ACTIVE_HOUSE, houses[0]);
+			blackboard->ChangeData(BB_Keys::LastPosition, agentInfo.Position);
+			blackboard->ChangeData(BB_Keys::ActiveHouse, newHouse);
 
 			// In rare scenarios the turn of the agent is to sharp and it escapes the behaviortree
-			blackboard->ChangeData(P_IS_GOING_FOR_HOUSE, true);
+			blackboard->ChangeData(BB_Keys::IsGoingForHouse, true);
 		}
 		else
 		{
@@ -137,106 +140,107 @@ namespace BT_Actions
 		return BehaviorState::Success;
 	}
 
-	BehaviorState RandomizeVisitLocations(Blackboard* blackboard)
+	inline BehaviorState RandomizeVisitLocations(Blackboard* blackboard)
 	{
-		std::vector<Elite::Vector2> locationsToVisit{};
-		std::vector<Elite::Vector2> locationsVisited{};
-
-		blackboard->GetData(P_EXPLORE_LOCATIONS_TO_VISIT, locationsToVisit);
-		blackboard->GetData(P_EXPLORE_LOCATIONS_VISITED, locationsVisited);
-
-		for (auto& loc : locationsVisited)
-		{
-			locationsToVisit.emplace_back(loc);
-		}
+		// Both lists are updated in place, the buffers are reused every round
+		blackboard->ModifyData(BB_Keys::ExploreLocationsVisited, [blackboard](std::vector<Elite::Vector2>& locationsVisited) {
+			blackboard->ModifyData(BB_Keys::ExploreLocationsToVisit, [&locationsVisited](std::vector<Elite::Vector2>& locationsToVisit) {
+				for (auto& loc : locationsVisited)
+				{
+					locationsToVisit.emplace_back(loc);
+				}
 
-		// shuffle
-		std::random_device rd{};
-		std::mt19937 g(rd());
-		std::shuffle(locationsToVisit.begin(), locationsToVisit.end(), g);
+				// shuffle
+				std::random_device rd{};
+				std::mt19937 g(rd());
+				std::shuffle(locationsToVisit.begin(), locationsToVisit.end(), g);
+			});
 
-		// clear visited
-		locationsVisited.clear();
+			// clear visited
+			locationsVisited.clear();
+		});
 
 		// update blackboard
-		blackboard->ChangeData(P_EXPLORE_LOCATIONS_TO_VISIT, locationsToVisit);
-		blackboard->ChangeData(P_EXPLORE_LOCATIONS_VISITED, locationsVisited);
-		blackboard->ChangeData(P_DESTINATION, locationsToVisit[0]);
+		blackboard->ChangeData(BB_Keys::Destination, blackboard->ViewData(BB_Keys::ExploreLocationsToVisit)[0]);
 
 		return BehaviorState::Success;
 	}
 
-	BehaviorState UpdateExplorationList(Blackboard* blackboard)
+	inline BehaviorState UpdateExplorationList(Blackboard* blackboard)
 	{
-		std::vector<Elite::Vector2> locationsToVisit{};
-		std::vector<Elite::Vector2> locationsVisited{};
 		AgentInfo playerInfo{};
 	
-		blackboard->GetData(P_EXPLORE_LOCATIONS_TO_VISIT, locationsToVisit);
-		blackboard->GetData(P_EXPLORE_LOCATIONS_VISITED, locationsVisited);
-		blackboard->GetData(P_PLAYERINFO, playerInfo);
+		blackboard->GetData(BB_Keys::PlayerInfo, playerInfo);
 
-		// Get reached element location
-		auto closestLocIt = std::find_if(locationsToVisit.begin(), locationsToVisit.end(), [playerInfo](Elite::Vector2 loc) {
-			return Elite::DistanceSquared(playerInfo.Position, loc) <= CONFIG_HAS_REACHED_DESTINATION * CONFIG_HAS_REACHED_DESTINATION;
-		});
+		// Both lists are updated in place
+		blackboard->ModifyData(BB_Keys::ExploreLocationsToVisit, [blackboard, &playerInfo](std::vector<Elite::Vector2>& locationsToVisit) {
+			// Get reached element location
+			auto closestLocIt = std::find_if(locationsToVisit.begin(), locationsToVisit.end(), [&playerInfo](const Elite::Vector2& loc) {
+				return Elite::DistanceSquared(playerInfo.Position, loc) <= CONFIG_HAS_REACHED_DESTINATION * CONFIG_HAS_REACHED_DESTINATION;
+			});
 
-		// catch if location wouldn't exist == should not be possible
-		if (closestLocIt == locationsToVisit.end())
-		{
-			throw std::runtime_error("Closest location not found");
-		}
+			// catch if location wouldn't exist == should not be possible
+			if (closestLocIt == locationsToVisit.end())
+			{
+				throw std::runtime_error("Closest location not found");
+			}
 
-		// place in visited
-		locationsVisited.emplace_back(*closestLocIt);
+			const Elite::Vector2 reachedLocation = *closestLocIt;
 
-		// remove from todo
-		auto toRemove = std::remove(locationsToVisit.begin(), locationsToVisit.end(), *closestLocIt);
-		locationsToVisit.erase(toRemove);
+			// place in visited
+			blackboard->ModifyData(BB_Keys::ExploreLocationsVisited, [&reachedLocation](std::vector<Elite::Vector2>& locationsVisited) {
+				locationsVisited.emplace_back(reachedLocation);
+			});
 
-		// Update blackboard
-		blackboard->ChangeData(P_EXPLORE_LOCATIONS_TO_VISIT, locationsToVisit);
-		blackboard->ChangeData(P_EXPLORE_LOCATIONS_VISITED, locationsVisited);
+			// remove from todo
+			auto toRemove = std::remove(locationsToVisit.begin(), locationsToVisit.end(), reachedLocation);
+			locationsToVisit.erase(toRemove);
+		});
 
 		return BehaviorState::Success;
 	}
 
-	BehaviorState SetNewExploreDestination(Blackboard* blackboard)
+	inline BehaviorState SetNewExploreDestination(Blackboard* blackboard)
 	{
-		std::vector<Elite::Vector2> locationsToVisit{};
+		const std::vector<Elite::Vector2>& locationsToVisit = blackboard->ViewData(BB_Keys::ExploreLocationsToVisit);
 
-		blackboard->GetData(P_EXPLORE_LOCATIONS_TO_VISIT, locationsToVisit);
+		// Last location was just visited, the list gets randomized again next tick
+		if (locationsToVisit.empty())
+		{
+			return BehaviorState::Failure;
+		}
 
 		auto newLocation = locationsToVisit[locationsToVisit.size() - 1];
 
-		blackboard->ChangeData(P_DESTINATION, newLocation);
+		blackboard->ChangeData(BB_Keys::Destination, newLocation);
 
 		return BehaviorState::Success;
 	}
 
-	BehaviorState AddHouseToVisited(Blackboard* blackboard)
+	inline BehaviorState AddHouseToVisited(Blackboard* blackboard)
 	{
-		std::vector<KnownHouse> knownHouses{};
 		HouseInfo activeHouse{};
 	
-		blackboard->GetData(P_ACTIVE_HOUSE, activeHouse);
-		blackboard->GetData(P_KNOWN_HOUSES, knownHouses);
-
-		knownHouses.push_back(KnownHouse{ activeHouse.Center, 0.f });
+		blackboard->GetData(BB_Keys::ActiveHouse, activeHouse);
 
 		// update blackboard
-		blackboard->ChangeData(P_KNOWN_HOUSES, knownHouses);
+		blackboard->ModifyData(BB_Keys::KnownHouses, [&activeHouse](std::vector<KnownHouse>& knownHouses) {
+			knownHouses.push_back(KnownHouse{ activeHouse.Center, false });
+		});
+		blackboard->ModifyData(BB_Keys::KnownHouseSweepTimers, [](std::vector<float>& timers) {
+			timers.push_back(0.f);
+		});
 
 		return BehaviorState::Success;
 	}
 
-	BehaviorState Face(Blackboard* blackboard)
+	inline BehaviorState Face(Blackboard* blackboard)
 	{
 		Elite::Vector2 target{};
 		AgentInfo playerInfo{};
 
-		blackboard->GetData(P_TARGETINFO, target);
-		blackboard->GetData(P_PLAYERINFO, playerInfo);
+		blackboard->GetData(BB_Keys::TargetInfo, target);
+		blackboard->GetData(BB_Keys::PlayerInfo, playerInfo);
 
 		SteeringPlugin_Output steering{};
 
@@ -262,42 +266,42 @@ namespace BT_Actions
 		steering.AngularVelocity = deltaAngle * CONFIG_TURN_SPEED * direction;
 		steering.AutoOrient = false;
 
-		blackboard->ChangeData(P_STEERING, steering);
+		blackboard->ChangeData(BB_Keys::Steering, steering);
 
 		return BehaviorState::Success;
 	}
 
-	BehaviorState SetAsTarget(Blackboard* blackboard)
+	inline BehaviorState SetAsTarget(Blackboard* blackboard)
 	{
 		std::vector<EnemyInfo>* enemies{};
 
-		blackboard->GetData(P_ENEMIES_IN_FOV, enemies);
+		blackboard->GetData(BB_Keys::EnemiesInFOV, enemies);
 
 		if (enemies->size() <= 0)
 		{
 			return BehaviorState::Failure;
 		}
 
-		blackboard->ChangeData(P_TARGETINFO, enemies->front().Location);
+		blackboard->ChangeData(BB_Keys::TargetInfo, enemies->front().Location);
 		return BehaviorState::Success;
 	}
 
-	BehaviorState SetRunAsTarget(Blackboard* blackboard)
+	inline BehaviorState SetRunAsTarget(Blackboard* blackboard)
 	{
 		Elite::Vector2 destination{};
 
-		blackboard->GetData(P_DESTINATION, destination);
-		blackboard->ChangeData(P_TARGETINFO, destination);
+		blackboard->GetData(BB_Keys::Destination, destination);
+		blackboard->ChangeData(BB_Keys::TargetInfo, destination);
 
 		return BehaviorState::Success;
 	}
 
-	BehaviorState DestroyGarbage(Blackboard* blackboard)
+	inline BehaviorState DestroyGarbage(Blackboard* blackboard)
 	{
 		std::vector<EntityInfo>* items{};
 		IExamInterface* examInterface{};
-		blackboard->GetData(P_ITEMS_IN_FOV, items);
-		blackboard->GetData(P_INTERFACE, examInterface);
+		blackboard->GetData(BB_Keys::ItemsInFOV, items);
+		blackboard->GetData(BB_Keys::Interface, examInterface);
 
 		// get first item
 		auto item = items->front();
@@ -319,15 +323,15 @@ namespace BT_Actions
 		return BehaviorState::Success;
 	}
 
-	BehaviorState PickupItem(Blackboard* blackboard)
+	inline BehaviorState PickupItem(Blackboard* blackboard)
 	{
 		std::vector<EntityInfo>* items{};
 		Inventory inventory{};
 		IExamInterface* examInterface{};
 
-		blackboard->GetData(P_ITEMS_IN_FOV, items);
-		blackboard->GetData(P_INVENTORY, inventory);
-		blackboard->GetData(P_INTERFACE, examInterface);
+		blackboard->GetData(BB_Keys::ItemsInFOV, items);
+		blackboard->GetData(BB_Keys::Inventory, inventory);
+		blackboard->GetData(BB_Keys::Interface, examInterface);
 
 		// get first item
 		auto item = items->front();
@@ -355,12 +359,12 @@ namespace BT_Actions
 
 		// Add item and occupy slot
 		inventory.FillSlot(slot, itemInfo);
-		blackboard->ChangeData(P_INVENTORY, inventory);
+		blackboard->ChangeData(BB_Keys::Inventory, inventory);
 
 		return BehaviorState::Success;
 	}
 
-	BehaviorState Pickup(Blackboard* blackboard)
+	inline BehaviorState Pickup(Blackboard* blackboard)
 	{
 		std::vector<EntityInfo>* items{};
 		IExamInterface* examInterface{};
@@ -368,11 +372,11 @@ namespace BT_Actions
 		Inventory inventory{};
 		Elite::Vector2 targetInfo{};
 
-		blackboard->GetData(P_ITEMS_IN_FOV, items);
-		blackboard->GetData(P_INTERFACE, examInterface);
-		blackboard->GetData(P_INVENTORY, inventory);
-		blackboard->GetData(P_PLAYERINFO, agentInfo);
-		blackboard->GetData(P_TARGETINFO, targetInfo);
+		blackboard->GetData(BB_Keys::ItemsInFOV, items);
+		blackboard->GetData(BB_Keys::Interface, examInterface);
+		blackboard->GetData(BB_Keys::Inventory, inventory);
+		blackboard->GetData(BB_Keys::PlayerInfo, agentInfo);
+		blackboard->GetData(BB_Keys::TargetInfo, targetInfo);
 
 		// Get empty slot + validate if valid slot
 		UINT slot = inventory.HasEmptySlot();
@@ -414,7 +418,7 @@ namespace BT_Actions
 					{
 						inventory.RemoveSlot(slot);
 						examInterface->Inventory_UseItem(slot);
-						blackboard->ChangeData(P_INVENTORY, inventory);
+						blackboard->ChangeData(BB_Keys::Inventory, inventory);
 						PrintMessage("Consumed leftover food to pickup more");
 					}
 					else
@@ -422,7 +426,7 @@ namespace BT_Actions
 						// Remove lower grade item
 						inventory.RemoveSlot(slot);
 						examInterface->Inventory_RemoveItem(slot);
-						blackboard->ChangeData(P_INVENTORY, inventory);
+						blackboard->ChangeData(BB_Keys::Inventory, inventory);
 					}
 				}
 			}
@@ -446,7 +450,7 @@ namespace BT_Actions
 
 				// Add item and occupy slot
 				inventory.FillSlot(slot, itemInfo);
-				blackboard->ChangeData(P_INVENTORY, inventory);
+				blackboard->ChangeData(BB_Keys::Inventory, inventory);
 
 				return BehaviorState::Success;
 			}
@@ -454,7 +458,7 @@ namespace BT_Actions
 			{
 				// Not close so set location and let seek handle movement
 				targetInfo = item.Location;
-				blackboard->ChangeData(P_TARGETINFO, targetInfo);
+				blackboard->ChangeData(BB_Keys::TargetInfo, targetInfo);
 				return BehaviorState::Running;
 			}
 		}
@@ -471,17 +475,17 @@ namespace BT_Actions
 
 				// Add item and occupy slot
 				inventory.FillSlot(slot, itemInfo);
-				blackboard->ChangeData(P_INVENTORY, inventory);
+				blackboard->ChangeData(BB_Keys::Inventory, inventory);
 			}
 
 			return BehaviorState::Success;
 		}
 
-		blackboard->ChangeData(P_TARGETINFO, targetInfo);
+		blackboard->ChangeData(BB_Keys::TargetInfo, targetInfo);
 		return BehaviorState::Success;
 	}
 
-	BehaviorState Drop(Blackboard* blackboard)
+	inline BehaviorState Drop(Blackboard* blackboard)
 	{
 		std::vector<EntityInfo>* items{};
 		IExamInterface* examInterface{};
@@ -490,11 +494,11 @@ namespace BT_Actions
 		Elite::Vector2 targetInfo{};
 
 		bool dataFound =
-			blackboard->GetData(P_ITEMS_IN_FOV, items) &&
-			blackboard->GetData(P_INTERFACE, examInterface) &&
-			blackboard->GetData(P_INVENTORY, inventory) &&
-			blackboard->GetData(P_PLAYERINFO, agentInfo) &&
-			blackboard->GetData(P_TARGETINFO, targetInfo);
+			blackboard->GetData(BB_Keys::ItemsInFOV, items) &&
+			blackboard->GetData(BB_Keys::Interface, examInterface) &&
+			blackboard->GetData(BB_Keys::Inventory, inventory) &&
+			blackboard->GetData(BB_Keys::PlayerInfo, agentInfo) &&
+			blackboard->GetData(BB_Keys::TargetInfo, targetInfo);
 
 		if (!dataFound)
 		{
@@ -509,7 +513,7 @@ namespace BT_Actions
 				inventory.RemoveSlot(i);
 				examInterface->Inventory_RemoveItem(i);
 
-				blackboard->ChangeData(P_INVENTORY, inventory);
+				blackboard->ChangeData(BB_Keys::Inventory, inventory);
 			}
 		}
 
@@ -537,7 +541,7 @@ namespace BT_Actions
 		return BehaviorState::Success;
 	}
 
-	BehaviorState Seek(Blackboard* blackboard)
+	inline BehaviorState Seek(Blackboard* blackboard)
 	{
 		Elite::Vector2 targetPos{};
 		AgentInfo agentInfo{};
@@ -545,10 +549,10 @@ namespace BT_Actions
 		SteeringPlugin_Output output{};
 		bool isInsideHouse{};
 
-		bool dataFound = blackboard->GetData(P_TARGETINFO, targetPos) &&
-			blackboard->GetData(P_PLAYERINFO, agentInfo) &&
-			blackboard->GetData(P_INTERFACE, pluginInterface) &&
-			blackboard->GetData(P_IS_IN_HOUSE, isInsideHouse);
+		bool dataFound = blackboard->GetData(BB_Keys::TargetInfo, targetPos) &&
+			blackboard->GetData(BB_Keys::PlayerInfo, agentInfo) &&
+			blackboard->GetData(BB_Keys::Interface, pluginInterface) &&
+			blackboard->GetData(BB_Keys::IsInHouse, isInsideHouse);
 
 		if (!dataFound)
 		{
@@ -575,28 +579,51 @@ namespace BT_Actions
 		output.LinearVelocity.Normalize();
 		output.LinearVelocity *= agentInfo.MaxLinearSpeed;
 
-		blackboard->ChangeData(P_STEERING, output);
+		blackboard->ChangeData(BB_Keys::Steering, output);
 		return BehaviorState::Success;
 	}
 
-	BehaviorState Explore(Blackboard* blackboard)
+	// Keeps seeking until the target is reached, so a resuming tree can continue here
+	inline BehaviorState SeekToTarget(Blackboard* blackboard)
+	{
+		const BehaviorState seekState = Seek(blackboard);
+		if (seekState != BehaviorState::Success)
+		{
+			return seekState;
+		}
+
+		Elite::Vector2 targetPos{};
+		AgentInfo agentInfo{};
+
+		blackboard->GetData(BB_Keys::TargetInfo, targetPos);
+		blackboard->GetData(BB_Keys::PlayerInfo, agentInfo);
+
+		if (Elite::DistanceSquared(targetPos, agentInfo.Position) > CONFIG_HAS_REACHED_DESTINATION * CONFIG_HAS_REACHED_DESTINATION)
+		{
+			return BehaviorState::Running;
+		}
+
+		return BehaviorState::Success;
+	}
+
+	inline BehaviorState Explore(Blackboard* blackboard)
 	{
 
 		Elite::Vector2 destination{};
 		
 
-		bool dataFound = blackboard->GetData(P_DESTINATION, destination);
+		bool dataFound = blackboard->GetData(BB_Keys::Destination, destination);
 		if (!dataFound)
 		{
 			return BehaviorState::Failure;
 		}
 
-		blackboard->ChangeData(P_TARGETINFO, destination);
+		blackboard->ChangeData(BB_Keys::TargetInfo, destination);
 
 		return BehaviorState::Success;
 	}
 
-	BehaviorState Sweep(Blackboard* blackboard)
+	inline BehaviorState Sweep(Blackboard* blackboard)
 	{
 		Elite::Vector2 targetPos{};
 		AgentInfo agentInfo{};
@@ -604,11 +631,11 @@ namespace BT_Actions
 		SteeringPlugin_Output output{};
 		SweepHouse sweepHouse{};
 
-		bool dataFound = blackboard->GetData(P_TARGETINFO, targetPos) &&
-			blackboard->GetData(P_PLAYERINFO, agentInfo) &&
-			blackboard->GetData(P_INTERFACE, pluginInterface) &&
-			blackboard->GetData(P_STEERING, output) &&
-			blackboard->GetData(P_HOUSE_TO_SWEEP, sweepHouse);
+		bool dataFound = blackboard->GetData(BB_Keys::TargetInfo, targetPos) &&
+			blackboard->GetData(BB_Keys::PlayerInfo, agentInfo) &&
+			blackboard->GetData(BB_Keys::Interface, pluginInterface) &&
+			blackboard->GetData(BB_Keys::Steering, output) &&
+			blackboard->GetData(BB_Keys::HouseToSweep, sweepHouse);
 
 		if (!dataFound)
 		{
@@ -627,48 +654,60 @@ namespace BT_Actions
 			output.LinearVelocity.Normalize();
 			output.LinearVelocity *= agentInfo.MaxLinearSpeed;
 
-			blackboard->ChangeData(P_HOUSE_TO_SWEEP, sweepHouse);
+			blackboard->ChangeData(BB_Keys::HouseToSweep, sweepHouse);
 		}
 		else
 		{
 			HouseInfo activeHouse{};
-			std::vector<KnownHouse> knownHouses{};
-
-			blackboard->GetData(P_ACTIVE_HOUSE, activeHouse);
-			blackboard->GetData(P_KNOWN_HOUSES, knownHouses);
 
-			bool houseExists{};
+			blackboard->GetData(BB_Keys::ActiveHouse, activeHouse);
 
-			for (KnownHouse& house : knownHouses)
-			{
-				if (Elite::Distance(house.housePosition, activeHouse.Center) <= FLT_EPSILON)
+			// Timers follow the order of the known houses, they are reset before the house is added
+			const std::vector<KnownHouse>& knownHouses = blackboard->ViewData(BB_Keys::KnownHouses);
+			blackboard->ModifyData(BB_Keys::KnownHouseSweepTimers, [&activeHouse, &knownHouses](std::vector<float>& timers) {
+				timers.resize(knownHouses.size());
+				for (size_t i{}; i < knownHouses.size(); ++i)
 				{
-					// Reference will update original list
-					house.lastSweepTime = 0.f;
+					if (Elite::Distance(knownHouses[i].housePosition, activeHouse.Center) <= FLT_EPSILON)
+						timers[i] = 0.f;
 				}
-			}
+				timers.push_back(0.f);
+			});
 
-			if (!houseExists)
-			{
-				knownHouses.push_back(KnownHouse{ activeHouse.Center, 0.f });
-			}
+			blackboard->ModifyData(BB_Keys::KnownHouses, [&activeHouse](std::vector<KnownHouse>& knownHouses) {
+				bool houseExists{};
 
-			blackboard->ChangeData(P_KNOWN_HOUSES, knownHouses);
+				for (KnownHouse& house : knownHouses)
+				{
+					if (Elite::Distance(house.housePosition, activeHouse.Center) <= FLT_EPSILON)
+					{
+						// Reference will update original list
+						house.isSweepDue = false;
+					}
+				}
+
+				if (!houseExists)
+				{
+					knownHouses.push_back(KnownHouse{ activeHouse.Center, false });
+				}
+			});
 		}
 
-		blackboard->ChangeData(P_STEERING, output);
+		blackboard->ChangeData(BB_Keys::Steering, output);
+
+		return BehaviorState::Success;
 	}
 
-	BehaviorState ExitHouse(Blackboard* blackboard)
+	inline BehaviorState ExitHouse(Blackboard* blackboard)
 	{
 		Elite::Vector2 targetPos{};
 		AgentInfo agentInfo{};
 		IExamInterface* pluginInterface{};
 		SteeringPlugin_Output output{};
 
-		bool dataFound = blackboard->GetData(P_DESTINATION, targetPos) &&
-			blackboard->GetData(P_PLAYERINFO, agentInfo) &&
-			blackboard->GetData(P_INTERFACE, pluginInterface);
+		bool dataFound = blackboard->GetData(BB_Keys::Destination, targetPos) &&
+			blackboard->GetData(BB_Keys::PlayerInfo, agentInfo) &&
+			blackboard->GetData(BB_Keys::Interface, pluginInterface);
 
 		if (!dataFound)
 		{
@@ -682,23 +721,23 @@ namespace BT_Actions
 		output.LinearVelocity.Normalize();
 		output.LinearVelocity *= agentInfo.MaxLinearSpeed;
 
-		blackboard->ChangeData(P_STEERING, output);
-		blackboard->ChangeData(P_SHOULDEXPLORE, true);
-		blackboard->ChangeData(P_IS_GOING_FOR_HOUSE, false);
-		blackboard->ChangeData(P_IS_IN_HOUSE, false);
+		blackboard->ChangeData(BB_Keys::Steering, output);
+		blackboard->ChangeData(BB_Keys::ShouldExplore, true);
+		blackboard->ChangeData(BB_Keys::IsGoingForHouse, false);
+		blackboard->ChangeData(BB_Keys::IsInHouse, false);
 
 		return BehaviorState::Success;
 	}
 
-	BehaviorState Heal(Blackboard* blackboard) 
+	inline BehaviorState Heal(Blackboard* blackboard) 
 	{
 		Inventory inventory{};
 		AgentInfo playerInfo{};
 		IExamInterface* examInterface{};
 
-		bool hasData = blackboard->GetData(P_PLAYERINFO, playerInfo)
-			&& blackboard->GetData(P_INVENTORY, inventory)
-			&& blackboard->GetData(P_INTERFACE, examInterface);
+		bool hasData = blackboard->GetData(BB_Keys::PlayerInfo, playerInfo)
+			&& blackboard->GetData(BB_Keys::Inventory, inventory)
+			&& blackboard->GetData(BB_Keys::Interface, examInterface);
 
 		// no need to check validation (CanHeal did that already)
 		auto foundIt = inventory.HasTypeOfInInventory(eItemType::MEDKIT);
@@ -708,20 +747,20 @@ namespace BT_Actions
 		inventory.RemoveSlot(slot);
 		examInterface->Inventory_UseItem(slot);
 		examInterface->Inventory_RemoveItem(slot);
-		blackboard->ChangeData(P_INVENTORY, inventory);
+		blackboard->ChangeData(BB_Keys::Inventory, inventory);
 
 		return BehaviorState::Success;
 	}
 
-	BehaviorState Eat(Blackboard* blackboard)
+	inline BehaviorState Eat(Blackboard* blackboard)
 	{
 		Inventory inventory{};
 		AgentInfo playerInfo{};
 		IExamInterface* examInterface{};
 
-		bool hasData = blackboard->GetData(P_PLAYERINFO, playerInfo)
-			&& blackboard->GetData(P_INVENTORY, inventory)
-			&& blackboard->GetData(P_INTERFACE, examInterface);
+		bool hasData = blackboard->GetData(BB_Keys::PlayerInfo, playerInfo)
+			&& blackboard->GetData(BB_Keys::Inventory, inventory)
+			&& blackboard->GetData(BB_Keys::Interface, examInterface);
 
 		// no need to check validation (CanHeal did that already)
 		auto foundIt = inventory.HasTypeOfInInventory(eItemType::FOOD);
@@ -731,22 +770,22 @@ namespace BT_Actions
 		inventory.RemoveSlot(slot);
 		examInterface->Inventory_UseItem(slot);
 		examInterface->Inventory_RemoveItem(slot);
-		blackboard->ChangeData(P_INVENTORY, inventory);
+		blackboard->ChangeData(BB_Keys::Inventory, inventory);
 
 		return BehaviorState::Success;
 	}
 
-	BehaviorState FaceZombie(Blackboard* blackboard)
+	inline BehaviorState FaceZombie(Blackboard* blackboard)
 	{
 		AgentInfo playerInfo{};
 		IExamInterface* examInterface{};
 		Elite::Vector2 zombie{};
 		SteeringPlugin_Output output{};
 
-		bool hasData = blackboard->GetData(P_ZOMBIE_TARGET, zombie) &&
-			blackboard->GetData(P_PLAYERINFO, playerInfo) &&
-			blackboard->GetData(P_INTERFACE, examInterface) &&
-			blackboard->GetData(P_STEERING, output);
+		bool hasData = blackboard->GetData(BB_Keys::ZombieTarget, zombie) &&
+			blackboard->GetData(BB_Keys::PlayerInfo, playerInfo) &&
+			blackboard->GetData(BB_Keys::Interface, examInterface) &&
+			blackboard->GetData(BB_Keys::Steering, output);
 
 		auto targetDir = zombie - playerInfo.Position;
 		auto angleTo = atan2f(targetDir.y, targetDir.x) + float(E_PI_2);
@@ -756,7 +795,7 @@ namespace BT_Actions
 		output.AngularVelocity = deltaAngle * CONFIG_TURN_SPEED;
 		output.AutoOrient = false;
 
-		blackboard->ChangeData(P_STEERING, output);
+		blackboard->ChangeData(BB_Keys::Steering, output);
 
 		if (deltaAngle >= 1.f)
 		{
@@ -768,13 +807,13 @@ namespace BT_Actions
 		}
 	}
 
-	BehaviorState Shoot(Blackboard* blackboard)
+	inline BehaviorState Shoot(Blackboard* blackboard)
 	{
 		Inventory inventory{};
 		IExamInterface* examInterface{};
 
-		blackboard->GetData(P_INVENTORY, inventory);
-		blackboard->GetData(P_INTERFACE, examInterface);
+		blackboard->GetData(BB_Keys::Inventory, inventory);
+		blackboard->GetData(BB_Keys::Interface, examInterface);
 
 		auto pistolIt = inventory.HasTypeOfInInventory(eItemType::PISTOL);
 		auto shotgunIt = inventory.HasTypeOfInInventory(eItemType::SHOTGUN);
@@ -789,7 +828,7 @@ namespace BT_Actions
 			if (oldAmmoCount - 1 <= 0)
 			{
 				inventory.RemoveSlot(slot);
-				blackboard->ChangeData(P_INVENTORY, inventory);
+				blackboard->ChangeData(BB_Keys::Inventory, inventory);
 				examInterface->Inventory_RemoveItem(slot);
 			}
 		}
@@ -803,7 +842,7 @@ namespace BT_Actions
 			if (oldAmmoCount - 1 <= 0)
 			{
 				inventory.RemoveSlot(slot);
-				blackboard->ChangeData(P_INVENTORY, inventory);
+				blackboard->ChangeData(BB_Keys::Inventory, inventory);
 				examInterface->Inventory_RemoveItem(slot);
 			}
 		}
@@ -811,18 +850,18 @@ namespace BT_Actions
 		return BehaviorState::Success;
 	}
 
-	BehaviorState Turn(Blackboard* blackboard)
+	inline BehaviorState Turn(Blackboard* blackboard)
 	{
 		SteeringPlugin_Output output{};
 
 		output.AutoOrient = false;
 		output.AngularVelocity = CONFIG_TURN_SPEED;
 
-		blackboard->ChangeData(P_STEERING, output);
+		blackboard->ChangeData(BB_Keys::Steering, output);
 		return BehaviorState::Success;
 	}
 
-	BehaviorState RunForestRun(Blackboard* blackboard) 
+	inline BehaviorState RunForestRun(Blackboard* blackboard) 
 	{
 		Elite::Vector2 targetPos{};
 		AgentInfo playerInfo{};
@@ -830,9 +869,9 @@ namespace BT_Actions
 		SteeringPlugin_Output output{};
 		bool canRun{};
 
-		bool dataFound = blackboard->GetData(P_TARGETINFO, targetPos) &&
-			blackboard->GetData(P_PLAYERINFO, playerInfo) &&
-			blackboard->GetData(P_INTERFACE, examInterface);
+		bool dataFound = blackboard->GetData(BB_Keys::TargetInfo, targetPos) &&
+			blackboard->GetData(BB_Keys::PlayerInfo, playerInfo) &&
+			blackboard->GetData(BB_Keys::Interface, examInterface);
 
 		targetPos = examInterface->NavMesh_GetClosestPathPoint(targetPos);
 
@@ -842,7 +881,7 @@ namespace BT_Actions
 		output.LinearVelocity.Normalize();
 		output.LinearVelocity *= playerInfo.MaxLinearSpeed;
 
-		blackboard->ChangeData(P_STEERING, output);
+		blackboard->ChangeData(BB_Keys::Steering, output);
 		return BehaviorState::Success;
 	}
 }
@@ -850,11 +889,11 @@ namespace BT_Actions
 namespace BT_Conditions
 {
 
-	bool ShouldExplore(Blackboard* blackboard)
+	inline bool ShouldExplore(Blackboard* blackboard)
 	{
 		bool shouldExplore{};
 
-		bool dataFound = blackboard->GetData(P_SHOULDEXPLORE, shouldExplore);
+		bool dataFound = blackboard->GetData(BB_Keys::ShouldExplore, shouldExplore);
 
 		if (!dataFound)
 		{
@@ -864,27 +903,35 @@ namespace BT_Conditions
 		return shouldExplore;
 	}
 	
-	bool IsHouseInFOV(Blackboard* blackboard)
+	inline bool IsHouseInFOV(Blackboard* blackboard)
 	{
-		std::vector<HouseInfo> houses{};
-
-		bool dataFound = blackboard->GetData(P_HOUSES_IN_FOV, houses);
-
-		if (!dataFound)
+		bool isHouseInFOV{};
+		if (blackboard->GetCachedResult(BB_Keys::IsHouseInFOVCache, isHouseInFOV, BB_Keys::HousesInFOV))
 		{
-			return false;
+			return isHouseInFOV;
 		}
 
-		return houses.size() > 0;
+		const std::vector<HouseInfo>& houses = blackboard->ViewData(BB_Keys::HousesInFOV);
+
+		isHouseInFOV = houses.size() > 0;
+		blackboard->SetCachedResult(BB_Keys::IsHouseInFOVCache, isHouseInFOV, BB_Keys::HousesInFOV);
+
+		return isHouseInFOV;
 	}
 
-	bool IsInHouse(Blackboard* blackboard)
+	inline bool IsInHouse(Blackboard* blackboard)
 	{
+		bool isCachedInHouse{};
+		if (blackboard->GetCachedResult(BB_Keys::IsInHouseCache, isCachedInHouse, BB_Keys::ActiveHouse, BB_Keys::PlayerInfo))
+		{
+			return isCachedInHouse;
+		}
+
 		AgentInfo agentInfo{};
 		HouseInfo houseInfo{};
 
-		bool dataFound = blackboard->GetData(P_ACTIVE_HOUSE, houseInfo) &&
-			blackboard->GetData(P_PLAYERINFO, agentInfo);
+		bool dataFound = blackboard->GetData(BB_Keys::ActiveHouse, houseInfo) &&
+			blackboard->GetData(BB_Keys::PlayerInfo, agentInfo);
 
 		if (!dataFound)
 		{
@@ -899,74 +946,82 @@ namespace BT_Conditions
 			agentInfo.Position.y < houseInfo.Center.y + houseInfo.Size.y / 2
 		);
 
+		blackboard->SetCachedResult(BB_Keys::IsInHouseCache, isInHouse, BB_Keys::ActiveHouse, BB_Keys::PlayerInfo);
+
 		return isInHouse;
 	}
 	
-	bool ShouldSweepHouse(Blackboard* blackboard)
+	inline bool ShouldSweepHouse(Blackboard* blackboard)
 	{
-		std::vector<KnownHouse> knownHouses{};
+		bool shouldSweep{};
+		if (blackboard->GetCachedResult(BB_Keys::ShouldSweepHouseCache, shouldSweep, BB_Keys::KnownHouses, BB_Keys::ActiveHouse, BB_Keys::HouseToSweep))
+		{
+			// When sweeping we know we are inside, so we set data
+			blackboard->ChangeData(BB_Keys::IsInHouse, true);
+			return shouldSweep;
+		}
+
 		HouseInfo activeHouse{};
 		SweepHouse sweepHouse{};
 
+		const std::vector<KnownHouse>& knownHouses = blackboard->ViewData(BB_Keys::KnownHouses);
+
 		bool dataFound =
-			blackboard->GetData(P_KNOWN_HOUSES, knownHouses) &&
-			blackboard->GetData(P_ACTIVE_HOUSE, activeHouse) &&
-			blackboard->GetData(P_HOUSE_TO_SWEEP, sweepHouse);
+			blackboard->GetData(BB_Keys::ActiveHouse, activeHouse) &&
+			blackboard->GetData(BB_Keys::HouseToSweep, sweepHouse);
 
 		if (!dataFound)
 		{
 			return false;
 		}
 
-		auto foundIt = std::find_if(knownHouses.begin(), knownHouses.end(), [activeHouse](KnownHouse house) {
+		auto foundIt = std::find_if(knownHouses.begin(), knownHouses.end(), [&activeHouse](const KnownHouse& house) {
 			float distance = Elite::Distance(house.housePosition, activeHouse.Center);
 			return distance <= FLT_EPSILON;
 		});
 
 		// When sweeping we know we are inside, so we set data
-		blackboard->ChangeData(P_IS_IN_HOUSE, true);
+		blackboard->ChangeData(BB_Keys::IsInHouse, true);
 
 		// Found
 		if (foundIt != knownHouses.end())
 		{
-			KnownHouse house = *foundIt;
+			const KnownHouse& house = *foundIt;
 
-			if (house.lastSweepTime >= CONFIG_SWEEP_MAX_TIMEOUT)
+			if (house.isSweepDue)
 			{
-				if (!sweepHouse.HasGeneratedLocations(activeHouse.Center))
-				{
-					sweepHouse.GenerateSweepLocations(activeHouse);
-					blackboard->ChangeData(P_HOUSE_TO_SWEEP, sweepHouse);
-				}
-
-				return true;
+				shouldSweep = true;
 			}
 		}
 		else
 		{
-			if (!sweepHouse.HasGeneratedLocations(activeHouse.Center))
-			{
-				sweepHouse.GenerateSweepLocations(activeHouse);
-				blackboard->ChangeData(P_HOUSE_TO_SWEEP, sweepHouse);
-			}
+			shouldSweep = true;
+		}
 
-			return true;
+		if (shouldSweep && !sweepHouse.HasGeneratedLocations(activeHouse.Center))
+		{
+			sweepHouse.GenerateSweepLocations(activeHouse);
+			blackboard->ChangeData(BB_Keys::HouseToSweep, sweepHouse);
 		}
 
-		return false;
+		// Stored after the sweep locations so their change does not invalidate it
+		blackboard->SetCachedResult(BB_Keys::ShouldSweepHouseCache, shouldSweep, BB_Keys::KnownHouses, BB_Keys::ActiveHouse, BB_Keys::HouseToSweep);
+
+		return shouldSweep;
 	}
 
-	bool IsGoingToHouse(Blackboard* blackboard)
+	inline bool IsGoingToHouse(Blackboard* blackboard)
 	{
 		bool isGoingForHouse{};
 		HouseInfo houseInfo{};
 		Elite::Vector2 target{};
 
-		bool dataFound = blackboard->GetData(P_IS_GOING_FOR_HOUSE, isGoingForHouse) &&
-			blackboard->GetData(P_ACTIVE_HOUSE, houseInfo) &&
-			blackboard->GetData(P_TARGETINFO, target);
+		bool dataFound = blackboard->GetData(BB_Keys::IsGoingForHouse, isGoingForHouse) &&
+			blackboard->GetData(BB_Keys::ActiveHouse, houseInfo) &&
+			blackboard->GetData(BB_Keys::TargetInfo, target);
 
-		if (!dataFound)
+		// Only fix the target while going for the house, an observer runs this while other branches own the target
+		if (!dataFound || !isGoingForHouse)
 		{
 			return false;
 		}
@@ -975,7 +1030,7 @@ namespace BT_Conditions
 		if (Elite::Distance(target, houseInfo.Center) > FLT_EPSILON)
 		{
 			// Reset the target to the house to stop bug
-			blackboard->ChangeData(P_TARGETINFO, houseInfo.Center);
+			blackboard->ChangeData(BB_Keys::TargetInfo, houseInfo.Center);
 
 			return false;
 		}
@@ -983,14 +1038,14 @@ namespace BT_Conditions
 		return isGoingForHouse;
 	}
 
-	bool SeesItem(Blackboard* blackboard)
+	inline bool SeesItem(Blackboard* blackboard)
 	{
 		std::vector<EntityInfo>* items{};
 		IExamInterface* examInterface{};
 
 		bool dataFound =
-			blackboard->GetData(P_ITEMS_IN_FOV, items) &&
-			blackboard->GetData(P_INTERFACE, examInterface);
+			blackboard->GetData(BB_Keys::ItemsInFOV, items) &&
+			blackboard->GetData(BB_Keys::Interface, examInterface);
 
 		if (!dataFound || items->size() == 0)
 		{
@@ -1006,19 +1061,19 @@ namespace BT_Conditions
 			return false;
 		}
 
-		blackboard->ChangeData(P_IS_IN_HOUSE, true);
+		blackboard->ChangeData(BB_Keys::IsInHouse, true);
 
 		return items->size() != 0;
 	}
 
-	bool SeesGarbage(Blackboard* blackboard)
+	inline bool SeesGarbage(Blackboard* blackboard)
 	{
 		std::vector<EntityInfo>* items{};
 		IExamInterface* examInterface{};
 
 		bool dataFound =
-			blackboard->GetData(P_ITEMS_IN_FOV, items) &&
-			blackboard->GetData(P_INTERFACE, examInterface);
+			blackboard->GetData(BB_Keys::ItemsInFOV, items) &&
+			blackboard->GetData(BB_Keys::Interface, examInterface);
 
 		if (!dataFound || items->size() == 0)
 		{
@@ -1032,7 +1087,7 @@ namespace BT_Conditions
 
 			if (itemInfo.Type == eItemType::GARBAGE)
 			{
-				blackboard->ChangeData(P_TARGETINFO, itemInfo.Location);
+				blackboard->ChangeData(BB_Keys::TargetInfo, itemInfo.Location);
 
 				return true;
 			}
@@ -1041,12 +1096,12 @@ namespace BT_Conditions
 		return false;
 	}
 
-	bool HasInventorySlot(Blackboard* blackboard)
+	inline bool HasInventorySlot(Blackboard* blackboard)
 	{
 		Inventory inventory{};
 
 		bool dataFound =
-			blackboard->GetData(P_INVENTORY, inventory);
+			blackboard->GetData(BB_Keys::Inventory, inventory);
 
 		if (!dataFound)
 		{
@@ -1058,11 +1113,11 @@ namespace BT_Conditions
 		return hasEmptySlot;
 	}
 
-	bool IsPlayerLowHealth(Blackboard* blackboard)
+	inline bool IsPlayerLowHealth(Blackboard* blackboard)
 	{
 		AgentInfo playerInfo{};
 
-		bool hasData = blackboard->GetData(P_PLAYERINFO, playerInfo);
+		bool hasData = blackboard->GetData(BB_Keys::PlayerInfo, playerInfo);
 
 		if (!hasData)
 		{
@@ -1072,13 +1127,13 @@ namespace BT_Conditions
 		return playerInfo.Health <= CONFIG_MIN_ALLOWED_HEALTH;
 	}
 
-	bool CanPlayerHeal(Blackboard* blackboard)
+	inline bool CanPlayerHeal(Blackboard* blackboard)
 	{
 		AgentInfo playerInfo{};
 		Inventory inventory{};
 
-		bool hasData = blackboard->GetData(P_PLAYERINFO, playerInfo)
-			&& blackboard->GetData(P_INVENTORY, inventory);
+		bool hasData = blackboard->GetData(BB_Keys::PlayerInfo, playerInfo)
+			&& blackboard->GetData(BB_Keys::Inventory, inventory);
 
 		if (!hasData)
 		{
@@ -1088,11 +1143,11 @@ namespace BT_Conditions
 		return inventory.HasTypeOfInInventory(eItemType::MEDKIT) != inventory.items.end();
 	}
 
-	bool IsPlayerLowStamina(Blackboard* blackboard)
+	inline bool IsPlayerLowStamina(Blackboard* blackboard)
 	{
 		AgentInfo playerInfo{};
 
-		bool hasData = blackboard->GetData(P_PLAYERINFO, playerInfo);
+		bool hasData = blackboard->GetData(BB_Keys::PlayerInfo, playerInfo);
 
 		if (!hasData)
 		{
@@ -1102,13 +1157,13 @@ namespace BT_Conditions
 		return playerInfo.Energy <= CONFIG_MIN_ALLOWED_STAMINA;
 	}
 
-	bool CanPlayerEat(Blackboard* blackboard)
+	inline bool CanPlayerEat(Blackboard* blackboard)
 	{
 		AgentInfo playerInfo{};
 		Inventory inventory{};
 
-		bool hasData = blackboard->GetData(P_PLAYERINFO, playerInfo)
-			&& blackboard->GetData(P_INVENTORY, inventory);
+		bool hasData = blackboard->GetData(BB_Keys::PlayerInfo, playerInfo)
+			&& blackboard->GetData(BB_Keys::Inventory, inventory);
 
 		if (!hasData)
 		{
@@ -1118,13 +1173,13 @@ namespace BT_Conditions
 		return inventory.HasTypeOfInInventory(eItemType::FOOD) != inventory.items.end();
 	}
 
-	bool IsZombieInFOV(Blackboard* blackboard)
+	inline bool IsZombieInFOV(Blackboard* blackboard)
 	{
 		std::vector<EnemyInfo>* enemies{};
 		IExamInterface* examInterface{};
 
-		bool hasData = blackboard->GetData(P_ENEMIES_IN_FOV, enemies) &&
-			blackboard->GetData(P_INTERFACE, examInterface);
+		bool hasData = blackboard->GetData(BB_Keys::EnemiesInFOV, enemies) &&
+			blackboard->GetData(BB_Keys::Interface, examInterface);
 
 		if (!hasData || enemies->size() == 0)
 		{
@@ -1136,17 +1191,17 @@ namespace BT_Conditions
 		for (auto enemy : *enemies)
 		{
 			doesFOVContainZombie = true;
-			blackboard->ChangeData(P_ZOMBIE_TARGET, enemy.Location);
+			blackboard->ChangeData(BB_Keys::ZombieTarget, enemy.Location);
 		}
 
 		return doesFOVContainZombie;
 	}
 
-	bool IsPlayerArmed(Blackboard* blackboard)
+	inline bool IsPlayerArmed(Blackboard* blackboard)
 	{
 		Inventory inventory{};
 
-		bool hasData = blackboard->GetData(P_INVENTORY, inventory);
+		bool hasData = blackboard->GetData(BB_Keys::Inventory, inventory);
 
 		if (!hasData)
 		{
@@ -1162,11 +1217,11 @@ namespace BT_Conditions
 		return isArmed;
 	}
 
-	bool IsPlayerNOTArmed(Blackboard* blackboard)
+	inline bool IsPlayerNOTArmed(Blackboard* blackboard)
 	{
 		Inventory inventory{};
 
-		bool hasData = blackboard->GetData(P_INVENTORY, inventory);
+		bool hasData = blackboard->GetData(BB_Keys::Inventory, inventory);
 
 		if (!hasData)
 		{
@@ -1182,13 +1237,13 @@ namespace BT_Conditions
 		return !isArmed;
 	}
 
-	bool IsPlayerBitten(Blackboard* blackboard)
+	inline bool IsPlayerBitten(Blackboard* blackboard)
 	{
 		AgentInfo playerInfo{};
 		bool playerWasBitten{};
 
-		bool hasData = blackboard->GetData(P_PLAYERINFO, playerInfo) &&
-			blackboard->GetData(P_PLAYER_WAS_BITTEN, playerWasBitten);
+		bool hasData = blackboard->GetData(BB_Keys::PlayerInfo, playerInfo) &&
+			blackboard->GetData(BB_Keys::PlayerWasBitten, playerWasBitten);
 
 		if (!hasData)
 		{
@@ -1202,22 +1257,22 @@ namespace BT_Conditions
 
 		if (playerInfo.WasBitten)
 		{
-			blackboard->ChangeData(P_PLAYER_WAS_BITTEN, true);
+			blackboard->ChangeData(BB_Keys::PlayerWasBitten, true);
 		}
 
 		return playerInfo.WasBitten;
 	}
 
-	bool IsFacingEnemy(Blackboard* blackboard)
+	inline bool IsFacingEnemy(Blackboard* blackboard)
 	{
 		std::vector<EnemyInfo>* enemies{};
 		AgentInfo playerInfo{};
 		AgentInfo agentInfo{};
 		SteeringPlugin_Output lastSteering{};
 
-		blackboard->GetData(P_ENEMIES_IN_FOV, enemies);
-		blackboard->GetData(P_PLAYERINFO, agentInfo);
-		blackboard->GetData(P_STEERING, lastSteering);
+		blackboard->GetData(BB_Keys::EnemiesInFOV, enemies);
+		blackboard->GetData(BB_Keys::PlayerInfo, agentInfo);
+		blackboard->GetData(BB_Keys::Steering, lastSteering);
 
 		if (enemies->size() == 0)
 		{
@@ -1241,16 +1296,16 @@ namespace BT_Conditions
 		return Elite::AreEqual(dotResult, 1.0f, accuracyMargin);
 	}
 
-	bool IsNotFacingEnemy(Blackboard* blackboard)
+	inline bool IsNotFacingEnemy(Blackboard* blackboard)
 	{
 		std::vector<EnemyInfo>* enemies{};
 		AgentInfo playerInfo{};
 		AgentInfo agentInfo{};
 		SteeringPlugin_Output lastSteering{};
 
-		blackboard->GetData(P_ENEMIES_IN_FOV, enemies);
-		blackboard->GetData(P_PLAYERINFO, agentInfo);
-		blackboard->GetData(P_STEERING, lastSteering);
+		blackboard->GetData(BB_Keys::EnemiesInFOV, enemies);
+		blackboard->GetData(BB_Keys::PlayerInfo, agentInfo);
+		blackboard->GetData(BB_Keys::Steering, lastSteering);
 
 		if (enemies->size() == 0)
 		{
@@ -1273,13 +1328,13 @@ namespace BT_Conditions
 		return !Elite::AreEqual(dotResult, 1.0f, accuracyMargin);
 	}
 
-	bool HasReachedExploreLocation(Blackboard* blackboard)
+	inline bool HasReachedExploreLocation(Blackboard* blackboard)
 	{
 		Elite::Vector2 destination{};
 		AgentInfo playerInfo{};
 
-		bool hasData = blackboard->GetData(P_DESTINATION, destination)
-			&& blackboard->GetData(P_PLAYERINFO, playerInfo);
+		bool hasData = blackboard->GetData(BB_Keys::Destination, destination)
+			&& blackboard->GetData(BB_Keys::PlayerInfo, playerInfo);
 		
 		if (!hasData)
 		{
@@ -1294,18 +1349,9 @@ namespace BT_Conditions
 		return false;
 	}
 
-	bool HasVisitedAllLocations(Blackboard* blackboard)
+	inline bool HasVisitedAllLocations(Blackboard* blackboard)
 	{
-		std::vector<Elite::Vector2> locationsToVisit{};
-		std::vector<Elite::Vector2> locationsVisited{};
-
-		bool hasData = blackboard->GetData(P_EXPLORE_LOCATIONS_TO_VISIT, locationsToVisit)
-			&& blackboard->GetData(P_EXPLORE_LOCATIONS_VISITED, locationsVisited);
-
-		if (!hasData)
-		{
-			return false;
-		}
+		const std::vector<Elite::Vector2>& locationsToVisit = blackboard->ViewData(BB_Keys::ExploreLocationsToVisit);
 
 		if (locationsToVisit.size() == 0)
 		{
@@ -1315,16 +1361,16 @@ namespace BT_Conditions
 		return false;
 	}
 
-	bool IsPlayerInGrabRange(Blackboard* blackboard)
+	inline bool IsPlayerInGrabRange(Blackboard* blackboard)
 	{
 		std::vector<EntityInfo>* items{};
 		IExamInterface* examInterface{};
 		AgentInfo playerInfo{};
 
 		bool hasData =
-			blackboard->GetData(P_ITEMS_IN_FOV, items) &&
-			blackboard->GetData(P_INTERFACE, examInterface) &&
-			blackboard->GetData(P_PLAYERINFO, playerInfo);
+			blackboard->GetData(BB_Keys::ItemsInFOV, items) &&
+			blackboard->GetData(BB_Keys::Interface, examInterface) &&
+			blackboard->GetData(BB_Keys::PlayerInfo, playerInfo);
 
 		if (!hasData)
 		{
@@ -1344,14 +1390,14 @@ namespace BT_Conditions
 		return false;
 	}
 
-	bool IsItemFood(Blackboard* blackboard)
+	inline bool IsItemFood(Blackboard* blackboard)
 	{
 		std::vector<EntityInfo>* items{};
 		IExamInterface* examInterface{};
 
 		bool hasData =
-			blackboard->GetData(P_ITEMS_IN_FOV, items) &&
-			blackboard->GetData(P_INTERFACE, examInterface);
+			blackboard->GetData(BB_Keys::ItemsInFOV, items) &&
+			blackboard->GetData(BB_Keys::Interface, examInterface);
 
 		if (!hasData)
 		{
@@ -1375,14 +1421,14 @@ namespace BT_Conditions
 		return itemInfo.Type == eItemType::FOOD;
 	}
 
-	bool IsItemMedkit(Blackboard* blackboard)
+	inline bool IsItemMedkit(Blackboard* blackboard)
 	{
 		std::vector<EntityInfo>* items{};
 		IExamInterface* examInterface{};
 
 		bool hasData =
-			blackboard->GetData(P_ITEMS_IN_FOV, items) &&
-			blackboard->GetData(P_INTERFACE, examInterface);
+			blackboard->GetData(BB_Keys::ItemsInFOV, items) &&
+			blackboard->GetData(BB_Keys::Interface, examInterface);
 
 		if (!hasData)
 		{
@@ -1406,14 +1452,14 @@ namespace BT_Conditions
 		return itemInfo.Type == eItemType::MEDKIT;
 	}
 
-	bool IsItemPistol(Blackboard* blackboard)
+	inline bool IsItemPistol(Blackboard* blackboard)
 	{
 		std::vector<EntityInfo>* items{};
 		IExamInterface* examInterface{};
 
 		bool hasData =
-			blackboard->GetData(P_ITEMS_IN_FOV, items) &&
-			blackboard->GetData(P_INTERFACE, examInterface);
+			blackboard->GetData(BB_Keys::ItemsInFOV, items) &&
+			blackboard->GetData(BB_Keys::Interface, examInterface);
 
 		if (!hasData)
 		{
@@ -1437,14 +1483,14 @@ namespace BT_Conditions
 		return itemInfo.Type == eItemType::PISTOL;
 	}
 
-	bool IsItemShotgun(Blackboard* blackboard)
+	inline bool IsItemShotgun(Blackboard* blackboard)
 	{
 		std::vector<EntityInfo>* items{};
 		IExamInterface* examInterface{};
 
 		bool hasData =
-			blackboard->GetData(P_ITEMS_IN_FOV, items) &&
-			blackboard->GetData(P_INTERFACE, examInterface);
+			blackboard->GetData(BB_Keys::ItemsInFOV, items) &&
+			blackboard->GetData(BB_Keys::Interface, examInterface);
 
 		if (!hasData)
 		{
@@ -1468,11 +1514,11 @@ namespace BT_Conditions
 		return itemInfo.Type == eItemType::SHOTGUN;
 	}
 
-	bool HasShotgun(Blackboard* blackboard)
+	inline bool HasShotgun(Blackboard* blackboard)
 	{
 		Inventory inventory{};
 
-		bool hasData = blackboard->GetData(P_INVENTORY, inventory);
+		bool hasData = blackboard->GetData(BB_Keys::Inventory, inventory);
 
 		if (!hasData)
 		{
@@ -1484,11 +1530,11 @@ namespace BT_Conditions
 		return it < inventory.items.end();
 	}
 
-	bool HasPistol(Blackboard* blackboard)
+	inline bool HasPistol(Blackboard* blackboard)
 	{
 		Inventory inventory{};
 
-		bool hasData = blackboard->GetData(P_INVENTORY, inventory);
+		bool hasData = blackboard->GetData(BB_Keys::Inventory, inventory);
 
 		if (!hasData)
 		{
@@ -1500,15 +1546,15 @@ namespace BT_Conditions
 		return it < inventory.items.end();
 	}
 
-	bool IsNewGunBetter(Blackboard* blackboard)
+	inline bool IsNewGunBetter(Blackboard* blackboard)
 	{
 		std::vector<EntityInfo>* items{};
 		Inventory inventory{};
 		IExamInterface* examInterface{};
 
-		bool hasData = blackboard->GetData(P_ITEMS_IN_FOV, items) &&
-			blackboard->GetData(P_INTERFACE, examInterface) &&
-			blackboard->GetData(P_INVENTORY, inventory);
+		bool hasData = blackboard->GetData(BB_Keys::ItemsInFOV, items) &&
+			blackboard->GetData(BB_Keys::Interface, examInterface) &&
+			blackboard->GetData(BB_Keys::Inventory, inventory);
 
 		if (!hasData)
 		{
@@ -1538,3 +1584,545 @@ namespace BT_Conditions
 		return newAmmo > currentAmmo;
 	}
 }
+
+/************************************************************************/
+/* Blackboard keys of the actions, declared when the tree is built		*/
+/************************************************************************/
+namespace BT_ActionKeys
+{
+	inline std::vector<BlackboardDependency> DropOldGun() { return { BB_Keys::ItemsInFOV, BB_Keys::Interface, BB_Keys::Inventory }; }
+	inline std::vector<BlackboardDependency> DestroyGun() { return { BB_Keys::ItemsInFOV, BB_Keys::Interface }; }
+	inline std::vector<BlackboardDependency> SetItemAsTarget() { return { BB_Keys::ItemsInFOV, BB_Keys::TargetInfo }; }
+	inline std::vector<BlackboardDependency> SetHouseAsActive() { return { BB_Keys::HousesInFOV, BB_Keys::KnownHouses, BB_Keys::PlayerInfo, BB_Keys::IsInHouse, BB_Keys::TargetInfo, BB_Keys::ShouldExplore, BB_Keys::LastPosition, BB_Keys::ActiveHouse, BB_Keys::IsGoingForHouse }; }
+	inline std::vector<BlackboardDependency> RandomizeVisitLocations() { return { BB_Keys::ExploreLocationsVisited, BB_Keys::ExploreLocationsToVisit, BB_Keys::Destination }; }
+	inline std::vector<BlackboardDependency> UpdateExplorationList() { return { BB_Keys::PlayerInfo, BB_Keys::ExploreLocationsToVisit, BB_Keys::ExploreLocationsVisited }; }
+	inline std::vector<BlackboardDependency> SetNewExploreDestination() { return { BB_Keys::ExploreLocationsToVisit, BB_Keys::Destination }; }
+	inline std::vector<BlackboardDependency> AddHouseToVisited() { return { BB_Keys::ActiveHouse, BB_Keys::KnownHouses, BB_Keys::KnownHouseSweepTimers }; }
+	inline std::vector<BlackboardDependency> Face() { return { BB_Keys::TargetInfo, BB_Keys::PlayerInfo, BB_Keys::Steering }; }
+	inline std::vector<BlackboardDependency> SetAsTarget() { return { BB_Keys::EnemiesInFOV, BB_Keys::TargetInfo }; }
+	inline std::vector<BlackboardDependency> SetRunAsTarget() { return { BB_Keys::Destination, BB_Keys::TargetInfo }; }
+	inline std::vector<BlackboardDependency> DestroyGarbage() { return { BB_Keys::ItemsInFOV, BB_Keys::Interface }; }
+	inline std::vector<BlackboardDependency> PickupItem() { return { BB_Keys::ItemsInFOV, BB_Keys::Inventory, BB_Keys::Interface }; }
+	inline std::vector<BlackboardDependency> Pickup() { return { BB_Keys::ItemsInFOV, BB_Keys::Interface, BB_Keys::Inventory, BB_Keys::PlayerInfo, BB_Keys::TargetInfo }; }
+	inline std::vector<BlackboardDependency> Drop() { return { BB_Keys::ItemsInFOV, BB_Keys::Interface, BB_Keys::Inventory, BB_Keys::PlayerInfo, BB_Keys::TargetInfo }; }
+	inline std::vector<BlackboardDependency> Seek() { return { BB_Keys::TargetInfo, BB_Keys::PlayerInfo, BB_Keys::Interface, BB_Keys::IsInHouse, BB_Keys::Steering }; }
+	inline std::vector<BlackboardDependency> SeekToTarget() { return Seek(); }
+	inline std::vector<BlackboardDependency> Explore() { return { BB_Keys::Destination, BB_Keys::TargetInfo }; }
+	inline std::vector<BlackboardDependency> Sweep() { return { BB_Keys::TargetInfo, BB_Keys::PlayerInfo, BB_Keys::Interface, BB_Keys::Steering, BB_Keys::HouseToSweep, BB_Keys::ActiveHouse, BB_Keys::KnownHouses, BB_Keys::KnownHouseSweepTimers }; }
+	inline std::vector<BlackboardDependency> ExitHouse() { return { BB_Keys::Destination, BB_Keys::PlayerInfo, BB_Keys::Interface, BB_Keys::Steering, BB_Keys::ShouldExplore, BB_Keys::IsGoingForHouse, BB_Keys::IsInHouse }; }
+	inline std::vector<BlackboardDependency> Heal() { return { BB_Keys::PlayerInfo, BB_Keys::Inventory, BB_Keys::Interface }; }
+	inline std::vector<BlackboardDependency> Eat() { return { BB_Keys::PlayerInfo, BB_Keys::Inventory, BB_Keys::Interface }; }
+	inline std::vector<BlackboardDependency> FaceZombie() { return { BB_Keys::ZombieTarget, BB_Keys::PlayerInfo, BB_Keys::Interface, BB_Keys::Steering }; }
+	inline std::vector<BlackboardDependency> Shoot() { return { BB_Keys::Inventory, BB_Keys::Interface }; }
+	inline std::vector<BlackboardDependency> Turn() { return { BB_Keys::Steering }; }
+	inline std::vector<BlackboardDependency> RunForestRun() { return { BB_Keys::TargetInfo, BB_Keys::PlayerInfo, BB_Keys::Interface, BB_Keys::Steering }; }
+}
+
+/************************************************************************/
+/* Blackboard keys of the conditions, declared when the tree is built	*/
+/************************************************************************/
+namespace BT_ConditionKeys
+{
+	inline std::vector<BlackboardDependency> ShouldExplore() { return { BB_Keys::ShouldExplore }; }
+	inline std::vector<BlackboardDependency> IsHouseInFOV() { return { BB_Keys::IsHouseInFOVCache, BB_Keys::HousesInFOV }; }
+	inline std::vector<BlackboardDependency> IsInHouse() { return { BB_Keys::IsInHouseCache, BB_Keys::ActiveHouse, BB_Keys::PlayerInfo }; }
+	inline std::vector<BlackboardDependency> ShouldSweepHouse() { return { BB_Keys::ShouldSweepHouseCache, BB_Keys::KnownHouses, BB_Keys::ActiveHouse, BB_Keys::HouseToSweep, BB_Keys::IsInHouse }; }
+	inline std::vector<BlackboardDependency> IsGoingToHouse() { return { BB_Keys::IsGoingForHouse, BB_Keys::ActiveHouse, BB_Keys::TargetInfo }; }
+	inline std::vector<BlackboardDependency> SeesItem() { return { BB_Keys::ItemsInFOV, BB_Keys::Interface, BB_Keys::IsInHouse }; }
+	inline std::vector<BlackboardDependency> SeesGarbage() { return { BB_Keys::ItemsInFOV, BB_Keys::Interface, BB_Keys::TargetInfo }; }
+	inline std::vector<BlackboardDependency> HasInventorySlot() { return { BB_Keys::Inventory }; }
+	inline std::vector<BlackboardDependency> IsPlayerLowHealth() { return { BB_Keys::PlayerInfo }; }
+	inline std::vector<BlackboardDependency> CanPlayerHeal() { return { BB_Keys::PlayerInfo, BB_Keys::Inventory }; }
+	inline std::vector<BlackboardDependency> IsPlayerLowStamina() { return { BB_Keys::PlayerInfo }; }
+	inline std::vector<BlackboardDependency> CanPlayerEat() { return { BB_Keys::PlayerInfo, BB_Keys::Inventory }; }
+	inline std::vector<BlackboardDependency> IsZombieInFOV() { return { BB_Keys::EnemiesInFOV, BB_Keys::Interface, BB_Keys::ZombieTarget }; }
+	inline std::vector<BlackboardDependency> IsPlayerArmed() { return { BB_Keys::Inventory }; }
+	inline std::vector<BlackboardDependency> IsPlayerNOTArmed() { return { BB_Keys::Inventory }; }
+	inline std::vector<BlackboardDependency> IsPlayerBitten() { return { BB_Keys::PlayerInfo, BB_Keys::PlayerWasBitten }; }
+	inline std::vector<BlackboardDependency> IsFacingEnemy() { return { BB_Keys::EnemiesInFOV, BB_Keys::PlayerInfo, BB_Keys::Steering }; }
+	inline std::vector<BlackboardDependency> IsNotFacingEnemy() { return { BB_Keys::EnemiesInFOV, BB_Keys::PlayerInfo, BB_Keys::Steering }; }
+	inline std::vector<BlackboardDependency> HasReachedExploreLocation() { return { BB_Keys::Destination, BB_Keys::PlayerInfo }; }
+	inline std::vector<BlackboardDependency> HasVisitedAllLocations() { return { BB_Keys::ExploreLocationsToVisit }; }
+	inline std::vector<BlackboardDependency> IsPlayerInGrabRange() { return { BB_Keys::ItemsInFOV, BB_Keys::Interface, BB_Keys::PlayerInfo }; }
+	inline std::vector<BlackboardDependency> IsItemFood() { return { BB_Keys::ItemsInFOV, BB_Keys::Interface }; }
+	inline std::vector<BlackboardDependency> IsItemMedkit() { return { BB_Keys::ItemsInFOV, BB_Keys::Interface }; }
+	inline std::vector<BlackboardDependency> IsItemPistol() { return { BB_Keys::ItemsInFOV, BB_Keys::Interface }; }
+	inline std::vector<BlackboardDependency> IsItemShotgun() { return { BB_Keys::ItemsInFOV, BB_Keys::Interface }; }
+	inline std::vector<BlackboardDependency> HasShotgun() { return { BB_Keys::Inventory }; }
+	inline std::vector<BlackboardDependency> HasPistol() { return { BB_Keys::Inventory }; }
+	inline std::vector<BlackboardDependency> IsNewGunBetter() { return { BB_Keys::ItemsInFOV, BB_Keys::Interface, BB_Keys::Inventory }; }
+}
+
+/************************************************************************/
+/* Read-only evaluations, can run on workers under a BehaviorParallel	*/
+/************************************************************************/
+namespace BT_Evaluations
+{
+	//An enemy is closer than half the FOV range
+	inline bool IsUnderThreat(const BlackboardView& view)
+	{
+		const std::vector<EnemyInfo>* enemies = view.ViewData(BB_Keys::EnemiesInFOV);
+		const AgentInfo& agentInfo = view.ViewData(BB_Keys::PlayerInfo);
+		if (enemies == nullptr)
+		{
+			return false;
+		}
+
+		const float threatRange = agentInfo.FOV_Range * 0.5f;
+		return std::any_of(enemies->begin(), enemies->end(), [&agentInfo, threatRange](const EnemyInfo& enemy) {
+			return Elite::DistanceSquared(enemy.Location, agentInfo.Position) < threatRange * threatRange;
+		});
+	}
+
+	//An item is close enough to grab, without asking the interface what it is
+	inline bool SeesItemInGrabRange(const BlackboardView& view)
+	{
+		const std::vector<EntityInfo>* items = view.ViewData(BB_Keys::ItemsInFOV);
+		const AgentInfo& agentInfo = view.ViewData(BB_Keys::PlayerInfo);
+		if (items == nullptr)
+		{
+			return false;
+		}
+
+		return std::any_of(items->begin(), items->end(), [&agentInfo](const EntityInfo& item) {
+			return item.Type == eEntityType::ITEM && Elite::DistanceSquared(item.Location, agentInfo.Position) < agentInfo.GrabRange * agentInfo.GrabRange;
+		});
+	}
+
+	//A house in view is new or has not been swept for CONFIG_SWEEP_MAX_TIMEOUT
+	inline bool SeesHouseToSweep(const BlackboardView& view)
+	{
+		const std::vector<HouseInfo>& houses = view.ViewData(BB_Keys::HousesInFOV);
+		const std::vector<KnownHouse>& knownHouses = view.ViewData(BB_Keys::KnownHouses);
+
+		return std::any_of(houses.begin(), houses.end(), [&knownHouses](const HouseInfo& house) {
+			auto foundIt = std::find_if(knownHouses.begin(), knownHouses.end(), [&house](const KnownHouse& knownHouse) {
+				return Elite::Distance(knownHouse.housePosition, house.Center) <= FLT_EPSILON;
+			});
+			return foundIt == knownHouses.end() || foundIt->isSweepDue;
+		});
+	}
+}
+
+namespace BT_EvaluationKeys
+{
+	inline std::vector<BlackboardDependency> IsUnderThreat() { return { BB_Keys::EnemiesInFOV, BB_Keys::PlayerInfo }; }
+	inline std::vector<BlackboardDependency> SeesItemInGrabRange() { return { BB_Keys::ItemsInFOV, BB_Keys::PlayerInfo }; }
+	inline std::vector<BlackboardDependency> SeesHouseToSweep() { return { BB_Keys::HousesInFOV, BB_Keys::KnownHouses }; }
+}
+
+/************************************************************************/
+/* Conditions with the same result for a whole tick, see ConditionMemo	*/
+/************************************************************************/
+namespace BT_PureConditions
+{
+	//Each is used by several branches and reads only keys that no action of the tree changes
+	//before the tick ends, so its first result of the tick is reused.
+	//IsZombieInFOV writes ZombieTarget and IsPlayerBitten writes PlayerWasBitten, so they are not pure:
+	//the memo is only correct because the first call of the tick always does that write and no action
+	//of the tree writes either key. An action that clears one of them must take its condition out of this list
+	inline std::vector<ConditionMemo::Condition> PerTick()
+	{
+		return {
+			BT_Conditions::IsZombieInFOV,
+			BT_Conditions::IsPlayerArmed,
+			BT_Conditions::IsPlayerInGrabRange,
+			BT_Conditions::IsPlayerBitten
+		};
+	}
+}
+
+/************************************************************************/
+/* Utility AI inputs, each normalized to [0, 1], see UtilityAI			*/
+/************************************************************************/
+namespace UT_Inputs
+{
+	//Health and energy of the agent at the start of a game
+	constexpr float MaxPlayerStat = 10.f;
+
+	inline float Health(Blackboard* blackboard)
+	{
+		AgentInfo playerInfo{};
+		if (!blackboard->GetData(BB_Keys::PlayerInfo, playerInfo))
+		{
+			return 1.f;
+		}
+
+		return playerInfo.Health / MaxPlayerStat;
+	}
+
+	inline float Energy(Blackboard* blackboard)
+	{
+		AgentInfo playerInfo{};
+		if (!blackboard->GetData(BB_Keys::PlayerInfo, playerInfo))
+		{
+			return 1.f;
+		}
+
+		return playerInfo.Energy / MaxPlayerStat;
+	}
+
+	inline float HasMedkit(Blackboard* blackboard) { return BT_Conditions::CanPlayerHeal(blackboard) ? 1.f : 0.f; }
+	inline float HasFood(Blackboard* blackboard) { return BT_Conditions::CanPlayerEat(blackboard) ? 1.f : 0.f; }
+	inline float IsArmed(Blackboard* blackboard) { return BT_Conditions::IsPlayerArmed(blackboard) ? 1.f : 0.f; }
+	inline float IsInHouse(Blackboard* blackboard) { return BT_Conditions::IsInHouse(blackboard) ? 1.f : 0.f; }
+
+	//A zombie in view or a bite that is still remembered
+	inline float Threat(Blackboard* blackboard)
+	{
+		return BT_Conditions::IsZombieInFOV(blackboard) || BT_Conditions::IsPlayerBitten(blackboard) ? 1.f : 0.f;
+	}
+
+	//Garbage counts, it is destroyed on the way
+	inline float SeesLoot(Blackboard* blackboard)
+	{
+		return BT_Conditions::SeesGarbage(blackboard) || BT_Conditions::SeesItem(blackboard) ? 1.f : 0.f;
+	}
+}
+
+namespace UT_InputKeys
+{
+	inline std::vector<BlackboardDependency> Health() { return { BB_Keys::PlayerInfo }; }
+	inline std::vector<BlackboardDependency> Energy() { return { BB_Keys::PlayerInfo }; }
+	inline std::vector<BlackboardDependency> HasMedkit() { return BT_ConditionKeys::CanPlayerHeal(); }
+	inline std::vector<BlackboardDependency> HasFood() { return BT_ConditionKeys::CanPlayerEat(); }
+	inline std::vector<BlackboardDependency> IsArmed() { return BT_ConditionKeys::IsPlayerArmed(); }
+	inline std::vector<BlackboardDependency> IsInHouse() { return BT_ConditionKeys::IsInHouse(); }
+	inline std::vector<BlackboardDependency> Threat()
+	{
+		std::vector<BlackboardDependency> dependencies = BT_ConditionKeys::IsZombieInFOV();
+		const std::vector<BlackboardDependency> bittenDependencies = BT_ConditionKeys::IsPlayerBitten();
+		dependencies.insert(dependencies.end(), bittenDependencies.begin(), bittenDependencies.end());
+		return dependencies;
+	}
+	inline std::vector<BlackboardDependency> SeesLoot()
+	{
+		std::vector<BlackboardDependency> dependencies = BT_ConditionKeys::SeesGarbage();
+		const std::vector<BlackboardDependency> itemDependencies = BT_ConditionKeys::SeesItem();
+		dependencies.insert(dependencies.end(), itemDependencies.begin(), itemDependencies.end());
+		return dependencies;
+	}
+}
+
+/************************************************************************/
+/* Facts of the GOAP world state, see GoapPlanner						*/
+/************************************************************************/
+namespace GP_Facts
+{
+	//A zombie in view or a bite that is still remembered
+	inline bool Threat(Blackboard* blackboard)
+	{
+		return BT_Conditions::IsZombieInFOV(blackboard) || BT_Conditions::IsPlayerBitten(blackboard);
+	}
+
+	//Grab range reads the first item in view, only asked when there is one
+	inline bool ItemInGrabRange(Blackboard* blackboard)
+	{
+		return BT_Conditions::SeesItem(blackboard) && BT_Conditions::IsPlayerInGrabRange(blackboard);
+	}
+
+	//Asking to sweep marks the agent as inside, only asked when it is
+	inline bool ShouldSweep(Blackboard* blackboard)
+	{
+		return BT_Conditions::IsInHouse(blackboard) && BT_Conditions::ShouldSweepHouse(blackboard);
+	}
+}
+
+namespace GP_FactKeys
+{
+	inline std::vector<BlackboardDependency> Threat() { return UT_InputKeys::Threat(); }
+	inline std::vector<BlackboardDependency> ItemInGrabRange()
+	{
+		std::vector<BlackboardDependency> dependencies = BT_ConditionKeys::SeesItem();
+		const std::vector<BlackboardDependency> rangeDependencies = BT_ConditionKeys::IsPlayerInGrabRange();
+		dependencies.insert(dependencies.end(), rangeDependencies.begin(), rangeDependencies.end());
+		return dependencies;
+	}
+	inline std::vector<BlackboardDependency> ShouldSweep()
+	{
+		std::vector<BlackboardDependency> dependencies = BT_ConditionKeys::IsInHouse();
+		const std::vector<BlackboardDependency> sweepDependencies = BT_ConditionKeys::ShouldSweepHouse();
+		dependencies.insert(dependencies.end(), sweepDependencies.begin(), sweepDependencies.end());
+		return dependencies;
+	}
+}
+
+/************************************************************************/
+/* Leaf names of tree files, see BehaviorTreeLoader						*/
+/************************************************************************/
+#define BT_REGISTER_ACTION(name) registry.AddAction(#name, BT_Actions::name, BT_ActionKeys::name())
+#define BT_REGISTER_CONDITION(name) registry.AddCondition(#name, BT_Conditions::name, BT_ConditionKeys::name())
+#define BT_REGISTER_EVALUATION(name) registry.AddEvaluation(#name, BT_Evaluations::name, BT_EvaluationKeys::name())
+
+namespace BT_Registry
+{
+	//Every leaf function under its own name, a tree file can use any of them
+	inline BehaviorRegistry Create()
+	{
+		BehaviorRegistry registry{};
+
+		BT_REGISTER_ACTION(DropOldGun);
+		BT_REGISTER_ACTION(DestroyGun);
+		BT_REGISTER_ACTION(SetItemAsTarget);
+		BT_REGISTER_ACTION(SetHouseAsActive);
+		BT_REGISTER_ACTION(RandomizeVisitLocations);
+		BT_REGISTER_ACTION(UpdateExplorationList);
+		BT_REGISTER_ACTION(SetNewExploreDestination);
+		BT_REGISTER_ACTION(AddHouseToVisited);
+		BT_REGISTER_ACTION(Face);
+		BT_REGISTER_ACTION(SetAsTarget);
+		BT_REGISTER_ACTION(SetRunAsTarget);
+		BT_REGISTER_ACTION(DestroyGarbage);
+		BT_REGISTER_ACTION(PickupItem);
+		BT_REGISTER_ACTION(Pickup);
+		BT_REGISTER_ACTION(Drop);
+		BT_REGISTER_ACTION(Seek);
+		BT_REGISTER_ACTION(SeekToTarget);
+		BT_REGISTER_ACTION(Explore);
+		BT_REGISTER_ACTION(Sweep);
+		BT_REGISTER_ACTION(ExitHouse);
+		BT_REGISTER_ACTION(Heal);
+		BT_REGISTER_ACTION(Eat);
+		BT_REGISTER_ACTION(FaceZombie);
+		BT_REGISTER_ACTION(Shoot);
+		BT_REGISTER_ACTION(Turn);
+		BT_REGISTER_ACTION(RunForestRun);
+
+		BT_REGISTER_CONDITION(ShouldExplore);
+		BT_REGISTER_CONDITION(IsHouseInFOV);
+		BT_REGISTER_CONDITION(IsInHouse);
+		BT_REGISTER_CONDITION(ShouldSweepHouse);
+		BT_REGISTER_CONDITION(IsGoingToHouse);
+		BT_REGISTER_CONDITION(SeesItem);
+		BT_REGISTER_CONDITION(SeesGarbage);
+		BT_REGISTER_CONDITION(HasInventorySlot);
+		BT_REGISTER_CONDITION(IsPlayerLowHealth);
+		BT_REGISTER_CONDITION(CanPlayerHeal);
+		BT_REGISTER_CONDITION(IsPlayerLowStamina);
+		BT_REGISTER_CONDITION(CanPlayerEat);
+		BT_REGISTER_CONDITION(IsZombieInFOV);
+		BT_REGISTER_CONDITION(IsPlayerArmed);
+		BT_REGISTER_CONDITION(IsPlayerNOTArmed);
+		BT_REGISTER_CONDITION(IsPlayerBitten);
+		BT_REGISTER_CONDITION(IsFacingEnemy);
+		BT_REGISTER_CONDITION(IsNotFacingEnemy);
+		BT_REGISTER_CONDITION(HasReachedExploreLocation);
+		BT_REGISTER_CONDITION(HasVisitedAllLocations);
+		BT_REGISTER_CONDITION(IsPlayerInGrabRange);
+		BT_REGISTER_CONDITION(IsItemFood);
+		BT_REGISTER_CONDITION(IsItemMedkit);
+		BT_REGISTER_CONDITION(IsItemPistol);
+		BT_REGISTER_CONDITION(IsItemShotgun);
+		BT_REGISTER_CONDITION(HasShotgun);
+		BT_REGISTER_CONDITION(HasPistol);
+		BT_REGISTER_CONDITION(IsNewGunBetter);
+
+		BT_REGISTER_EVALUATION(IsUnderThreat);
+		BT_REGISTER_EVALUATION(SeesItemInGrabRange);
+		BT_REGISTER_EVALUATION(SeesHouseToSweep);
+
+		return registry;
+	}
+}
+
+#undef BT_REGISTER_ACTION
+#undef BT_REGISTER_CONDITION
+#undef BT_REGISTER_EVALUATION
+
+/************************************************************************/
+/* Static form of Plugin::CreateRootBehavior							*/
+/************************************************************************/
+namespace BT_Static
+{
+	//Keep in sync with Plugin::CreateRootBehavior at a bookkeeping tick rate of 0, the benchmark compares both every tick.
+	//Observers are written as the sequence of their condition and child, which gives the same results.
+	using AgentRootBehavior = Selector<
+		// Combat
+		Selector<
+			Sequence<
+				Cond<BT_Conditions::IsZombieInFOV, BT_ConditionKeys::IsZombieInFOV>,
+				Cond<BT_Conditions::IsPlayerArmed, BT_ConditionKeys::IsPlayerArmed>,
+				Selector<
+					Sequence<
+						Cond<BT_Conditions::IsFacingEnemy, BT_ConditionKeys::IsFacingEnemy>,
+						Act<BT_Actions::Shoot, BT_ActionKeys::Shoot>
+					>,
+					Sequence<
+						Cond<BT_Conditions::IsNotFacingEnemy, BT_ConditionKeys::IsNotFacingEnemy>,
+						Act<BT_Actions::SetAsTarget, BT_ActionKeys::SetAsTarget>,
+						Act<BT_Actions::Face, BT_ActionKeys::Face>
+					>
+				>
+			>,
+			Sequence<
+				Cond<BT_Conditions::IsZombieInFOV, BT_ConditionKeys::IsZombieInFOV>,
+				Cond<BT_Conditions::IsInHouse, BT_ConditionKeys::IsInHouse>,
+				Cond<BT_Conditions::IsPlayerNOTArmed, BT_ConditionKeys::IsPlayerNOTArmed>,
+				Act<BT_Actions::AddHouseToVisited, BT_ActionKeys::AddHouseToVisited>,
+				Act<BT_Actions::SetRunAsTarget, BT_ActionKeys::SetRunAsTarget>,
+				Act<BT_Actions::RunForestRun, BT_ActionKeys::RunForestRun>
+			>,
+			Sequence<
+				Cond<BT_Conditions::IsPlayerBitten, BT_ConditionKeys::IsPlayerBitten>,
+				Cond<BT_Conditions::IsPlayerArmed, BT_ConditionKeys::IsPlayerArmed>,
+				Act<BT_Actions::Turn, BT_ActionKeys::Turn>
+			>,
+			Sequence<
+				Cond<BT_Conditions::IsPlayerBitten, BT_ConditionKeys::IsPlayerBitten>,
+				Act<BT_Actions::RunForestRun, BT_ActionKeys::RunForestRun>
+			>
+		>,
+
+		// Item consumption
+		Sequence<
+			Cond<BT_Conditions::IsPlayerLowHealth, BT_ConditionKeys::IsPlayerLowHealth>,
+			Cond<BT_Conditions::CanPlayerHeal, BT_ConditionKeys::CanPlayerHeal>,
+			Act<BT_Actions::Heal, BT_ActionKeys::Heal>
+		>,
+		Sequence<
+			Cond<BT_Conditions::IsPlayerLowStamina, BT_ConditionKeys::IsPlayerLowStamina>,
+			Cond<BT_Conditions::CanPlayerEat, BT_ConditionKeys::CanPlayerEat>,
+			Act<BT_Actions::Eat, BT_ActionKeys::Eat>
+		>,
+
+		// Garbage
+		Selector<
+			Sequence<
+				Cond<BT_Conditions::SeesGarbage, BT_ConditionKeys::SeesGarbage>,
+				Selector<
+					Sequence<
+						Cond<BT_Conditions::IsPlayerInGrabRange, BT_ConditionKeys::IsPlayerInGrabRange>,
+						Act<BT_Actions::DestroyGarbage, BT_ActionKeys::DestroyGarbage>
+					>,
+					Sequence<
+						Act<BT_Actions::SetItemAsTarget, BT_ActionKeys::SetItemAsTarget>,
+						Act<BT_Actions::Seek, BT_ActionKeys::Seek>
+					>
+				>
+			>
+		>,
+
+		// Items
+		Sequence<
+			Cond<BT_Conditions::SeesItem, BT_ConditionKeys::SeesItem>,
+			Selector<
+				// Consume food before picking up more
+				Sequence<
+					Cond<BT_Conditions::IsItemFood, BT_ConditionKeys::IsItemFood>,
+					Cond<BT_Conditions::IsPlayerInGrabRange, BT_ConditionKeys::IsPlayerInGrabRange>,
+					Cond<BT_Conditions::CanPlayerEat, BT_ConditionKeys::CanPlayerEat>,
+					Act<BT_Actions::Eat, BT_ActionKeys::Eat>
+				>,
+				// Consume medkit if hurt and on ground
+				Sequence<
+					Cond<BT_Conditions::IsItemMedkit, BT_ConditionKeys::IsItemMedkit>,
+					Cond<BT_Conditions::IsPlayerInGrabRange, BT_ConditionKeys::IsPlayerInGrabRange>,
+					Cond<BT_Conditions::CanPlayerHeal, BT_ConditionKeys::CanPlayerHeal>,
+					Act<BT_Actions::Heal, BT_ActionKeys::Heal>
+				>,
+				// Checks if pistol is worth it
+				Sequence<
+					Cond<BT_Conditions::IsItemPistol, BT_ConditionKeys::IsItemPistol>,
+					Cond<BT_Conditions::IsPlayerInGrabRange, BT_ConditionKeys::IsPlayerInGrabRange>,
+					Selector<
+						Sequence<
+							// If has no pistol pick up
+							NotCond<BT_Conditions::HasPistol, BT_ConditionKeys::HasPistol>,
+							Act<BT_Actions::PickupItem, BT_ActionKeys::PickupItem>
+						>,
+						Sequence<
+							// If has pistol but new one is better drop old pick up new
+							Cond<BT_Conditions::IsNewGunBetter, BT_ConditionKeys::IsNewGunBetter>,
+							Act<BT_Actions::DropOldGun, BT_ActionKeys::DropOldGun>,
+							Act<BT_Actions::PickupItem, BT_ActionKeys::PickupItem>
+						>,
+						Sequence<
+							// Destroy less-value gun
+							Act<BT_Actions::DestroyGun, BT_ActionKeys::DestroyGun>
+						>
+					>
+				>,
+				// Checks if shotgun is worth it
+				Sequence<
+					Cond<BT_Conditions::IsItemShotgun, BT_ConditionKeys::IsItemShotgun>,
+					Cond<BT_Conditions::IsPlayerInGrabRange, BT_ConditionKeys::IsPlayerInGrabRange>,
+					Selector<
+						Sequence<
+							// If has no pistol pick up
+							NotCond<BT_Conditions::HasShotgun, BT_ConditionKeys::HasShotgun>,
+							Act<BT_Actions::PickupItem, BT_ActionKeys::PickupItem>
+						>,
+						Sequence<
+							// If has pistol but new one is better drop old pick up new
+							Cond<BT_Conditions::IsNewGunBetter, BT_ConditionKeys::IsNewGunBetter>,
+							Act<BT_Actions::DropOldGun, BT_ActionKeys::DropOldGun>,
+							Act<BT_Actions::PickupItem, BT_ActionKeys::PickupItem>
+						>,
+						Sequence<
+							// Destroy less-value gun
+							Act<BT_Actions::DestroyGun, BT_ActionKeys::DestroyGun>
+						>
+					>
+				>,
+				// Pick item if has inventory slot and in range
+				Sequence<
+					Cond<BT_Conditions::IsPlayerInGrabRange, BT_ConditionKeys::IsPlayerInGrabRange>,
+					Cond<BT_Conditions::HasInventorySlot, BT_ConditionKeys::HasInventorySlot>,
+					Act<BT_Actions::PickupItem, BT_ActionKeys::PickupItem>
+				>,
+				// Set seen item as target and seek
+				Sequence<
+					NotCond<BT_Conditions::IsPlayerInGrabRange, BT_ConditionKeys::IsPlayerInGrabRange>,
+					Act<BT_Actions::SetItemAsTarget, BT_ActionKeys::SetItemAsTarget>,
+					Act<BT_Actions::Seek, BT_ActionKeys::Seek>
+				>
+			>
+		>,
+
+		// Sweeping house
+		Sequence<
+			Cond<BT_Conditions::IsInHouse, BT_ConditionKeys::IsInHouse>,
+			Selector<
+				Sequence<
+					Cond<BT_Conditions::ShouldSweepHouse, BT_ConditionKeys::ShouldSweepHouse>,
+					Act<BT_Actions::Sweep, BT_ActionKeys::Sweep>
+				>,
+				Sequence<
+					Act<BT_Actions::ExitHouse, BT_ActionKeys::ExitHouse>
+				>
+			>
+		>,
+
+		// House detection
+		Selector<
+			Sequence<
+				Cond<BT_Conditions::IsGoingToHouse, BT_ConditionKeys::IsGoingToHouse>,
+				Act<BT_Actions::SeekToTarget, BT_ActionKeys::SeekToTarget>
+			>,
+			Sequence<
+				Cond<BT_Conditions::IsHouseInFOV, BT_ConditionKeys::IsHouseInFOV>,
+				Act<BT_Actions::SetHouseAsActive, BT_ActionKeys::SetHouseAsActive>
+			>
+		>,
+
+		// Exploration
+		Sequence<
+			Selector<
+				Sequence<
+					Cond<BT_Conditions::HasVisitedAllLocations, BT_ConditionKeys::HasVisitedAllLocations>,
+					Act<BT_Actions::RandomizeVisitLocations, BT_ActionKeys::RandomizeVisitLocations>
+				>,
+				Sequence<
+					Cond<BT_Conditions::HasReachedExploreLocation, BT_ConditionKeys::HasReachedExploreLocation>,
+					Act<BT_Actions::UpdateExplorationList, BT_ActionKeys::UpdateExplorationList>,
+					Act<BT_Actions::SetNewExploreDestination, BT_ActionKeys::SetNewExploreDestination>
+				>,
+				Sequence<
+					Cond<BT_Conditions::ShouldExplore, BT_ConditionKeys::ShouldExplore>,
+					Act<BT_Actions::Explore, BT_ActionKeys::Explore>,
+					Act<BT_Actions::SeekToTarget, BT_ActionKeys::SeekToTarget>
+				>
+			>
+		>
+	>;
+}
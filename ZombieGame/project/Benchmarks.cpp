@@ -0,0 +1,1871 @@
+#include "stdafx.h"
+#include "Benchmarks.h"
+#include "Plugin.h"
+#include "IExamInterface.h"
+#include "EBlackboard.h"
+#include "EBehaviorTree.h"
+#include "EFlatBehaviorTree.h"
+#include "EBatchBehaviorTree.h"
+#include "EStaticBehaviorTree.h"
+#include "EWorkerPool.h"
+#include "EBehaviorTreeLoader.h"
+#include "EUtilityAI.h"
+#include "EFiniteStateMachine.h"
+#include "EGoapPlanner.h"
+#include "Structs.h"
+#include "BlackboardKeys.h"
+#include "Behaviors.h"
+
+#include <chrono>
+#include <atomic>
+#include <limits>
+#include <iterator>
+#include <stdexcept>
+
+#if CONFIG_RUN_BENCHMARKS
+/************************************************************************/
+/* Allocation counting, replaces the global new of the whole DLL        */
+/************************************************************************/
+// A replacement operator new is global, so while benchmarks are compiled in it counts
+// and serves every allocation of the plugin, not only the ones of this file
+namespace
+{
+	std::atomic<size_t> g_AllocationCount{};
+}
+
+void* operator new(size_t size)
+{
+	++g_AllocationCount;
+	if (void* p = malloc(size))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+#endif
+
+namespace
+{
+	using BenchmarkClock = std::chrono::high_resolution_clock;
+
+	constexpr size_t BENCHMARK_ITERATIONS = 1000000;
+	constexpr int BENCHMARK_TREE_ROUNDS = 5; // Best of, a tree tick is short next to the noise
+
+	// Returns the average duration of one call in nanoseconds
+	template<typename Fn>
+	double Measure(size_t iterations, Fn fn)
+	{
+		const auto start = BenchmarkClock::now();
+		for (size_t i{}; i < iterations; ++i)
+		{
+			fn();
+		}
+		const auto end = BenchmarkClock::now();
+
+		return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+	}
+
+	void PrintResult(const char* name, double before, double after)
+	{
+		printf("%-40s %10.2f ns %10.2f ns %8.2fx\n", name, before, after, before / after);
+	}
+
+	// Frame counter for allocation measurements
+	size_t GetAllocationCount()
+	{
+#if CONFIG_RUN_BENCHMARKS
+		return g_AllocationCount;
+#else
+		return 0;
+#endif
+	}
+
+	template<typename Fn>
+	double CountAllocationsPerFrame(size_t frameCount, Fn fn)
+	{
+		const size_t allocationsBefore = GetAllocationCount();
+		for (size_t i{}; i < frameCount; ++i)
+		{
+			fn();
+		}
+
+		return double(GetAllocationCount() - allocationsBefore) / frameCount;
+	}
+
+	// Interface stub so behaviors can run outside of the game
+	class BenchmarkInterface : public IExamInterface
+	{
+	public:
+		WorldInfo World_GetInfo() const override { return WorldInfo{ {}, { 500.f, 500.f } }; }
+		StatisticsInfo World_GetStats() const override { return StatisticsInfo{}; }
+
+		bool Fov_GetHouseByIndex(UINT index, HouseInfo& houseInfo) const override { return false; }
+		bool Fov_GetEntityByIndex(UINT index, EntityInfo& enemyInfo) const override { return false; }
+
+		AgentInfo Agent_GetInfo() const override { return AgentInfo{}; }
+		bool Enemy_GetInfo(EntityInfo entity, EnemyInfo& enemy) override { return false; }
+
+		Elite::Vector2 NavMesh_GetClosestPathPoint(Elite::Vector2 goal) const override { return goal; }
+
+		bool Inventory_AddItem(UINT slotId, ItemInfo item) override { return true; }
+		bool Inventory_UseItem(UINT slotId) override { return true; }
+		bool Inventory_RemoveItem(UINT slotId) override { return true; }
+		bool Inventory_GetItem(UINT slotId, ItemInfo& item) override { return false; }
+		UINT Inventory_GetCapacity() const override { return 5; }
+
+		// Items of a benchmark carry their type in the hash, they can be destroyed but not grabbed
+		bool Item_GetInfo(EntityInfo entity, ItemInfo& item) override
+		{
+			item = ItemInfo{ static_cast<eItemType>(entity.EntityHash), entity.Location, entity.EntityHash };
+			return entity.Type == eEntityType::ITEM;
+		}
+		bool Item_Grab(EntityInfo entity, ItemInfo& item) override { return false; }
+		bool Item_Destroy(EntityInfo entity) override { return entity.Type == eEntityType::ITEM; }
+
+		int Weapon_GetAmmo(ItemInfo& item) override { return 0; }
+		int Medkit_GetHealth(ItemInfo& item) override { return 0; }
+		int Food_GetEnergy(ItemInfo& item) override { return 0; }
+
+		bool PurgeZone_GetInfo(EntityInfo entity, PurgeZoneInfo& zone) override { return false; }
+
+		Elite::Vector2 Debug_ConvertScreenToWorld(Elite::Vector2 screenPos) const override { return screenPos; }
+		Elite::Vector2 Debug_ConvertWorldToScreen(Elite::Vector2 worldPos) const override { return worldPos; }
+
+		bool Input_IsKeyboardKeyDown(Elite::InputScancode key) const override { return false; }
+		bool Input_IsKeyboardKeyUp(Elite::InputScancode key) const override { return false; }
+		bool Input_IsMouseButtonDown(Elite::InputMouseButton button) const override { return false; }
+		bool Input_IsMouseButtonUp(Elite::InputMouseButton button) const override { return false; }
+		Elite::MouseData Input_GetMouseData(Elite::InputType type, Elite::InputMouseButton button) const override { return Elite::MouseData{}; }
+
+		void RequestShutdown() const override {}
+
+		void Draw_Polygon(const Elite::Vector2* points, int count, const Elite::Vector3& color, float depth) override {}
+		void Draw_SolidPolygon(const Elite::Vector2* points, int count, const Elite::Vector3& color, float depth, bool triangulate) override {}
+		void Draw_Circle(const Elite::Vector2& center, float radius, const Elite::Vector3& color, float depth) override {}
+		void Draw_SolidCircle(const Elite::Vector2& center, float32 radius, const Elite::Vector2& axis, const Elite::Vector3& color, float depth) override {}
+		void Draw_Segment(const Elite::Vector2& p1, const Elite::Vector2& p2, const Elite::Vector3& color, float depth) override {}
+		void Draw_Direction(const Elite::Vector2& p, Elite::Vector2 dir, float length, const Elite::Vector3& color, float depth) override {}
+		void Draw_Transform(const b2Transform& xf, float depth) override {}
+		void Draw_Point(const Elite::Vector2& p, float size, const Elite::Vector3& color, float depth) override {}
+		float NextDepthSlice() override { return 0.f; }
+	};
+
+	// A long run with many known houses: timers tick every frame, a new house is found now and then
+	// and every tick is published for Render. Runs on plain vectors or on copy-on-write vectors.
+	template<typename KnownHousesType, typename HousesType>
+	struct KnownHousesRun
+	{
+		static constexpr size_t HOUSE_INTERVAL = 100;
+
+		KnownHousesRun(size_t knownHouseCount)
+			: layout(CreateLayout())
+			, blackboard(layout)
+			, snapshots(layout)
+		{
+			std::vector<KnownHouse> knownHouses{};
+			std::vector<float> timers{};
+			for (size_t i{}; i < knownHouseCount; ++i)
+			{
+				knownHouses.push_back(KnownHouse{ { i * 30.f, 100.f }, false });
+				timers.push_back(static_cast<float>(i % CONFIG_SWEEP_MAX_TIMEOUT));
+			}
+			blackboard.ChangeData(KnownHousesKey(), KnownHousesType{ knownHouses });
+			blackboard.ChangeData(TimersKey(), timers);
+		}
+
+		void Tick(float dt)
+		{
+			++frame;
+			if (frame % HOUSE_INTERVAL == 0)
+			{
+				const HouseInfo house{ { frame * 1.f, -100.f }, { 20.f, 20.f } };
+				blackboard.ChangeData(HousesKey(), HousesType{ std::vector<HouseInfo>{ house } });
+				blackboard.ModifyData(KnownHousesKey(), [&house](std::vector<KnownHouse>& knownHouses) {
+					knownHouses.push_back(KnownHouse{ house.Center, false });
+				});
+				blackboard.ModifyData(TimersKey(), [](std::vector<float>& timers) {
+					timers.push_back(0.f);
+				});
+			}
+
+			// Same as the sweep timers in Plugin::UpdateSteering
+			bool hasTimedOut{};
+			blackboard.ModifyData(TimersKey(), [dt, &hasTimedOut](std::vector<float>& timers) {
+				for (float& timer : timers)
+				{
+					hasTimedOut |= timer < CONFIG_SWEEP_MAX_TIMEOUT && timer + dt >= CONFIG_SWEEP_MAX_TIMEOUT;
+					timer += dt;
+				}
+			});
+			if (hasTimedOut)
+			{
+				const std::vector<float>& timers = blackboard.ViewData(TimersKey());
+				blackboard.ModifyData(KnownHousesKey(), [&timers](std::vector<KnownHouse>& knownHouses) {
+					for (size_t i{}; i < knownHouses.size() && i < timers.size(); ++i)
+					{
+						knownHouses[i].isSweepDue = timers[i] >= CONFIG_SWEEP_MAX_TIMEOUT;
+					}
+				});
+			}
+
+			snapshots.Publish(blackboard);
+			const Blackboard& snapshot = snapshots.Acquire();
+			const std::vector<KnownHouse>& knownHouses = snapshot.ViewData(KnownHousesKey());
+			sink = knownHouses.size() + static_cast<const std::vector<HouseInfo>&>(snapshot.ViewData(HousesKey())).size();
+		}
+
+		static BlackboardKey<KnownHousesType> KnownHousesKey() { return { 0, P_KNOWN_HOUSES }; }
+		static BlackboardKey<HousesType> HousesKey() { return { 1, P_HOUSES_IN_FOV }; }
+		static BlackboardKey<std::vector<float>> TimersKey() { return { 2, P_KNOWN_HOUSE_SWEEP_TIMERS }; }
+		static BlackboardLayout CreateLayout()
+		{
+			BlackboardLayout layout{};
+			layout.Register(KnownHousesKey()).Register(HousesKey()).Register(TimersKey());
+			return layout;
+		}
+
+		BlackboardLayout layout;
+		Blackboard blackboard;
+		BlackboardSnapshots snapshots;
+		size_t frame = 0;
+		volatile size_t sink = 0;
+	};
+
+	void FillBlackboard(Blackboard& blackboard, IExamInterface* pInterface, std::vector<EnemyInfo>* pEnemies, std::vector<EntityInfo>* pItems);
+
+	// An agent walking around on its own, moved by the steering its tree outputs.
+	// Houses come into view now and then so the house branches run as well.
+	struct AgentWorld
+	{
+		static constexpr size_t HOUSE_INTERVAL = 600;
+		static constexpr size_t HOUSE_VISIBLE_TICKS = 120;
+
+		AgentWorld()
+			: blackboard(BB_Keys::CreateLayout())
+		{
+			FillBlackboard(blackboard, &benchmarkInterface, &enemies, &items);
+
+			std::vector<Elite::Vector2> locations{};
+			for (int angle{}; angle < 360; angle += 36)
+			{
+				locations.push_back(Elite::Vector2{ cosf(Elite::ToRadians(static_cast<float>(angle))), sinf(Elite::ToRadians(static_cast<float>(angle))) } * 150.f);
+			}
+			blackboard.ChangeData(BB_Keys::ExploreLocationsToVisit, CowVector<Elite::Vector2>{ locations });
+			blackboard.ChangeData(BB_Keys::Destination, locations.front());
+
+			agentInfo.MaxLinearSpeed = 5.f;
+			agentInfo.FOV_Range = 20.f;
+			agentInfo.Health = 10.f;
+			agentInfo.Energy = 10.f;
+		}
+
+		// Same order of updates as Plugin::UpdateSteering
+		void Step(float dt)
+		{
+			++tick;
+			std::vector<HouseInfo> houses{};
+			if (tick % HOUSE_INTERVAL < HOUSE_VISIBLE_TICKS)
+			{
+				const size_t houseIndex = tick / HOUSE_INTERVAL;
+				houses.push_back(HouseInfo{ { houseIndex * 40.f - 100.f, 30.f }, { 20.f, 20.f } });
+			}
+			if (!IsSameBlackboardData(houses, blackboard.ViewData(BB_Keys::HousesInFOV).Get()))
+				blackboard.ChangeData(BB_Keys::HousesInFOV, CowVector<HouseInfo>{ houses });
+
+			agentInfo.Position += blackboard.ViewData(BB_Keys::Steering).LinearVelocity * dt;
+			blackboard.ChangeData(BB_Keys::IsInHouse, false);
+			blackboard.ChangeData(BB_Keys::PlayerInfo, agentInfo);
+
+			// Random choices of the leaves depend on the tick only
+			srand(static_cast<unsigned int>(tick));
+		}
+
+		BenchmarkInterface benchmarkInterface{};
+		std::vector<EnemyInfo> enemies{};
+		std::vector<EntityInfo> items{};
+		Blackboard blackboard;
+		AgentInfo agentInfo{};
+		size_t tick = 0;
+	};
+
+	// The agent of AgentWorld scavenging a world with a fixed number of items while zombies hunt it.
+	// Items have to be walked to and picked up, a zombie bites an agent it catches and a gun kills one per shot,
+	// so the decisions decide how long the agent lasts. The run is over when health or energy runs out
+	struct SurvivalWorld
+	{
+		static constexpr float ENERGY_DRAIN = 0.05f; // Per second
+		static constexpr float RUN_ENERGY_DRAIN = 0.1f; // Per second of running, on top
+		static constexpr float RUN_SPEED_FACTOR = 1.5f; // Of the walking speed
+		static constexpr float ITEM_RESTORE = 5.f;
+		static constexpr size_t ITEM_COUNT = 40; // Nothing new is found once they are gone
+		static constexpr unsigned int ZOMBIE_CHANCE = 1200; // One in, per tick
+		static constexpr float ZOMBIE_SPEED = 4.f; // Catches an agent that stands still or walks into it
+		static constexpr float ZOMBIE_SPAWN_DISTANCE = 15.f;
+		static constexpr float ZOMBIE_DESPAWN_DISTANCE = 30.f;
+		static constexpr float BITE_RANGE = 1.5f;
+		static constexpr float BITE_DAMAGE = 1.f;
+		static constexpr float BITE_INTERVAL = 1.f; // Seconds between two bites of one zombie
+
+		struct Zombie
+		{
+			Elite::Vector2 position;
+			float biteTimer;
+			int hash;
+		};
+
+		// Grabbing takes the item out of the world, using a gun kills the closest zombie in view
+		class SurvivalInterface final : public BenchmarkInterface
+		{
+		public:
+			explicit SurvivalInterface(SurvivalWorld* pWorld) : m_pWorld(pWorld) {}
+
+			bool Item_Grab(EntityInfo entity, ItemInfo& item) override { return m_pWorld->Grab(entity, item); }
+			bool Inventory_UseItem(UINT slotId) override
+			{
+				m_pWorld->Use(slotId);
+				return true;
+			}
+
+		private:
+			SurvivalWorld* m_pWorld;
+		};
+
+		explicit SurvivalWorld(unsigned int seed)
+			: rng(seed)
+			, survivalInterface(this)
+		{
+			world.blackboard.ChangeData(BB_Keys::Interface, static_cast<IExamInterface*>(&survivalInterface));
+			world.agentInfo.GrabRange = 2.f;
+
+			// Inside the ring of explore locations of AgentWorld, so exploring comes across them
+			for (size_t i{}; i < ITEM_COUNT; ++i)
+			{
+				const float angle = Elite::ToRadians(static_cast<float>(rng() % 360));
+				const float radius = static_cast<float>(rng() % 160);
+				const unsigned int roll = rng() % 10;
+				const eItemType type = roll < 5 ? eItemType::FOOD : roll < 8 ? eItemType::MEDKIT : eItemType::PISTOL;
+				groundItems.push_back(EntityInfo{ eEntityType::ITEM, Elite::Vector2{ cosf(angle), sinf(angle) } * radius, static_cast<int>(type) });
+			}
+		}
+
+		SurvivalWorld(const SurvivalWorld& other) = delete;
+		SurvivalWorld& operator=(const SurvivalWorld& other) = delete;
+
+		// False once the agent is dead
+		bool Step(float dt)
+		{
+			AgentInfo& agentInfo = world.agentInfo;
+
+			// Running is faster and costs energy, AgentWorld moves the agent at walking speed
+			const SteeringPlugin_Output& steering = world.blackboard.ViewData(BB_Keys::Steering);
+			agentInfo.Energy -= (ENERGY_DRAIN + (steering.RunMode ? RUN_ENERGY_DRAIN : 0.f)) * dt;
+			if (steering.RunMode)
+				agentInfo.Position += steering.LinearVelocity * (RUN_SPEED_FACTOR - 1.f) * dt;
+			if (!steering.AutoOrient)
+				agentInfo.Orientation += steering.AngularVelocity * dt;
+			else if (steering.LinearVelocity.MagnitudeSquared() > 0.f)
+				agentInfo.Orientation = atan2f(steering.LinearVelocity.y, steering.LinearVelocity.x);
+
+			StepZombies(dt);
+			if (agentInfo.Energy <= 0.f || agentInfo.Health <= 0.f)
+				return false;
+
+			// Same as the bite timer of Plugin::UpdateSteering
+			bittenTime = agentInfo.WasBitten ? 0.f : bittenTime + dt;
+			if (bittenTime > CONFIG_BITTEN_REMEMBER_TIME && world.blackboard.ViewData(BB_Keys::PlayerWasBitten))
+				world.blackboard.ChangeData(BB_Keys::PlayerWasBitten, false);
+
+			UpdateView();
+			world.Step(dt);
+			++aliveTicks;
+			return true;
+		}
+
+		bool Grab(const EntityInfo& entity, ItemInfo& item)
+		{
+			const auto itemIt = std::find_if(groundItems.begin(), groundItems.end(), [&entity](const EntityInfo& groundItem) { return groundItem.Location == entity.Location; });
+			if (itemIt == groundItems.end() || Elite::Distance(itemIt->Location, world.agentInfo.Position) > world.agentInfo.GrabRange)
+				return false;
+
+			item = ItemInfo{ static_cast<eItemType>(itemIt->EntityHash), itemIt->Location, itemIt->EntityHash };
+			groundItems.erase(itemIt);
+			return true;
+		}
+
+		// Called before the inventory on the blackboard loses the item.
+		// Food and medkits restore their stat, a gun kills the closest zombie in view
+		void Use(UINT slot)
+		{
+			const Inventory& inventory = world.blackboard.ViewData(BB_Keys::Inventory);
+			if (slot >= inventory.slots.size() || !inventory.slots[slot])
+				return;
+
+			const eItemType type = inventory.items[slot].Type;
+			if (type == eItemType::FOOD || type == eItemType::MEDKIT)
+			{
+				float& stat = type == eItemType::FOOD ? world.agentInfo.Energy : world.agentInfo.Health;
+				stat = std::min(stat + ITEM_RESTORE, UT_Inputs::MaxPlayerStat);
+				++usedCount;
+			}
+			else if (type == eItemType::PISTOL && !world.enemies.empty())
+			{
+				const int targetHash = world.enemies.front().EnemyHash;
+				zombies.erase(std::remove_if(zombies.begin(), zombies.end(), [targetHash](const Zombie& zombie) { return zombie.hash == targetHash; }), zombies.end());
+				++killCount;
+			}
+		}
+
+		AgentWorld world{};
+		std::mt19937 rng;
+		SurvivalInterface survivalInterface;
+		std::vector<EntityInfo> groundItems{};
+		std::vector<Zombie> zombies{};
+		float bittenTime = 0.f;
+		int nextZombieHash = 0;
+		size_t usedCount = 0;
+		size_t biteCount = 0;
+		size_t killCount = 0;
+		size_t aliveTicks = 0;
+
+	private:
+		void StepZombies(float dt)
+		{
+			AgentInfo& agentInfo = world.agentInfo;
+			if (rng() % ZOMBIE_CHANCE == 0)
+			{
+				const float angle = Elite::ToRadians(static_cast<float>(rng() % 360));
+				zombies.push_back(Zombie{ agentInfo.Position + Elite::Vector2{ cosf(angle), sinf(angle) } * ZOMBIE_SPAWN_DISTANCE, 0.f, nextZombieHash++ });
+			}
+
+			agentInfo.WasBitten = false;
+			for (Zombie& zombie : zombies)
+			{
+				const Elite::Vector2 toAgent = agentInfo.Position - zombie.position;
+				const float distance = toAgent.Magnitude();
+				if (distance > BITE_RANGE)
+					zombie.position += toAgent * (std::min(ZOMBIE_SPEED * dt, distance - BITE_RANGE) / distance);
+
+				zombie.biteTimer -= dt;
+				if (Elite::Distance(zombie.position, agentInfo.Position) <= BITE_RANGE + 0.01f && zombie.biteTimer <= 0.f)
+				{
+					agentInfo.Health -= BITE_DAMAGE;
+					agentInfo.WasBitten = true;
+					zombie.biteTimer = BITE_INTERVAL;
+					++biteCount;
+				}
+			}
+
+			// Outrun zombies give up
+			zombies.erase(std::remove_if(zombies.begin(), zombies.end(), [&agentInfo](const Zombie& zombie) {
+				return Elite::Distance(zombie.position, agentInfo.Position) > ZOMBIE_DESPAWN_DISTANCE;
+			}), zombies.end());
+		}
+
+		// Items and zombies in range of the agent, the closest first, like the FOV of Plugin::UpdateSteering
+		void UpdateView()
+		{
+			const AgentInfo& agentInfo = world.agentInfo;
+			const auto isCloser = [&agentInfo](const Elite::Vector2& left, const Elite::Vector2& right) {
+				return Elite::DistanceSquared(left, agentInfo.Position) < Elite::DistanceSquared(right, agentInfo.Position);
+			};
+
+			std::vector<EntityInfo> items{};
+			for (const EntityInfo& item : groundItems)
+			{
+				if (Elite::Distance(item.Location, agentInfo.Position) <= agentInfo.FOV_Range)
+					items.push_back(item);
+			}
+			std::sort(items.begin(), items.end(), [&isCloser](const EntityInfo& left, const EntityInfo& right) { return isCloser(left.Location, right.Location); });
+
+			std::vector<EnemyInfo> enemies{};
+			for (const Zombie& zombie : zombies)
+			{
+				if (Elite::Distance(zombie.position, agentInfo.Position) <= agentInfo.FOV_Range)
+					enemies.push_back(EnemyInfo{ eEnemyType::ZOMBIE_NORMAL, zombie.position, {}, zombie.hash, 1.f, 1.f });
+			}
+			std::sort(enemies.begin(), enemies.end(), [&isCloser](const EnemyInfo& left, const EnemyInfo& right) { return isCloser(left.Location, right.Location); });
+
+			if (!IsSameBlackboardData(items, world.items))
+			{
+				world.items.swap(items);
+				world.blackboard.MarkChanged(BB_Keys::ItemsInFOV);
+			}
+			if (!IsSameBlackboardData(enemies, world.enemies))
+			{
+				world.enemies.swap(enemies);
+				world.blackboard.MarkChanged(BB_Keys::EnemiesInFOV);
+			}
+		}
+	};
+
+	struct SurvivalScore
+	{
+		double decisionTime = 0.0; // Nanoseconds
+		size_t tickCount = 0;
+		size_t usedCount = 0;
+		size_t biteCount = 0;
+		size_t killCount = 0;
+	};
+
+	// Plays one seed until the agent dies or maxTickCount, decide runs the decision of a tick on the world's blackboard
+	template<typename Fn>
+	void PlaySurvival(SurvivalWorld& world, size_t maxTickCount, float dt, SurvivalScore& score, Fn decide)
+	{
+		while (world.aliveTicks < maxTickCount && world.Step(dt))
+		{
+			const auto start = BenchmarkClock::now();
+			decide();
+			score.decisionTime += std::chrono::duration<double, std::nano>(BenchmarkClock::now() - start).count();
+		}
+		score.tickCount += world.aliveTicks;
+		score.usedCount += world.usedCount;
+		score.biteCount += world.biteCount;
+		score.killCount += world.killCount;
+	}
+
+	// The pointer tree the way BehaviorTree runs it, with a scheduler and resuming its running branch
+	void PlayTreeSurvival(unsigned int seed, size_t maxTickCount, float dt, SurvivalScore& score)
+	{
+		IBehavior* pRootBehavior = Plugin::CreateRootBehavior();
+		BehaviorTreeContext context{};
+		pRootBehavior->BindContext(&context);
+		BehaviorState state = BehaviorState::Failure;
+
+		SurvivalWorld world{ seed };
+		PlaySurvival(world, maxTickCount, dt, score, [&]()
+		{
+			context.scheduler.Advance(dt);
+			state = state == BehaviorState::Running ? pRootBehavior->Resume(&world.world.blackboard) : pRootBehavior->Execute(&world.world.blackboard);
+		});
+
+		SAFE_DELETE(pRootBehavior);
+	}
+
+	void PrintSurvival(const char* name, const SurvivalScore& treeScore, const SurvivalScore& score, size_t seedCount, float dt)
+	{
+		printf("%-40s %10.1f s %10.1f s %10zu seeds\n", name, treeScore.tickCount * dt / seedCount, score.tickCount * dt / seedCount, seedCount);
+		printf("%-40s %10.1f items %10.1f items\n", "Items used (tree vs other)", double(treeScore.usedCount) / seedCount, double(score.usedCount) / seedCount);
+		printf("%-40s %10.1f bites %10.1f bites\n", "Zombie bites (tree vs other)", double(treeScore.biteCount) / seedCount, double(score.biteCount) / seedCount);
+		printf("%-40s %10.1f kills %10.1f kills\n", "Zombie kills (tree vs other)", double(treeScore.killCount) / seedCount, double(score.killCount) / seedCount);
+	}
+
+	// Average duration of one tree tick in nanoseconds, best of a few rounds.
+	// Only the tree is timed, the simulated agent costs more than the decision itself
+	template<typename Fn>
+	double MeasureTreeTick(size_t tickCount, float dt, Fn executeTree)
+	{
+		double bestTick = std::numeric_limits<double>::max();
+		for (int round{}; round < BENCHMARK_TREE_ROUNDS; ++round)
+		{
+			AgentWorld timingWorld{};
+			double totalTime{};
+			for (size_t i{}; i < tickCount; ++i)
+			{
+				timingWorld.Step(dt);
+				const auto start = BenchmarkClock::now();
+				executeTree(&timingWorld.blackboard);
+				const auto end = BenchmarkClock::now();
+				totalTime += std::chrono::duration<double, std::nano>(end - start).count();
+			}
+			bestTick = std::min(bestTick, totalTime / tickCount);
+		}
+		return bestTick;
+	}
+
+	// Same result and the same steering written
+	bool IsSameTick(BehaviorState state, const Blackboard& blackboard, BehaviorState otherState, const Blackboard& otherBlackboard)
+	{
+		const SteeringPlugin_Output& steering = blackboard.ViewData(BB_Keys::Steering);
+		const SteeringPlugin_Output& otherSteering = otherBlackboard.ViewData(BB_Keys::Steering);
+		return state == otherState
+			&& steering.LinearVelocity == otherSteering.LinearVelocity
+			&& steering.AngularVelocity == otherSteering.AngularVelocity
+			&& steering.AutoOrient == otherSteering.AutoOrient
+			&& steering.RunMode == otherSteering.RunMode;
+	}
+
+	// Sums the counters of every BehaviorTickRate node in a tree
+	void CountTickRateNodes(const IBehavior* pBehavior, size_t& tickCount, size_t& skippedCount)
+	{
+		if (const BehaviorTickRate* pTickRate = dynamic_cast<const BehaviorTickRate*>(pBehavior))
+		{
+			tickCount += pTickRate->GetTickCount();
+			skippedCount += pTickRate->GetSkippedCount();
+		}
+		for (size_t i{}; i < pBehavior->GetChildCount(); ++i)
+		{
+			CountTickRateNodes(pBehavior->GetChild(i), tickCount, skippedCount);
+		}
+	}
+
+	// Counts the nodes whose type, name or child count differ between two trees
+	size_t CountShapeMismatches(const IBehavior* pBehavior, const IBehavior* pOtherBehavior)
+	{
+		const bool isSameName = pBehavior->GetName() == nullptr || pOtherBehavior->GetName() == nullptr
+			? pBehavior->GetName() == pOtherBehavior->GetName()
+			: strcmp(pBehavior->GetName(), pOtherBehavior->GetName()) == 0;
+		if (strcmp(pBehavior->GetTypeName(), pOtherBehavior->GetTypeName()) != 0 || !isSameName || pBehavior->GetChildCount() != pOtherBehavior->GetChildCount())
+			return 1;
+
+		size_t mismatchCount{};
+		for (size_t i{}; i < pBehavior->GetChildCount(); ++i)
+		{
+			mismatchCount += CountShapeMismatches(pBehavior->GetChild(i), pOtherBehavior->GetChild(i));
+		}
+		return mismatchCount;
+	}
+
+	// Fills a blackboard with the same keys and types Plugin::Initialize uses
+	void FillBlackboard(Blackboard& blackboard, IExamInterface* pInterface, std::vector<EnemyInfo>* pEnemies, std::vector<EntityInfo>* pItems)
+	{
+		blackboard.AddData(BB_Keys::PlayerInfo, AgentInfo{});
+		blackboard.AddData(BB_Keys::WorldInfo, WorldInfo{});
+		blackboard.AddData(BB_Keys::TargetInfo, Elite::Vector2{});
+		blackboard.AddData(BB_Keys::Interface, pInterface);
+		blackboard.AddData(BB_Keys::ShouldExplore, true);
+		blackboard.AddData(BB_Keys::HousesInFOV, std::vector<HouseInfo>{});
+		blackboard.AddData(BB_Keys::EnemiesInFOV, pEnemies);
+		blackboard.AddData(BB_Keys::ItemsInFOV, pItems);
+		blackboard.AddData(BB_Keys::Steering, SteeringPlugin_Output{});
+		blackboard.AddData(BB_Keys::LastPosition, Elite::Vector2{});
+		blackboard.AddData(BB_Keys::ActiveHouse, HouseInfo{});
+		blackboard.AddData(BB_Keys::KnownHouses, std::vector<KnownHouse>{});
+		blackboard.AddData(BB_Keys::KnownHouseSweepTimers, std::vector<float>{});
+		blackboard.AddData(BB_Keys::IsGoingForHouse, false);
+		blackboard.AddData(BB_Keys::Inventory, Inventory{});
+		blackboard.AddData(BB_Keys::HouseToSweep, SweepHouse{});
+		blackboard.AddData(BB_Keys::ZombieTarget, Elite::Vector2{});
+		blackboard.AddData(BB_Keys::PlayerWasBitten, false);
+		blackboard.AddData(BB_Keys::IsInHouse, false);
+		blackboard.AddData(BB_Keys::ExploreLocationsToVisit, std::vector<Elite::Vector2>{});
+		blackboard.AddData(BB_Keys::ExploreLocationsVisited, std::vector<Elite::Vector2>{});
+		blackboard.AddData(BB_Keys::Destination, Elite::Vector2{});
+		blackboard.AddData(BB_Keys::DestinationReached, false);
+	}
+
+	// Every decorator over a scripted child, ticked by a tree that walks from the root and by one that resumes.
+	// Both have to give the results of the script, including a branch that is left without an Abort and entered again
+	void CheckDecorators()
+	{
+		constexpr float dt = 0.125f; // Exact in binary, so the timers expire on a known tick
+
+		struct DecoratorCase
+		{
+			const char* pName;
+			IBehavior* (*fpCreate)(IBehavior* pChild);
+			const char* pChildScript; // S, F or R per run of the child, the last one repeats
+			const char* pExpected; // S, F or R per tick, '-' is a tick that does not reach the decorator
+			size_t childRunCount;
+		};
+		const DecoratorCase cases[] =
+		{
+			{ "Timeout expires", [](IBehavior* pChild) -> IBehavior* { return new BehaviorTimeout(0.25f, pChild); }, "R", "RRFR", 4 },
+			{ "Timeout entered again", [](IBehavior* pChild) -> IBehavior* { return new BehaviorTimeout(0.25f, pChild); }, "R", "RR--RRF", 5 },
+			{ "Retry runs out", [](IBehavior* pChild) -> IBehavior* { return new BehaviorRetry(3, pChild); }, "F", "RRFRRF", 6 },
+			{ "Retry entered again", [](IBehavior* pChild) -> IBehavior* { return new BehaviorRetry(3, pChild); }, "F", "R--RRF", 4 },
+			{ "Retry succeeds", [](IBehavior* pChild) -> IBehavior* { return new BehaviorRetry(3, pChild); }, "FS", "RS", 2 },
+			{ "Cooldown", [](IBehavior* pChild) -> IBehavior* { return new BehaviorCooldown(0.25f, pChild); }, "S", "SFSF", 2 },
+			{ "Cooldown after running", [](IBehavior* pChild) -> IBehavior* { return new BehaviorCooldown(0.25f, pChild); }, "RS", "RSFS", 3 },
+			{ "Rate limit", [](IBehavior* pChild) -> IBehavior* { return new BehaviorRateLimit(4.f, pChild); }, "S", "SFS", 2 },
+			{ "Rate limit entered again", [](IBehavior* pChild) -> IBehavior* { return new BehaviorRateLimit(2.f, pChild); }, "R", "R-F", 1 },
+			{ "Inverter", [](IBehavior* pChild) -> IBehavior* { return new BehaviorInverter(pChild); }, "SFR", "FSR", 3 },
+			{ "Force success", [](IBehavior* pChild) -> IBehavior* { return new BehaviorForceSuccess(pChild); }, "SFR", "SSR", 3 },
+		};
+		const auto toState = [](char code)
+		{
+			return code == 'S' ? BehaviorState::Success : code == 'F' ? BehaviorState::Failure : BehaviorState::Running;
+		};
+
+		size_t checkCount{};
+		size_t mismatchCount{};
+		for (const DecoratorCase& decoratorCase : cases)
+		{
+			for (bool isResuming : { false, true })
+			{
+				size_t runCount{};
+				const size_t scriptLength = strlen(decoratorCase.pChildScript);
+				IBehavior* pDecorator = decoratorCase.fpCreate(new BehaviorAction([&runCount, &decoratorCase, scriptLength, &toState](Blackboard*)
+				{
+					return toState(decoratorCase.pChildScript[std::min(runCount++, scriptLength - 1)]);
+				}));
+				BehaviorTreeContext context{};
+				pDecorator->BindContext(&context);
+
+				std::string results{};
+				BehaviorState state = BehaviorState::Failure;
+				for (const char* pTick = decoratorCase.pExpected; *pTick != '\0'; ++pTick)
+				{
+					context.scheduler.Advance(dt);
+					if (*pTick == '-')
+					{
+						state = BehaviorState::Failure;
+						results += '-';
+						continue;
+					}
+
+					state = isResuming && state == BehaviorState::Running ? pDecorator->Resume(nullptr) : pDecorator->Execute(nullptr);
+					results += state == BehaviorState::Success ? 'S' : state == BehaviorState::Failure ? 'F' : 'R';
+				}
+
+				++checkCount;
+				if (results != decoratorCase.pExpected || runCount != decoratorCase.childRunCount)
+				{
+					++mismatchCount;
+					printf("WARNING: %s (%s) gave %s with %zu child runs instead of %s with %zu \n", decoratorCase.pName, isResuming ? "resuming" : "walking",
+						results.c_str(), runCount, decoratorCase.pExpected, decoratorCase.childRunCount);
+				}
+				SAFE_DELETE(pDecorator);
+			}
+		}
+		printf("%-40s %10zu checked %10zu mismatches\n", "Decorator results", checkCount, mismatchCount);
+	}
+}
+
+namespace Benchmarks
+{
+	void RunAll()
+	{
+		printf("%-40s %13s %13s %9s\n", "Benchmark", "Before", "After", "Speedup");
+		BlackboardLookup();
+		BlackboardAllocations();
+		BlackboardStorage();
+		BlackboardSnapshot();
+		BlackboardCheckpoint();
+		BlackboardCopyOnWrite();
+		BehaviorTreeExecutors();
+		BehaviorTreeResume();
+		BehaviorTreeConditionMemo();
+		BehaviorTreeTickRate();
+		BehaviorTreeDecorators();
+		BehaviorTreeParallel();
+		BehaviorTreeBatch();
+		BehaviorTreeLoading();
+		BehaviorTreeReordering();
+		BehaviorTreeTrace();
+		DecisionMakingUtility();
+		DecisionMakingStateMachine();
+		DecisionMakingGoap();
+	}
+
+	void BlackboardLookup()
+	{
+		std::vector<EnemyInfo> enemies{};
+		std::vector<EntityInfo> items{};
+
+		Blackboard blackboard{ BB_Keys::CreateLayout() };
+		FillBlackboard(blackboard, nullptr, &enemies, &items);
+
+		AgentInfo agentInfo{};
+		bool isInHouse{};
+		volatile float sink{};
+
+		// String keys: std::string construction, hash, map probe and dynamic_cast per lookup
+		const double stringLookup = Measure(BENCHMARK_ITERATIONS, [&]() {
+			blackboard.GetData(P_PLAYERINFO, agentInfo);
+			blackboard.GetData(P_IS_IN_HOUSE, isInHouse);
+			sink = agentInfo.Position.x + static_cast<float>(isInHouse);
+		}) / 2.0;
+
+		// Typed keys: slot index and static_cast
+		const double typedLookup = Measure(BENCHMARK_ITERATIONS, [&]() {
+			blackboard.GetData(BB_Keys::PlayerInfo, agentInfo);
+			blackboard.GetData(BB_Keys::IsInHouse, isInHouse);
+			sink = agentInfo.Position.x + static_cast<float>(isInHouse);
+		}) / 2.0;
+
+		PrintResult("Blackboard GetData (per lookup)", stringLookup, typedLookup);
+
+		const double stringChange = Measure(BENCHMARK_ITERATIONS, [&]() {
+			blackboard.ChangeData(P_IS_IN_HOUSE, true);
+		});
+
+		const double typedChange = Measure(BENCHMARK_ITERATIONS, [&]() {
+			blackboard.ChangeData(BB_Keys::IsInHouse, true);
+		});
+
+		PrintResult("Blackboard ChangeData (per write)", stringChange, typedChange);
+	}
+
+	void BlackboardAllocations()
+	{
+		constexpr size_t frameCount = 1000;
+		constexpr size_t knownHouseCount = 32;
+
+		BenchmarkInterface benchmarkInterface{};
+		std::vector<EnemyInfo> enemies{};
+		std::vector<EntityInfo> items{};
+
+		Blackboard blackboard{ BB_Keys::CreateLayout() };
+		FillBlackboard(blackboard, &benchmarkInterface, &enemies, &items);
+
+		// Agent stands in a known house far away from every explore location
+		AgentInfo agentInfo{};
+		agentInfo.MaxLinearSpeed = 5.f;
+
+		HouseInfo activeHouse{ { 0.f, 0.f }, { 20.f, 20.f } };
+		std::vector<KnownHouse> knownHouses{};
+		for (size_t i{}; i < knownHouseCount; ++i)
+		{
+			knownHouses.push_back(KnownHouse{ { 100.f + i * 30.f, 100.f }, false });
+		}
+		knownHouses.push_back(KnownHouse{ activeHouse.Center, true });
+		std::vector<float> sweepTimers(knownHouseCount, 0.f);
+		sweepTimers.push_back(static_cast<float>(CONFIG_SWEEP_MAX_TIMEOUT));
+
+		std::vector<Elite::Vector2> locationsToVisit{};
+		for (int i{}; i < CONFIG_RANDOM_LOCATION_COUNT; ++i)
+		{
+			locationsToVisit.push_back({ 200.f + i * 10.f, -200.f });
+		}
+
+		blackboard.ChangeData(BB_Keys::PlayerInfo, agentInfo);
+		blackboard.ChangeData(BB_Keys::ActiveHouse, activeHouse);
+		blackboard.ChangeData(BB_Keys::KnownHouses, knownHouses);
+		blackboard.ChangeData(BB_Keys::KnownHouseSweepTimers, sweepTimers);
+		blackboard.ChangeData(BB_Keys::ExploreLocationsToVisit, locationsToVisit);
+		blackboard.ChangeData(BB_Keys::Destination, locationsToVisit.front());
+
+		// Same subtrees as in Plugin::Initialize
+		BehaviorSequence exploration{ {
+			new BehaviorSelector{{
+				new BehaviorSequence{{
+					new BehaviorConditional(BT_Conditions::HasVisitedAllLocations),
+					new BehaviorAction(BT_Actions::RandomizeVisitLocations)
+				}},
+				new BehaviorSequence{{
+					new BehaviorConditional(BT_Conditions::HasReachedExploreLocation),
+					new BehaviorAction(BT_Actions::UpdateExplorationList),
+					new BehaviorAction(BT_Actions::SetNewExploreDestination)
+				}},
+				new BehaviorSequence{{
+					new BehaviorConditional(BT_Conditions::ShouldExplore),
+					new BehaviorAction(BT_Actions::Explore),
+					new BehaviorAction(BT_Actions::Seek)
+				}},
+			}},
+		} };
+
+		BehaviorSequence houseSweep{ {
+			new BehaviorConditional(BT_Conditions::IsInHouse),
+			new BehaviorSelector{{
+				new BehaviorSequence{{
+					new BehaviorConditional(BT_Conditions::ShouldSweepHouse),
+					new BehaviorAction(BT_Actions::Sweep)
+				}},
+				new BehaviorSequence{{
+					new BehaviorAction(BT_Actions::ExitHouse)
+				}},
+			}},
+		} };
+
+		// Travelling towards the current explore location
+		const double travelAllocations = CountAllocationsPerFrame(frameCount, [&]() {
+			exploration.Execute(&blackboard);
+		});
+
+		// Reaching an explore location every frame, which also rotates the lists
+		const double reachAllocations = CountAllocationsPerFrame(frameCount, [&]() {
+			agentInfo.Position = blackboard.ViewData(BB_Keys::Destination);
+			blackboard.ChangeData(BB_Keys::PlayerInfo, agentInfo);
+			exploration.Execute(&blackboard);
+		});
+
+		// Walking the sweep spots of the active house
+		agentInfo.Position = activeHouse.Center;
+		blackboard.ChangeData(BB_Keys::PlayerInfo, agentInfo);
+
+		const double sweepAllocations = CountAllocationsPerFrame(frameCount, [&]() {
+			const SweepHouse& sweepHouse = blackboard.ViewData(BB_Keys::HouseToSweep);
+			if (sweepHouse.sweepIndex < CONFIG_MAX_HOUSE_SWEEP_SPOTS)
+			{
+				agentInfo.Position = sweepHouse.sweepLocations[sweepHouse.sweepIndex];
+				blackboard.ChangeData(BB_Keys::PlayerInfo, agentInfo);
+			}
+			houseSweep.Execute(&blackboard);
+		});
+
+		printf("%-40s %10.2f allocations per frame\n", "Exploration branch (travelling)", travelAllocations);
+		printf("%-40s %10.2f allocations per frame\n", "Exploration branch (reaching)", reachAllocations);
+		printf("%-40s %10.2f allocations per frame\n", "House sweep branch", sweepAllocations);
+	}
+
+	void BlackboardStorage()
+	{
+		constexpr size_t iterations = 10000;
+
+		std::vector<EnemyInfo> enemies{};
+		std::vector<EntityInfo> items{};
+		const BlackboardLayout layout = BB_Keys::CreateLayout();
+
+		// Heap: one field per key behind its own allocation
+		const double heapAllocations = CountAllocationsPerFrame(iterations, [&]() {
+			Blackboard blackboard{};
+			FillBlackboard(blackboard, nullptr, &enemies, &items);
+		});
+
+		// Arena: every field in one block, the layout is built once
+		const double arenaAllocations = CountAllocationsPerFrame(iterations, [&]() {
+			Blackboard blackboard{ layout };
+			FillBlackboard(blackboard, nullptr, &enemies, &items);
+		});
+
+		printf("%-40s %10.2f allocations %10.2f allocations\n", "Blackboard construction", heapAllocations, arenaAllocations);
+
+		Blackboard heapBlackboard{};
+		FillBlackboard(heapBlackboard, nullptr, &enemies, &items);
+		Blackboard arenaBlackboard{ layout };
+		FillBlackboard(arenaBlackboard, nullptr, &enemies, &items);
+
+		// Every key a tick touches, read through a view
+		volatile float sink{};
+		auto touchAll = [&sink](Blackboard& blackboard) {
+			float sum{};
+			sum += blackboard.ViewData(BB_Keys::PlayerInfo).Position.x;
+			sum += blackboard.ViewData(BB_Keys::WorldInfo).Center.x;
+			sum += blackboard.ViewData(BB_Keys::TargetInfo).x;
+			sum += blackboard.ViewData(BB_Keys::Interface) != nullptr;
+			sum += blackboard.ViewData(BB_Keys::ShouldExplore);
+			sum += blackboard.ViewData(BB_Keys::HousesInFOV).size();
+			sum += blackboard.ViewData(BB_Keys::EnemiesInFOV)->size();
+			sum += blackboard.ViewData(BB_Keys::ItemsInFOV)->size();
+			sum += blackboard.ViewData(BB_Keys::Steering).AngularVelocity;
+			sum += blackboard.ViewData(BB_Keys::LastPosition).x;
+			sum += blackboard.ViewData(BB_Keys::ActiveHouse).Center.x;
+			sum += blackboard.ViewData(BB_Keys::KnownHouses).size();
+			sum += blackboard.ViewData(BB_Keys::KnownHouseSweepTimers).size();
+			sum += blackboard.ViewData(BB_Keys::IsGoingForHouse);
+			sum += blackboard.ViewData(BB_Keys::Inventory).slots[0];
+			sum += blackboard.ViewData(BB_Keys::HouseToSweep).sweepIndex;
+			sum += blackboard.ViewData(BB_Keys::ZombieTarget).x;
+			sum += blackboard.ViewData(BB_Keys::PlayerWasBitten);
+			sum += blackboard.ViewData(BB_Keys::IsInHouse);
+			sum += blackboard.ViewData(BB_Keys::ExploreLocationsToVisit).size();
+			sum += blackboard.ViewData(BB_Keys::ExploreLocationsVisited).size();
+			sum += blackboard.ViewData(BB_Keys::Destination).x;
+			sum += blackboard.ViewData(BB_Keys::DestinationReached);
+			sink = sum;
+		};
+
+		const double heapTouch = Measure(BENCHMARK_ITERATIONS, [&]() { touchAll(heapBlackboard); });
+		const double arenaTouch = Measure(BENCHMARK_ITERATIONS, [&]() { touchAll(arenaBlackboard); });
+
+		PrintResult("Blackboard read of all 23 keys", heapTouch, arenaTouch);
+		printf("%-40s %10zu bytes %10zu cache lines\n", "Blackboard arena", layout.GetSize(), (layout.GetSize() + BlackboardLayout::ARENA_ALIGNMENT - 1) / BlackboardLayout::ARENA_ALIGNMENT);
+	}
+
+	void BlackboardSnapshot()
+	{
+		std::vector<EnemyInfo> enemies{};
+		std::vector<EntityInfo> items{};
+		const BlackboardLayout layout = BB_Keys::CreateLayout();
+
+		Blackboard blackboard{ layout };
+		FillBlackboard(blackboard, nullptr, &enemies, &items);
+
+		std::vector<Elite::Vector2> locations{};
+		for (int i{}; i < CONFIG_RANDOM_LOCATION_COUNT; ++i)
+		{
+			locations.push_back({ i * 10.f, -200.f });
+		}
+		blackboard.ChangeData(BB_Keys::ExploreLocationsToVisit, locations);
+		blackboard.ChangeData(BB_Keys::ExploreLocationsVisited, locations);
+
+		BlackboardSnapshots snapshots{ layout };
+		AgentInfo agentInfo{};
+		volatile float sink{};
+
+		// Render copies out of the live blackboard, the agent moves every tick
+		auto copyTick = [&]() {
+			agentInfo.Position.x += 1.f;
+			blackboard.ChangeData(BB_Keys::PlayerInfo, agentInfo);
+
+			const std::vector<Elite::Vector2> toVisit = blackboard.ViewData(BB_Keys::ExploreLocationsToVisit).Get();
+			const std::vector<Elite::Vector2> visited = blackboard.ViewData(BB_Keys::ExploreLocationsVisited).Get();
+			SweepHouse sweepHouse{};
+			AgentInfo renderAgent{};
+			blackboard.GetData(BB_Keys::HouseToSweep, sweepHouse);
+			blackboard.GetData(BB_Keys::PlayerInfo, renderAgent);
+			sink = renderAgent.Position.x + toVisit.size() + visited.size() + sweepHouse.sweepIndex;
+		};
+
+		// Publish only copies the changed fields, Render views the snapshot
+		auto snapshotTick = [&]() {
+			agentInfo.Position.x += 1.f;
+			blackboard.ChangeData(BB_Keys::PlayerInfo, agentInfo);
+			snapshots.Publish(blackboard);
+
+			const Blackboard& snapshot = snapshots.Acquire();
+			sink = snapshot.ViewData(BB_Keys::PlayerInfo).Position.x
+				+ snapshot.ViewData(BB_Keys::ExploreLocationsToVisit).size()
+				+ snapshot.ViewData(BB_Keys::ExploreLocationsVisited).size()
+				+ snapshot.ViewData(BB_Keys::HouseToSweep).sweepIndex;
+		};
+
+		PrintResult("Render reads per tick (copy vs snapshot)", Measure(BENCHMARK_ITERATIONS, copyTick), Measure(BENCHMARK_ITERATIONS, snapshotTick));
+		printf("%-40s %10.2f allocations %10.2f allocations\n", "Render reads per tick", CountAllocationsPerFrame(1000, copyTick), CountAllocationsPerFrame(1000, snapshotTick));
+	}
+
+	void BlackboardCheckpoint()
+	{
+		constexpr size_t iterations = 10000;
+		constexpr size_t knownHouseCount = 64;
+
+		std::vector<EnemyInfo> enemies{};
+		std::vector<EntityInfo> items{};
+		const BlackboardLayout layout = BB_Keys::CreateLayout();
+
+		Blackboard blackboard{ layout };
+		FillBlackboard(blackboard, nullptr, &enemies, &items);
+
+		std::vector<KnownHouse> knownHouses{};
+		for (size_t i{}; i < knownHouseCount; ++i)
+		{
+			knownHouses.push_back(KnownHouse{ { i * 30.f, 100.f }, i % 2 == 0 });
+		}
+		std::vector<Elite::Vector2> locations(CONFIG_RANDOM_LOCATION_COUNT, Elite::Vector2{ 10.f, 20.f });
+		blackboard.ChangeData(BB_Keys::KnownHouses, knownHouses);
+		blackboard.ChangeData(BB_Keys::ExploreLocationsToVisit, locations);
+		blackboard.ChangeData(BB_Keys::ExploreLocationsVisited, locations);
+
+		std::vector<char> checkpoint{};
+		blackboard.SaveCheckpoint(checkpoint);
+
+		// Restoring into a blackboard that already held a run of the same size
+		Blackboard restored{ layout };
+		FillBlackboard(restored, nullptr, &enemies, &items);
+		restored.LoadCheckpoint(checkpoint.data(), checkpoint.size());
+
+		const double save = Measure(iterations, [&]() { blackboard.SaveCheckpoint(checkpoint); });
+		const double load = Measure(iterations, [&]() { restored.LoadCheckpoint(checkpoint.data(), checkpoint.size()); });
+		const double loadAllocations = CountAllocationsPerFrame(iterations, [&]() { restored.LoadCheckpoint(checkpoint.data(), checkpoint.size()); });
+
+		bool isSame = restored.ViewData(BB_Keys::KnownHouses).size() == knownHouseCount
+			&& restored.ViewData(BB_Keys::KnownHouses).back().isSweepDue == knownHouses.back().isSweepDue;
+
+		// A copy sharing the buffer, like a snapshot for Render, keeps what it had when a checkpoint replaces it
+		const CowVector<KnownHouse> heldKnownHouses = restored.ViewData(BB_Keys::KnownHouses);
+		std::vector<char> emptyCheckpoint{};
+		blackboard.ChangeData(BB_Keys::KnownHouses, CowVector<KnownHouse>{});
+		blackboard.SaveCheckpoint(emptyCheckpoint);
+		restored.LoadCheckpoint(emptyCheckpoint.data(), emptyCheckpoint.size());
+		isSame = isSame && heldKnownHouses.size() == knownHouseCount && restored.ViewData(BB_Keys::KnownHouses).empty();
+
+		printf("%-40s %10zu bytes %10s\n", "Blackboard checkpoint", checkpoint.size(), isSame ? "restored" : "MISMATCH");
+		printf("%-40s %10.2f ns save %10.2f ns load %6.2f allocations\n", "Blackboard checkpoint save and load", save, load, loadAllocations);
+	}
+
+	void BlackboardCopyOnWrite()
+	{
+		constexpr size_t frameCount = 100000; // About half an hour of game time at 60 fps
+		constexpr size_t knownHouseCount = 256;
+		constexpr float dt = 1.f / 60.f;
+
+		using VectorRun = KnownHousesRun<std::vector<KnownHouse>, std::vector<HouseInfo>>;
+		using CowRun = KnownHousesRun<CowVector<KnownHouse>, CowVector<HouseInfo>>;
+
+		VectorRun vectorRun{ knownHouseCount };
+		CowRun cowRun{ knownHouseCount };
+		const double vectorTick = Measure(frameCount, [&]() { vectorRun.Tick(dt); });
+		const double cowTick = Measure(frameCount, [&]() { cowRun.Tick(dt); });
+
+		VectorRun vectorAllocationRun{ knownHouseCount };
+		CowRun cowAllocationRun{ knownHouseCount };
+		const double vectorAllocations = CountAllocationsPerFrame(frameCount, [&]() { vectorAllocationRun.Tick(dt); });
+		const double cowAllocations = CountAllocationsPerFrame(frameCount, [&]() { cowAllocationRun.Tick(dt); });
+
+		PrintResult("Known houses long run (vector vs cow)", vectorTick, cowTick);
+		printf("%-40s %10.2f allocations %10.2f allocations\n", "Known houses long run per tick", vectorAllocations, cowAllocations);
+	}
+
+	void BehaviorTreeExecutors()
+	{
+		constexpr size_t tickCount = 100000;
+		constexpr float dt = 1.f / 60.f;
+
+		// Only the pointer tree has a scheduler, so every executor runs the bookkeeping every frame
+		IBehavior* pRootBehavior = Plugin::CreateRootBehavior(0.f);
+		FlatBehaviorTree flatTree{};
+		flatTree.Compile(pRootBehavior);
+
+		// Every executor drives its own agent through the same ticks, every decision has to match
+		AgentWorld pointerWorld{};
+		AgentWorld flatWorld{};
+		AgentWorld staticWorld{};
+		StaticBehaviorTree<BT_Static::AgentRootBehavior> staticTree{ &staticWorld.blackboard };
+		size_t flatMismatchCount{};
+		size_t staticMismatchCount{};
+		for (size_t i{}; i < tickCount; ++i)
+		{
+			pointerWorld.Step(dt);
+			const BehaviorState pointerState = pRootBehavior->Execute(&pointerWorld.blackboard);
+			flatWorld.Step(dt);
+			const BehaviorState flatState = flatTree.Execute(&flatWorld.blackboard);
+			staticWorld.Step(dt);
+			const BehaviorState staticState = staticTree.Execute(&staticWorld.blackboard);
+
+			if (!IsSameTick(pointerState, pointerWorld.blackboard, flatState, flatWorld.blackboard))
+			{
+				++flatMismatchCount;
+			}
+			if (!IsSameTick(pointerState, pointerWorld.blackboard, staticState, staticWorld.blackboard))
+			{
+				++staticMismatchCount;
+			}
+		}
+
+		const double pointerTick = MeasureTreeTick(tickCount, dt, [&](Blackboard* pBlackboard) { return pRootBehavior->Execute(pBlackboard); });
+		const double flatTick = MeasureTreeTick(tickCount, dt, [&](Blackboard* pBlackboard) { return flatTree.Execute(pBlackboard); });
+		const double staticTick = MeasureTreeTick(tickCount, dt, [&](Blackboard* pBlackboard) { return staticTree.Execute(pBlackboard); });
+
+		PrintResult("Behavior tree tick (pointer vs flat)", pointerTick, flatTick);
+		PrintResult("Behavior tree tick (pointer vs static)", pointerTick, staticTick);
+		printf("%-40s %10.0f ticks/s %10.0f ticks/s %10.0f ticks/s\n", "Behavior tree throughput", 1e9 / pointerTick, 1e9 / flatTick, 1e9 / staticTick);
+		printf("%-40s %10zu nodes %10zu mismatches in %zu ticks\n", "Flat behavior tree", flatTree.GetNodes().size(), flatMismatchCount, tickCount);
+		printf("%-40s %10zu bytes %10zu mismatches in %zu ticks\n", "Static behavior tree", sizeof(BT_Static::AgentRootBehavior), staticMismatchCount, tickCount);
+
+		SAFE_DELETE(pRootBehavior);
+	}
+
+	void BehaviorTreeResume()
+	{
+		constexpr size_t tickCount = 100000;
+		constexpr float dt = 1.f / 60.f;
+
+		// Same tree twice, one walks from the root every tick and the other resumes like BehaviorTree does
+		IBehavior* pWalkRootBehavior = Plugin::CreateRootBehavior();
+		IBehavior* pResumeRootBehavior = Plugin::CreateRootBehavior();
+		BehaviorState resumeState = BehaviorState::Failure;
+		const auto resumeTree = [&](Blackboard* pBlackboard)
+		{
+			resumeState = resumeState == BehaviorState::Running ? pResumeRootBehavior->Resume(pBlackboard) : pResumeRootBehavior->Execute(pBlackboard);
+			return resumeState;
+		};
+
+		// Resuming skips the branches in front of the running one, so decisions can differ for a tick
+		AgentWorld walkWorld{};
+		AgentWorld resumeWorld{};
+		size_t resumedCount{};
+		size_t mismatchCount{};
+		for (size_t i{}; i < tickCount; ++i)
+		{
+			walkWorld.Step(dt);
+			pWalkRootBehavior->Execute(&walkWorld.blackboard);
+			resumeWorld.Step(dt);
+			resumedCount += resumeState == BehaviorState::Running ? 1 : 0;
+			resumeTree(&resumeWorld.blackboard);
+
+			const SteeringPlugin_Output& walkSteering = walkWorld.blackboard.ViewData(BB_Keys::Steering);
+			const SteeringPlugin_Output& resumeSteering = resumeWorld.blackboard.ViewData(BB_Keys::Steering);
+			if (walkSteering.LinearVelocity != resumeSteering.LinearVelocity || walkSteering.AngularVelocity != resumeSteering.AngularVelocity)
+			{
+				++mismatchCount;
+			}
+		}
+
+		pResumeRootBehavior->Abort();
+		resumeState = BehaviorState::Failure;
+		const double walkTick = MeasureTreeTick(tickCount, dt, [&](Blackboard* pBlackboard) { return pWalkRootBehavior->Execute(pBlackboard); });
+		const double resumeTick = MeasureTreeTick(tickCount, dt, resumeTree);
+
+		PrintResult("Behavior tree tick (walk vs resume)", walkTick, resumeTick);
+		printf("%-40s %10zu resumed %10zu steering mismatches in %zu ticks\n", "Resuming behavior tree", resumedCount, mismatchCount, tickCount);
+
+		SAFE_DELETE(pWalkRootBehavior);
+		SAFE_DELETE(pResumeRootBehavior);
+	}
+
+	void BehaviorTreeConditionMemo()
+	{
+		constexpr size_t tickCount = 100000;
+		constexpr float dt = 1.f / 60.f;
+
+		// Same tree twice, the second one answers BT_PureConditions from its memo like BehaviorTree does.
+		// Both get a context, so their tick rate nodes run on the same frames
+		IBehavior* pPlainRootBehavior = Plugin::CreateRootBehavior();
+		IBehavior* pMemoRootBehavior = Plugin::CreateRootBehavior();
+		BehaviorTreeContext plainContext{};
+		BehaviorTreeContext context{};
+		ConditionMemo& conditionMemo = context.conditionMemo;
+		conditionMemo.SetPureConditions(BT_PureConditions::PerTick());
+		pPlainRootBehavior->BindContext(&plainContext);
+		pMemoRootBehavior->BindContext(&context);
+		const auto plainTree = [&](Blackboard* pBlackboard)
+		{
+			plainContext.scheduler.Advance(dt);
+			return pPlainRootBehavior->Execute(pBlackboard);
+		};
+		const auto memoTree = [&](Blackboard* pBlackboard)
+		{
+			conditionMemo.NextTick();
+			context.scheduler.Advance(dt);
+			return pMemoRootBehavior->Execute(pBlackboard);
+		};
+
+		AgentWorld plainWorld{};
+		AgentWorld memoWorld{};
+		size_t mismatchCount{};
+		for (size_t i{}; i < tickCount; ++i)
+		{
+			plainWorld.Step(dt);
+			plainTree(&plainWorld.blackboard);
+			memoWorld.Step(dt);
+			memoTree(&memoWorld.blackboard);
+
+			const SteeringPlugin_Output& plainSteering = plainWorld.blackboard.ViewData(BB_Keys::Steering);
+			const SteeringPlugin_Output& memoSteering = memoWorld.blackboard.ViewData(BB_Keys::Steering);
+			if (plainSteering.LinearVelocity != memoSteering.LinearVelocity || plainSteering.AngularVelocity != memoSteering.AngularVelocity)
+			{
+				++mismatchCount;
+			}
+		}
+		const size_t evaluationCount = conditionMemo.GetEvaluationCount();
+		const size_t savedCount = conditionMemo.GetSavedCount();
+
+		const double plainTick = MeasureTreeTick(tickCount, dt, plainTree);
+		const double memoTick = MeasureTreeTick(tickCount, dt, memoTree);
+
+		PrintResult("Behavior tree tick (pure condition memo)", plainTick, memoTick);
+		printf("%-40s %10zu evaluated %10zu saved %10zu steering mismatches in %zu ticks\n", "Pure conditions", evaluationCount, savedCount, mismatchCount, tickCount);
+
+		SAFE_DELETE(pPlainRootBehavior);
+		SAFE_DELETE(pMemoRootBehavior);
+	}
+
+	void BehaviorTreeTickRate()
+	{
+		constexpr size_t tickCount = 100000;
+		constexpr float dt = 1.f / 60.f;
+
+		// Same tree twice, only the second one has a scheduler, so its bookkeeping runs at CONFIG_BOOKKEEPING_TICK_RATE
+		IBehavior* pFrameRateRootBehavior = Plugin::CreateRootBehavior();
+		IBehavior* pScheduledRootBehavior = Plugin::CreateRootBehavior();
+		BehaviorTreeContext context{};
+		pScheduledRootBehavior->BindContext(&context);
+		const auto scheduledTree = [&](Blackboard* pBlackboard)
+		{
+			context.scheduler.Advance(dt);
+			return pScheduledRootBehavior->Execute(pBlackboard);
+		};
+
+		// Skipped bookkeeping falls through to the steering branches, the agents only drift apart by the frames a bookkeeping change is late
+		AgentWorld frameRateWorld{};
+		AgentWorld scheduledWorld{};
+		float maxDistance{};
+		for (size_t i{}; i < tickCount; ++i)
+		{
+			frameRateWorld.Step(dt);
+			pFrameRateRootBehavior->Execute(&frameRateWorld.blackboard);
+			scheduledWorld.Step(dt);
+			scheduledTree(&scheduledWorld.blackboard);
+
+			maxDistance = std::max(maxDistance, Elite::Distance(frameRateWorld.agentInfo.Position, scheduledWorld.agentInfo.Position));
+		}
+
+		size_t tickRateCount{};
+		size_t skippedCount{};
+		CountTickRateNodes(pScheduledRootBehavior, tickRateCount, skippedCount);
+
+		const double frameRateTick = MeasureTreeTick(tickCount, dt, [&](Blackboard* pBlackboard) { return pFrameRateRootBehavior->Execute(pBlackboard); });
+		const double scheduledTick = MeasureTreeTick(tickCount, dt, scheduledTree);
+
+		PrintResult("Behavior tree tick (bookkeeping rate)", frameRateTick, scheduledTick);
+		printf("%-40s %10zu ticked %10zu skipped %10.2f max agent distance in %zu ticks\n", "Tick rate nodes", tickRateCount, skippedCount, maxDistance, tickCount);
+
+		SAFE_DELETE(pFrameRateRootBehavior);
+		SAFE_DELETE(pScheduledRootBehavior);
+	}
+
+	void BehaviorTreeDecorators()
+	{
+		constexpr size_t tickCount = 100000;
+		constexpr float dt = 1.f / 60.f;
+		constexpr size_t knownHouseCount = 4096;
+
+		// The house in view is the last known one and was swept recently, so every run scans all known houses and fails
+		std::vector<KnownHouse> knownHouses{};
+		for (size_t i{}; i < knownHouseCount; ++i)
+		{
+			knownHouses.push_back(KnownHouse{ { -1000.f - i, 0.f }, false });
+		}
+		Blackboard blackboard{ BB_Keys::CreateLayout() };
+		FillBlackboard(blackboard, nullptr, nullptr, nullptr);
+		blackboard.ChangeData(BB_Keys::HousesInFOV, CowVector<HouseInfo>{ std::vector<HouseInfo>{ HouseInfo{ knownHouses.back().housePosition, { 20.f, 20.f } } } });
+		blackboard.ChangeData(BB_Keys::KnownHouses, CowVector<KnownHouse>{ knownHouses });
+
+		// SetHouseAsActive every frame, behind a rate limit and behind a cooldown
+		size_t runCounts[3]{};
+		const auto createScan = [&runCounts](size_t variant) -> IBehavior*
+		{
+			IBehavior* pScan = new BehaviorAction([&runCounts, variant](Blackboard* pBlackboard)
+			{
+				++runCounts[variant];
+				return BT_Actions::SetHouseAsActive(pBlackboard);
+			}, BT_ActionKeys::SetHouseAsActive());
+			if (variant == 1)
+				return new BehaviorRateLimit(5.f, pScan);
+			if (variant == 2)
+				return new BehaviorCooldown(0.2f, pScan);
+			return pScan;
+		};
+
+		double tickTimes[3]{};
+		for (size_t variant{}; variant < 3; ++variant)
+		{
+			IBehavior* pScan = createScan(variant);
+			BehaviorTreeContext context{};
+			pScan->BindContext(&context);
+			tickTimes[variant] = Measure(tickCount, [&]()
+			{
+				context.scheduler.Advance(dt);
+				pScan->Execute(&blackboard);
+			});
+			SAFE_DELETE(pScan);
+		}
+
+		PrintResult("House scan (every frame vs rate limit)", tickTimes[0], tickTimes[1]);
+		PrintResult("House scan (every frame vs cooldown)", tickTimes[0], tickTimes[2]);
+		printf("%-40s %10zu runs %10zu runs %10zu runs in %zu ticks\n", "House scans (frame, rate limit, cooldown)", runCounts[0], runCounts[1], runCounts[2], tickCount);
+
+		CheckDecorators();
+	}
+
+	void BehaviorTreeParallel()
+	{
+		constexpr size_t iterations = 2000;
+		constexpr size_t workerCount = 3;
+
+		// Below the cutoff of BehaviorParallel both nodes run their children in turn, the largest set goes to the pool
+		WorkerPool workerPool{ workerCount };
+		for (size_t perceptionCount : { size_t{ 16 }, size_t{ 4096 }, size_t{ 65536 } })
+		{
+			// Large perception sets, none of them close enough to pass, so every evaluation reads everything
+			std::vector<EnemyInfo> enemies(perceptionCount);
+			std::vector<EntityInfo> items(perceptionCount);
+			std::vector<HouseInfo> houses{};
+			std::vector<KnownHouse> knownHouses{};
+			for (size_t i{}; i < perceptionCount; ++i)
+			{
+				enemies[i].Location = { 1000.f + i, 0.f };
+				items[i] = EntityInfo{ eEntityType::ITEM, { 0.f, 1000.f + i } };
+				knownHouses.push_back(KnownHouse{ { -1000.f - i, 0.f }, false });
+			}
+			for (size_t i{}; i < 2; ++i)
+			{
+				houses.push_back(HouseInfo{ knownHouses[perceptionCount - 1 - i].housePosition, { 20.f, 20.f } });
+			}
+
+			Blackboard blackboard{ BB_Keys::CreateLayout() };
+			FillBlackboard(blackboard, nullptr, &enemies, &items);
+			AgentInfo agentInfo{};
+			agentInfo.FOV_Range = 20.f;
+			agentInfo.GrabRange = 2.f;
+			blackboard.ChangeData(BB_Keys::PlayerInfo, agentInfo);
+			blackboard.ChangeData(BB_Keys::HousesInFOV, CowVector<HouseInfo>{ houses });
+			blackboard.ChangeData(BB_Keys::KnownHouses, CowVector<KnownHouse>{ knownHouses });
+
+			// Same node twice, only the second one is bound to the pool
+			const auto createParallel = []()
+			{
+				return new BehaviorParallel({
+					new BehaviorViewConditional(BT_Evaluations::IsUnderThreat, BT_EvaluationKeys::IsUnderThreat()),
+					new BehaviorViewConditional(BT_Evaluations::SeesItemInGrabRange, BT_EvaluationKeys::SeesItemInGrabRange()),
+					new BehaviorViewConditional(BT_Evaluations::SeesHouseToSweep, BT_EvaluationKeys::SeesHouseToSweep())
+				}, ParallelPolicy::RequireOne, ParallelPolicy::RequireAll);
+			};
+			IBehavior* pSerialBehavior = createParallel();
+			IBehavior* pPooledBehavior = createParallel();
+			BehaviorTreeContext context{};
+			context.pWorkerPool = &workerPool;
+			pPooledBehavior->BindContext(&context);
+
+			size_t mismatchCount{};
+			const double serialTick = Measure(iterations, [&]() { mismatchCount += pSerialBehavior->Execute(&blackboard) == BehaviorState::Failure ? 0 : 1; });
+			const double pooledTick = Measure(iterations, [&]() { mismatchCount += pPooledBehavior->Execute(&blackboard) == BehaviorState::Failure ? 0 : 1; });
+
+			char name[64]{};
+			snprintf(name, sizeof(name), "Parallel evaluations (%zu entities)", perceptionCount);
+			PrintResult(name, serialTick, pooledTick);
+			if (mismatchCount > 0)
+				printf("WARNING: %zu parallel evaluations passed, none should \n", mismatchCount);
+
+			SAFE_DELETE(pSerialBehavior);
+			SAFE_DELETE(pPooledBehavior);
+		}
+
+		// A throwing task reaches the caller once the other tasks are joined, whichever thread ran it
+		constexpr size_t taskCount = 64;
+		size_t rethrownCount{};
+		for (size_t throwingTask{}; throwingTask < taskCount; ++throwingTask)
+		{
+			try
+			{
+				workerPool.ParallelFor(taskCount, [throwingTask](size_t task)
+				{
+					if (task == throwingTask)
+						throw std::runtime_error("task failed");
+				}, 4);
+			}
+			catch (const std::runtime_error&)
+			{
+				++rethrownCount;
+			}
+		}
+		printf("%-40s %10zu thrown %10zu rethrown\n", "Parallel task exceptions", taskCount, rethrownCount);
+		if (rethrownCount != taskCount)
+			printf("WARNING: %zu task exceptions did not reach the caller \n", taskCount - rethrownCount);
+	}
+
+	void BehaviorTreeBatch()
+	{
+		constexpr size_t agentTickCount = 65536;
+		constexpr float dt = 1.f / 60.f;
+
+		IBehavior* pRootBehavior = Plugin::CreateRootBehavior(0.f);
+		for (uint32_t agentCount : { 1u, 64u, 1024u })
+		{
+			const size_t tickCount = agentTickCount / agentCount;
+
+			// Every agent twice, once with a flat tree of its own and once in the batch. The worlds start
+			// at different ticks so the agents spread over the branches, every decision has to match
+			double soloTick = std::numeric_limits<double>::max();
+			double batchTick = std::numeric_limits<double>::max();
+			size_t mismatchCount{};
+			for (int round{}; round < BENCHMARK_TREE_ROUNDS; ++round)
+			{
+				std::vector<std::unique_ptr<AgentWorld>> soloWorlds{};
+				std::vector<std::unique_ptr<AgentWorld>> batchWorlds{};
+				std::vector<std::unique_ptr<FlatBehaviorTree>> soloTrees{};
+				std::vector<BehaviorState> soloStates(agentCount, BehaviorState::Failure);
+				BatchBehaviorTree batchTree{ pRootBehavior };
+				for (uint32_t agentIndex{}; agentIndex < agentCount; ++agentIndex)
+				{
+					soloWorlds.push_back(std::make_unique<AgentWorld>());
+					batchWorlds.push_back(std::make_unique<AgentWorld>());
+					soloWorlds.back()->tick = batchWorlds.back()->tick = agentIndex * 53;
+					soloTrees.push_back(std::make_unique<FlatBehaviorTree>(&soloWorlds.back()->blackboard, pRootBehavior));
+					batchTree.AddAgent(&batchWorlds.back()->blackboard);
+				}
+
+				double soloTime{};
+				double batchTime{};
+				for (size_t i{}; i < tickCount; ++i)
+				{
+					for (uint32_t agentIndex{}; agentIndex < agentCount; ++agentIndex)
+					{
+						soloWorlds[agentIndex]->Step(dt);
+						batchWorlds[agentIndex]->Step(dt);
+					}
+
+					const auto soloStart = BenchmarkClock::now();
+					for (uint32_t agentIndex{}; agentIndex < agentCount; ++agentIndex)
+					{
+						soloWorlds[agentIndex]->blackboard.DispatchNotifications();
+						soloStates[agentIndex] = soloTrees[agentIndex]->Execute(&soloWorlds[agentIndex]->blackboard);
+					}
+					const auto batchStart = BenchmarkClock::now();
+					batchTree.Update(dt);
+					const auto batchEnd = BenchmarkClock::now();
+					soloTime += std::chrono::duration<double, std::nano>(batchStart - soloStart).count();
+					batchTime += std::chrono::duration<double, std::nano>(batchEnd - batchStart).count();
+
+					for (uint32_t agentIndex{}; agentIndex < agentCount; ++agentIndex)
+					{
+						if (!IsSameTick(soloStates[agentIndex], soloWorlds[agentIndex]->blackboard, batchTree.GetResult(agentIndex), batchWorlds[agentIndex]->blackboard))
+							++mismatchCount;
+					}
+				}
+				soloTick = std::min(soloTick, soloTime / (tickCount * agentCount));
+				batchTick = std::min(batchTick, batchTime / (tickCount * agentCount));
+			}
+
+			// Per agent and tick
+			char name[64]{};
+			snprintf(name, sizeof(name), "Batch tree agent tick (%u agents)", agentCount);
+			PrintResult(name, soloTick, batchTick);
+			printf("%-40s %10.0f agents/s %10.0f agents/s %10zu mismatches\n", "", 1e9 / soloTick, 1e9 / batchTick, mismatchCount);
+		}
+
+		SAFE_DELETE(pRootBehavior);
+	}
+
+	void BehaviorTreeLoading()
+	{
+		constexpr size_t loadCount = 1000;
+		constexpr size_t tickCount = 100000;
+		constexpr float dt = 1.f / 60.f;
+		const char* pCompiledPath = "Benchmark.bt";
+
+		std::ifstream jsonFile{ CONFIG_BEHAVIOR_TREE_JSON, std::ios::binary };
+		if (!jsonFile)
+		{
+			printf("WARNING: %s is not next to the executable, skipped the loading benchmark \n", CONFIG_BEHAVIOR_TREE_JSON);
+			return;
+		}
+		const std::string json{ std::istreambuf_iterator<char>{ jsonFile }, std::istreambuf_iterator<char>{} };
+
+		const BehaviorRegistry registry = BT_Registry::Create();
+		const BehaviorTreeLoader loader{ registry };
+		std::vector<char> compiled{};
+		if (!loader.Compile(json, compiled) || !loader.CompileFile(CONFIG_BEHAVIOR_TREE_JSON, pCompiledPath))
+			return;
+
+		// Every build includes freeing the tree again
+		const double codeBuild = Measure(loadCount, []() { delete Plugin::CreateRootBehavior(); });
+		const double jsonBuild = Measure(loadCount, [&]() { delete loader.LoadJson(json); });
+		const double compiledBuild = Measure(loadCount, [&]() { delete loader.Instantiate(compiled.data(), compiled.size()); });
+		const double fileBuild = Measure(loadCount, [&]() { delete loader.LoadFile(pCompiledPath); });
+
+		// The loaded tree has to be the tree in code, node for node and decision for decision
+		IBehavior* pCodeRootBehavior = Plugin::CreateRootBehavior();
+		IBehavior* pLoadedRootBehavior = loader.LoadFile(pCompiledPath);
+		remove(pCompiledPath);
+		if (pLoadedRootBehavior == nullptr)
+		{
+			SAFE_DELETE(pCodeRootBehavior);
+			return;
+		}
+
+		const size_t shapeMismatchCount = CountShapeMismatches(pCodeRootBehavior, pLoadedRootBehavior);
+		AgentWorld codeWorld{};
+		AgentWorld loadedWorld{};
+		size_t mismatchCount{};
+		for (size_t i{}; i < tickCount; ++i)
+		{
+			codeWorld.Step(dt);
+			const BehaviorState codeState = pCodeRootBehavior->Execute(&codeWorld.blackboard);
+			loadedWorld.Step(dt);
+			const BehaviorState loadedState = pLoadedRootBehavior->Execute(&loadedWorld.blackboard);
+
+			const SteeringPlugin_Output& codeSteering = codeWorld.blackboard.ViewData(BB_Keys::Steering);
+			const SteeringPlugin_Output& loadedSteering = loadedWorld.blackboard.ViewData(BB_Keys::Steering);
+			if (codeState != loadedState || codeSteering.LinearVelocity != loadedSteering.LinearVelocity || codeSteering.AngularVelocity != loadedSteering.AngularVelocity)
+			{
+				++mismatchCount;
+			}
+		}
+
+		const BehaviorTreeFileHeader& header = *reinterpret_cast<const BehaviorTreeFileHeader*>(compiled.data());
+		PrintResult("Behavior tree build (JSON vs compiled)", jsonBuild, compiledBuild);
+		PrintResult("Behavior tree build (code vs mapped file)", codeBuild, fileBuild);
+		printf("%-40s %10zu bytes %10u nodes %zu shape and %zu decision mismatches in %zu ticks\n", "Compiled behavior tree", compiled.size(), header.nodeCount, shapeMismatchCount, mismatchCount, tickCount);
+
+		SAFE_DELETE(pCodeRootBehavior);
+		SAFE_DELETE(pLoadedRootBehavior);
+	}
+
+	void BehaviorTreeReordering()
+	{
+		constexpr size_t tickCount = 20000;
+		constexpr float dt = 1.f / 60.f;
+
+		std::ifstream jsonFile{ CONFIG_BEHAVIOR_TREE_JSON, std::ios::binary };
+		if (!jsonFile)
+		{
+			printf("WARNING: %s is not next to the executable, skipped the reordering benchmark \n", CONFIG_BEHAVIOR_TREE_JSON);
+			return;
+		}
+		const std::string json{ std::istreambuf_iterator<char>{ jsonFile }, std::istreambuf_iterator<char>{} };
+
+		const BehaviorRegistry registry = BT_Registry::Create();
+		const BehaviorTreeLoader loader{ registry };
+		std::vector<char> compiled{};
+		if (!loader.Compile(json, compiled))
+			return;
+
+		// Most ticks an item is in view, of a random type and mostly out of grab range
+		const auto stepWorld = [dt](AgentWorld& world, std::mt19937& rng)
+		{
+			world.Step(dt);
+			world.agentInfo.GrabRange = 2.f;
+			world.items.clear();
+			if (rng() % 4 != 0)
+			{
+				const float distance = rng() % 8 == 0 ? 1.f : 10.f;
+				world.items.push_back(EntityInfo{ eEntityType::ITEM, world.agentInfo.Position + Elite::Vector2{ distance, 0.f }, static_cast<int>(rng() % 5) });
+			}
+		};
+
+		// The profile comes from the trace of the tree as it was compiled, so it only has counts
+		std::vector<BehaviorReorder> reorders{};
+		std::vector<char> optimized{ compiled };
+		{
+			IBehavior* pProfiledRootBehavior = loader.Instantiate(compiled.data(), compiled.size());
+			BehaviorTrace trace{ size_t{ 1 } << 20 };
+			trace.Register(pProfiledRootBehavior);
+			AgentWorld world{};
+			std::mt19937 rng{ 1 };
+			for (size_t i{}; i < tickCount; ++i)
+			{
+				stepWorld(world, rng);
+				trace.BeginFrame(i * dt);
+				pProfiledRootBehavior->ExecuteProfiled(&world.blackboard);
+			}
+			const BehaviorTreeProfile profile = trace.CreateProfile();
+			SAFE_DELETE(pProfiledRootBehavior);
+
+			if (!BehaviorTreeOptimizer{ profile }.Optimize(optimized, true, reorders))
+				return;
+		}
+		BehaviorTreeOptimizer::PrintReorders(reorders);
+
+		// Both trees on other items than the profile saw, every decision has to match
+		IBehavior* pRootBehavior = loader.Instantiate(compiled.data(), compiled.size());
+		IBehavior* pReorderedRootBehavior = loader.Instantiate(optimized.data(), optimized.size());
+		BehaviorTrace trace{ size_t{ 1 } << 20 };
+		BehaviorTrace reorderedTrace{ size_t{ 1 } << 20 };
+		trace.Register(pRootBehavior);
+		reorderedTrace.Register(pReorderedRootBehavior);
+		AgentWorld world{};
+		AgentWorld reorderedWorld{};
+		std::mt19937 rng{ 2 };
+		std::mt19937 reorderedRng{ 2 };
+		size_t mismatchCount{};
+		for (size_t i{}; i < tickCount; ++i)
+		{
+			stepWorld(world, rng);
+			trace.BeginFrame(i * dt);
+			const BehaviorState state = pRootBehavior->ExecuteProfiled(&world.blackboard);
+			stepWorld(reorderedWorld, reorderedRng);
+			reorderedTrace.BeginFrame(i * dt);
+			const BehaviorState reorderedState = pReorderedRootBehavior->ExecuteProfiled(&reorderedWorld.blackboard);
+			if (!IsSameTick(state, world.blackboard, reorderedState, reorderedWorld.blackboard))
+				++mismatchCount;
+		}
+
+		// Only conditions moved, so the nodes that did not run are the evaluations saved
+		double expectedSaving{};
+		for (const BehaviorReorder& reorder : reorders)
+		{
+			expectedSaving += reorder.evaluationsBefore - reorder.evaluationsAfter;
+		}
+		const double measuredSaving = (double(trace.GetRecordCount()) - double(reorderedTrace.GetRecordCount())) / tickCount;
+
+		const auto measureTick = [&](IBehavior* pBehavior)
+		{
+			double bestTick = std::numeric_limits<double>::max();
+			for (int round{}; round < BENCHMARK_TREE_ROUNDS; ++round)
+			{
+				AgentWorld timingWorld{};
+				std::mt19937 timingRng{ 2 };
+				double totalTime{};
+				for (size_t i{}; i < tickCount; ++i)
+				{
+					stepWorld(timingWorld, timingRng);
+					const auto start = BenchmarkClock::now();
+					pBehavior->Execute(&timingWorld.blackboard);
+					totalTime += std::chrono::duration<double, std::nano>(BenchmarkClock::now() - start).count();
+				}
+				bestTick = std::min(bestTick, totalTime / tickCount);
+			}
+			return bestTick;
+		};
+		const double tick = measureTick(pRootBehavior);
+		const double reorderedTick = measureTick(pReorderedRootBehavior);
+
+		PrintResult("Behavior tree tick (compiled vs reordered)", tick, reorderedTick);
+		printf("%-40s %10.3f expected %10.3f measured %10zu mismatches in %zu ticks\n", "Evaluations saved per tick", expectedSaving, measuredSaving, mismatchCount, tickCount);
+
+		SAFE_DELETE(pRootBehavior);
+		SAFE_DELETE(pReorderedRootBehavior);
+	}
+
+	void BehaviorTreeTrace()
+	{
+		constexpr size_t tickCount = 100000;
+		constexpr float dt = 1.f / 60.f;
+		const char* pDrainPath = "BenchmarkTrace.csv";
+
+		// Same tree twice, the second one records every node it runs like BehaviorTree does
+		IBehavior* pPlainRootBehavior = Plugin::CreateRootBehavior();
+		IBehavior* pTracedRootBehavior = Plugin::CreateRootBehavior();
+		BehaviorTrace trace{};
+		trace.Register(pTracedRootBehavior);
+		float time{};
+		const auto plainTree = [&](Blackboard* pBlackboard) { return pPlainRootBehavior->ExecuteProfiled(pBlackboard); };
+		const auto tracedTree = [&](Blackboard* pBlackboard)
+		{
+			time += dt;
+			trace.BeginFrame(time);
+			return pTracedRootBehavior->ExecuteProfiled(pBlackboard);
+		};
+
+		const double plainTick = MeasureTreeTick(tickCount, dt, plainTree);
+		const double tracedTick = MeasureTreeTick(tickCount, dt, tracedTree);
+		const double recordsPerTick = double(trace.GetRecordCount()) / (tickCount * BENCHMARK_TREE_ROUNDS);
+		const double recordTime = Measure(BENCHMARK_ITERATIONS, [&trace]() { trace.Record(0, BehaviorState::Success); });
+
+		AgentWorld plainWorld{};
+		AgentWorld world{};
+		const double plainAllocations = CountAllocationsPerFrame(tickCount, [&]()
+		{
+			plainWorld.Step(dt);
+			plainTree(&plainWorld.blackboard);
+		});
+		const double tracedAllocations = CountAllocationsPerFrame(tickCount, [&]()
+		{
+			world.Step(dt);
+			tracedTree(&world.blackboard);
+		});
+
+		// The drain thread writes while the tree keeps ticking, a burst that fits the ring loses nothing
+		// however late the thread gets to run. A real game ticks far slower than this loop
+		const size_t drainTickCount = static_cast<size_t>(0.9 * trace.GetCapacity() / recordsPerTick);
+		uint64_t lostCount{};
+		double drainTime{};
+		if (trace.StartDrain(pDrainPath))
+		{
+			const uint64_t lostBefore = trace.GetLostCount();
+			for (size_t i{}; i < drainTickCount; ++i)
+			{
+				world.Step(dt);
+				tracedTree(&world.blackboard);
+			}
+			const auto start = BenchmarkClock::now();
+			trace.StopDrain();
+			drainTime = std::chrono::duration<double, std::nano>(BenchmarkClock::now() - start).count();
+			lostCount = trace.GetLostCount() - lostBefore;
+			remove(pDrainPath);
+		}
+
+		PrintResult("Behavior tree tick (plain vs traced)", plainTick, tracedTick);
+		printf("%-40s %10.2f ns/record %10.2f records/tick\n", "Behavior trace", recordTime, recordsPerTick);
+		printf("%-40s %10.2f allocations %10.2f allocations\n", "Behavior tree tick (plain vs traced)", plainAllocations, tracedAllocations);
+		printf("%-40s %10zu records %10llu lost %10.2f ms to finish after %zu ticks\n", "Behavior trace drain", trace.GetCapacity(), static_cast<unsigned long long>(lostCount), drainTime / 1e6, drainTickCount);
+
+		SAFE_DELETE(pPlainRootBehavior);
+		SAFE_DELETE(pTracedRootBehavior);
+	}
+	void DecisionMakingUtility()
+	{
+		constexpr size_t maxTickCount = 100000;
+		constexpr float dt = 1.f / 60.f;
+		constexpr unsigned int seeds[] = { 1, 2, 3, 4, 5 };
+
+		// Both deciders play the same seeds, decisions are timed while they play
+		SurvivalScore treeScore{};
+		SurvivalScore utilityScore{};
+		for (unsigned int seed : seeds)
+		{
+			PlayTreeSurvival(seed, maxTickCount, dt, treeScore);
+
+			SurvivalWorld world{ seed };
+			UtilityAI* pUtilityAI = Plugin::CreateUtilityAI(&world.world.blackboard);
+			PlaySurvival(world, maxTickCount, dt, utilityScore, [&]() { pUtilityAI->Update(dt); });
+			SAFE_DELETE(pUtilityAI);
+		}
+
+		// Scoring alone, the inputs read the blackboard of a fresh agent
+		AgentWorld world{};
+		UtilityAI* pUtilityAI = Plugin::CreateUtilityAI(&world.blackboard);
+		world.Step(dt);
+		const double scoreTime = Measure(BENCHMARK_ITERATIONS, [pUtilityAI]() { pUtilityAI->Decide(); });
+
+		PrintResult("Decision tick (tree vs utility)", treeScore.decisionTime / treeScore.tickCount, utilityScore.decisionTime / utilityScore.tickCount);
+		printf("%-40s %10.2f ns/tick %10zu actions\n", "Utility scoring", scoreTime, pUtilityAI->GetActionCount());
+		PrintSurvival("Survival time (tree vs utility)", treeScore, utilityScore, std::extent<decltype(seeds)>::value, dt);
+
+		SAFE_DELETE(pUtilityAI);
+	}
+
+	void DecisionMakingStateMachine()
+	{
+		constexpr size_t maxTickCount = 100000;
+		constexpr float dt = 1.f / 60.f;
+		constexpr unsigned int seeds[] = { 1, 2, 3, 4, 5 };
+
+		SurvivalScore treeScore{};
+		SurvivalScore machineScore{};
+		size_t evaluationCount{};
+		size_t transitionCount{};
+		size_t conditionCount{};
+		for (unsigned int seed : seeds)
+		{
+			PlayTreeSurvival(seed, maxTickCount, dt, treeScore);
+
+			SurvivalWorld world{ seed };
+			FiniteStateMachine* pStateMachine = Plugin::CreateStateMachine(&world.world.blackboard);
+			PlaySurvival(world, maxTickCount, dt, machineScore, [&]() { pStateMachine->Update(dt); });
+			evaluationCount += pStateMachine->GetEvaluationCount();
+			transitionCount += pStateMachine->GetTransitionCount();
+			conditionCount = pStateMachine->GetConditionCount();
+			SAFE_DELETE(pStateMachine);
+		}
+
+		PrintResult("Decision tick (tree vs state machine)", treeScore.decisionTime / treeScore.tickCount, machineScore.decisionTime / machineScore.tickCount);
+		printf("%-40s %10.2f checked %10zu conditions %10zu transitions\n", "State machine conditions per tick", double(evaluationCount) / machineScore.tickCount, conditionCount, transitionCount);
+		PrintSurvival("Survival time (tree vs state machine)", treeScore, machineScore, std::extent<decltype(seeds)>::value, dt);
+	}
+
+	void DecisionMakingGoap()
+	{
+		constexpr size_t maxTickCount = 100000;
+		constexpr float dt = 1.f / 60.f;
+		constexpr unsigned int seeds[] = { 1, 2, 3, 4, 5 };
+
+		SurvivalScore treeScore{};
+		SurvivalScore plannerScore{};
+		double maxPlanningTime{};
+		double totalPlanningTime{};
+		size_t cacheHitCount{};
+		size_t searchCount{};
+		size_t overBudgetCount{};
+		for (unsigned int seed : seeds)
+		{
+			PlayTreeSurvival(seed, maxTickCount, dt, treeScore);
+
+			SurvivalWorld world{ seed };
+			GoapPlanner* pPlanner = Plugin::CreateGoapPlanner(&world.world.blackboard);
+			PlaySurvival(world, maxTickCount, dt, plannerScore, [&]() { pPlanner->Update(dt); });
+			maxPlanningTime = std::max(maxPlanningTime, pPlanner->GetMaxPlanningTime());
+			totalPlanningTime += pPlanner->GetTotalPlanningTime();
+			cacheHitCount += pPlanner->GetCacheHitCount();
+			searchCount += pPlanner->GetSearchCount();
+			overBudgetCount += pPlanner->GetOverBudgetCount();
+			SAFE_DELETE(pPlanner);
+		}
+
+		PrintResult("Decision tick (tree vs planner)", treeScore.decisionTime / treeScore.tickCount, plannerScore.decisionTime / plannerScore.tickCount);
+		printf("%-40s %10.3f avg us %10.3f max us %10zu over budget\n", "Planning time per tick", totalPlanningTime / plannerScore.tickCount, maxPlanningTime, overBudgetCount);
+		printf("%-40s %10zu hits %10zu searches\n", "Plan cache", cacheHitCount, searchCount);
+		PrintSurvival("Survival time (tree vs planner)", treeScore, plannerScore, std::extent<decltype(seeds)>::value, dt);
+
+		// Every world state and goal, searched cold and then looked up
+		SurvivalWorld world{ seeds[0] };
+		GoapPlanner* pPlanner = Plugin::CreateGoapPlanner(&world.world.blackboard);
+		const GoapState stateCount = GoapState{ 1 } << pPlanner->GetFactCount();
+		const uint32_t goalCount = static_cast<uint32_t>(pPlanner->GetGoalCount());
+		const GoapPlanner::Clock::time_point noDeadline = GoapPlanner::Clock::time_point::max();
+		volatile size_t planLength{};
+		const double searchTime = Measure(1, [&]() {
+			pPlanner->ClearCache();
+			for (GoapState state{}; state < stateCount; ++state)
+			{
+				for (uint32_t goalIndex{}; goalIndex < goalCount; ++goalIndex)
+				{
+					planLength = planLength + pPlanner->FindPlan(state, goalIndex, noDeadline)->size();
+				}
+			}
+		});
+		const double lookupTime = Measure(1, [&]() {
+			for (GoapState state{}; state < stateCount; ++state)
+			{
+				for (uint32_t goalIndex{}; goalIndex < goalCount; ++goalIndex)
+				{
+					planLength = planLength + pPlanner->FindPlan(state, goalIndex, noDeadline)->size();
+				}
+			}
+		});
+		PrintResult("Plan (A* search vs cache lookup)", searchTime / (stateCount * goalCount), lookupTime / (stateCount * goalCount));
+		printf("%-40s %10zu plans %10.2f actions per plan\n", "Plans of every state and goal", pPlanner->GetCachedPlanCount(), double(planLength) / (2 * stateCount * goalCount));
+
+		SAFE_DELETE(pPlanner);
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+/************************************************************************/
+/* Micro benchmarks, only run when CONFIG_RUN_BENCHMARKS is enabled     */
+/************************************************************************/
+namespace Benchmarks
+{
+	void RunAll();
+
+	void BlackboardLookup();
+	void BlackboardAllocations();
+	void BlackboardStorage();
+	void BlackboardSnapshot();
+	void BlackboardCheckpoint();
+	void BlackboardCopyOnWrite();
+	void BehaviorTreeExecutors();
+	void BehaviorTreeResume();
+	void BehaviorTreeConditionMemo();
+	void BehaviorTreeTickRate();
+	void BehaviorTreeDecorators();
+	void BehaviorTreeParallel();
+	void BehaviorTreeBatch();
+	void BehaviorTreeLoading();
+	void BehaviorTreeReordering();
+	void BehaviorTreeTrace();
+	void DecisionMakingUtility();
+	void DecisionMakingStateMachine();
+	void DecisionMakingGoap();
+}
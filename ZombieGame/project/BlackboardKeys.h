@@ -0,0 +1,122 @@
+#pragma once
+
+#include "EBlackboard.h"
+#include "Plugin.h"
+#include "Structs.h"
+
+/************************************************************************/
+/* Blackboard slots, one per P_ string macro							*/
+/************************************************************************/
+enum BlackboardSlot : uint32_t
+{
+	SLOT_PLAYERINFO,
+	SLOT_WORLDINFO,
+	SLOT_TARGETINFO,
+	SLOT_INTERFACE,
+	SLOT_SHOULDEXPLORE,
+	SLOT_HOUSES_IN_FOV,
+	SLOT_STEERING,
+	SLOT_LAST_POSITION,
+	SLOT_ACTIVE_HOUSE,
+	SLOT_KNOWN_HOUSES,
+	SLOT_KNOWN_HOUSE_SWEEP_TIMERS,
+	SLOT_DESTINATION_REACHED,
+	SLOT_DESTINATION,
+	SLOT_IS_GOING_FOR_HOUSE,
+	SLOT_INVENTORY,
+	SLOT_HOUSE_TO_SWEEP,
+	SLOT_ZOMBIE_TARGET,
+	SLOT_PLAYER_WAS_BITTEN,
+	SLOT_ENEMIES_IN_FOV,
+	SLOT_ITEMS_IN_FOV,
+	SLOT_IS_IN_HOUSE,
+	SLOT_EXPLORE_LOCATIONS_TO_VISIT,
+	SLOT_EXPLORE_LOCATIONS_VISITED,
+
+	// Cached condition results
+	SLOT_CACHE_IS_HOUSE_IN_FOV,
+	SLOT_CACHE_IS_IN_HOUSE,
+	SLOT_CACHE_SHOULD_SWEEP_HOUSE,
+
+	SLOT_COUNT
+};
+
+/************************************************************************/
+/* Typed keys															*/
+/************************************************************************/
+namespace BB_Keys
+{
+	constexpr BlackboardKey<AgentInfo> PlayerInfo{ SLOT_PLAYERINFO, P_PLAYERINFO };
+	constexpr BlackboardKey<::WorldInfo> WorldInfo{ SLOT_WORLDINFO, P_WORLDINFO };
+	constexpr BlackboardKey<Elite::Vector2> TargetInfo{ SLOT_TARGETINFO, P_TARGETINFO };
+	constexpr BlackboardKey<IExamInterface*> Interface{ SLOT_INTERFACE, P_INTERFACE };
+	constexpr BlackboardKey<bool> ShouldExplore{ SLOT_SHOULDEXPLORE, P_SHOULDEXPLORE };
+	constexpr BlackboardKey<CowVector<HouseInfo>> HousesInFOV{ SLOT_HOUSES_IN_FOV, P_HOUSES_IN_FOV };
+	constexpr BlackboardKey<SteeringPlugin_Output> Steering{ SLOT_STEERING, P_STEERING };
+	constexpr BlackboardKey<Elite::Vector2> LastPosition{ SLOT_LAST_POSITION, P_LAST_POSITION };
+	constexpr BlackboardKey<HouseInfo> ActiveHouse{ SLOT_ACTIVE_HOUSE, P_ACTIVE_HOUSE };
+	constexpr BlackboardKey<CowVector<KnownHouse>> KnownHouses{ SLOT_KNOWN_HOUSES, P_KNOWN_HOUSES };
+	constexpr BlackboardKey<std::vector<float>> KnownHouseSweepTimers{ SLOT_KNOWN_HOUSE_SWEEP_TIMERS, P_KNOWN_HOUSE_SWEEP_TIMERS }; //Seconds since swept, in the order of KnownHouses
+	constexpr BlackboardKey<bool> DestinationReached{ SLOT_DESTINATION_REACHED, P_DESTINATION_REACHED };
+	constexpr BlackboardKey<Elite::Vector2> Destination{ SLOT_DESTINATION, P_DESTINATION };
+	constexpr BlackboardKey<bool> IsGoingForHouse{ SLOT_IS_GOING_FOR_HOUSE, P_IS_GOING_FOR_HOUSE };
+	constexpr BlackboardKey<::Inventory> Inventory{ SLOT_INVENTORY, P_INVENTORY };
+	constexpr BlackboardKey<SweepHouse> HouseToSweep{ SLOT_HOUSE_TO_SWEEP, P_HOUSE_TO_SWEEP };
+	constexpr BlackboardKey<Elite::Vector2> ZombieTarget{ SLOT_ZOMBIE_TARGET, P_ZOMBIE_TARGET };
+	constexpr BlackboardKey<bool> PlayerWasBitten{ SLOT_PLAYER_WAS_BITTEN, P_PLAYER_WAS_BITTEN };
+	constexpr BlackboardKey<std::vector<EnemyInfo>*> EnemiesInFOV{ SLOT_ENEMIES_IN_FOV, P_ENEMIES_IN_FOV };
+	constexpr BlackboardKey<std::vector<EntityInfo>*> ItemsInFOV{ SLOT_ITEMS_IN_FOV, P_ITEMS_IN_FOV };
+	constexpr BlackboardKey<bool> IsInHouse{ SLOT_IS_IN_HOUSE, P_IS_IN_HOUSE };
+	constexpr BlackboardKey<CowVector<Elite::Vector2>> ExploreLocationsToVisit{ SLOT_EXPLORE_LOCATIONS_TO_VISIT, P_EXPLORE_LOCATIONS_TO_VISIT };
+	constexpr BlackboardKey<CowVector<Elite::Vector2>> ExploreLocationsVisited{ SLOT_EXPLORE_LOCATIONS_VISITED, P_EXPLORE_LOCATIONS_VISITED };
+
+	// Cached condition results, the size is the number of input keys
+	constexpr BlackboardKey<BlackboardCache<bool, 1>> IsHouseInFOVCache{ SLOT_CACHE_IS_HOUSE_IN_FOV, P_CACHE_IS_HOUSE_IN_FOV };
+	constexpr BlackboardKey<BlackboardCache<bool, 2>> IsInHouseCache{ SLOT_CACHE_IS_IN_HOUSE, P_CACHE_IS_IN_HOUSE };
+	constexpr BlackboardKey<BlackboardCache<bool, 3>> ShouldSweepHouseCache{ SLOT_CACHE_SHOULD_SWEEP_HOUSE, P_CACHE_SHOULD_SWEEP_HOUSE };
+}
+
+/************************************************************************/
+/* Arena layout, hot keys of a tick first								*/
+/************************************************************************/
+namespace BB_Keys
+{
+	inline BlackboardLayout CreateLayout()
+	{
+		BlackboardLayout layout{};
+
+		// Read by nearly every leaf
+		layout.Register(PlayerInfo)
+			.Register(Interface)
+			.Register(ItemsInFOV)
+			.Register(EnemiesInFOV)
+			.Register(Inventory)
+			.Register(TargetInfo)
+			.Register(Steering)
+			.Register(IsInHouse)
+			.Register(PlayerWasBitten)
+			.Register(ZombieTarget);
+
+		// House and exploration state
+		layout.Register(ActiveHouse)
+			.Register(IsGoingForHouse)
+			.Register(ShouldExplore)
+			.Register(Destination)
+			.Register(DestinationReached)
+			.Register(LastPosition)
+			.Register(HouseToSweep)
+			.Register(HousesInFOV)
+			.Register(KnownHouses)
+			.Register(KnownHouseSweepTimers)
+			.Register(ExploreLocationsToVisit)
+			.Register(ExploreLocationsVisited)
+			.Register(WorldInfo);
+
+		// Condition caches
+		layout.Register(IsHouseInFOVCache)
+			.Register(IsInHouseCache)
+			.Register(ShouldSweepHouseCache);
+
+		return layout;
+	}
+}
@@ -0,0 +1,117 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "BlackboardProfiler.h"
+
+void BlackboardProfiler::OnRead(const char* key, size_t bytesCopied, bool isStringLookup)
+{
+	KeyRecord& record = GetRecord(key, isStringLookup);
+	++record.frame.reads;
+	record.frame.bytesCopied += bytesCopied;
+}
+
+void BlackboardProfiler::OnWrite(const char* key, size_t bytesCopied, bool isStringLookup)
+{
+	KeyRecord& record = GetRecord(key, isStringLookup);
+	++record.frame.writes;
+	record.frame.bytesCopied += bytesCopied;
+}
+
+void BlackboardProfiler::OnMiss(const char* key, bool isStringLookup)
+{
+	++GetRecord(key, isStringLookup).frame.misses;
+}
+
+void BlackboardProfiler::EndFrame()
+{
+	for (auto& it : m_Records)
+	{
+		KeyRecord& record = it.second;
+		record.total.reads += record.frame.reads;
+		record.total.writes += record.frame.writes;
+		record.total.bytesCopied += record.frame.bytesCopied;
+		record.total.misses += record.frame.misses;
+		record.total.stringLookups += record.frame.stringLookups;
+
+		record.maxPerFrame.reads = std::max(record.maxPerFrame.reads, record.frame.reads);
+		record.maxPerFrame.writes = std::max(record.maxPerFrame.writes, record.frame.writes);
+		record.maxPerFrame.bytesCopied = std::max(record.maxPerFrame.bytesCopied, record.frame.bytesCopied);
+		record.maxPerFrame.misses = std::max(record.maxPerFrame.misses, record.frame.misses);
+		record.maxPerFrame.stringLookups = std::max(record.maxPerFrame.stringLookups, record.frame.stringLookups);
+
+		record.lastFrame = record.frame;
+		record.frame = BlackboardKeyStats{};
+	}
+	++m_FrameCount;
+}
+
+void BlackboardProfiler::RenderImGui(const char* title) const
+{
+	const float frameCount = static_cast<float>(std::max<uint64_t>(m_FrameCount, 1));
+
+	ImGui::Begin(title);
+	ImGui::Text("Frames: %llu, averages per frame", static_cast<unsigned long long>(m_FrameCount));
+	ImGui::Separator();
+
+	ImGui::Columns(6, "BlackboardProfiler");
+	ImGui::Text("Key"); ImGui::NextColumn();
+	ImGui::Text("Bytes"); ImGui::NextColumn();
+	ImGui::Text("Reads"); ImGui::NextColumn();
+	ImGui::Text("Writes"); ImGui::NextColumn();
+	ImGui::Text("Misses"); ImGui::NextColumn();
+	ImGui::Text("String"); ImGui::NextColumn();
+	ImGui::Separator();
+
+	for (const auto& it : GetSortedRecords())
+	{
+		const BlackboardKeyStats& total = it.second.total;
+		ImGui::Text("%s", it.first.c_str()); ImGui::NextColumn();
+		ImGui::Text("%.1f", total.bytesCopied / frameCount); ImGui::NextColumn();
+		ImGui::Text("%.2f", total.reads / frameCount); ImGui::NextColumn();
+		ImGui::Text("%.2f", total.writes / frameCount); ImGui::NextColumn();
+		ImGui::Text("%.2f", total.misses / frameCount); ImGui::NextColumn();
+		ImGui::Text("%.2f", total.stringLookups / frameCount); ImGui::NextColumn();
+	}
+
+	ImGui::Columns(1);
+	ImGui::End();
+}
+
+bool BlackboardProfiler::WriteCsv(const std::string& path) const
+{
+	std::ofstream file{ path };
+	if (!file)
+	{
+		printf("WARNING: Could not write Blackboard profile to '%s' \n", path.c_str());
+		return false;
+	}
+
+	file << "key,frames,reads,writes,bytesCopied,misses,stringLookups,maxReadsPerFrame,maxWritesPerFrame,maxBytesPerFrame\n";
+	for (const auto& it : GetSortedRecords())
+	{
+		const BlackboardKeyStats& total = it.second.total;
+		const BlackboardKeyStats& maxPerFrame = it.second.maxPerFrame;
+		file << it.first << ',' << m_FrameCount << ','
+			<< total.reads << ',' << total.writes << ',' << total.bytesCopied << ',' << total.misses << ',' << total.stringLookups << ','
+			<< maxPerFrame.reads << ',' << maxPerFrame.writes << ',' << maxPerFrame.bytesCopied << '\n';
+	}
+	return true;
+}
+
+BlackboardProfiler::KeyRecord& BlackboardProfiler::GetRecord(const char* key, bool isStringLookup)
+{
+	KeyRecord& record = m_Records[key];
+	if (isStringLookup)
+		++record.frame.stringLookups;
+	return record;
+}
+
+std::vector<std::pair<std::string, BlackboardProfiler::KeyRecord>> BlackboardProfiler::GetSortedRecords() const
+{
+	std::vector<std::pair<std::string, KeyRecord>> records{ m_Records.begin(), m_Records.end() };
+	std::sort(records.begin(), records.end(), [](const std::pair<std::string, KeyRecord>& lhs, const std::pair<std::string, KeyRecord>& rhs) {
+		if (lhs.second.total.bytesCopied != rhs.second.total.bytesCopied)
+			return lhs.second.total.bytesCopied > rhs.second.total.bytesCopied;
+		return lhs.second.total.reads + lhs.second.total.writes > rhs.second.total.reads + rhs.second.total.writes;
+	});
+	return records;
+}
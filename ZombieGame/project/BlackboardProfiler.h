@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+//Per key access statistics of a Blackboard, shown in an ImGui panel and written to a CSV on shutdown.
+//When disabled the hooks compile to nothing and the Blackboard has no profiler member.
+#define CONFIG_PROFILE_BLACKBOARD 0
+
+#if CONFIG_PROFILE_BLACKBOARD
+#define BLACKBOARD_PROFILE(call) call
+#else
+#define BLACKBOARD_PROFILE(call)
+#endif
+
+//Bytes a copy of the data moves, vectors count their elements as well
+template<typename T> size_t GetBlackboardDataSize(const T&)
+{
+	return sizeof(T);
+}
+template<typename T> size_t GetBlackboardDataSize(const std::vector<T>& data)
+{
+	return sizeof(std::vector<T>) + data.size() * sizeof(T);
+}
+
+struct BlackboardKeyStats
+{
+	uint64_t reads{};
+	uint64_t writes{};
+	uint64_t bytesCopied{};
+	uint64_t misses{};
+	uint64_t stringLookups{}; //Accesses through the string API, candidates for typed keys
+};
+
+class BlackboardProfiler final
+{
+public:
+	void OnRead(const char* key, size_t bytesCopied, bool isStringLookup);
+	void OnWrite(const char* key, size_t bytesCopied, bool isStringLookup);
+	void OnMiss(const char* key, bool isStringLookup);
+
+	//Call once per tick, the frame counters move to the totals
+	void EndFrame();
+
+	void RenderImGui(const char* title) const;
+	bool WriteCsv(const std::string& path) const;
+
+private:
+	struct KeyRecord
+	{
+		BlackboardKeyStats frame;
+		BlackboardKeyStats lastFrame;
+		BlackboardKeyStats total;
+		BlackboardKeyStats maxPerFrame;
+	};
+
+	std::unordered_map<std::string, KeyRecord> m_Records{};
+	uint64_t m_FrameCount = 0;
+
+	KeyRecord& GetRecord(const char* key, bool isStringLookup);
+	//Most bytes copied first, then most accesses
+	std::vector<std::pair<std::string, KeyRecord>> GetSortedRecords() const;
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "CowVector.h"
+
+//-----------------------------------------------------------------
+// BLACKBOARD CHECKPOINT STREAMS
+//-----------------------------------------------------------------
+class BlackboardWriter final
+{
+public:
+	explicit BlackboardWriter(std::vector<char>& buffer) : m_Buffer(buffer) {}
+
+	void Write(const void* pData, size_t size)
+	{
+		const size_t offset = m_Buffer.size();
+		m_Buffer.resize(offset + size);
+		if (size > 0)
+			memcpy(m_Buffer.data() + offset, pData, size);
+	}
+	template<typename T> void WriteValue(const T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Only plain data can be written directly");
+		Write(&value, sizeof(T));
+	}
+
+	size_t GetSize() const { return m_Buffer.size(); }
+	//Fills in a value that could only be known after writing what follows it
+	template<typename T> void Patch(size_t offset, const T& value)
+	{
+		memcpy(m_Buffer.data() + offset, &value, sizeof(T));
+	}
+
+private:
+	std::vector<char>& m_Buffer;
+};
+
+//Reads straight out of the checkpoint buffer, fails instead of reading past its end
+class BlackboardReader final
+{
+public:
+	BlackboardReader(const char* pData, size_t size) : m_pData(pData), m_Size(size) {}
+
+	bool Read(void* pData, size_t size)
+	{
+		if (size > m_Size - m_Offset)
+			return false;
+		if (size > 0)
+			memcpy(pData, m_pData + m_Offset, size);
+		m_Offset += size;
+		return true;
+	}
+	template<typename T> bool ReadValue(T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Only plain data can be read directly");
+		return Read(&value, sizeof(T));
+	}
+	bool Skip(size_t size)
+	{
+		if (size > m_Size - m_Offset)
+			return false;
+		m_Offset += size;
+		return true;
+	}
+
+	size_t GetOffset() const { return m_Offset; }
+	size_t GetRemaining() const { return m_Size - m_Offset; }
+
+private:
+	const char* m_pData;
+	size_t m_Size;
+	size_t m_Offset = 0;
+};
+
+//-----------------------------------------------------------------
+// BLACKBOARD SERIALIZERS (PER TYPE)
+//-----------------------------------------------------------------
+//Specialize for a type to make its fields part of a checkpoint.
+//Plain data is copied bytewise, anything without a serializer is left out.
+//Pointers are left out as well, they only mean something in the running process.
+template<typename T, typename Enable = void>
+struct BlackboardSerializer
+{
+	static constexpr bool IsSupported = false;
+	static void Write(BlackboardWriter&, const T&) {}
+	static bool Read(BlackboardReader&, T&) { return false; }
+};
+
+template<typename T>
+struct BlackboardSerializer<T, typename std::enable_if<std::is_trivially_copyable<T>::value && !std::is_pointer<T>::value>::type>
+{
+	static constexpr bool IsSupported = true;
+	static void Write(BlackboardWriter& writer, const T& data) { writer.WriteValue(data); }
+	static bool Read(BlackboardReader& reader, T& data) { return reader.ReadValue(data); }
+};
+
+//Vectors of plain data, read back into the existing vector so its capacity is reused
+template<typename T>
+struct BlackboardSerializer<std::vector<T>, typename std::enable_if<std::is_trivially_copyable<T>::value>::type>
+{
+	static constexpr bool IsSupported = true;
+	static void Write(BlackboardWriter& writer, const std::vector<T>& data)
+	{
+		writer.WriteValue(static_cast<uint32_t>(data.size()));
+		writer.Write(data.data(), data.size() * sizeof(T));
+	}
+	static bool Read(BlackboardReader& reader, std::vector<T>& data)
+	{
+		uint32_t count{};
+		if (!reader.ReadValue(count) || static_cast<size_t>(count) * sizeof(T) > reader.GetRemaining())
+			return false;
+		data.resize(count);
+		return reader.Read(data.data(), count * sizeof(T));
+	}
+};
+
+template<typename T>
+struct BlackboardSerializer<CowVector<T>, typename std::enable_if<BlackboardSerializer<std::vector<T>>::IsSupported>::type>
+{
+	static constexpr bool IsSupported = true;
+	static void Write(BlackboardWriter& writer, const CowVector<T>& data) { BlackboardSerializer<std::vector<T>>::Write(writer, data.Get()); }
+	//Copies sharing the old content, like a snapshot for Render, keep it
+	static bool Read(BlackboardReader& reader, CowVector<T>& data) { return BlackboardSerializer<std::vector<T>>::Read(reader, data.Overwrite()); }
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+//-----------------------------------------------------------------
+// COPY-ON-WRITE VECTOR
+//-----------------------------------------------------------------
+//Copies share one reference counted buffer, only Mutate on a shared buffer copies it.
+//Used for the large blackboard collections, so handing them out or snapshotting them is a pointer copy.
+template<typename T>
+class CowVector final
+{
+public:
+	CowVector() = default;
+	//Empty vectors do not allocate a buffer until they are mutated
+	CowVector(std::vector<T> data)
+		: m_pData(data.empty() ? nullptr : std::make_shared<std::vector<T>>(std::move(data)))
+	{}
+
+	const std::vector<T>& Get() const
+	{
+		static const std::vector<T> empty{};
+		return m_pData != nullptr ? *m_pData : empty;
+	}
+	operator const std::vector<T>&() const { return Get(); }
+
+	//Detaches from the other copies first if the buffer is shared
+	std::vector<T>& Mutate()
+	{
+		if (m_pData == nullptr)
+			m_pData = std::make_shared<std::vector<T>>();
+		else if (m_pData.use_count() > 1)
+			m_pData = std::make_shared<std::vector<T>>(*m_pData);
+		return *m_pData;
+	}
+
+	//For replacing the whole content: a new empty buffer if the current one is shared, nothing is copied
+	std::vector<T>& Overwrite()
+	{
+		if (m_pData == nullptr || m_pData.use_count() > 1)
+			m_pData = std::make_shared<std::vector<T>>();
+		return *m_pData;
+	}
+
+	bool IsSharedWith(const CowVector<T>& other) const { return m_pData == other.m_pData; }
+
+	size_t size() const { return Get().size(); }
+	bool empty() const { return Get().empty(); }
+	const T& operator[](size_t index) const { return Get()[index]; }
+	const T& front() const { return Get().front(); }
+	const T& back() const { return Get().back(); }
+	typename std::vector<T>::const_iterator begin() const { return Get().begin(); }
+	typename std::vector<T>::const_iterator end() const { return Get().end(); }
+
+private:
+	std::shared_ptr<std::vector<T>> m_pData = nullptr;
+};
@@ -0,0 +1,199 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "EBatchBehaviorTree.h"
+
+#include <algorithm>
+
+//-----------------------------------------------------------------
+// BATCH BEHAVIOR TREE
+//-----------------------------------------------------------------
+BatchBehaviorTree::BatchBehaviorTree(const IBehavior* pTemplateBehavior)
+{
+	if (!m_Template.Compile(pTemplateBehavior))
+		return;
+
+	m_PartialSequenceCount = m_Template.GetPartialSequenceCount();
+
+	// Composites nest as deep as the subtrees that are still open at a node
+	const std::vector<FlatBehaviorNode>& nodes = m_Template.GetNodes();
+	std::vector<uint32_t> openSubtreeEnds{};
+	for (uint32_t nodeIndex{}; nodeIndex < nodes.size(); ++nodeIndex)
+	{
+		while (!openSubtreeEnds.empty() && openSubtreeEnds.back() <= nodeIndex)
+		{
+			openSubtreeEnds.pop_back();
+		}
+		if (nodes[nodeIndex].subtreeEnd > nodeIndex + 1)
+		{
+			openSubtreeEnds.push_back(nodes[nodeIndex].subtreeEnd);
+			m_MaxDepth = std::max(m_MaxDepth, static_cast<uint32_t>(openSubtreeEnds.size()));
+		}
+	}
+}
+
+uint32_t BatchBehaviorTree::AddAgent(Blackboard* pBlackBoard)
+{
+	m_BlackBoards.push_back(pBlackBoard);
+	m_Results.push_back(BehaviorState::Failure);
+	m_PartialSequenceIndices.resize(m_PartialSequenceIndices.size() + m_PartialSequenceCount, 0);
+
+	// Slice 0 lists every agent, the composites of depth d use slice d
+	m_Wavefronts.resize(m_BlackBoards.size() * (m_MaxDepth + 1));
+	return static_cast<uint32_t>(m_BlackBoards.size() - 1);
+}
+
+void BatchBehaviorTree::ClearAgents()
+{
+	m_BlackBoards.clear();
+	m_Results.clear();
+	m_PartialSequenceIndices.clear();
+	m_Wavefronts.clear();
+}
+
+void BatchBehaviorTree::Update(float)
+{
+	//Changes of the previous tick are delivered in one batch before deciding
+	for (Blackboard* pBlackBoard : m_BlackBoards)
+	{
+		pBlackBoard->DispatchNotifications();
+	}
+
+	Execute();
+}
+
+void BatchBehaviorTree::Execute()
+{
+	const uint32_t agentCount = static_cast<uint32_t>(m_BlackBoards.size());
+	if (!IsCompiled())
+	{
+		std::fill(m_Results.begin(), m_Results.end(), BehaviorState::Failure);
+		return;
+	}
+	if (agentCount == 0)
+		return;
+
+	uint32_t* pAllAgents = m_Wavefronts.data();
+	for (uint32_t agentIndex{}; agentIndex < agentCount; ++agentIndex)
+	{
+		pAllAgents[agentIndex] = agentIndex;
+	}
+	ExecuteNode(0, pAllAgents, agentCount, 1);
+}
+
+void BatchBehaviorTree::ExecuteNode(uint32_t nodeIndex, const uint32_t* pAgents, uint32_t agentCount, uint32_t depth)
+{
+	const std::vector<FlatBehaviorNode>& nodes = m_Template.GetNodes();
+	const FlatBehaviorNode& node = nodes[nodeIndex];
+	Blackboard* const* ppBlackBoards = m_BlackBoards.data();
+	BehaviorState* pResults = m_Results.data();
+
+	switch (node.type)
+	{
+	case FlatBehaviorType::Conditional:
+	{
+		const FlatBehaviorTree::Condition fpCondition = m_Template.GetCondition(node.data);
+		for (uint32_t i{}; i < agentCount; ++i)
+		{
+			pResults[pAgents[i]] = fpCondition(ppBlackBoards[pAgents[i]]) ? BehaviorState::Success : BehaviorState::Failure;
+		}
+		return;
+	}
+	case FlatBehaviorType::NotConditional:
+	{
+		const FlatBehaviorTree::Condition fpCondition = m_Template.GetCondition(node.data);
+		for (uint32_t i{}; i < agentCount; ++i)
+		{
+			pResults[pAgents[i]] = fpCondition(ppBlackBoards[pAgents[i]]) ? BehaviorState::Failure : BehaviorState::Success;
+		}
+		return;
+	}
+	case FlatBehaviorType::Action:
+	{
+		const FlatBehaviorTree::Action fpAction = m_Template.GetAction(node.data);
+		for (uint32_t i{}; i < agentCount; ++i)
+		{
+			pResults[pAgents[i]] = fpAction(ppBlackBoards[pAgents[i]]);
+		}
+		return;
+	}
+	case FlatBehaviorType::Selector:
+	case FlatBehaviorType::Sequence:
+	{
+		// A selector goes on with the agents whose child failed, a sequence with the ones whose child succeeded.
+		// Agents left after the last child keep that result, which is also the result of the composite
+		const BehaviorState continueState = node.type == FlatBehaviorType::Selector ? BehaviorState::Failure : BehaviorState::Success;
+		if (node.childCount == 0)
+		{
+			for (uint32_t i{}; i < agentCount; ++i)
+			{
+				pResults[pAgents[i]] = continueState;
+			}
+			return;
+		}
+
+		uint32_t* pWavefront = m_Wavefronts.data() + size_t{ depth } * m_BlackBoards.size();
+		std::copy(pAgents, pAgents + agentCount, pWavefront);
+		uint32_t wavefrontCount = agentCount;
+		for (uint32_t child = nodeIndex + 1; child < node.subtreeEnd && wavefrontCount > 0; child = nodes[child].subtreeEnd)
+		{
+			ExecuteNode(child, pWavefront, wavefrontCount, depth + 1);
+			wavefrontCount = static_cast<uint32_t>(std::remove_if(pWavefront, pWavefront + wavefrontCount, [pResults, continueState](uint32_t agentIndex) {
+				return pResults[agentIndex] != continueState;
+			}) - pWavefront);
+		}
+		return;
+	}
+	case FlatBehaviorType::PartialSequence:
+	{
+		// Agents are grouped by the child they resume, the groups are fixed before any child runs
+		// so an agent that moves on to the next child waits for the next tick like in the flat tree
+		uint32_t* pResumeIndices = m_PartialSequenceIndices.data() + node.data;
+		const uint32_t stride = m_PartialSequenceCount;
+		uint32_t* pWavefront = m_Wavefronts.data() + size_t{ depth } * m_BlackBoards.size();
+		std::copy(pAgents, pAgents + agentCount, pWavefront);
+		std::sort(pWavefront, pWavefront + agentCount, [pResumeIndices, stride](uint32_t left, uint32_t right) {
+			const uint32_t leftResume = pResumeIndices[size_t{ left } * stride];
+			const uint32_t rightResume = pResumeIndices[size_t{ right } * stride];
+			return leftResume != rightResume ? leftResume < rightResume : left < right;
+		});
+
+		uint32_t groupBegin{};
+		uint32_t childOrdinal{};
+		for (uint32_t child = nodeIndex + 1; child < node.subtreeEnd && groupBegin < agentCount; child = nodes[child].subtreeEnd, ++childOrdinal)
+		{
+			uint32_t groupEnd = groupBegin;
+			while (groupEnd < agentCount && pResumeIndices[size_t{ pWavefront[groupEnd] } * stride] == childOrdinal)
+			{
+				++groupEnd;
+			}
+			if (groupEnd == groupBegin)
+				continue;
+
+			ExecuteNode(child, pWavefront + groupBegin, groupEnd - groupBegin, depth + 1);
+			for (uint32_t i = groupBegin; i < groupEnd; ++i)
+			{
+				const uint32_t agentIndex = pWavefront[i];
+				uint32_t& resumeIndex = pResumeIndices[size_t{ agentIndex } * stride];
+				if (pResults[agentIndex] == BehaviorState::Failure)
+				{
+					resumeIndex = 0;
+				}
+				else if (pResults[agentIndex] == BehaviorState::Success)
+				{
+					++resumeIndex;
+					pResults[agentIndex] = BehaviorState::Running;
+				}
+			}
+			groupBegin = groupEnd;
+		}
+
+		// Succeeds on the tick after the last child succeeded
+		for (uint32_t i = groupBegin; i < agentCount; ++i)
+		{
+			pResumeIndices[size_t{ pWavefront[i] } * stride] = 0;
+			pResults[pWavefront[i]] = BehaviorState::Success;
+		}
+		return;
+	}
+	}
+}
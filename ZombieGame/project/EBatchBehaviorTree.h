@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "EFlatBehaviorTree.h"
+
+//-----------------------------------------------------------------
+// BATCH BEHAVIOR TREE
+//-----------------------------------------------------------------
+//Ticks the same tree for many agents in one pass. The template tree is compiled to its flat form once,
+//every agent only brings its blackboard and the child to resume of each partial sequence.
+//Execution is a wavefront: a node runs for all agents that reached it before the pass moves on,
+//a composite then hands the agents that continue to its next child. A leaf function therefore runs
+//back to back for every agent at it, which keeps its code and the tree nodes in cache.
+//Gives every agent the same result as a flat tree of its own. Does not own the blackboards.
+class BatchBehaviorTree final : public IDecisionMaking
+{
+public:
+	//The template keeps its ownership, it is not used after compiling
+	explicit BatchBehaviorTree(const IBehavior* pTemplateBehavior);
+	~BatchBehaviorTree() = default;
+
+	BatchBehaviorTree(const BatchBehaviorTree& other) = delete;
+	BatchBehaviorTree& operator=(const BatchBehaviorTree& other) = delete;
+	BatchBehaviorTree(BatchBehaviorTree&& other) = delete;
+	BatchBehaviorTree& operator=(BatchBehaviorTree&& other) = delete;
+
+	//Returns the index of the agent
+	uint32_t AddAgent(Blackboard* pBlackBoard);
+	void ClearAgents();
+
+	//Delivers the notifications of every blackboard, then executes
+	virtual void Update(float deltaTime) override;
+	//One pass over all agents, the result of each is in GetResult
+	void Execute();
+
+	bool IsCompiled() const { return m_Template.IsCompiled(); }
+	size_t GetAgentCount() const { return m_BlackBoards.size(); }
+	BehaviorState GetResult(uint32_t agentIndex) const { return m_Results[agentIndex]; }
+
+private:
+	FlatBehaviorTree m_Template{};
+	uint32_t m_PartialSequenceCount = 0;
+	uint32_t m_MaxDepth = 0;
+
+	//Per agent
+	std::vector<Blackboard*> m_BlackBoards{};
+	std::vector<BehaviorState> m_Results{};
+	std::vector<uint32_t> m_PartialSequenceIndices{}; //Child to resume, agent after agent
+
+	//Agents still running at the composite of each depth, one slice of agent count per depth
+	std::vector<uint32_t> m_Wavefronts{};
+
+	void ExecuteNode(uint32_t nodeIndex, const uint32_t* pAgents, uint32_t agentCount, uint32_t depth);
+};
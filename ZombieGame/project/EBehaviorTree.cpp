@@ -1,20 +1,152 @@
 //=== General Includes ===
 #include "stdafx.h"
 #include "EBehaviorTree.h"
+#include "EFlatBehaviorTree.h"
+#include "EWorkerPool.h"
 
+#include <chrono>
+
+
+//-----------------------------------------------------------------
+// BEHAVIOR INTERFACES (BASE)
+//-----------------------------------------------------------------
+#if CONFIG_PROFILE_BEHAVIOR_TREE
+BehaviorState IBehavior::ExecuteProfiled(Blackboard* pBlackBoard)
+{
+	if (m_pProfiler == nullptr)
+		return Traced(Execute(pBlackBoard));
+
+	m_pProfiler->OnEnter(m_ProfileIndex);
+	const BehaviorState state = Execute(pBlackBoard);
+	m_pProfiler->OnExit(m_ProfileIndex, state);
+	return Traced(state);
+}
+
+BehaviorState IBehavior::ResumeProfiled(Blackboard* pBlackBoard)
+{
+	if (m_pProfiler == nullptr)
+		return Traced(Resume(pBlackBoard));
+
+	m_pProfiler->OnEnter(m_ProfileIndex);
+	const BehaviorState state = Resume(pBlackBoard);
+	m_pProfiler->OnExit(m_ProfileIndex, state);
+	return Traced(state);
+}
+#endif
 
 //-----------------------------------------------------------------
 // BEHAVIOR TREE COMPOSITES (IBehavior)
 //-----------------------------------------------------------------
 #pragma region COMPOSITES
+//COMPOSITE
+bool BehaviorComposite::ValidateDependencies(const Blackboard* pBlackBoard) const
+{
+	// Keep going after a failure so every missing key gets reported
+	bool isValid = true;
+	for (const auto& child : m_ChildBehaviors)
+	{
+		isValid &= child->ValidateDependencies(pBlackBoard);
+	}
+	return isValid;
+}
+
+void BehaviorComposite::Abort()
+{
+	if (m_RunningChildIndex >= 0)
+	{
+		m_ChildBehaviors[m_RunningChildIndex]->Abort();
+		m_RunningChildIndex = -1;
+	}
+}
+
+bool BehaviorComposite::IsReadOnly() const
+{
+	for (const auto& child : m_ChildBehaviors)
+	{
+		if (!child->IsReadOnly())
+			return false;
+	}
+	return true;
+}
+
+void BehaviorComposite::BindContext(BehaviorTreeContext* pContext)
+{
+	for (const auto& child : m_ChildBehaviors)
+	{
+		child->BindContext(pContext);
+	}
+}
+
+bool BehaviorComposite::FlattenChildren(FlatBehaviorTree& flatTree) const
+{
+	for (const auto& child : m_ChildBehaviors)
+	{
+		if (!child->Flatten(flatTree))
+			return false;
+	}
+	return true;
+}
+
 //SELECTOR
+bool BehaviorSelector::Flatten(FlatBehaviorTree& flatTree) const
+{
+	const uint32_t nodeIndex = flatTree.BeginComposite(FlatBehaviorType::Selector, static_cast<uint32_t>(m_ChildBehaviors.size()));
+	const bool isFlattened = FlattenChildren(flatTree);
+	flatTree.EndComposite(nodeIndex);
+	return isFlattened;
+}
+
 BehaviorState BehaviorSelector::Execute(Blackboard* pBlackBoard)
 {
+	return ExecuteFrom(pBlackBoard, 0);
+}
+
+BehaviorState BehaviorSelector::Resume(Blackboard* pBlackBoard)
+{
+	if (m_RunningChildIndex < 0)
+		return Execute(pBlackBoard);
+
+	// Higher priority children are only looked at through their observers
+	const size_t runningIndex = m_RunningChildIndex;
+	for (size_t i{}; i < runningIndex; ++i)
+	{
+		if (m_ChildBehaviors[i]->ShouldAbortLowerPriority(pBlackBoard))
+		{
+			Abort();
+			return Execute(pBlackBoard);
+		}
+	}
+
+	m_CurrentState = m_ChildBehaviors[runningIndex]->ResumeProfiled(pBlackBoard);
+	if (m_CurrentState != BehaviorState::Failure)
+	{
+		m_RunningChildIndex = m_CurrentState == BehaviorState::Running ? m_RunningChildIndex : -1;
+		return m_CurrentState;
+	}
+
+	return ExecuteFrom(pBlackBoard, runningIndex + 1);
+}
+
+bool BehaviorSelector::ShouldAbortLowerPriority(Blackboard* pBlackBoard)
+{
+	// Any child that would now be entered
+	for (const auto& child : m_ChildBehaviors)
+	{
+		if (child->ShouldAbortLowerPriority(pBlackBoard))
+			return true;
+	}
+	return false;
+}
+
+BehaviorState BehaviorSelector::ExecuteFrom(Blackboard* pBlackBoard, size_t firstChild)
+{
+	m_RunningChildIndex = -1;
+
 	//TODO: Fill in this code
 	// Loop over all children in m_ChildBehaviors
-	for (const auto& child : m_ChildBehaviors)
+	for (size_t i = firstChild; i < m_ChildBehaviors.size(); ++i)
 	{
-		m_CurrentState = child->Execute(pBlackBoard);
+		m_CurrentState = m_ChildBehaviors[i]->ExecuteProfiled(pBlackBoard);
 
 		if (m_CurrentState == BehaviorState::Success)
 		{
@@ -23,6 +155,7 @@ BehaviorState BehaviorSelector::Execute(Blackboard* pBlackBoard)
 
 		if (m_CurrentState == BehaviorState::Running)
 		{
+			m_RunningChildIndex = static_cast<int>(i);
 			return m_CurrentState;
 		}
 
@@ -48,14 +181,62 @@ BehaviorState BehaviorSelector::Execute(Blackboard* pBlackBoard)
 	m_CurrentState = BehaviorState::Failure;
 	return m_CurrentState;
 }
+BehaviorState BehaviorSelector::ExecuteReadOnly(const BlackboardView& view) const
+{
+	for (const auto& child : m_ChildBehaviors)
+	{
+		const BehaviorState state = child->ExecuteReadOnly(view);
+		if (state != BehaviorState::Failure)
+			return state;
+	}
+	return BehaviorState::Failure;
+}
+
 //SEQUENCE
+bool BehaviorSequence::Flatten(FlatBehaviorTree& flatTree) const
+{
+	const uint32_t nodeIndex = flatTree.BeginComposite(FlatBehaviorType::Sequence, static_cast<uint32_t>(m_ChildBehaviors.size()));
+	const bool isFlattened = FlattenChildren(flatTree);
+	flatTree.EndComposite(nodeIndex);
+	return isFlattened;
+}
 BehaviorState BehaviorSequence::Execute(Blackboard* pBlackBoard)
 {
+	return ExecuteFrom(pBlackBoard, 0);
+}
+
+BehaviorState BehaviorSequence::Resume(Blackboard* pBlackBoard)
+{
+	if (m_RunningChildIndex < 0)
+		return Execute(pBlackBoard);
+
+	// Children before the running one already succeeded
+	const size_t runningIndex = m_RunningChildIndex;
+	m_CurrentState = m_ChildBehaviors[runningIndex]->ResumeProfiled(pBlackBoard);
+	if (m_CurrentState != BehaviorState::Success)
+	{
+		m_RunningChildIndex = m_CurrentState == BehaviorState::Running ? m_RunningChildIndex : -1;
+		return m_CurrentState;
+	}
+
+	return ExecuteFrom(pBlackBoard, runningIndex + 1);
+}
+
+bool BehaviorSequence::ShouldAbortLowerPriority(Blackboard* pBlackBoard)
+{
+	// The first child guards the sequence
+	return !m_ChildBehaviors.empty() && m_ChildBehaviors.front()->ShouldAbortLowerPriority(pBlackBoard);
+}
+
+BehaviorState BehaviorSequence::ExecuteFrom(Blackboard* pBlackBoard, size_t firstChild)
+{
+	m_RunningChildIndex = -1;
+
 	//TODO: FIll in this code
 	//Loop over all children in m_ChildBehaviors
-	for (auto child : m_ChildBehaviors)
+	for (size_t i = firstChild; i < m_ChildBehaviors.size(); ++i)
 	{
-		m_CurrentState = child->Execute(pBlackBoard);
+		m_CurrentState = m_ChildBehaviors[i]->ExecuteProfiled(pBlackBoard);
 
 		if (m_CurrentState == BehaviorState::Failure)
 		{
@@ -64,6 +245,7 @@ BehaviorState BehaviorSequence::Execute(Blackboard* pBlackBoard)
 
 		if (m_CurrentState == BehaviorState::Running)
 		{
+			m_RunningChildIndex = static_cast<int>(i);
 			return BehaviorState::Running;
 		}
 	}
@@ -84,12 +266,30 @@ BehaviorState BehaviorSequence::Execute(Blackboard* pBlackBoard)
 	m_CurrentState = BehaviorState::Success;
 	return m_CurrentState;
 }
+BehaviorState BehaviorSequence::ExecuteReadOnly(const BlackboardView& view) const
+{
+	for (const auto& child : m_ChildBehaviors)
+	{
+		const BehaviorState state = child->ExecuteReadOnly(view);
+		if (state != BehaviorState::Success)
+			return state;
+	}
+	return BehaviorState::Success;
+}
+
 //PARTIAL SEQUENCE
+bool BehaviorPartialSequence::Flatten(FlatBehaviorTree& flatTree) const
+{
+	const uint32_t nodeIndex = flatTree.BeginComposite(FlatBehaviorType::PartialSequence, static_cast<uint32_t>(m_ChildBehaviors.size()));
+	const bool isFlattened = FlattenChildren(flatTree);
+	flatTree.EndComposite(nodeIndex);
+	return isFlattened;
+}
 BehaviorState BehaviorPartialSequence::Execute(Blackboard* pBlackBoard)
 {
 	while (m_CurrentBehaviorIndex < m_ChildBehaviors.size())
 	{
-		m_CurrentState = m_ChildBehaviors[m_CurrentBehaviorIndex]->Execute(pBlackBoard);
+		m_CurrentState = m_ChildBehaviors[m_CurrentBehaviorIndex]->ExecuteProfiled(pBlackBoard);
 		switch (m_CurrentState)
 		{
 		case BehaviorState::Failure:
@@ -108,7 +308,461 @@ BehaviorState BehaviorPartialSequence::Execute(Blackboard* pBlackBoard)
 	m_CurrentState = BehaviorState::Success;
 	return m_CurrentState;
 }
+
+void BehaviorPartialSequence::Abort()
+{
+	if (m_CurrentBehaviorIndex < m_ChildBehaviors.size())
+	{
+		m_ChildBehaviors[m_CurrentBehaviorIndex]->Abort();
+	}
+	m_CurrentBehaviorIndex = 0;
+}
+
+//OBSERVER
+BehaviorState BehaviorObserver::Execute(Blackboard* pBlackBoard)
+{
+	if (!Evaluate(pBlackBoard))
+	{
+		m_CurrentState = BehaviorState::Failure;
+		return m_CurrentState;
+	}
+
+	m_CurrentState = m_pChildBehavior->ExecuteProfiled(pBlackBoard);
+	return m_CurrentState;
+}
+
+BehaviorState BehaviorObserver::Resume(Blackboard* pBlackBoard)
+{
+	// The running child is given up once the condition no longer holds
+	if (HasKeyChanged(pBlackBoard) && !Evaluate(pBlackBoard))
+	{
+		m_pChildBehavior->Abort();
+		m_CurrentState = BehaviorState::Failure;
+		return m_CurrentState;
+	}
+
+	m_CurrentState = m_pChildBehavior->ResumeProfiled(pBlackBoard);
+	return m_CurrentState;
+}
+
+bool BehaviorObserver::ShouldAbortLowerPriority(Blackboard* pBlackBoard)
+{
+	// Only a condition that became true takes over, one that stayed true already had its chance
+	// and would otherwise abort the lower priority branch on every tick while its own branch fails
+	if (HasKeyChanged(pBlackBoard))
+	{
+		const bool wasTrue = m_LastResult;
+		if (Evaluate(pBlackBoard) && !wasTrue)
+			return true;
+	}
+
+	// While it holds, an observer nested in its branch can still take over
+	return m_LastResult && m_pChildBehavior->ShouldAbortLowerPriority(pBlackBoard);
+}
+
+void BehaviorObserver::Abort()
+{
+	m_pChildBehavior->Abort();
+}
+
+bool BehaviorObserver::ValidateDependencies(const Blackboard* pBlackBoard) const
+{
+	const bool isValid = BehaviorLeaf::CheckDependencies(pBlackBoard, m_Dependencies);
+	return m_pChildBehavior->ValidateDependencies(pBlackBoard) && isValid;
+}
+
+void BehaviorObserver::BindContext(BehaviorTreeContext* pContext)
+{
+	m_MemoBinding = pContext->conditionMemo.Bind(m_fpConditional);
+	m_pChildBehavior->BindContext(pContext);
+}
+
+bool BehaviorObserver::HasKeyChanged(const Blackboard* pBlackBoard) const
+{
+	// Without declared keys a change can not be seen, so the condition always runs
+	bool hasChanged = m_Dependencies.empty();
+	for (size_t i{}; i < m_Dependencies.size() && !hasChanged; ++i)
+	{
+		hasChanged = m_Dependencies[i].GetVersionIn(*pBlackBoard) != m_LastVersions[i];
+	}
+	return hasChanged;
+}
+
+bool BehaviorObserver::Evaluate(Blackboard* pBlackBoard)
+{
+	m_LastResult = m_fpConditional != nullptr && m_MemoBinding.Evaluate(m_fpConditional, pBlackBoard);
+
+	// Taken after the condition ran, so keys it writes itself do not count as a change
+	for (size_t i{}; i < m_Dependencies.size(); ++i)
+	{
+		m_LastVersions[i] = m_Dependencies[i].GetVersionIn(*pBlackBoard);
+	}
+	return m_LastResult;
+}
+
+//PARALLEL
+BehaviorState BehaviorParallel::Execute(Blackboard* pBlackBoard)
+{
+	const BlackboardView view{ *pBlackBoard };
+
+	// The owning thread waits in ParallelFor, so nothing writes to the blackboard meanwhile
+	if (m_pWorkerPool == nullptr)
+	{
+		ExecuteChildren(view);
+	}
+	else if (m_ExecutionCount++ % SAMPLE_INTERVAL == 0)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		ExecuteChildren(view);
+		m_SerialTime = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+	}
+	else if (m_SerialTime < m_MinParallelTime)
+	{
+		ExecuteChildren(view);
+	}
+	else
+	{
+		m_pWorkerPool->ParallelFor(m_ChildBehaviors.size(), [this, &view](size_t childIndex)
+		{
+			m_ChildStates[childIndex] = m_ChildBehaviors[childIndex]->ExecuteReadOnly(view);
+		});
+	}
+
+	size_t successCount{};
+	size_t failureCount{};
+	for (const BehaviorState childState : m_ChildStates)
+	{
+		successCount += childState == BehaviorState::Success ? 1 : 0;
+		failureCount += childState == BehaviorState::Failure ? 1 : 0;
+	}
+	m_CurrentState = Join(successCount, failureCount);
+	return m_CurrentState;
+}
+
+BehaviorState BehaviorParallel::ExecuteReadOnly(const BlackboardView& view) const
+{
+	// Already on a worker, the children run one by one. Only the counts are kept, several threads
+	// can run this node at once so it can not use m_ChildStates, and it allocates nothing per call
+	size_t successCount{};
+	size_t failureCount{};
+	for (const auto& child : m_ChildBehaviors)
+	{
+		const BehaviorState childState = child->ExecuteReadOnly(view);
+		successCount += childState == BehaviorState::Success ? 1 : 0;
+		failureCount += childState == BehaviorState::Failure ? 1 : 0;
+	}
+	return Join(successCount, failureCount);
+}
+
+bool BehaviorParallel::ValidateDependencies(const Blackboard* pBlackBoard) const
+{
+	bool isValid = BehaviorComposite::ValidateDependencies(pBlackBoard);
+	for (const auto& child : m_ChildBehaviors)
+	{
+		if (!child->IsReadOnly())
+		{
+			printf("ERROR: Child '%s' of a parallel behavior can write to the Blackboard, only read-only behaviors can run in parallel \n", child->GetName() != nullptr ? child->GetName() : child->GetTypeName());
+			isValid = false;
+		}
+	}
+	return isValid;
+}
+
+void BehaviorParallel::BindContext(BehaviorTreeContext* pContext)
+{
+	m_pWorkerPool = pContext->pWorkerPool;
+	BehaviorComposite::BindContext(pContext);
+}
+
+void BehaviorParallel::ExecuteChildren(const BlackboardView& view)
+{
+	for (size_t i{}; i < m_ChildBehaviors.size(); ++i)
+	{
+		m_ChildStates[i] = m_ChildBehaviors[i]->ExecuteReadOnly(view);
+	}
+}
+
+BehaviorState BehaviorParallel::Join(size_t successCount, size_t failureCount) const
+{
+	const size_t childCount = m_ChildBehaviors.size();
+	if (childCount == 0)
+		return BehaviorState::Success;
+	if (failureCount > 0 && (m_FailurePolicy == ParallelPolicy::RequireOne || failureCount == childCount))
+		return BehaviorState::Failure;
+	if (successCount > 0 && (m_SuccessPolicy == ParallelPolicy::RequireOne || successCount == childCount))
+		return BehaviorState::Success;
+	return BehaviorState::Running;
+}
+
+//TICK RATE
+BehaviorState BehaviorTickRate::Execute(Blackboard* pBlackBoard)
+{
+	// The last result is not repeated, a success would keep the parent from reaching its other branches
+	if (m_CurrentState != BehaviorState::Running && !IsDue())
+	{
+		++m_SkippedCount;
+		return BehaviorState::Failure;
+	}
+
+	m_CurrentState = m_pChildBehavior->ExecuteProfiled(pBlackBoard);
+	OnTicked();
+	return m_CurrentState;
+}
+
+BehaviorState BehaviorTickRate::Resume(Blackboard* pBlackBoard)
+{
+	if (m_CurrentState != BehaviorState::Running)
+		return Execute(pBlackBoard);
+
+	m_CurrentState = m_pChildBehavior->ResumeProfiled(pBlackBoard);
+	OnTicked();
+	return m_CurrentState;
+}
+
+bool BehaviorTickRate::ShouldAbortLowerPriority(Blackboard* pBlackBoard)
+{
+	// Can only take over on a tick of its own
+	return IsDue() && m_pChildBehavior->ShouldAbortLowerPriority(pBlackBoard);
+}
+
+void BehaviorTickRate::Abort()
+{
+	m_pChildBehavior->Abort();
+	if (m_CurrentState == BehaviorState::Running)
+		m_CurrentState = BehaviorState::Failure;
+}
+
+void BehaviorTickRate::BindContext(BehaviorTreeContext* pContext)
+{
+	m_pScheduler = &pContext->scheduler;
+	m_NextTickTime = pContext->scheduler.GetFirstTickTime(m_Interval);
+	m_pChildBehavior->BindContext(pContext);
+}
+
+bool BehaviorTickRate::IsDue() const
+{
+	return m_pScheduler == nullptr || !(m_Interval > 0.f) || m_pScheduler->GetTime() >= m_NextTickTime;
+}
+
+void BehaviorTickRate::OnTicked()
+{
+	++m_TickCount;
+	if (m_pScheduler == nullptr || !(m_Interval > 0.f) || m_pScheduler->GetTime() < m_NextTickTime)
+		return;
+
+	// Stays on its phase, ticks missed during a long frame are not made up
+	const float missedIntervals = std::floor((m_pScheduler->GetTime() - m_NextTickTime) / m_Interval);
+	m_NextTickTime += (missedIntervals + 1.f) * m_Interval;
+}
+#pragma endregion
+//-----------------------------------------------------------------
+// BEHAVIOR TREE DECORATORS (IBehavior)
+//-----------------------------------------------------------------
+#pragma region DECORATORS
+//DECORATOR BASE
+BehaviorState BehaviorDecorator::Execute(Blackboard* pBlackBoard)
+{
+	m_CurrentState = Tick(pBlackBoard, false);
+	if (m_CurrentState == BehaviorState::Running && m_pContext != nullptr)
+		GetTimer().runningTick = m_pContext->scheduler.GetTickCount();
+	return m_CurrentState;
+}
+
+BehaviorState BehaviorDecorator::Resume(Blackboard* pBlackBoard)
+{
+	m_CurrentState = Tick(pBlackBoard, true);
+	if (m_CurrentState == BehaviorState::Running && m_pContext != nullptr)
+		GetTimer().runningTick = m_pContext->scheduler.GetTickCount();
+	return m_CurrentState;
+}
+
+void BehaviorDecorator::Abort()
+{
+	m_pChildBehavior->Abort();
+	if (m_CurrentState == BehaviorState::Running)
+		m_CurrentState = BehaviorState::Failure;
+}
+
+BehaviorState BehaviorDecorator::RunChild(Blackboard* pBlackBoard, bool isResuming)
+{
+	return isResuming && WasRunning() ? m_pChildBehavior->ResumeProfiled(pBlackBoard) : m_pChildBehavior->ExecuteProfiled(pBlackBoard);
+}
+
+bool BehaviorDecorator::WasRunning() const
+{
+	// Only Abort resets the state, so without a timer it is all there is to go on
+	if (m_CurrentState != BehaviorState::Running)
+		return false;
+	return m_pContext == nullptr || GetTimer().runningTick + 1 == m_pContext->scheduler.GetTickCount();
+}
+
+void BehaviorDecorator::BindTimer(BehaviorTreeContext* pContext)
+{
+	m_pContext = pContext;
+	m_TimerSlot = pContext->timers.Allocate();
+	m_pChildBehavior->BindContext(pContext);
+}
+
+//COOLDOWN
+BehaviorState BehaviorCooldown::Tick(Blackboard* pBlackBoard, bool isResuming)
+{
+	if (!WasRunning() && IsCoolingDown())
+		return BehaviorState::Failure;
+
+	const BehaviorState state = RunChild(pBlackBoard, isResuming);
+	if (state != BehaviorState::Running && m_pContext != nullptr)
+		GetTimer().time = GetTime() + m_Seconds;
+	return state;
+}
+
+bool BehaviorCooldown::ShouldAbortLowerPriority(Blackboard* pBlackBoard)
+{
+	return !IsCoolingDown() && m_pChildBehavior->ShouldAbortLowerPriority(pBlackBoard);
+}
+
+void BehaviorCooldown::BindContext(BehaviorTreeContext* pContext)
+{
+	BindTimer(pContext);
+}
+
+bool BehaviorCooldown::IsCoolingDown() const
+{
+	return m_pContext != nullptr && GetTime() < GetTimer().time;
+}
+
+//RATE LIMIT
+BehaviorState BehaviorRateLimit::Tick(Blackboard* pBlackBoard, bool isResuming)
+{
+	if (!WasRunning())
+	{
+		if (IsLimited())
+			return BehaviorState::Failure;
+		if (m_pContext != nullptr)
+			GetTimer().time = GetTime() + m_Interval;
+	}
+	return RunChild(pBlackBoard, isResuming);
+}
+
+bool BehaviorRateLimit::ShouldAbortLowerPriority(Blackboard* pBlackBoard)
+{
+	return !IsLimited() && m_pChildBehavior->ShouldAbortLowerPriority(pBlackBoard);
+}
+
+void BehaviorRateLimit::BindContext(BehaviorTreeContext* pContext)
+{
+	BindTimer(pContext);
+}
+
+bool BehaviorRateLimit::IsLimited() const
+{
+	return m_pContext != nullptr && GetTime() < GetTimer().time;
+}
+
+//TIMEOUT
+BehaviorState BehaviorTimeout::Tick(Blackboard* pBlackBoard, bool isResuming)
+{
+	if (m_pContext == nullptr)
+		return RunChild(pBlackBoard, isResuming);
+
+	// The clock starts on the tick the child starts
+	if (!WasRunning())
+		GetTimer().time = GetTime();
+
+	const BehaviorState state = RunChild(pBlackBoard, isResuming);
+	if (state == BehaviorState::Running && GetTime() - GetTimer().time >= m_Seconds)
+	{
+		m_pChildBehavior->Abort();
+		return BehaviorState::Failure;
+	}
+	return state;
+}
+
+void BehaviorTimeout::BindContext(BehaviorTreeContext* pContext)
+{
+	BindTimer(pContext);
+}
+
+//RETRY
+BehaviorState BehaviorRetry::Tick(Blackboard* pBlackBoard, bool isResuming)
+{
+	// Attempts of a branch that was left count no longer
+	if (!WasRunning())
+	{
+		m_IsRetrying = false;
+		if (m_pContext != nullptr)
+			GetTimer().count = 0;
+	}
+
+	const BehaviorState state = RunChild(pBlackBoard, isResuming && !m_IsRetrying);
+	m_IsRetrying = false;
+	if (m_pContext == nullptr)
+		return state;
+
+	// Failures in a row, a success starts the count over
+	uint32_t& failureCount = GetTimer().count;
+	if (state != BehaviorState::Failure)
+	{
+		failureCount = state == BehaviorState::Running ? failureCount : 0;
+		return state;
+	}
+	if (++failureCount < m_AttemptCount)
+	{
+		m_IsRetrying = true;
+		return BehaviorState::Running;
+	}
+	failureCount = 0;
+	return BehaviorState::Failure;
+}
+
+void BehaviorRetry::Abort()
+{
+	BehaviorDecorator::Abort();
+	m_IsRetrying = false;
+	if (m_pContext != nullptr)
+		GetTimer().count = 0;
+}
+
+void BehaviorRetry::BindContext(BehaviorTreeContext* pContext)
+{
+	BindTimer(pContext);
+}
+
+//INVERTER
+BehaviorState BehaviorInverter::Invert(BehaviorState state)
+{
+	switch (state)
+	{
+	case BehaviorState::Success:
+		return BehaviorState::Failure;
+	case BehaviorState::Failure:
+		return BehaviorState::Success;
+	default:
+		return state;
+	}
+}
 #pragma endregion
+//-----------------------------------------------------------------
+// BEHAVIOR TREE LEAF (IBehavior)
+//-----------------------------------------------------------------
+bool BehaviorLeaf::ValidateDependencies(const Blackboard* pBlackBoard) const
+{
+	return CheckDependencies(pBlackBoard, m_Dependencies);
+}
+
+bool BehaviorLeaf::CheckDependencies(const Blackboard* pBlackBoard, const std::vector<BlackboardDependency>& dependencies)
+{
+	bool isValid = true;
+	for (const auto& dependency : dependencies)
+	{
+		if (!dependency.IsBoundIn(*pBlackBoard))
+		{
+			printf("ERROR: Behavior needs key '%s' of type '%s' which is missing from the Blackboard or has another type \n", dependency.name, dependency.typeName);
+			isValid = false;
+		}
+	}
+	return isValid;
+}
+
 //-----------------------------------------------------------------
 // BEHAVIOR TREE CONDITIONAL (IBehavior)
 //-----------------------------------------------------------------
@@ -117,7 +771,7 @@ BehaviorState BehaviorConditional::Execute(Blackboard* pBlackBoard)
 	if (m_fpConditional == nullptr)
 		return BehaviorState::Failure;
 
-	switch (m_fpConditional(pBlackBoard))
+	switch (m_MemoBinding.Evaluate(m_fpConditional, pBlackBoard))
 	{
 	case true:
 		m_CurrentState = BehaviorState::Success;
@@ -129,6 +783,20 @@ BehaviorState BehaviorConditional::Execute(Blackboard* pBlackBoard)
 	}
 }
 
+BehaviorState BehaviorViewConditional::Execute(Blackboard* pBlackBoard)
+{
+	m_CurrentState = ExecuteReadOnly(BlackboardView{ *pBlackBoard });
+	return m_CurrentState;
+}
+
+BehaviorState BehaviorViewConditional::ExecuteReadOnly(const BlackboardView& view) const
+{
+	if (m_fpConditional == nullptr)
+		return BehaviorState::Failure;
+
+	return m_fpConditional(view) ? BehaviorState::Success : BehaviorState::Failure;
+}
+
 //-----------------------------------------------------------------
 // BEHAVIOR TREE ACTION (IBehavior)
 //-----------------------------------------------------------------
@@ -146,7 +814,7 @@ BehaviorState BehaviorNotConditional::Execute(Blackboard* pBlackBoard)
 	if (m_fpConditional == nullptr)
 		return BehaviorState::Failure;
 
-	switch (m_fpConditional(pBlackBoard))
+	switch (m_MemoBinding.Evaluate(m_fpConditional, pBlackBoard))
 	{
 	case true:
 		m_CurrentState = BehaviorState::Failure;
@@ -157,3 +825,51 @@ BehaviorState BehaviorNotConditional::Execute(Blackboard* pBlackBoard)
 		return m_CurrentState;
 	}
 }
+
+//-----------------------------------------------------------------
+// FLATTENING OF LEAVES
+//-----------------------------------------------------------------
+//Only leaves made from plain functions can be flattened, lambdas with captures can not
+bool BehaviorConditional::Flatten(FlatBehaviorTree& flatTree) const
+{
+	const FlatBehaviorTree::Condition* pfpConditional = m_fpConditional.target<FlatBehaviorTree::Condition>();
+	if (pfpConditional == nullptr)
+		return false;
+
+	flatTree.AddCondition(FlatBehaviorType::Conditional, *pfpConditional);
+	return true;
+}
+
+bool BehaviorNotConditional::Flatten(FlatBehaviorTree& flatTree) const
+{
+	const FlatBehaviorTree::Condition* pfpConditional = m_fpConditional.target<FlatBehaviorTree::Condition>();
+	if (pfpConditional == nullptr)
+		return false;
+
+	flatTree.AddCondition(FlatBehaviorType::NotConditional, *pfpConditional);
+	return true;
+}
+
+bool BehaviorAction::Flatten(FlatBehaviorTree& flatTree) const
+{
+	const FlatBehaviorTree::Action* pfpAction = m_fpAction.target<FlatBehaviorTree::Action>();
+	if (pfpAction == nullptr)
+		return false;
+
+	flatTree.AddAction(*pfpAction);
+	return true;
+}
+
+//Flattened as a sequence of its condition and child, which is what it is when nothing resumes
+bool BehaviorObserver::Flatten(FlatBehaviorTree& flatTree) const
+{
+	const FlatBehaviorTree::Condition* pfpConditional = m_fpConditional.target<FlatBehaviorTree::Condition>();
+	if (pfpConditional == nullptr)
+		return false;
+
+	const uint32_t nodeIndex = flatTree.BeginComposite(FlatBehaviorType::Sequence, 2);
+	flatTree.AddCondition(FlatBehaviorType::Conditional, *pfpConditional);
+	const bool isFlattened = m_pChildBehavior->Flatten(flatTree);
+	flatTree.EndComposite(nodeIndex);
+	return isFlattened;
+}
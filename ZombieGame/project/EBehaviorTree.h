@@ -1,7 +1,14 @@
 #pragma once
 
+#include <cmath>
+
 #include "EBlackboard.h"
 #include "EDecisionMaking.h"
+#include "BehaviorProfiler.h"
+#include "BehaviorTrace.h"
+
+class FlatBehaviorTree;
+class WorkerPool;
 
 //-----------------------------------------------------------------
 	// BEHAVIOR TREE HELPERS
@@ -13,6 +20,154 @@ enum class BehaviorState
 	Running
 };
 
+//-----------------------------------------------------------------
+// CONDITION MEMO
+//-----------------------------------------------------------------
+//Results of the conditions a tree declared pure for one tick. A pure condition gives the same
+//result every time it runs in a tick, so only its first call does the work.
+//NextTick forgets every result, the tree calls it before each update.
+class ConditionMemo final
+{
+public:
+	using Condition = bool(*)(Blackboard*);
+
+	//Where a leaf finds its result, an unbound leaf calls its condition every time
+	struct Binding
+	{
+		ConditionMemo* pMemo = nullptr;
+		uint32_t slot = 0;
+
+		bool Evaluate(const std::function<bool(Blackboard*)>& fpCondition, Blackboard* pBlackBoard) const
+		{
+			return pMemo != nullptr ? pMemo->Evaluate(slot, fpCondition, pBlackBoard) : fpCondition(pBlackBoard);
+		}
+	};
+
+	void SetPureConditions(const std::vector<Condition>& pureConditions)
+	{
+		m_Entries.clear();
+		for (Condition fpCondition : pureConditions)
+			m_Entries.push_back(Entry{ fpCondition, 0, false });
+	}
+	//Only plain functions declared pure get a binding, lambdas can not be compared
+	Binding Bind(const std::function<bool(Blackboard*)>& fpCondition)
+	{
+		const Condition* pfpCondition = fpCondition.target<Condition>();
+		for (size_t i{}; pfpCondition != nullptr && i < m_Entries.size(); ++i)
+		{
+			if (m_Entries[i].fpCondition == *pfpCondition)
+				return Binding{ this, static_cast<uint32_t>(i) };
+		}
+		return Binding{};
+	}
+
+	bool Evaluate(uint32_t slot, const std::function<bool(Blackboard*)>& fpCondition, Blackboard* pBlackBoard)
+	{
+		Entry& entry = m_Entries[slot];
+		if (entry.tick == m_Tick)
+		{
+			++m_SavedCount;
+			return entry.result;
+		}
+
+		++m_EvaluationCount;
+		entry.result = fpCondition(pBlackBoard);
+		entry.tick = m_Tick;
+		return entry.result;
+	}
+	void NextTick() { ++m_Tick; }
+
+	//Calls of pure conditions that did run, and calls answered from the memo
+	size_t GetEvaluationCount() const { return m_EvaluationCount; }
+	size_t GetSavedCount() const { return m_SavedCount; }
+	void ResetCounters() { m_EvaluationCount = m_SavedCount = 0; }
+
+private:
+	struct Entry
+	{
+		Condition fpCondition;
+		uint32_t tick; //Tick the result belongs to
+		bool result;
+	};
+
+	std::vector<Entry> m_Entries{};
+	uint32_t m_Tick = 1; //Entries start at tick 0, so nothing is remembered before the first tick
+	size_t m_EvaluationCount = 0;
+	size_t m_SavedCount = 0;
+};
+
+//-----------------------------------------------------------------
+// TICK SCHEDULER
+//-----------------------------------------------------------------
+//Time of a tree, advanced by its updates. BehaviorTickRate nodes read it to decide whether they are due.
+class BehaviorTickScheduler final
+{
+public:
+	void Advance(float deltaTime) { m_Time += deltaTime; ++m_TickCount; }
+	float GetTime() const { return m_Time; }
+	//Updates so far, decorators compare it to tell whether they ran on the previous one
+	uint32_t GetTickCount() const { return m_TickCount; }
+
+	//First tick of a new node, phases follow the golden ratio so any number of nodes
+	//with the same interval spread evenly over that interval instead of ticking on the same frame
+	float GetFirstTickTime(float interval)
+	{
+		const float phase = std::fmod(m_PhaseCount * 0.618034f, 1.f);
+		++m_PhaseCount;
+		return m_Time + phase * interval;
+	}
+	void ResetPhases() { m_PhaseCount = 0; }
+
+private:
+	float m_Time = 0.f;
+	uint32_t m_TickCount = 0;
+	uint32_t m_PhaseCount = 0;
+};
+
+//-----------------------------------------------------------------
+// DECORATOR TIMERS
+//-----------------------------------------------------------------
+//Timers and counters of the decorator nodes of one tree, in one array instead of in the nodes.
+//A decorator takes a slot when it is bound and keeps only its index, so the timed decorators of a
+//tree sit next to each other in memory and are reset in one go.
+class BehaviorTimerTable final
+{
+public:
+	static constexpr uint32_t NoTimer = UINT32_MAX;
+
+	struct Timer
+	{
+		float time = 0.f; //Tree time the decorator waits for, or the time its child started
+		uint32_t count = 0; //Failures in a row of a retry
+		uint32_t runningTick = 0; //Last tick the decorator returned Running on
+	};
+
+	uint32_t Allocate()
+	{
+		m_Timers.push_back(Timer{});
+		return static_cast<uint32_t>(m_Timers.size() - 1);
+	}
+	Timer& Get(uint32_t slot) { return m_Timers[slot]; }
+	void Clear() { m_Timers.clear(); }
+	size_t GetTimerCount() const { return m_Timers.size(); }
+
+private:
+	std::vector<Timer> m_Timers{};
+};
+
+//-----------------------------------------------------------------
+// BEHAVIOR TREE CONTEXT
+//-----------------------------------------------------------------
+//State the nodes of one tree share, owned by the tree and handed to its nodes once it is built.
+//Nodes that were never bound run as if it did not exist.
+struct BehaviorTreeContext
+{
+	ConditionMemo conditionMemo{};
+	BehaviorTickScheduler scheduler{};
+	BehaviorTimerTable timers{};
+	WorkerPool* pWorkerPool = nullptr; //Not owned, a BehaviorParallel runs its children one by one without it
+};
+
 //-----------------------------------------------------------------
 // BEHAVIOR INTERFACES (BASE)
 //-----------------------------------------------------------------
@@ -22,11 +177,77 @@ public:
 	IBehavior() = default;
 	virtual ~IBehavior() = default;
 	virtual BehaviorState Execute(Blackboard* pBlackBoard) = 0;
+	//Continues the branch that returned Running on the previous tick, starts over by default
+	virtual BehaviorState Resume(Blackboard* pBlackBoard) { return Execute(pBlackBoard); }
+	//True when a running lower priority branch should give way to this one
+	virtual bool ShouldAbortLowerPriority(Blackboard*) { return false; }
+	//Forgets the running branch
+	virtual void Abort() {}
+	//Reports every declared key the blackboard is missing, call once after building the tree
+	virtual bool ValidateDependencies(const Blackboard*) const { return true; }
+	//Appends the node and its subtree to a flat tree, false if the node has no flat form
+	virtual bool Flatten(FlatBehaviorTree&) const { return false; }
+	//Hands the shared state of the tree to the subtree, e.g. pure results from the condition memo
+	virtual void BindContext(BehaviorTreeContext*) {}
+	//Subtrees that only read the blackboard can run on worker threads, see BehaviorParallel.
+	//ExecuteReadOnly changes neither the blackboard nor the node, so the same tree can be read from several threads
+	virtual bool IsReadOnly() const { return false; }
+	virtual BehaviorState ExecuteReadOnly(const BlackboardView&) const { return BehaviorState::Failure; }
+
+	//Children in execution order, used to walk the tree from outside
+	virtual size_t GetChildCount() const { return 0; }
+	virtual IBehavior* GetChild(size_t) const { return nullptr; }
+	virtual const char* GetTypeName() const = 0;
+	//Shown by the profiler instead of the type name, see NameBehavior
+	const char* GetName() const { return m_pName; }
+	void SetName(const char* pName) { m_pName = pName; }
+
+	//Execute and Resume as parents call them, timed when CONFIG_PROFILE_BEHAVIOR_TREE is enabled
+	//and recorded when the node belongs to a BehaviorTrace
+#if CONFIG_PROFILE_BEHAVIOR_TREE
+	BehaviorState ExecuteProfiled(Blackboard* pBlackBoard);
+	BehaviorState ResumeProfiled(Blackboard* pBlackBoard);
+	void SetProfiler(BehaviorProfiler* pProfiler, uint32_t nodeIndex) { m_pProfiler = pProfiler; m_ProfileIndex = nodeIndex; }
+#else
+	BehaviorState ExecuteProfiled(Blackboard* pBlackBoard) { return Traced(Execute(pBlackBoard)); }
+	BehaviorState ResumeProfiled(Blackboard* pBlackBoard) { return Traced(Resume(pBlackBoard)); }
+#endif
+#if CONFIG_TRACE_BEHAVIOR_TREE
+	void SetTrace(BehaviorTrace* pTrace, uint32_t nodeIndex) { m_pTrace = pTrace; m_TraceIndex = nodeIndex; }
+#endif
 
 protected:
 	BehaviorState m_CurrentState = BehaviorState::Failure;
+
+private:
+	const char* m_pName = nullptr;
+#if CONFIG_PROFILE_BEHAVIOR_TREE
+	BehaviorProfiler* m_pProfiler = nullptr;
+	uint32_t m_ProfileIndex = 0;
+#endif
+#if CONFIG_TRACE_BEHAVIOR_TREE
+	BehaviorTrace* m_pTrace = nullptr;
+	uint32_t m_TraceIndex = 0;
+#endif
+
+	BehaviorState Traced(BehaviorState state)
+	{
+#if CONFIG_TRACE_BEHAVIOR_TREE
+		if (m_pTrace != nullptr)
+			m_pTrace->Record(m_TraceIndex, state);
+#endif
+		return state;
+	}
 };
 
+//Names a node for the profiler and returns it, so it can wrap a node where the tree is built
+template<typename Behavior>
+Behavior* NameBehavior(const char* pName, Behavior* pBehavior)
+{
+	pBehavior->SetName(pName);
+	return pBehavior;
+}
+
 //-----------------------------------------------------------------
 // BEHAVIOR TREE COMPOSITES (IBehavior)
 //-----------------------------------------------------------------
@@ -47,9 +268,18 @@ public:
 	}
 
 	virtual BehaviorState Execute(Blackboard* pBlackBoard) override = 0;
+	virtual void Abort() override;
+	virtual bool ValidateDependencies(const Blackboard* pBlackBoard) const override;
+	virtual void BindContext(BehaviorTreeContext* pContext) override;
+	virtual size_t GetChildCount() const override { return m_ChildBehaviors.size(); }
+	virtual IBehavior* GetChild(size_t childIndex) const override { return m_ChildBehaviors[childIndex]; }
+	virtual bool IsReadOnly() const override;
 
 protected:
 	std::vector<IBehavior*> m_ChildBehaviors = {};
+	int m_RunningChildIndex = -1; //Child that returned Running on the last tick
+
+	bool FlattenChildren(FlatBehaviorTree& flatTree) const;
 };
 
 //--- SELECTOR ---
@@ -61,6 +291,14 @@ public:
 	virtual ~BehaviorSelector() = default;
 
 	virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+	virtual BehaviorState Resume(Blackboard* pBlackBoard) override;
+	virtual bool ShouldAbortLowerPriority(Blackboard* pBlackBoard) override;
+	virtual bool Flatten(FlatBehaviorTree& flatTree) const override;
+	virtual const char* GetTypeName() const override { return "Selector"; }
+	virtual BehaviorState ExecuteReadOnly(const BlackboardView& view) const override;
+
+private:
+	BehaviorState ExecuteFrom(Blackboard* pBlackBoard, size_t firstChild);
 };
 
 //--- SEQUENCE ---
@@ -72,6 +310,14 @@ public:
 	virtual ~BehaviorSequence() = default;
 
 	virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+	virtual BehaviorState Resume(Blackboard* pBlackBoard) override;
+	virtual bool ShouldAbortLowerPriority(Blackboard* pBlackBoard) override;
+	virtual bool Flatten(FlatBehaviorTree& flatTree) const override;
+	virtual const char* GetTypeName() const override { return "Sequence"; }
+	virtual BehaviorState ExecuteReadOnly(const BlackboardView& view) const override;
+
+private:
+	BehaviorState ExecuteFrom(Blackboard* pBlackBoard, size_t firstChild);
 };
 
 //--- PARTIAL SEQUENCE ---
@@ -83,44 +329,387 @@ public:
 	virtual ~BehaviorPartialSequence() = default;
 
 	virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+	//Already continues where it was, the current child starts over
+	virtual BehaviorState Resume(Blackboard* pBlackBoard) override { return Execute(pBlackBoard); }
+	virtual void Abort() override;
+	virtual bool Flatten(FlatBehaviorTree& flatTree) const override;
+	virtual const char* GetTypeName() const override { return "PartialSequence"; }
+	//Remembers its child index, so it never runs read-only
+	virtual bool IsReadOnly() const override { return false; }
 
 private:
 	unsigned int m_CurrentBehaviorIndex = 0;
 };
+
+//--- OBSERVER ---
+//Runs its child while the condition passes, like a sequence of the two.
+//While a lower priority branch of the same selector is running, only this condition is
+//checked again, and only after one of its keys changed. It takes over when it turned true,
+//or while it holds when an observer in its branch turned true. Guards that can change while the
+//observer holds, e.g. having the item to use, are observers of their own for that reason.
+//A resumed child is aborted as soon as the condition fails again after a change of its keys.
+class BehaviorObserver : public IBehavior
+{
+public:
+	explicit BehaviorObserver(std::function<bool(Blackboard*)> fp, std::vector<BlackboardDependency> dependencies, IBehavior* pChildBehavior)
+		: m_fpConditional(fp), m_Dependencies(dependencies), m_LastVersions(dependencies.size()), m_pChildBehavior(pChildBehavior) {}
+	virtual ~BehaviorObserver()
+	{
+		SAFE_DELETE(m_pChildBehavior);
+	}
+
+	virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+	virtual BehaviorState Resume(Blackboard* pBlackBoard) override;
+	virtual bool ShouldAbortLowerPriority(Blackboard* pBlackBoard) override;
+	virtual void Abort() override;
+	virtual bool ValidateDependencies(const Blackboard* pBlackBoard) const override;
+	virtual bool Flatten(FlatBehaviorTree& flatTree) const override;
+	virtual void BindContext(BehaviorTreeContext* pContext) override;
+	virtual size_t GetChildCount() const override { return 1; }
+	virtual IBehavior* GetChild(size_t) const override { return m_pChildBehavior; }
+	virtual const char* GetTypeName() const override { return "Observer"; }
+
+private:
+	std::function<bool(Blackboard*)> m_fpConditional = nullptr;
+	ConditionMemo::Binding m_MemoBinding{};
+	std::vector<BlackboardDependency> m_Dependencies = {};
+	std::vector<uint32_t> m_LastVersions = {}; //Versions of the keys when the condition last ran
+	bool m_LastResult = false;
+	IBehavior* m_pChildBehavior = nullptr;
+
+	bool HasKeyChanged(const Blackboard* pBlackBoard) const;
+	bool Evaluate(Blackboard* pBlackBoard);
+};
+
+//--- PARALLEL ---
+enum class ParallelPolicy
+{
+	RequireOne,
+	RequireAll
+};
+
+//Runs independent read-only subtrees at the same time on the worker pool of its tree and joins
+//them before returning. Children only get a BlackboardView, so they are evaluations whose state is
+//their result, e.g. threat, item or house scoring. Fails when the failure policy is met, succeeds
+//when the success policy is met, runs otherwise. The defaults behave like a sequence.
+//Waking the workers and joining them costs more than a few cheap children take, so the children only go to the
+//pool while running them one by one takes longer than minParallelTime. That time is sampled every SAMPLE_INTERVAL executions.
+class BehaviorParallel : public BehaviorComposite
+{
+public:
+	static constexpr uint32_t SAMPLE_INTERVAL = 64;
+
+	explicit BehaviorParallel(std::vector<IBehavior*> childBehaviors, ParallelPolicy successPolicy = ParallelPolicy::RequireAll, ParallelPolicy failurePolicy = ParallelPolicy::RequireOne, float minParallelTime = 50.f)
+		: BehaviorComposite(childBehaviors), m_SuccessPolicy(successPolicy), m_FailurePolicy(failurePolicy), m_MinParallelTime(minParallelTime), m_ChildStates(childBehaviors.size()) {}
+	virtual ~BehaviorParallel() = default;
+
+	virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+	virtual BehaviorState ExecuteReadOnly(const BlackboardView& view) const override;
+	virtual bool ValidateDependencies(const Blackboard* pBlackBoard) const override;
+	virtual void BindContext(BehaviorTreeContext* pContext) override;
+	virtual const char* GetTypeName() const override { return "Parallel"; }
+
+private:
+	ParallelPolicy m_SuccessPolicy;
+	ParallelPolicy m_FailurePolicy;
+	float m_MinParallelTime; //Microseconds
+	float m_SerialTime = 0.f; //Microseconds, of the last sample
+	uint32_t m_ExecutionCount = 0;
+	std::vector<BehaviorState> m_ChildStates; //Written by the workers, one element each
+	WorkerPool* m_pWorkerPool = nullptr;
+
+	void ExecuteChildren(const BlackboardView& view);
+	BehaviorState Join(size_t successCount, size_t failureCount) const;
+};
+
+//--- TICK RATE ---
+//Runs its child at most once per interval of tree time and fails in between, so a parent selector
+//goes on to its next branch instead of stopping at a stale success. Meant for bookkeeping branches
+//that do not need the frame rate. Nodes start at different phases, so their ticks are spread over
+//the frames. A running child is kept ticking every frame until it finishes.
+//Without a bound context, or without a positive interval, the child runs on every tick.
+//Has no flat form, the flat and static trees have no scheduler to run it on.
+class BehaviorTickRate : public IBehavior
+{
+public:
+	explicit BehaviorTickRate(float interval, IBehavior* pChildBehavior)
+		: m_Interval(interval), m_pChildBehavior(pChildBehavior) {}
+	virtual ~BehaviorTickRate()
+	{
+		SAFE_DELETE(m_pChildBehavior);
+	}
+
+	virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+	virtual BehaviorState Resume(Blackboard* pBlackBoard) override;
+	virtual bool ShouldAbortLowerPriority(Blackboard* pBlackBoard) override;
+	virtual void Abort() override;
+	virtual bool ValidateDependencies(const Blackboard* pBlackBoard) const override { return m_pChildBehavior->ValidateDependencies(pBlackBoard); }
+	virtual bool Flatten(FlatBehaviorTree&) const override { return false; }
+	virtual void BindContext(BehaviorTreeContext* pContext) override;
+	virtual size_t GetChildCount() const override { return 1; }
+	virtual IBehavior* GetChild(size_t) const override { return m_pChildBehavior; }
+	virtual const char* GetTypeName() const override { return "TickRate"; }
+
+	//Ticks the child ran on and ticks skipped in between
+	size_t GetTickCount() const { return m_TickCount; }
+	size_t GetSkippedCount() const { return m_SkippedCount; }
+
+private:
+	float m_Interval = 0.f;
+	float m_NextTickTime = 0.f;
+	const BehaviorTickScheduler* m_pScheduler = nullptr;
+	IBehavior* m_pChildBehavior = nullptr;
+	size_t m_TickCount = 0;
+	size_t m_SkippedCount = 0;
+
+	bool IsDue() const;
+	void OnTicked();
+};
 #pragma endregion
 
+//-----------------------------------------------------------------
+// BEHAVIOR TREE DECORATORS (IBehavior)
+//-----------------------------------------------------------------
+#pragma region DECORATORS
+	//--- DECORATOR BASE ---
+//Wraps one subtree. Timed decorators keep their state in the timer table of the tree and
+//pass their child through until they are bound. None of them has a flat form, the flat and static
+//trees have no timers and would drop the decorator without a word.
+class BehaviorDecorator : public IBehavior
+{
+public:
+	explicit BehaviorDecorator(IBehavior* pChildBehavior)
+		: m_pChildBehavior(pChildBehavior) {}
+	virtual ~BehaviorDecorator()
+	{
+		SAFE_DELETE(m_pChildBehavior);
+	}
+
+	virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+	virtual BehaviorState Resume(Blackboard* pBlackBoard) override;
+	virtual bool ShouldAbortLowerPriority(Blackboard* pBlackBoard) override { return m_pChildBehavior->ShouldAbortLowerPriority(pBlackBoard); }
+	virtual void Abort() override;
+	virtual bool ValidateDependencies(const Blackboard* pBlackBoard) const override { return m_pChildBehavior->ValidateDependencies(pBlackBoard); }
+	virtual void BindContext(BehaviorTreeContext* pContext) override { m_pChildBehavior->BindContext(pContext); }
+	virtual size_t GetChildCount() const override { return 1; }
+	virtual IBehavior* GetChild(size_t) const override { return m_pChildBehavior; }
+
+protected:
+	IBehavior* m_pChildBehavior = nullptr;
+	BehaviorTreeContext* m_pContext = nullptr; //Only set by timed decorators
+	uint32_t m_TimerSlot = BehaviorTimerTable::NoTimer;
+
+	//Execute and Resume of the decorator, a resume continues a child that was running
+	virtual BehaviorState Tick(Blackboard* pBlackBoard, bool isResuming) = 0;
+	BehaviorState RunChild(Blackboard* pBlackBoard, bool isResuming);
+	//True when the decorator returned Running on the previous tick of the tree. A branch that was left
+	//without an Abort, e.g. by a tree that does not resume or a preempted utility action, starts over
+	bool WasRunning() const;
+	//Takes a slot in the timer table of the context
+	void BindTimer(BehaviorTreeContext* pContext);
+	BehaviorTimerTable::Timer& GetTimer() const { return m_pContext->timers.Get(m_TimerSlot); }
+	float GetTime() const { return m_pContext->scheduler.GetTime(); }
+};
+
+//--- COOLDOWN ---
+//Fails without running its child for a number of seconds after the child finished
+class BehaviorCooldown : public BehaviorDecorator
+{
+public:
+	explicit BehaviorCooldown(float seconds, IBehavior* pChildBehavior)
+		: BehaviorDecorator(pChildBehavior), m_Seconds(seconds) {}
+	virtual ~BehaviorCooldown() = default;
+
+	virtual bool ShouldAbortLowerPriority(Blackboard* pBlackBoard) override;
+	virtual void BindContext(BehaviorTreeContext* pContext) override;
+	virtual const char* GetTypeName() const override { return "Cooldown"; }
+
+private:
+	float m_Seconds = 0.f;
+
+	virtual BehaviorState Tick(Blackboard* pBlackBoard, bool isResuming) override;
+	bool IsCoolingDown() const;
+};
+
+//--- RATE LIMIT ---
+//Starts its child at most a number of times per second and fails in between. Unlike a tick rate node
+//it does not repeat the last result, so a selector moves on to its next child. A running child keeps the frame rate.
+class BehaviorRateLimit : public BehaviorDecorator
+{
+public:
+	explicit BehaviorRateLimit(float ticksPerSecond, IBehavior* pChildBehavior)
+		: BehaviorDecorator(pChildBehavior), m_Interval(ticksPerSecond > 0.f ? 1.f / ticksPerSecond : 0.f) {}
+	virtual ~BehaviorRateLimit() = default;
+
+	virtual bool ShouldAbortLowerPriority(Blackboard* pBlackBoard) override;
+	virtual void BindContext(BehaviorTreeContext* pContext) override;
+	virtual const char* GetTypeName() const override { return "RateLimit"; }
+
+private:
+	float m_Interval = 0.f;
+
+	virtual BehaviorState Tick(Blackboard* pBlackBoard, bool isResuming) override;
+	bool IsLimited() const;
+};
+
+//--- TIMEOUT ---
+//Aborts its child and fails once the child has been running for a number of seconds
+class BehaviorTimeout : public BehaviorDecorator
+{
+public:
+	explicit BehaviorTimeout(float seconds, IBehavior* pChildBehavior)
+		: BehaviorDecorator(pChildBehavior), m_Seconds(seconds) {}
+	virtual ~BehaviorTimeout() = default;
+
+	virtual void BindContext(BehaviorTreeContext* pContext) override;
+	virtual const char* GetTypeName() const override { return "Timeout"; }
+
+private:
+	float m_Seconds = 0.f;
+
+	virtual BehaviorState Tick(Blackboard* pBlackBoard, bool isResuming) override;
+};
+
+//--- RETRY ---
+//Runs again after its child failed, on the next tick, until the child failed a number of times in a row.
+//Returns Running while attempts are left, so a resuming tree comes back to it
+class BehaviorRetry : public BehaviorDecorator
+{
+public:
+	explicit BehaviorRetry(uint32_t attemptCount, IBehavior* pChildBehavior)
+		: BehaviorDecorator(pChildBehavior), m_AttemptCount(attemptCount) {}
+	virtual ~BehaviorRetry() = default;
+
+	virtual void Abort() override;
+	virtual void BindContext(BehaviorTreeContext* pContext) override;
+	virtual const char* GetTypeName() const override { return "Retry"; }
+
+private:
+	uint32_t m_AttemptCount = 1;
+	bool m_IsRetrying = false; //The child failed, it starts over instead of being resumed
+
+	virtual BehaviorState Tick(Blackboard* pBlackBoard, bool isResuming) override;
+};
+
+//--- INVERTER ---
+//Swaps success and failure of its child, running stays running
+class BehaviorInverter : public BehaviorDecorator
+{
+public:
+	explicit BehaviorInverter(IBehavior* pChildBehavior)
+		: BehaviorDecorator(pChildBehavior) {}
+	virtual ~BehaviorInverter() = default;
+
+	virtual const char* GetTypeName() const override { return "Inverter"; }
+	virtual bool IsReadOnly() const override { return m_pChildBehavior->IsReadOnly(); }
+	virtual BehaviorState ExecuteReadOnly(const BlackboardView& view) const override { return Invert(m_pChildBehavior->ExecuteReadOnly(view)); }
+
+	static BehaviorState Invert(BehaviorState state);
+
+private:
+	virtual BehaviorState Tick(Blackboard* pBlackBoard, bool isResuming) override { return Invert(RunChild(pBlackBoard, isResuming)); }
+};
+
+//--- FORCE SUCCESS ---
+//Succeeds whenever its child finished, running stays running
+class BehaviorForceSuccess : public BehaviorDecorator
+{
+public:
+	explicit BehaviorForceSuccess(IBehavior* pChildBehavior)
+		: BehaviorDecorator(pChildBehavior) {}
+	virtual ~BehaviorForceSuccess() = default;
+
+	virtual const char* GetTypeName() const override { return "ForceSuccess"; }
+	virtual bool IsReadOnly() const override { return m_pChildBehavior->IsReadOnly(); }
+	virtual BehaviorState ExecuteReadOnly(const BlackboardView& view) const override { return Force(m_pChildBehavior->ExecuteReadOnly(view)); }
+
+	static BehaviorState Force(BehaviorState state) { return state == BehaviorState::Running ? state : BehaviorState::Success; }
+
+private:
+	virtual BehaviorState Tick(Blackboard* pBlackBoard, bool isResuming) override { return Force(RunChild(pBlackBoard, isResuming)); }
+};
+#pragma endregion
+
+//-----------------------------------------------------------------
+// BEHAVIOR TREE LEAF (IBehavior)
+//-----------------------------------------------------------------
+//Leaves declare the blackboard keys they use when they are built
+class BehaviorLeaf : public IBehavior
+{
+public:
+	explicit BehaviorLeaf(std::vector<BlackboardDependency> dependencies) : m_Dependencies(dependencies) {}
+	virtual bool ValidateDependencies(const Blackboard* pBlackBoard) const override;
+
+	const std::vector<BlackboardDependency>& GetDependencies() const { return m_Dependencies; }
+	//Reports every key of the list the blackboard is missing
+	static bool CheckDependencies(const Blackboard* pBlackBoard, const std::vector<BlackboardDependency>& dependencies);
+
+private:
+	std::vector<BlackboardDependency> m_Dependencies = {};
+};
+
 //-----------------------------------------------------------------
 // BEHAVIOR TREE CONDITIONAL (IBehavior)
 //-----------------------------------------------------------------
-class BehaviorConditional : public IBehavior
+class BehaviorConditional : public BehaviorLeaf
 {
 public:
-	explicit BehaviorConditional(std::function<bool(Blackboard*)> fp) : m_fpConditional(fp) {}
+	explicit BehaviorConditional(std::function<bool(Blackboard*)> fp, std::vector<BlackboardDependency> dependencies = {})
+		: BehaviorLeaf(dependencies), m_fpConditional(fp) {}
 	virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+	virtual bool Flatten(FlatBehaviorTree& flatTree) const override;
+	virtual void BindContext(BehaviorTreeContext* pContext) override { m_MemoBinding = pContext->conditionMemo.Bind(m_fpConditional); }
+	virtual const char* GetTypeName() const override { return "Conditional"; }
 
 private:
 	std::function<bool(Blackboard*)> m_fpConditional = nullptr;
+	ConditionMemo::Binding m_MemoBinding{};
 };
 
-class BehaviorNotConditional : public IBehavior
+class BehaviorNotConditional : public BehaviorLeaf
 {
 public:
-	explicit BehaviorNotConditional(std::function<bool(Blackboard*)> fp) : m_fpConditional(fp) {}
+	explicit BehaviorNotConditional(std::function<bool(Blackboard*)> fp, std::vector<BlackboardDependency> dependencies = {})
+		: BehaviorLeaf(dependencies), m_fpConditional(fp) {}
 	virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+	virtual bool Flatten(FlatBehaviorTree& flatTree) const override;
+	virtual void BindContext(BehaviorTreeContext* pContext) override { m_MemoBinding = pContext->conditionMemo.Bind(m_fpConditional); }
+	virtual const char* GetTypeName() const override { return "NotConditional"; }
 
 private:
 	std::function<bool(Blackboard*)> m_fpConditional = nullptr;
+	ConditionMemo::Binding m_MemoBinding{};
 };
 
 
+//Condition that only reads, so it can run on a worker thread under a BehaviorParallel
+class BehaviorViewConditional : public BehaviorLeaf
+{
+public:
+	using Condition = bool(*)(const BlackboardView&);
+
+	explicit BehaviorViewConditional(Condition fpConditional, std::vector<BlackboardDependency> dependencies = {})
+		: BehaviorLeaf(dependencies), m_fpConditional(fpConditional) {}
+	virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+	virtual bool IsReadOnly() const override { return true; }
+	virtual BehaviorState ExecuteReadOnly(const BlackboardView& view) const override;
+	virtual const char* GetTypeName() const override { return "ViewConditional"; }
+
+private:
+	Condition m_fpConditional = nullptr;
+};
+
 //-----------------------------------------------------------------
 // BEHAVIOR TREE ACTION (IBehavior)
 //-----------------------------------------------------------------
-class BehaviorAction : public IBehavior
+class BehaviorAction : public BehaviorLeaf
 {
 public:
-	explicit BehaviorAction(std::function<BehaviorState(Blackboard*)> fp) : m_fpAction(fp) {}
+	explicit BehaviorAction(std::function<BehaviorState(Blackboard*)> fp, std::vector<BlackboardDependency> dependencies = {})
+		: BehaviorLeaf(dependencies), m_fpAction(fp) {}
 	virtual BehaviorState Execute(Blackboard* pBlackBoard) override;
+	virtual bool Flatten(FlatBehaviorTree& flatTree) const override;
+	virtual const char* GetTypeName() const override { return "Action"; }
 
 private:
 	std::function<BehaviorState(Blackboard*)> m_fpAction = nullptr;
@@ -133,7 +722,12 @@ class BehaviorTree final : public IDecisionMaking
 {
 public:
 	explicit BehaviorTree(Blackboard* pBlackBoard, IBehavior* pRootBehavior)
-		: m_pBlackBoard(pBlackBoard), m_pRootBehavior(pRootBehavior) {};
+		: m_pBlackBoard(pBlackBoard), m_pRootBehavior(pRootBehavior)
+	{
+		BindContext();
+		BEHAVIOR_PROFILE(m_Profiler.Register(m_pRootBehavior));
+		BEHAVIOR_TRACE(m_Trace.Register(m_pRootBehavior));
+	};
 	~BehaviorTree()
 	{
 		SAFE_DELETE(m_pRootBehavior);
@@ -148,15 +742,85 @@ public:
 			return;
 		}
 
-		m_CurrentState = m_pRootBehavior->Execute(m_pBlackBoard);
+		//Changes of the previous tick are delivered in one batch before deciding
+		m_pBlackBoard->DispatchNotifications();
+		m_Context.conditionMemo.NextTick();
+		m_Context.scheduler.Advance(deltaTime);
+		BEHAVIOR_TRACE(m_Trace.BeginFrame(m_Context.scheduler.GetTime()));
+
+		//A running branch is continued, higher priority branches only come back through their observers
+		if (m_IsResumingRunning && m_CurrentState == BehaviorState::Running)
+			m_CurrentState = m_pRootBehavior->ResumeProfiled(m_pBlackBoard);
+		else
+			m_CurrentState = m_pRootBehavior->ExecuteProfiled(m_pBlackBoard);
+		BEHAVIOR_PROFILE(m_Profiler.EndFrame());
+	}
+	void SetResumeRunning(bool isResumingRunning)
+	{
+		m_IsResumingRunning = isResumingRunning;
+		if (m_pRootBehavior != nullptr)
+			m_pRootBehavior->Abort();
 	}
 	Blackboard* GetBlackboard() const
 	{
 		return m_pBlackBoard;
 	}
+	bool ValidateDependencies() const
+	{
+		return m_pRootBehavior != nullptr && m_pRootBehavior->ValidateDependencies(m_pBlackBoard);
+	}
+	IBehavior* GetRootBehavior() const
+	{
+		return m_pRootBehavior;
+	}
+	//Conditions that give the same result for a whole tick, each runs at most once per tick
+	void SetPureConditions(const std::vector<ConditionMemo::Condition>& pureConditions)
+	{
+		m_Context.conditionMemo.SetPureConditions(pureConditions);
+		BindContext();
+	}
+	const ConditionMemo& GetConditionMemo() const
+	{
+		return m_Context.conditionMemo;
+	}
+	//Pool the parallel nodes of the tree run on, not owned
+	void SetWorkerPool(WorkerPool* pWorkerPool)
+	{
+		m_Context.pWorkerPool = pWorkerPool;
+		BindContext();
+	}
+#if CONFIG_PROFILE_BEHAVIOR_TREE
+	const BehaviorProfiler& GetProfiler() const
+	{
+		return m_Profiler;
+	}
+#endif
+#if CONFIG_TRACE_BEHAVIOR_TREE
+	BehaviorTrace& GetTrace()
+	{
+		return m_Trace;
+	}
+#endif
 
 private:
 	BehaviorState m_CurrentState = BehaviorState::Failure;
 	Blackboard* m_pBlackBoard = nullptr;
 	IBehavior* m_pRootBehavior = nullptr;
+	bool m_IsResumingRunning = false;
+	BehaviorTreeContext m_Context{};
+#if CONFIG_PROFILE_BEHAVIOR_TREE
+	BehaviorProfiler m_Profiler{};
+#endif
+#if CONFIG_TRACE_BEHAVIOR_TREE
+	BehaviorTrace m_Trace{};
+#endif
+
+	void BindContext()
+	{
+		// Binding again hands out the same phases and timers
+		m_Context.scheduler.ResetPhases();
+		m_Context.timers.Clear();
+		if (m_pRootBehavior != nullptr)
+			m_pRootBehavior->BindContext(&m_Context);
+	}
 };
\ No newline at end of file
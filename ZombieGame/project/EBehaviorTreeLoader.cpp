@@ -0,0 +1,1089 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "EBehaviorTreeLoader.h"
+#include "BlackboardSerializer.h"
+
+#include <unordered_set>
+#include <iterator>
+#include <limits>
+#include <numeric>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
+//-----------------------------------------------------------------
+// BEHAVIOR REGISTRY
+//-----------------------------------------------------------------
+void BehaviorRegistry::AddCondition(const std::string& name, Condition fpCondition, std::vector<BlackboardDependency> dependencies)
+{
+	m_Conditions[name] = Entry<Condition>{ fpCondition, dependencies };
+}
+
+void BehaviorRegistry::AddAction(const std::string& name, Action fpAction, std::vector<BlackboardDependency> dependencies)
+{
+	m_Actions[name] = Entry<Action>{ fpAction, dependencies };
+}
+
+void BehaviorRegistry::AddEvaluation(const std::string& name, Evaluation fpEvaluation, std::vector<BlackboardDependency> dependencies)
+{
+	m_Evaluations[name] = Entry<Evaluation>{ fpEvaluation, dependencies };
+}
+
+const BehaviorRegistry::Entry<BehaviorRegistry::Condition>* BehaviorRegistry::FindCondition(const std::string& name) const
+{
+	const auto it = m_Conditions.find(name);
+	return it != m_Conditions.end() ? &it->second : nullptr;
+}
+
+const BehaviorRegistry::Entry<BehaviorRegistry::Action>* BehaviorRegistry::FindAction(const std::string& name) const
+{
+	const auto it = m_Actions.find(name);
+	return it != m_Actions.end() ? &it->second : nullptr;
+}
+
+const BehaviorRegistry::Entry<BehaviorRegistry::Evaluation>* BehaviorRegistry::FindEvaluation(const std::string& name) const
+{
+	const auto it = m_Evaluations.find(name);
+	return it != m_Evaluations.end() ? &it->second : nullptr;
+}
+
+namespace
+{
+	//-----------------------------------------------------------------
+	// JSON
+	//-----------------------------------------------------------------
+	//Just enough JSON for tree descriptions, objects keep their keys in file order
+	struct JsonValue
+	{
+		enum class Type
+		{
+			Null,
+			Boolean,
+			Number,
+			String,
+			Array,
+			Object
+		};
+
+		Type type = Type::Null;
+		bool boolean = false;
+		double number = 0.0;
+		std::string string{};
+		std::vector<JsonValue> elements{}; //Items of an array, values of an object
+		std::vector<std::string> keys{}; //Keys of an object, one per element
+
+		const JsonValue* Find(const char* pKey) const
+		{
+			for (size_t i{}; i < keys.size(); ++i)
+			{
+				if (keys[i] == pKey)
+					return &elements[i];
+			}
+			return nullptr;
+		}
+	};
+
+	class JsonParser final
+	{
+	public:
+		explicit JsonParser(const std::string& json) : m_pCurrent(json.c_str()), m_pEnd(json.c_str() + json.size()) {}
+
+		bool Parse(JsonValue& value)
+		{
+			if (!ParseValue(value, 0))
+				return false;
+
+			SkipWhitespace();
+			return m_pCurrent == m_pEnd || Fail("unexpected text after the root value");
+		}
+
+	private:
+		static constexpr int MaxDepth = 256;
+
+		const char* m_pCurrent;
+		const char* m_pEnd;
+		int m_Line = 1;
+
+		bool Fail(const char* pMessage) const
+		{
+			printf("WARNING: Behavior tree JSON line %d: %s \n", m_Line, pMessage);
+			return false;
+		}
+
+		void SkipWhitespace()
+		{
+			while (m_pCurrent != m_pEnd && (*m_pCurrent == ' ' || *m_pCurrent == '\t' || *m_pCurrent == '\r' || *m_pCurrent == '\n'))
+			{
+				m_Line += *m_pCurrent == '\n' ? 1 : 0;
+				++m_pCurrent;
+			}
+		}
+
+		bool Consume(char expected)
+		{
+			SkipWhitespace();
+			if (m_pCurrent == m_pEnd || *m_pCurrent != expected)
+				return false;
+
+			++m_pCurrent;
+			return true;
+		}
+
+		bool ParseValue(JsonValue& value, int depth)
+		{
+			if (depth > MaxDepth)
+				return Fail("nested too deep");
+
+			SkipWhitespace();
+			if (m_pCurrent == m_pEnd)
+				return Fail("unexpected end of file");
+
+			switch (*m_pCurrent)
+			{
+			case '{':
+				value.type = JsonValue::Type::Object;
+				++m_pCurrent;
+				if (Consume('}'))
+					return true;
+				do
+				{
+					SkipWhitespace();
+					value.keys.emplace_back();
+					value.elements.emplace_back();
+					if (!ParseString(value.keys.back()))
+						return false;
+					if (!Consume(':'))
+						return Fail("expected ':' after an object key");
+					if (!ParseValue(value.elements.back(), depth + 1))
+						return false;
+				} while (Consume(','));
+				return Consume('}') || Fail("expected ',' or '}' in an object");
+			case '[':
+				value.type = JsonValue::Type::Array;
+				++m_pCurrent;
+				if (Consume(']'))
+					return true;
+				do
+				{
+					value.elements.emplace_back();
+					if (!ParseValue(value.elements.back(), depth + 1))
+						return false;
+				} while (Consume(','));
+				return Consume(']') || Fail("expected ',' or ']' in an array");
+			case '"':
+				value.type = JsonValue::Type::String;
+				return ParseString(value.string);
+			case 't':
+				value.type = JsonValue::Type::Boolean;
+				value.boolean = true;
+				return ParseLiteral("true");
+			case 'f':
+				value.type = JsonValue::Type::Boolean;
+				return ParseLiteral("false");
+			case 'n':
+				return ParseLiteral("null");
+			default:
+				value.type = JsonValue::Type::Number;
+				return ParseNumber(value.number);
+			}
+		}
+
+		bool ParseString(std::string& string)
+		{
+			if (m_pCurrent == m_pEnd || *m_pCurrent != '"')
+				return Fail("expected a string");
+
+			++m_pCurrent;
+			while (m_pCurrent != m_pEnd && *m_pCurrent != '"')
+			{
+				const char c = *m_pCurrent++;
+				if (static_cast<unsigned char>(c) < 0x20)
+					return Fail("control character in a string");
+				if (c != '\\')
+				{
+					string += c;
+					continue;
+				}
+
+				if (m_pCurrent == m_pEnd)
+					break;
+				switch (*m_pCurrent++)
+				{
+				case '"': string += '"'; break;
+				case '\\': string += '\\'; break;
+				case '/': string += '/'; break;
+				case 'b': string += '\b'; break;
+				case 'f': string += '\f'; break;
+				case 'n': string += '\n'; break;
+				case 'r': string += '\r'; break;
+				case 't': string += '\t'; break;
+				case 'u':
+				{
+					// Basic plane only, names and comments do not need more
+					if (m_pEnd - m_pCurrent < 4)
+						return Fail("incomplete \\u escape");
+					const std::string digits{ m_pCurrent, m_pCurrent + 4 };
+					char* pDigitsEnd = nullptr;
+					const unsigned long codePoint = strtoul(digits.c_str(), &pDigitsEnd, 16);
+					if (pDigitsEnd != digits.c_str() + 4)
+						return Fail("invalid \\u escape");
+					m_pCurrent += 4;
+
+					if (codePoint < 0x80)
+					{
+						string += static_cast<char>(codePoint);
+					}
+					else if (codePoint < 0x800)
+					{
+						string += static_cast<char>(0xC0 | (codePoint >> 6));
+						string += static_cast<char>(0x80 | (codePoint & 0x3F));
+					}
+					else
+					{
+						string += static_cast<char>(0xE0 | (codePoint >> 12));
+						string += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+						string += static_cast<char>(0x80 | (codePoint & 0x3F));
+					}
+					break;
+				}
+				default:
+					return Fail("invalid escape in a string");
+				}
+			}
+
+			if (m_pCurrent == m_pEnd)
+				return Fail("unterminated string");
+
+			++m_pCurrent;
+			return true;
+		}
+
+		bool ParseNumber(double& number)
+		{
+			// strtod also reads hex, inf and nan, JSON only allows a sign and digits up front
+			if (*m_pCurrent != '-' && (*m_pCurrent < '0' || *m_pCurrent > '9'))
+				return Fail("unexpected character");
+
+			// The text is a std::string, so strtod stops at its terminator at the latest
+			char* pNumberEnd = nullptr;
+			number = strtod(m_pCurrent, &pNumberEnd);
+			if (pNumberEnd == m_pCurrent)
+				return Fail("invalid number");
+
+			m_pCurrent = pNumberEnd;
+			return true;
+		}
+
+		bool ParseLiteral(const char* pLiteral)
+		{
+			const size_t length = strlen(pLiteral);
+			if (static_cast<size_t>(m_pEnd - m_pCurrent) < length || strncmp(m_pCurrent, pLiteral, length) != 0)
+				return Fail("unexpected character");
+
+			m_pCurrent += length;
+			return true;
+		}
+	};
+
+	//-----------------------------------------------------------------
+	// COMPILER
+	//-----------------------------------------------------------------
+	const char* const g_NodeTypeNames[] = { "Selector", "Sequence", "PartialSequence", "Parallel", "Observer", "TickRate", "Conditional", "NotConditional", "ViewConditional", "Action", "Cooldown", "RateLimit", "Timeout", "Retry", "Inverter", "ForceSuccess" };
+	const char* const g_PolicyNames[] = { "RequireOne", "RequireAll" };
+
+	//Intervals and rates are divided by, so they have to be above 0. Durations can be 0, a retry needs one attempt
+	bool IsValidParameter(BehaviorNodeType type, double parameter)
+	{
+		if (!std::isfinite(parameter))
+			return false;
+
+		switch (type)
+		{
+		case BehaviorNodeType::TickRate:
+		case BehaviorNodeType::RateLimit:
+			return parameter > 0.0;
+		case BehaviorNodeType::Cooldown:
+		case BehaviorNodeType::Timeout:
+			return parameter >= 0.0;
+		case BehaviorNodeType::Retry:
+			return parameter >= 1.0 && parameter < static_cast<double>(std::numeric_limits<uint32_t>::max());
+		default:
+			return true;
+		}
+	}
+
+	const char* GetParameterRange(BehaviorNodeType type)
+	{
+		switch (type)
+		{
+		case BehaviorNodeType::TickRate:
+		case BehaviorNodeType::RateLimit:
+			return "above 0";
+		case BehaviorNodeType::Retry:
+			return "of 1 or more";
+		default:
+			return "of 0 or more";
+		}
+	}
+
+	//Appends a JSON tree in pre-order, every name is checked against the registry
+	class BehaviorTreeCompiler final
+	{
+	public:
+		explicit BehaviorTreeCompiler(const BehaviorRegistry& registry) : m_Registry(registry) {}
+
+		bool CompileNode(const JsonValue& node, const std::string& parentPath, size_t childOrdinal)
+		{
+			if (node.type != JsonValue::Type::Object)
+				return Fail(parentPath + '[' + std::to_string(childOrdinal) + ']', "is not an object");
+
+			const JsonValue* pType = node.Find("type");
+			const JsonValue* pName = node.Find("name");
+			if (pType == nullptr || pType->type != JsonValue::Type::String)
+				return Fail(parentPath + '[' + std::to_string(childOrdinal) + ']', "has no type");
+			if (pName != nullptr && pName->type != JsonValue::Type::String)
+				return Fail(parentPath + '[' + std::to_string(childOrdinal) + ']', "has a name that is not a string");
+
+			// Named like the profiler names its frames
+			const std::string frame = pName != nullptr ? pName->string : pType->string + '[' + std::to_string(childOrdinal) + ']';
+			const std::string path = parentPath.empty() ? frame : parentPath + '/' + frame;
+
+			const auto typeIt = std::find_if(std::begin(g_NodeTypeNames), std::end(g_NodeTypeNames), [pType](const char* pTypeName) { return pType->string == pTypeName; });
+			if (typeIt == std::end(g_NodeTypeNames))
+				return Fail(path, "has unknown type '" + pType->string + "'");
+
+			BehaviorTreeFileNode fileNode{};
+			fileNode.type = static_cast<BehaviorNodeType>(typeIt - std::begin(g_NodeTypeNames));
+			fileNode.successPolicy = static_cast<uint8_t>(ParallelPolicy::RequireAll);
+			fileNode.failurePolicy = static_cast<uint8_t>(ParallelPolicy::RequireOne);
+			fileNode.name = pName != nullptr ? AddString(pName->string) : BehaviorTreeFileNode::NoString;
+			fileNode.function = BehaviorTreeFileNode::NoString;
+
+			const JsonValue* pOrderIndependent = node.Find("orderIndependent");
+			if (pOrderIndependent != nullptr)
+			{
+				if (pOrderIndependent->type != JsonValue::Type::Boolean)
+					return Fail(path, "has an \"orderIndependent\" that is not true or false");
+				if (fileNode.type != BehaviorNodeType::Selector && fileNode.type != BehaviorNodeType::Sequence)
+					return Fail(path, "can not be order independent, only a selector or sequence can");
+				fileNode.flags = pOrderIndependent->boolean ? BehaviorTreeFileNode::OrderIndependent : 0;
+			}
+
+			std::vector<const JsonValue*> children{};
+			switch (fileNode.type)
+			{
+			case BehaviorNodeType::Parallel:
+				if (!ReadPolicy(node, "success", path, fileNode.successPolicy) || !ReadPolicy(node, "failure", path, fileNode.failurePolicy))
+					return false;
+				// Parallel children are listed like any composite's
+			case BehaviorNodeType::Selector:
+			case BehaviorNodeType::Sequence:
+			case BehaviorNodeType::PartialSequence:
+			{
+				const JsonValue* pChildren = node.Find("children");
+				if (pChildren == nullptr || pChildren->type != JsonValue::Type::Array)
+					return Fail(path, "has no \"children\" array");
+				for (const JsonValue& child : pChildren->elements)
+				{
+					children.push_back(&child);
+				}
+				break;
+			}
+			case BehaviorNodeType::Observer:
+			case BehaviorNodeType::TickRate:
+			case BehaviorNodeType::Cooldown:
+			case BehaviorNodeType::RateLimit:
+			case BehaviorNodeType::Timeout:
+			case BehaviorNodeType::Retry:
+			case BehaviorNodeType::Inverter:
+			case BehaviorNodeType::ForceSuccess:
+			{
+				const JsonValue* pChild = node.Find("child");
+				if (pChild == nullptr)
+					return Fail(path, "has no \"child\"");
+				children.push_back(pChild);
+
+				switch (fileNode.type)
+				{
+				case BehaviorNodeType::Observer:
+					if (!ReadFunction(node, "condition", path, fileNode.function))
+						return false;
+					break;
+				case BehaviorNodeType::TickRate:
+					if (!ReadParameter(node, "interval", fileNode.type, path, "seconds", fileNode.parameter))
+						return false;
+					break;
+				case BehaviorNodeType::Cooldown:
+				case BehaviorNodeType::Timeout:
+					if (!ReadParameter(node, "seconds", fileNode.type, path, "seconds", fileNode.parameter))
+						return false;
+					break;
+				case BehaviorNodeType::RateLimit:
+					if (!ReadParameter(node, "rate", fileNode.type, path, "ticks per second", fileNode.parameter))
+						return false;
+					break;
+				case BehaviorNodeType::Retry:
+					if (!ReadParameter(node, "attempts", fileNode.type, path, "attempts", fileNode.parameter))
+						return false;
+					fileNode.parameter = std::floor(fileNode.parameter);
+					break;
+				default:
+					break;
+				}
+				break;
+			}
+			case BehaviorNodeType::Conditional:
+			case BehaviorNodeType::NotConditional:
+			case BehaviorNodeType::ViewConditional:
+				if (!ReadFunction(node, "condition", path, fileNode.function))
+					return false;
+				break;
+			case BehaviorNodeType::Action:
+				if (!ReadFunction(node, "action", path, fileNode.function))
+					return false;
+				break;
+			}
+
+			// Check the leaf before any child is appended, its kind decides which table the name is in
+			if (fileNode.function != BehaviorTreeFileNode::NoString)
+			{
+				const std::string function{ m_Strings.data() + fileNode.function };
+				const bool isRegistered = fileNode.type == BehaviorNodeType::Action ? m_Registry.FindAction(function) != nullptr
+					: fileNode.type == BehaviorNodeType::ViewConditional ? m_Registry.FindEvaluation(function) != nullptr
+					: m_Registry.FindCondition(function) != nullptr;
+				if (!isRegistered)
+					return Fail(path, "uses '" + function + "', which is not registered as " + (fileNode.type == BehaviorNodeType::Action ? "an action" : fileNode.type == BehaviorNodeType::ViewConditional ? "an evaluation" : "a condition"));
+			}
+
+			fileNode.childCount = static_cast<uint32_t>(children.size());
+			m_Nodes.push_back(fileNode);
+			for (size_t i{}; i < children.size(); ++i)
+			{
+				if (!CompileNode(*children[i], path, i))
+					return false;
+			}
+			return true;
+		}
+
+		void Write(std::vector<char>& buffer) const
+		{
+			buffer.clear();
+			BlackboardWriter writer{ buffer };
+			writer.WriteValue(BehaviorTreeFileHeader{ BEHAVIOR_TREE_MAGIC, BEHAVIOR_TREE_VERSION, static_cast<uint32_t>(m_Nodes.size()), static_cast<uint32_t>(m_Strings.size()) });
+			writer.Write(m_Nodes.data(), m_Nodes.size() * sizeof(BehaviorTreeFileNode));
+			writer.Write(m_Strings.data(), m_Strings.size());
+		}
+
+	private:
+		const BehaviorRegistry& m_Registry;
+		std::vector<BehaviorTreeFileNode> m_Nodes{};
+		std::vector<char> m_Strings{};
+		std::unordered_map<std::string, uint32_t> m_StringOffsets{};
+
+		static bool Fail(const std::string& path, const std::string& message)
+		{
+			printf("WARNING: Behavior tree node '%s' %s \n", path.c_str(), message.c_str());
+			return false;
+		}
+
+		//Equal names share one entry of the string table
+		uint32_t AddString(const std::string& string)
+		{
+			const auto it = m_StringOffsets.find(string);
+			if (it != m_StringOffsets.end())
+				return it->second;
+
+			const uint32_t offset = static_cast<uint32_t>(m_Strings.size());
+			m_Strings.insert(m_Strings.end(), string.begin(), string.end());
+			m_Strings.push_back('\0');
+			m_StringOffsets.emplace(string, offset);
+			return offset;
+		}
+
+		bool ReadFunction(const JsonValue& node, const char* pKey, const std::string& path, uint32_t& function)
+		{
+			const JsonValue* pFunction = node.Find(pKey);
+			if (pFunction == nullptr || pFunction->type != JsonValue::Type::String)
+				return Fail(path, std::string{ "has no \"" } + pKey + '"');
+
+			function = AddString(pFunction->string);
+			return true;
+		}
+
+		bool ReadParameter(const JsonValue& node, const char* pKey, BehaviorNodeType type, const std::string& path, const char* pUnit, float& parameter)
+		{
+			const JsonValue* pParameter = node.Find(pKey);
+			if (pParameter == nullptr || pParameter->type != JsonValue::Type::Number || !IsValidParameter(type, pParameter->number))
+				return Fail(path, std::string{ "needs \"" } + pKey + "\" " + GetParameterRange(type) + " " + pUnit);
+
+			parameter = static_cast<float>(pParameter->number);
+			return true;
+		}
+
+		bool ReadPolicy(const JsonValue& node, const char* pKey, const std::string& path, uint8_t& policy)
+		{
+			const JsonValue* pPolicy = node.Find(pKey);
+			if (pPolicy == nullptr)
+				return true;
+
+			for (size_t i{}; i < std::extent<decltype(g_PolicyNames)>::value; ++i)
+			{
+				if (pPolicy->type == JsonValue::Type::String && pPolicy->string == g_PolicyNames[i])
+				{
+					policy = static_cast<uint8_t>(i);
+					return true;
+				}
+			}
+			return Fail(path, std::string{ "has a \"" } + pKey + "\" policy that is not RequireOne or RequireAll");
+		}
+	};
+
+	//Nodes only keep a pointer to their name, which has to outlive the file it was read from
+	const char* InternName(const char* pName)
+	{
+		static std::unordered_set<std::string> s_Names{};
+		return s_Names.insert(pName).first->c_str();
+	}
+
+	//-----------------------------------------------------------------
+	// MAPPED FILE
+	//-----------------------------------------------------------------
+	//Read-only view of a whole file, the pages are only read when the loader touches them
+	class MappedFile final
+	{
+	public:
+		explicit MappedFile(const std::string& path)
+		{
+#ifdef _WIN32
+			m_File = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			LARGE_INTEGER size{};
+			if (m_File == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_File, &size) || size.QuadPart == 0)
+				return;
+
+			m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (m_Mapping == nullptr)
+				return;
+
+			m_pData = static_cast<const char*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+			m_Size = m_pData != nullptr ? static_cast<size_t>(size.QuadPart) : 0;
+#else
+			const int file = open(path.c_str(), O_RDONLY);
+			if (file < 0)
+				return;
+
+			struct stat status{};
+			if (fstat(file, &status) == 0 && status.st_size > 0)
+			{
+				void* pData = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+				if (pData != MAP_FAILED)
+				{
+					m_pData = static_cast<const char*>(pData);
+					m_Size = static_cast<size_t>(status.st_size);
+				}
+			}
+			close(file);
+#endif
+		}
+
+		~MappedFile()
+		{
+#ifdef _WIN32
+			if (m_pData != nullptr)
+				UnmapViewOfFile(m_pData);
+			if (m_Mapping != nullptr)
+				CloseHandle(m_Mapping);
+			if (m_File != INVALID_HANDLE_VALUE)
+				CloseHandle(m_File);
+#else
+			if (m_pData != nullptr)
+				munmap(const_cast<char*>(m_pData), m_Size);
+#endif
+		}
+
+		MappedFile(const MappedFile& other) = delete;
+		MappedFile& operator=(const MappedFile& other) = delete;
+
+		const char* GetData() const { return m_pData; }
+		size_t GetSize() const { return m_Size; }
+
+	private:
+#ifdef _WIN32
+		HANDLE m_File = INVALID_HANDLE_VALUE;
+		HANDLE m_Mapping = nullptr;
+#endif
+		const char* m_pData = nullptr;
+		size_t m_Size = 0;
+	};
+
+	//The header of a compiled tree whose nodes and string table fit in its size, nullptr after a warning
+	const BehaviorTreeFileHeader* CheckCompiledTree(const char* pData, size_t size)
+	{
+		// The nodes are read in place, a mapped file or a heap buffer is always aligned enough
+		if (pData == nullptr || size < sizeof(BehaviorTreeFileHeader) || reinterpret_cast<uintptr_t>(pData) % alignof(BehaviorTreeFileNode) != 0)
+		{
+			printf("WARNING: Compiled behavior tree is too small or not aligned \n");
+			return nullptr;
+		}
+
+		const BehaviorTreeFileHeader* pHeader = reinterpret_cast<const BehaviorTreeFileHeader*>(pData);
+		if (pHeader->magic != BEHAVIOR_TREE_MAGIC || pHeader->version != BEHAVIOR_TREE_VERSION)
+		{
+			printf("WARNING: Compiled behavior tree has version %u instead of %u, compile it again \n", pHeader->version, BEHAVIOR_TREE_VERSION);
+			return nullptr;
+		}
+
+		const size_t nodesSize = static_cast<size_t>(pHeader->nodeCount) * sizeof(BehaviorTreeFileNode);
+		const char* pStrings = pData + sizeof(BehaviorTreeFileHeader) + nodesSize;
+		if (pHeader->nodeCount == 0 || size != sizeof(BehaviorTreeFileHeader) + nodesSize + pHeader->stringTableSize
+			|| (pHeader->stringTableSize > 0 && pStrings[pHeader->stringTableSize - 1] != '\0'))
+		{
+			printf("WARNING: Compiled behavior tree is damaged \n");
+			return nullptr;
+		}
+		return pHeader;
+	}
+}
+
+//-----------------------------------------------------------------
+// BEHAVIOR TREE LOADER
+//-----------------------------------------------------------------
+IBehavior* BehaviorTreeLoader::LoadFile(const std::string& path) const
+{
+	const MappedFile file{ path };
+	if (file.GetData() == nullptr)
+	{
+		printf("WARNING: Could not open behavior tree '%s' \n", path.c_str());
+		return nullptr;
+	}
+
+	uint32_t magic{};
+	if (file.GetSize() >= sizeof(magic))
+		memcpy(&magic, file.GetData(), sizeof(magic));
+
+	// Anything that is not compiled is taken for JSON
+	if (magic == BEHAVIOR_TREE_MAGIC)
+		return Instantiate(file.GetData(), file.GetSize());
+	return LoadJson(std::string{ file.GetData(), file.GetSize() });
+}
+
+IBehavior* BehaviorTreeLoader::LoadJson(const std::string& json) const
+{
+	std::vector<char> buffer{};
+	if (!Compile(json, buffer))
+		return nullptr;
+
+	return Instantiate(buffer.data(), buffer.size());
+}
+
+IBehavior* BehaviorTreeLoader::Instantiate(const char* pData, size_t size) const
+{
+	const BehaviorTreeFileHeader* pHeader = CheckCompiledTree(pData, size);
+	if (pHeader == nullptr)
+		return nullptr;
+
+	const BehaviorTreeFileHeader& header = *pHeader;
+	const char* pStrings = pData + sizeof(BehaviorTreeFileHeader) + static_cast<size_t>(header.nodeCount) * sizeof(BehaviorTreeFileNode);
+	const BehaviorTreeFileNode* pNodes = reinterpret_cast<const BehaviorTreeFileNode*>(pData + sizeof(BehaviorTreeFileHeader));
+	uint32_t nodeIndex = 0;
+	IBehavior* pRootBehavior = InstantiateNode(pNodes, header.nodeCount, nodeIndex, pStrings, header.stringTableSize);
+	if (pRootBehavior != nullptr && nodeIndex != header.nodeCount)
+	{
+		printf("WARNING: Compiled behavior tree has %u nodes outside of its root \n", header.nodeCount - nodeIndex);
+		SAFE_DELETE(pRootBehavior);
+	}
+	return pRootBehavior;
+}
+
+IBehavior* BehaviorTreeLoader::InstantiateNode(const BehaviorTreeFileNode* pNodes, uint32_t nodeCount, uint32_t& nodeIndex, const char* pStrings, uint32_t stringTableSize) const
+{
+	if (nodeIndex >= nodeCount)
+	{
+		printf("WARNING: Compiled behavior tree ends inside a node \n");
+		return nullptr;
+	}
+
+	const BehaviorTreeFileNode& node = pNodes[nodeIndex++];
+	const char* pFunction = node.function < stringTableSize ? pStrings + node.function : "";
+
+	std::vector<IBehavior*> children{};
+	const auto fail = [&children](const std::string& message) -> IBehavior*
+	{
+		if (!message.empty())
+			printf("WARNING: Compiled behavior tree %s \n", message.c_str());
+		for (IBehavior* pChild : children)
+		{
+			delete pChild;
+		}
+		return nullptr;
+	};
+
+	// Every child is at least one more node
+	if (node.childCount > nodeCount - nodeIndex)
+		return fail("has a node with more children than nodes left");
+
+	children.reserve(node.childCount);
+	for (uint32_t i{}; i < node.childCount; ++i)
+	{
+		// The child already said what is wrong
+		IBehavior* pChild = InstantiateNode(pNodes, nodeCount, nodeIndex, pStrings, stringTableSize);
+		if (pChild == nullptr)
+			return fail("");
+		children.push_back(pChild);
+	}
+
+	const bool isComposite = node.type == BehaviorNodeType::Selector || node.type == BehaviorNodeType::Sequence
+		|| node.type == BehaviorNodeType::PartialSequence || node.type == BehaviorNodeType::Parallel;
+	const bool isDecorator = node.type == BehaviorNodeType::Observer || node.type == BehaviorNodeType::TickRate || node.type >= BehaviorNodeType::Cooldown;
+	if (!isComposite && children.size() != (isDecorator ? 1u : 0u))
+		return fail("has a node with " + std::to_string(children.size()) + " children where " + (isDecorator ? "one" : "none") + " belong");
+
+	// Checked again, a file written by hand or by an older compiler can hold any float
+	if (!IsValidParameter(node.type, node.parameter))
+		return fail(std::string{ "has a " } + g_NodeTypeNames[static_cast<size_t>(node.type)] + " parameter of " + std::to_string(node.parameter) + ", it needs one " + GetParameterRange(node.type));
+
+	const std::string function{ pFunction };
+	IBehavior* pBehavior = nullptr;
+	switch (node.type)
+	{
+	case BehaviorNodeType::Selector:
+		pBehavior = new BehaviorSelector{ children };
+		break;
+	case BehaviorNodeType::Sequence:
+		pBehavior = new BehaviorSequence{ children };
+		break;
+	case BehaviorNodeType::PartialSequence:
+		pBehavior = new BehaviorPartialSequence{ children };
+		break;
+	case BehaviorNodeType::Parallel:
+		if (node.successPolicy > static_cast<uint8_t>(ParallelPolicy::RequireAll) || node.failurePolicy > static_cast<uint8_t>(ParallelPolicy::RequireAll))
+			return fail("has an unknown parallel policy");
+		pBehavior = new BehaviorParallel{ children, static_cast<ParallelPolicy>(node.successPolicy), static_cast<ParallelPolicy>(node.failurePolicy) };
+		break;
+	case BehaviorNodeType::Observer:
+	{
+		const BehaviorRegistry::Entry<BehaviorRegistry::Condition>* pEntry = m_Registry.FindCondition(function);
+		if (pEntry == nullptr)
+			return fail("observes '" + function + "', which is not registered, compile it again");
+		pBehavior = new BehaviorObserver(pEntry->fp, pEntry->dependencies, children.front());
+		break;
+	}
+	case BehaviorNodeType::TickRate:
+		pBehavior = new BehaviorTickRate(node.parameter, children.front());
+		break;
+	case BehaviorNodeType::Cooldown:
+		pBehavior = new BehaviorCooldown(node.parameter, children.front());
+		break;
+	case BehaviorNodeType::RateLimit:
+		pBehavior = new BehaviorRateLimit(node.parameter, children.front());
+		break;
+	case BehaviorNodeType::Timeout:
+		pBehavior = new BehaviorTimeout(node.parameter, children.front());
+		break;
+	case BehaviorNodeType::Retry:
+		pBehavior = new BehaviorRetry(static_cast<uint32_t>(node.parameter), children.front());
+		break;
+	case BehaviorNodeType::Inverter:
+		pBehavior = new BehaviorInverter(children.front());
+		break;
+	case BehaviorNodeType::ForceSuccess:
+		pBehavior = new BehaviorForceSuccess(children.front());
+		break;
+	case BehaviorNodeType::Conditional:
+	case BehaviorNodeType::NotConditional:
+	{
+		const BehaviorRegistry::Entry<BehaviorRegistry::Condition>* pEntry = m_Registry.FindCondition(function);
+		if (pEntry == nullptr)
+			return fail("uses condition '" + function + "', which is not registered, compile it again");
+		if (node.type == BehaviorNodeType::Conditional)
+			pBehavior = new BehaviorConditional(pEntry->fp, pEntry->dependencies);
+		else
+			pBehavior = new BehaviorNotConditional(pEntry->fp, pEntry->dependencies);
+		break;
+	}
+	case BehaviorNodeType::ViewConditional:
+	{
+		const BehaviorRegistry::Entry<BehaviorRegistry::Evaluation>* pEntry = m_Registry.FindEvaluation(function);
+		if (pEntry == nullptr)
+			return fail("uses evaluation '" + function + "', which is not registered, compile it again");
+		pBehavior = new BehaviorViewConditional(pEntry->fp, pEntry->dependencies);
+		break;
+	}
+	case BehaviorNodeType::Action:
+	{
+		const BehaviorRegistry::Entry<BehaviorRegistry::Action>* pEntry = m_Registry.FindAction(function);
+		if (pEntry == nullptr)
+			return fail("uses action '" + function + "', which is not registered, compile it again");
+		pBehavior = new BehaviorAction(pEntry->fp, pEntry->dependencies);
+		break;
+	}
+	default:
+		return fail("has an unknown node type " + std::to_string(static_cast<int>(node.type)));
+	}
+
+	if (node.name < stringTableSize)
+		pBehavior->SetName(InternName(pStrings + node.name));
+	return pBehavior;
+}
+
+bool BehaviorTreeLoader::Compile(const std::string& json, std::vector<char>& buffer) const
+{
+	JsonValue root{};
+	if (!JsonParser{ json }.Parse(root))
+		return false;
+
+	BehaviorTreeCompiler compiler{ m_Registry };
+	if (!compiler.CompileNode(root, "", 0))
+		return false;
+
+	compiler.Write(buffer);
+	return true;
+}
+
+bool BehaviorTreeLoader::CompileFile(const std::string& jsonPath, const std::string& compiledPath) const
+{
+	std::ifstream jsonFile{ jsonPath, std::ios::binary };
+	if (!jsonFile)
+	{
+		printf("WARNING: Could not open behavior tree '%s' \n", jsonPath.c_str());
+		return false;
+	}
+
+	const std::string json{ std::istreambuf_iterator<char>{ jsonFile }, std::istreambuf_iterator<char>{} };
+	std::vector<char> buffer{};
+	if (!Compile(json, buffer))
+	{
+		printf("WARNING: Behavior tree '%s' was not compiled \n", jsonPath.c_str());
+		return false;
+	}
+
+	std::ofstream compiledFile{ compiledPath, std::ios::binary };
+	if (!compiledFile.write(buffer.data(), buffer.size()))
+	{
+		printf("WARNING: Could not write compiled behavior tree to '%s' \n", compiledPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------
+// BEHAVIOR TREE OPTIMIZER
+//-----------------------------------------------------------------
+bool BehaviorTreeOptimizer::Optimize(std::vector<char>& buffer, bool apply, std::vector<BehaviorReorder>& reorders) const
+{
+	reorders.clear();
+	const BehaviorTreeFileHeader* pHeader = CheckCompiledTree(buffer.data(), buffer.size());
+	if (pHeader == nullptr)
+		return false;
+
+	const uint32_t nodeCount = pHeader->nodeCount;
+	const uint32_t stringTableSize = pHeader->stringTableSize;
+	BehaviorTreeFileNode* pNodes = reinterpret_cast<BehaviorTreeFileNode*>(buffer.data() + sizeof(BehaviorTreeFileHeader));
+	const char* pStrings = buffer.data() + sizeof(BehaviorTreeFileHeader) + static_cast<size_t>(nodeCount) * sizeof(BehaviorTreeFileNode);
+
+	// The whole tree is checked before a node moves, so a damaged buffer is left as it was
+	uint32_t nodeIndex = 0;
+	if (!OptimizeNode(pNodes, nodeCount, nodeIndex, pStrings, stringTableSize, "", 0, false, reorders))
+		return false;
+	if (nodeIndex != nodeCount)
+	{
+		printf("WARNING: Compiled behavior tree has %u nodes outside of its root \n", nodeCount - nodeIndex);
+		return false;
+	}
+
+	if (apply && !reorders.empty())
+	{
+		reorders.clear();
+		nodeIndex = 0;
+		OptimizeNode(pNodes, nodeCount, nodeIndex, pStrings, stringTableSize, "", 0, true, reorders);
+	}
+	return true;
+}
+
+bool BehaviorTreeOptimizer::OptimizeNode(BehaviorTreeFileNode* pNodes, uint32_t nodeCount, uint32_t& nodeIndex, const char* pStrings, uint32_t stringTableSize,
+	const std::string& parentPath, uint32_t childOrdinal, bool apply, std::vector<BehaviorReorder>& reorders) const
+{
+	if (nodeIndex >= nodeCount)
+	{
+		printf("WARNING: Compiled behavior tree ends inside a node \n");
+		return false;
+	}
+
+	const BehaviorTreeFileNode& node = pNodes[nodeIndex++];
+	if (static_cast<size_t>(node.type) >= std::extent<decltype(g_NodeTypeNames)>::value || node.childCount > nodeCount - nodeIndex)
+	{
+		printf("WARNING: Compiled behavior tree is damaged \n");
+		return false;
+	}
+
+	// Named like the profiler and the trace name their nodes
+	const auto getFrame = [pStrings, stringTableSize](const BehaviorTreeFileNode& frameNode, uint32_t ordinal)
+	{
+		return frameNode.name < stringTableSize
+			? std::string{ pStrings + frameNode.name }
+			: std::string{ g_NodeTypeNames[static_cast<size_t>(frameNode.type)] } + '[' + std::to_string(ordinal) + ']';
+	};
+	const std::string frame = getFrame(node, childOrdinal);
+	const std::string path = parentPath.empty() ? frame : parentPath + '/' + frame;
+
+	// Conditions are leaves, so the ones the composite starts with are the nodes right after it
+	BehaviorTreeFileNode* pConditions = pNodes + nodeIndex;
+	uint32_t conditionCount{};
+	if (node.flags & BehaviorTreeFileNode::OrderIndependent)
+	{
+		while (conditionCount < node.childCount && pConditions[conditionCount].childCount == 0
+			&& (pConditions[conditionCount].type == BehaviorNodeType::Conditional || pConditions[conditionCount].type == BehaviorNodeType::NotConditional
+				|| pConditions[conditionCount].type == BehaviorNodeType::ViewConditional))
+		{
+			++conditionCount;
+		}
+	}
+
+	BehaviorReorder reorder{ path };
+	const auto firstIt = conditionCount > 1 && m_Profile.frameCount > 0 ? m_Profile.nodes.find(path + '/' + getFrame(pConditions[0], 0)) : m_Profile.nodes.end();
+	if (firstIt != m_Profile.nodes.end() && firstIt->second.executions > 0)
+	{
+		// A sequence goes on when a condition succeeds, a selector when it fails
+		const bool isSequence = node.type == BehaviorNodeType::Sequence;
+		std::vector<double> passRates(conditionCount, 1.0);
+		std::vector<double> nanoseconds(conditionCount, 0.0);
+		bool hasTimes = false;
+		for (uint32_t i{}; i < conditionCount; ++i)
+		{
+			const auto statsIt = m_Profile.nodes.find(path + '/' + getFrame(pConditions[i], i));
+			if (statsIt == m_Profile.nodes.end() || statsIt->second.executions == 0)
+				continue;
+
+			// Never reached conditions keep a rate of 1 and go last, nothing is known about them
+			const BehaviorNodeStats& stats = statsIt->second;
+			passRates[i] = static_cast<double>(isSequence ? stats.successes : stats.failures) / stats.executions;
+			nanoseconds[i] = static_cast<double>(stats.inclusiveNs) / stats.executions;
+			hasTimes |= stats.inclusiveNs > 0;
+		}
+
+		const auto getKey = [&](uint32_t i)
+		{
+			return passRates[i] >= 1.0 ? std::numeric_limits<double>::infinity() : (hasTimes ? nanoseconds[i] : 1.0) / (1.0 - passRates[i]);
+		};
+		reorder.order.resize(conditionCount);
+		std::iota(reorder.order.begin(), reorder.order.end(), 0u);
+		std::stable_sort(reorder.order.begin(), reorder.order.end(), [&getKey](uint32_t left, uint32_t right) { return getKey(left) < getKey(right); });
+
+		// Per entry, a condition runs when every one in front of it let the composite go on
+		const auto getExpected = [&passRates](const std::vector<uint32_t>& order, const std::vector<double>& costs)
+		{
+			double expected{};
+			double reachRate = 1.0;
+			for (const uint32_t i : order)
+			{
+				expected += reachRate * (costs.empty() ? 1.0 : costs[i]);
+				reachRate *= passRates[i];
+			}
+			return expected;
+		};
+		std::vector<uint32_t> originalOrder(conditionCount);
+		std::iota(originalOrder.begin(), originalOrder.end(), 0u);
+		const double entriesPerTick = static_cast<double>(firstIt->second.executions) / m_Profile.frameCount;
+		reorder.evaluationsBefore = entriesPerTick * getExpected(originalOrder, {});
+		reorder.evaluationsAfter = entriesPerTick * getExpected(reorder.order, {});
+		reorder.nanosecondsBefore = hasTimes ? entriesPerTick * getExpected(originalOrder, nanoseconds) : 0.0;
+		reorder.nanosecondsAfter = hasTimes ? entriesPerTick * getExpected(reorder.order, nanoseconds) : 0.0;
+
+		const bool isCheaper = hasTimes ? reorder.nanosecondsAfter < reorder.nanosecondsBefore : reorder.evaluationsAfter < reorder.evaluationsBefore;
+		if (reorder.order != originalOrder && isCheaper)
+		{
+			for (const uint32_t i : reorder.order)
+			{
+				reorder.conditions.push_back(pConditions[i].function < stringTableSize ? pStrings + pConditions[i].function : "");
+			}
+			reorders.push_back(reorder);
+		}
+		else
+		{
+			reorder.order.clear();
+		}
+	}
+
+	for (uint32_t i{}; i < node.childCount; ++i)
+	{
+		if (!OptimizeNode(pNodes, nodeCount, nodeIndex, pStrings, stringTableSize, path, i, apply, reorders))
+			return false;
+	}
+
+	// Moved after the children were named by their old position
+	if (apply && !reorder.order.empty())
+	{
+		const std::vector<BehaviorTreeFileNode> conditions{ pConditions, pConditions + conditionCount };
+		for (uint32_t i{}; i < conditionCount; ++i)
+		{
+			pConditions[i] = conditions[reorder.order[i]];
+		}
+	}
+	return true;
+}
+
+bool BehaviorTreeOptimizer::OptimizeFile(const std::string& compiledPath, const std::string& profilePath, bool apply)
+{
+	BehaviorTreeProfile profile{};
+	if (!profile.Read(profilePath))
+		return false;
+
+	std::vector<char> buffer{};
+	{
+		std::ifstream compiledFile{ compiledPath, std::ios::binary };
+		if (!compiledFile)
+		{
+			printf("WARNING: Could not open behavior tree '%s' \n", compiledPath.c_str());
+			return false;
+		}
+		buffer.assign(std::istreambuf_iterator<char>{ compiledFile }, std::istreambuf_iterator<char>{});
+	}
+
+	std::vector<BehaviorReorder> reorders{};
+	if (!BehaviorTreeOptimizer{ profile }.Optimize(buffer, apply, reorders))
+	{
+		printf("WARNING: Behavior tree '%s' was not optimized \n", compiledPath.c_str());
+		return false;
+	}
+
+	PrintReorders(reorders);
+	if (!apply || reorders.empty())
+		return true;
+
+	std::ofstream compiledFile{ compiledPath, std::ios::binary };
+	if (!compiledFile.write(buffer.data(), buffer.size()))
+	{
+		printf("WARNING: Could not write compiled behavior tree to '%s' \n", compiledPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+void BehaviorTreeOptimizer::PrintReorders(const std::vector<BehaviorReorder>& reorders)
+{
+	double savedEvaluations{};
+	double savedNanoseconds{};
+	for (const BehaviorReorder& reorder : reorders)
+	{
+		std::string conditions{};
+		for (const std::string& condition : reorder.conditions)
+		{
+			conditions += conditions.empty() ? condition : ", " + condition;
+		}
+		printf("Reorder '%s' to %s: %.3f instead of %.3f evaluations per tick", reorder.path.c_str(), conditions.c_str(), reorder.evaluationsAfter, reorder.evaluationsBefore);
+		if (reorder.nanosecondsBefore > 0.0)
+			printf(", %.1f instead of %.1f ns", reorder.nanosecondsAfter, reorder.nanosecondsBefore);
+		printf(" \n");
+
+		savedEvaluations += reorder.evaluationsBefore - reorder.evaluationsAfter;
+		savedNanoseconds += reorder.nanosecondsBefore - reorder.nanosecondsAfter;
+	}
+	if (savedNanoseconds > 0.0)
+		printf("Behavior tree reorders: %zu, saving %.3f evaluations and %.1f ns per tick \n", reorders.size(), savedEvaluations, savedNanoseconds);
+	else
+		printf("Behavior tree reorders: %zu, saving %.3f evaluations per tick \n", reorders.size(), savedEvaluations);
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "EBehaviorTree.h"
+#include "BehaviorProfiler.h"
+
+//-----------------------------------------------------------------
+// BEHAVIOR REGISTRY
+//-----------------------------------------------------------------
+//Leaf functions by the name a tree file uses for them, with the keys they declare.
+//Filled by BT_Registry::Create, see Behaviors.h
+class BehaviorRegistry final
+{
+public:
+	using Condition = bool(*)(Blackboard*);
+	using Action = BehaviorState(*)(Blackboard*);
+	using Evaluation = bool(*)(const BlackboardView&);
+
+	template<typename Function>
+	struct Entry
+	{
+		Function fp;
+		std::vector<BlackboardDependency> dependencies;
+	};
+
+	void AddCondition(const std::string& name, Condition fpCondition, std::vector<BlackboardDependency> dependencies);
+	void AddAction(const std::string& name, Action fpAction, std::vector<BlackboardDependency> dependencies);
+	void AddEvaluation(const std::string& name, Evaluation fpEvaluation, std::vector<BlackboardDependency> dependencies);
+
+	//nullptr when nothing was registered under the name
+	const Entry<Condition>* FindCondition(const std::string& name) const;
+	const Entry<Action>* FindAction(const std::string& name) const;
+	const Entry<Evaluation>* FindEvaluation(const std::string& name) const;
+
+private:
+	std::unordered_map<std::string, Entry<Condition>> m_Conditions{};
+	std::unordered_map<std::string, Entry<Action>> m_Actions{};
+	std::unordered_map<std::string, Entry<Evaluation>> m_Evaluations{};
+};
+
+//-----------------------------------------------------------------
+// COMPILED BEHAVIOR TREE FILE
+//-----------------------------------------------------------------
+//Header, nodes in pre-order and a string table of zero terminated names.
+//Every record has a fixed size and 4 byte alignment, so a mapped file is read in place.
+#define BEHAVIOR_TREE_MAGIC 0x4E425442 // "BTBN"
+#define BEHAVIOR_TREE_VERSION 1
+
+//Named like IBehavior::GetTypeName, which is also the "type" of a node in a JSON tree
+enum class BehaviorNodeType : uint8_t
+{
+	Selector,
+	Sequence,
+	PartialSequence,
+	Parallel,
+	Observer,
+	TickRate,
+	Conditional,
+	NotConditional,
+	ViewConditional,
+	Action,
+	Cooldown,
+	RateLimit,
+	Timeout,
+	Retry,
+	Inverter,
+	ForceSuccess
+};
+
+struct BehaviorTreeFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t nodeCount;
+	uint32_t stringTableSize;
+};
+
+struct BehaviorTreeFileNode
+{
+	static constexpr uint32_t NoString = UINT32_MAX;
+	static constexpr uint8_t OrderIndependent = 1; //Flag of a selector or sequence whose leading conditions can run in any order
+
+	BehaviorNodeType type;
+	uint8_t successPolicy; //ParallelPolicy of a parallel
+	uint8_t failurePolicy;
+	uint8_t flags;
+	uint32_t childCount; //The children follow the node, each with its own subtree
+	uint32_t name; //Offset in the string table or NoString
+	uint32_t function; //Offset of the registry name of a leaf or observer condition
+	float parameter; //Interval of a tick rate, seconds of a cooldown or timeout, rate of a rate limit, attempts of a retry
+};
+
+static_assert(sizeof(BehaviorTreeFileHeader) == 16 && sizeof(BehaviorTreeFileNode) == 20, "The compiled tree layout is part of the file format");
+
+//-----------------------------------------------------------------
+// BEHAVIOR TREE LOADER
+//-----------------------------------------------------------------
+//Builds pointer trees from a JSON description or its compiled form.
+//A JSON node is an object with a "type" and an optional "name":
+//	Selector, Sequence, PartialSequence: "children"
+//	Selector, Sequence: optional "orderIndependent", true when the conditions they start with can be tested in any order
+//	Parallel: "children", optional "success" and "failure" ("RequireOne" or "RequireAll")
+//	Observer: "condition" and "child"
+//	TickRate: "interval" in seconds and "child"
+//	Cooldown, Timeout: "seconds" and "child"
+//	RateLimit: "rate" in ticks per second and "child"
+//	Retry: "attempts" and "child"
+//	Inverter, ForceSuccess: "child"
+//	Conditional, NotConditional, ViewConditional: "condition"
+//	Action: "action"
+//JSON is compiled before it is instantiated, so both forms are checked the same way.
+class BehaviorTreeLoader final
+{
+public:
+	explicit BehaviorTreeLoader(const BehaviorRegistry& registry) : m_Registry(registry) {}
+
+	//A new tree from a compiled or JSON file, nullptr after a warning when it can not be used
+	IBehavior* LoadFile(const std::string& path) const;
+	IBehavior* LoadJson(const std::string& json) const;
+	IBehavior* Instantiate(const char* pData, size_t size) const;
+
+	//The offline step, checks the JSON against the registry and replaces the buffer with its compiled form
+	bool Compile(const std::string& json, std::vector<char>& buffer) const;
+	bool CompileFile(const std::string& jsonPath, const std::string& compiledPath) const;
+
+private:
+	const BehaviorRegistry& m_Registry;
+
+	IBehavior* InstantiateNode(const BehaviorTreeFileNode* pNodes, uint32_t nodeCount, uint32_t& nodeIndex, const char* pStrings, uint32_t stringTableSize) const;
+};
+
+//-----------------------------------------------------------------
+// BEHAVIOR TREE OPTIMIZER
+//-----------------------------------------------------------------
+//New order of the leading conditions of one order-independent composite, with the expected evaluations
+//and time of those conditions per tick before and after. Times are 0 when the profile has none
+struct BehaviorReorder
+{
+	std::string path{};
+	std::vector<uint32_t> order{}; //Old position of each condition in the new order
+	std::vector<std::string> conditions{}; //Registry names in the new order
+	double evaluationsBefore{};
+	double evaluationsAfter{};
+	double nanosecondsBefore{};
+	double nanosecondsAfter{};
+};
+
+//Offline step after compiling. The conditions an order-independent selector or sequence starts with are sorted so the
+//cheap ones that most often end the composite run first: by cost / (1 - p), where p is the rate at which a condition lets
+//the composite go on. Cost is the time per run when the profile has times, one evaluation otherwise. Actions and
+//composites keep their place. Rates are taken as independent, though each was measured behind the conditions in front of it.
+//Unnamed nodes are found by their position, so the profile has to be of the tree as it was compiled, not a reordered one.
+class BehaviorTreeOptimizer final
+{
+public:
+	explicit BehaviorTreeOptimizer(const BehaviorTreeProfile& profile) : m_Profile(profile) {}
+
+	//Finds the reorders of a compiled tree that lower the expected cost and applies them to the buffer when asked.
+	//False after a warning when the buffer is not a compiled tree
+	bool Optimize(std::vector<char>& buffer, bool apply, std::vector<BehaviorReorder>& reorders) const;
+	//Reads both files, prints the reorders and writes the compiled tree back when applying
+	static bool OptimizeFile(const std::string& compiledPath, const std::string& profilePath, bool apply);
+	static void PrintReorders(const std::vector<BehaviorReorder>& reorders);
+
+private:
+	const BehaviorTreeProfile& m_Profile;
+
+	bool OptimizeNode(BehaviorTreeFileNode* pNodes, uint32_t nodeCount, uint32_t& nodeIndex, const char* pStrings, uint32_t stringTableSize,
+		const std::string& parentPath, uint32_t childOrdinal, bool apply, std::vector<BehaviorReorder>& reorders) const;
+};
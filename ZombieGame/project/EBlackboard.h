@@ -1,6 +1,18 @@
 #pragma once
 
 #include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <type_traits>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+
+#include "BlackboardProfiler.h"
+#include "BlackboardSerializer.h"
+#include "CowVector.h"
 //-----------------------------------------------------------------
 	// BLACKBOARD TYPES (BASE)
 	//-----------------------------------------------------------------
@@ -9,8 +21,53 @@ class IBlackBoardField
 public:
 	IBlackBoardField() = default;
 	virtual ~IBlackBoardField() = default;
+
+	//Bumped on every change of the data, never decreases
+	uint32_t GetVersion() const { return m_Version; }
+	void BumpVersion() { ++m_Version; }
+
+protected:
+	void SetVersion(uint32_t version) { m_Version = version; }
+
+private:
+	uint32_t m_Version = 0;
 };
 
+//Dirty check for writes: plain data and vectors of plain data are compared bytewise,
+//anything else always counts as changed
+template<typename T> bool IsSameBlackboardData(const T& lhs, const T& rhs, std::true_type)
+{
+	return memcmp(&lhs, &rhs, sizeof(T)) == 0;
+}
+template<typename T> bool IsSameBlackboardData(const T&, const T&, std::false_type)
+{
+	return false;
+}
+template<typename T> bool IsSameBlackboardData(const T& lhs, const T& rhs)
+{
+	return IsSameBlackboardData(lhs, rhs, std::is_trivially_copyable<T>{});
+}
+template<typename T> bool IsSameBlackboardData(const std::vector<T>& lhs, const std::vector<T>& rhs)
+{
+	if (!std::is_trivially_copyable<T>::value || lhs.size() != rhs.size())
+		return false;
+	return lhs.empty() || memcmp(lhs.data(), rhs.data(), sizeof(T) * lhs.size()) == 0;
+}
+template<typename T> bool IsSameBlackboardData(const CowVector<T>& lhs, const CowVector<T>& rhs)
+{
+	return lhs.IsSharedWith(rhs) || IsSameBlackboardData(lhs.Get(), rhs.Get());
+}
+
+//What ModifyData hands out, copy-on-write data is detached first
+template<typename T> T& GetMutableBlackboardData(T& data)
+{
+	return data;
+}
+template<typename T> std::vector<T>& GetMutableBlackboardData(CowVector<T>& data)
+{
+	return data.Mutate();
+}
+
 //BlackboardField does not take ownership of pointers whatsoever!
 template<typename T>
 class BlackboardField : public IBlackBoardField
@@ -18,20 +75,143 @@ class BlackboardField : public IBlackBoardField
 public:
 	explicit BlackboardField(T data) : m_Data(data)
 	{}
-	T GetData() { return m_Data; };
-	void SetData(T data) { m_Data = data; }
+	const T& GetData() const { return m_Data; };
+	T& GetDataRef() { return m_Data; }
+	void SetData(const T& data)
+	{
+		if (IsSameBlackboardData(m_Data, data))
+			return;
+
+		m_Data = data;
+		BumpVersion();
+	}
+	//Used by snapshots, takes over the version so unchanged fields can be skipped next time
+	void CopyFrom(const BlackboardField<T>& other)
+	{
+		m_Data = other.m_Data;
+		SetVersion(other.GetVersion());
+	}
 
 private:
 	T m_Data;
 };
 
+//Result of a computation together with the versions of the keys it was computed from
+template<typename R, size_t N>
+struct BlackboardCache
+{
+	std::array<uint32_t, N> versions{};
+	R result{};
+	bool isValid = false;
+};
+
+//-----------------------------------------------------------------
+// BLACKBOARD KEYS (TYPED)
+//-----------------------------------------------------------------
+//A key is declared once with a compile-time slot id and the name used by the string API.
+//Lookups through a key are a direct slot access: no string, no hashing and no dynamic_cast.
+template<typename T>
+struct BlackboardKey
+{
+	using ValueType = T;
+
+	constexpr BlackboardKey(uint32_t slot, const char* keyName) : id(slot), name(keyName) {}
+
+	uint32_t id;
+	const char* name;
+};
+
+//-----------------------------------------------------------------
+// BLACKBOARD LAYOUT
+//-----------------------------------------------------------------
+//Fixes the position of every registered field inside one contiguous arena.
+//Fields are placed in registration order, so register the keys a tick touches most first.
+class BlackboardLayout final
+{
+public:
+	static constexpr size_t ARENA_ALIGNMENT = 64; //Cache line
+
+	struct Entry
+	{
+		uint32_t id;
+		const char* name;
+		size_t offset;
+		IBlackBoardField* (*pConstruct)(void* pMemory);
+		void (*pCopy)(IBlackBoardField* pDestination, const IBlackBoardField* pSource);
+		void (*pSave)(BlackboardWriter& writer, const IBlackBoardField* pField); //nullptr without a serializer
+		bool (*pLoad)(BlackboardReader& reader, IBlackBoardField* pField);
+	};
+
+	template<typename T> BlackboardLayout& Register(const BlackboardKey<T>& key)
+	{
+		using FieldType = BlackboardField<T>;
+		static_assert(alignof(FieldType) <= ARENA_ALIGNMENT, "Blackboard field is over-aligned");
+
+		for (const Entry& entry : m_Entries)
+		{
+			if (entry.id == key.id)
+			{
+				printf("WARNING: Key '%s' shares slot %u with '%s' in the Blackboard layout \n", key.name, key.id, entry.name);
+				return *this;
+			}
+		}
+
+		m_Size = (m_Size + alignof(FieldType) - 1) & ~(alignof(FieldType) - 1);
+		m_Entries.push_back(Entry{ key.id, key.name, m_Size, [](void* pMemory) -> IBlackBoardField* {
+			return new (pMemory) FieldType(T{});
+		}, [](IBlackBoardField* pDestination, const IBlackBoardField* pSource) {
+			static_cast<FieldType*>(pDestination)->CopyFrom(*static_cast<const FieldType*>(pSource));
+		}, BlackboardSerializer<T>::IsSupported ? +[](BlackboardWriter& writer, const IBlackBoardField* pField) {
+			BlackboardSerializer<T>::Write(writer, static_cast<const FieldType*>(pField)->GetData());
+		} : nullptr, BlackboardSerializer<T>::IsSupported ? +[](BlackboardReader& reader, IBlackBoardField* pField) {
+			FieldType* pTypedField = static_cast<FieldType*>(pField);
+			if (!BlackboardSerializer<T>::Read(reader, pTypedField->GetDataRef()))
+				return false;
+			pTypedField->BumpVersion();
+			return true;
+		} : nullptr });
+		m_Size += sizeof(FieldType);
+
+		if (key.id >= m_SlotCount)
+			m_SlotCount = key.id + 1;
+
+		return *this;
+	}
+
+	const std::vector<Entry>& GetEntries() const { return m_Entries; }
+	size_t GetSize() const { return m_Size; }
+	uint32_t GetSlotCount() const { return m_SlotCount; }
+
+private:
+	std::vector<Entry> m_Entries{};
+	size_t m_Size = 0;
+	uint32_t m_SlotCount = 0;
+};
+
 //-----------------------------------------------------------------
 // BLACKBOARD (BASE)
 //-----------------------------------------------------------------
+class Blackboard;
+using BlackboardCallback = std::function<void(Blackboard*)>;
+
 class Blackboard final
 {
 public:
 	Blackboard() = default;
+	//Every field of the layout is default constructed in a single allocation
+	explicit Blackboard(const BlackboardLayout& layout)
+		: m_Layout(layout)
+	{
+		m_pArenaMemory = new char[layout.GetSize() + BlackboardLayout::ARENA_ALIGNMENT];
+		const uintptr_t address = reinterpret_cast<uintptr_t>(m_pArenaMemory);
+		m_pArena = m_pArenaMemory + (BlackboardLayout::ARENA_ALIGNMENT - address % BlackboardLayout::ARENA_ALIGNMENT) % BlackboardLayout::ARENA_ALIGNMENT;
+
+		m_Slots.resize(layout.GetSlotCount(), nullptr);
+		for (const auto& entry : layout.GetEntries())
+		{
+			m_Slots[entry.id] = entry.pConstruct(m_pArena + entry.offset);
+		}
+	}
 	~Blackboard()
 	{
 		for (auto el : m_BlackboardData)
@@ -43,6 +223,17 @@ public:
 			}
 		}
 		m_BlackboardData.clear();
+
+		//Arena fields are only destructed, the memory goes in one piece
+		for (const auto& entry : m_Layout.GetEntries())
+		{
+			m_Slots[entry.id]->~IBlackBoardField();
+		}
+		delete[] m_pArenaMemory;
+		m_pArenaMemory = nullptr;
+		m_pArena = nullptr;
+
+		m_Slots.clear();
 	}
 
 	Blackboard(const Blackboard& other) = delete;
@@ -54,9 +245,10 @@ public:
 	template<typename T> bool AddData(const std::string& name, T data)
 	{
 		auto it = m_BlackboardData.find(name);
-		if (it == m_BlackboardData.end())
+		if (it == m_BlackboardData.end() && FindArenaField(name) == nullptr)
 		{
 			m_BlackboardData[name] = new BlackboardField<T>(data);
+			BLACKBOARD_PROFILE(m_Profiler.OnWrite(name.c_str(), GetBlackboardDataSize(data), true));
 			return true;
 		}
 		printf("WARNING: Data '%s' of type '%s' already in Blackboard \n", name.c_str(), typeid(T).name());
@@ -66,17 +258,14 @@ public:
 	//Change the data of the blackboard
 	template<typename T> bool ChangeData(const std::string& name, T data)
 	{
-		auto it = m_BlackboardData.find(name);
-		if (it != m_BlackboardData.end())
+		BlackboardField<T>* p = dynamic_cast<BlackboardField<T>*>(FindField(name));
+		if (p)
 		{
-			auto test = m_BlackboardData[name];
-			BlackboardField<T>* p = dynamic_cast<BlackboardField<T>*>(m_BlackboardData[name]);
-			if (p)
-			{
-				p->SetData(data);
-				return true;
-			}
+			BLACKBOARD_PROFILE(m_Profiler.OnWrite(name.c_str(), GetBlackboardDataSize(data), true));
+			p->SetData(data);
+			return true;
 		}
+		BLACKBOARD_PROFILE(m_Profiler.OnMiss(name.c_str(), true));
 		printf("WARNING: Data '%s' of type '%s' not found in Blackboard \n", name.c_str(), typeid(T).name());
 		return false;
 	}
@@ -84,16 +273,518 @@ public:
 	//Get the data from the blackboard
 	template<typename T> bool GetData(const std::string& name, T& data)
 	{
-		BlackboardField<T>* p = dynamic_cast<BlackboardField<T>*>(m_BlackboardData[name]);
+		BlackboardField<T>* p = dynamic_cast<BlackboardField<T>*>(FindField(name));
 		if (p != nullptr)
 		{
+			BLACKBOARD_PROFILE(m_Profiler.OnRead(name.c_str(), GetBlackboardDataSize(p->GetData()), true));
 			data = p->GetData();
 			return true;
 		}
+		BLACKBOARD_PROFILE(m_Profiler.OnMiss(name.c_str(), true));
 		printf("WARNING: Data '%s' of type '%s' not found in Blackboard \n", name.c_str(), typeid(T).name());
 		return false;
 	}
 
+	//Add data to the blackboard and bind it to the slot of the typed key
+	template<typename T> bool AddData(const BlackboardKey<T>& key, const typename BlackboardKey<T>::ValueType& data)
+	{
+		//Fields of the layout already live in the arena, only their initial value is set
+		if (IsArenaField(key.id))
+		{
+			BlackboardField<T>* p = dynamic_cast<BlackboardField<T>*>(m_Slots[key.id]);
+			if (p == nullptr)
+			{
+				printf("WARNING: Key '%s' of type '%s' does not match the Blackboard layout \n", key.name, typeid(T).name());
+				return false;
+			}
+
+			p->SetData(data);
+			return true;
+		}
+
+		bool isAdded = AddData<T>(key.name, data);
+
+		//Data added through the string API can still be bound, the type is only checked here
+		BlackboardField<T>* p = dynamic_cast<BlackboardField<T>*>(FindField(key.name));
+		if (p == nullptr)
+		{
+			printf("WARNING: Key '%s' of type '%s' does not match the Blackboard data \n", key.name, typeid(T).name());
+			return false;
+		}
+
+		if (key.id >= m_Slots.size())
+			m_Slots.resize(key.id + 1, nullptr);
+		m_Slots[key.id] = p;
+
+		return isAdded;
+	}
+
+	//Change the data of the blackboard through a typed key
+	template<typename T> bool ChangeData(const BlackboardKey<T>& key, const typename BlackboardKey<T>::ValueType& data)
+	{
+		BlackboardField<T>* p = GetField(key);
+		if (p)
+		{
+			BLACKBOARD_PROFILE(m_Profiler.OnWrite(key.name, GetBlackboardDataSize(data), false));
+			p->SetData(data);
+			return true;
+		}
+		BLACKBOARD_PROFILE(m_Profiler.OnMiss(key.name, false));
+		printf("WARNING: Data '%s' of type '%s' not found in Blackboard \n", key.name, typeid(T).name());
+		return false;
+	}
+
+	//Get the data from the blackboard through a typed key
+	template<typename T> bool GetData(const BlackboardKey<T>& key, T& data)
+	{
+		BlackboardField<T>* p = GetField(key);
+		if (p != nullptr)
+		{
+			BLACKBOARD_PROFILE(m_Profiler.OnRead(key.name, GetBlackboardDataSize(p->GetData()), false));
+			data = p->GetData();
+			return true;
+		}
+		BLACKBOARD_PROFILE(m_Profiler.OnMiss(key.name, false));
+		printf("WARNING: Data '%s' of type '%s' not found in Blackboard \n", key.name, typeid(T).name());
+		return false;
+	}
+
+	//Read-only view on the data, nothing is copied
+	template<typename T> const T& ViewData(const BlackboardKey<T>& key) const
+	{
+		BlackboardField<T>* p = GetField(key);
+		if (p != nullptr)
+		{
+			BLACKBOARD_PROFILE(m_Profiler.OnRead(key.name, 0, false));
+			return p->GetData();
+		}
+		BLACKBOARD_PROFILE(m_Profiler.OnMiss(key.name, false));
+		printf("WARNING: Data '%s' of type '%s' not found in Blackboard \n", key.name, typeid(T).name());
+
+		static const T empty{};
+		return empty;
+	}
+
+	//Mutate the data in place, fn is called with a T& and nothing is copied
+	//(a CowVector<T> hands out its std::vector<T>&, detached if it was shared)
+	//If fn returns a bool, the version is only bumped when it returns true
+	template<typename T, typename Fn> bool ModifyData(const BlackboardKey<T>& key, Fn fn)
+	{
+		BlackboardField<T>* p = GetField(key);
+		if (p != nullptr)
+		{
+			BLACKBOARD_PROFILE(m_Profiler.OnWrite(key.name, 0, false));
+			auto& data = GetMutableBlackboardData(p->GetDataRef());
+			if (CallModifier(fn, data, std::is_same<decltype(fn(data)), bool>{}))
+				p->BumpVersion();
+			return true;
+		}
+		BLACKBOARD_PROFILE(m_Profiler.OnMiss(key.name, false));
+		printf("WARNING: Data '%s' of type '%s' not found in Blackboard \n", key.name, typeid(T).name());
+		return false;
+	}
+
+	//For data the blackboard only points to, tells subscribers and caches the pointee changed
+	template<typename T> void MarkChanged(const BlackboardKey<T>& key)
+	{
+		BlackboardField<T>* p = GetField(key);
+		if (p != nullptr)
+			p->BumpVersion();
+	}
+
+	//Callback runs once on the next DispatchNotifications after the key changed,
+	//no matter how often it changed in between
+	template<typename T> uint32_t Subscribe(const BlackboardKey<T>& key, BlackboardCallback callback)
+	{
+		const uint32_t subscriptionId = ++m_LastSubscriptionId;
+		m_Subscriptions.push_back(Subscription{ subscriptionId, key.id, GetVersion(key), callback });
+		return subscriptionId;
+	}
+
+	void Unsubscribe(uint32_t subscriptionId)
+	{
+		for (auto& subscription : m_Subscriptions)
+		{
+			if (subscription.id == subscriptionId)
+				subscription.callback = nullptr;
+		}
+	}
+
+	//Called once per tick, changes made by the callbacks themselves are delivered on the next one
+	void DispatchNotifications()
+	{
+		const size_t subscriptionCount = m_Subscriptions.size();
+		for (size_t i{}; i < subscriptionCount; ++i)
+		{
+			const uint32_t version = GetSlotVersion(m_Subscriptions[i].slot);
+			if (version == m_Subscriptions[i].lastVersion || m_Subscriptions[i].callback == nullptr)
+				continue;
+
+			m_Subscriptions[i].lastVersion = version;
+			BlackboardCallback callback = m_Subscriptions[i].callback;
+			callback(this);
+		}
+
+		m_Subscriptions.erase(std::remove_if(m_Subscriptions.begin(), m_Subscriptions.end(), [](const Subscription& subscription) {
+			return subscription.callback == nullptr;
+		}), m_Subscriptions.end());
+	}
+
+	//Copies the arena fields of a blackboard built from the same layout, unchanged fields are skipped.
+	//Pointers are copied as they are, the data they point to is not.
+	void CopyArenaFrom(const Blackboard& source)
+	{
+		if (m_pArena == nullptr || source.m_Layout.GetSize() != m_Layout.GetSize() || source.m_Layout.GetEntries().size() != m_Layout.GetEntries().size())
+		{
+			printf("WARNING: Blackboard arena can only be copied from a blackboard with the same layout \n");
+			return;
+		}
+
+		for (const auto& entry : m_Layout.GetEntries())
+		{
+			const IBlackBoardField* pSource = source.m_Slots[entry.id];
+			if (m_Slots[entry.id]->GetVersion() != pSource->GetVersion())
+				entry.pCopy(m_Slots[entry.id], pSource);
+		}
+	}
+
+#if CONFIG_PROFILE_BLACKBOARD
+	BlackboardProfiler& GetProfiler() const { return m_Profiler; }
+#endif
+
+	//Writes every arena field that has a serializer, the buffer is cleared first
+	void SaveCheckpoint(std::vector<char>& buffer) const
+	{
+		buffer.clear();
+		BlackboardWriter writer{ buffer };
+		writer.WriteValue(uint32_t{ CHECKPOINT_MAGIC });
+		writer.WriteValue(uint32_t{ CHECKPOINT_VERSION });
+
+		const size_t fieldCountOffset = writer.GetSize();
+		uint32_t fieldCount{};
+		writer.WriteValue(fieldCount);
+
+		for (const auto& entry : m_Layout.GetEntries())
+		{
+			if (entry.pSave == nullptr)
+				continue;
+
+			writer.WriteValue(entry.id);
+			const size_t sizeOffset = writer.GetSize();
+			writer.WriteValue(uint32_t{});
+
+			entry.pSave(writer, m_Slots[entry.id]);
+			writer.Patch(sizeOffset, static_cast<uint32_t>(writer.GetSize() - sizeOffset - sizeof(uint32_t)));
+			++fieldCount;
+		}
+		writer.Patch(fieldCountOffset, fieldCount);
+	}
+
+	//Restores the fields in place, vectors keep their capacity. Restored fields count as changed.
+	bool LoadCheckpoint(const char* pData, size_t size)
+	{
+		BlackboardReader reader{ pData, size };
+		uint32_t magic{}, version{}, fieldCount{};
+		if (!reader.ReadValue(magic) || !reader.ReadValue(version) || !reader.ReadValue(fieldCount) || magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION)
+		{
+			printf("WARNING: Data is not a Blackboard checkpoint \n");
+			return false;
+		}
+
+		for (uint32_t i{}; i < fieldCount; ++i)
+		{
+			uint32_t slot{}, fieldSize{};
+			if (!reader.ReadValue(slot) || !reader.ReadValue(fieldSize) || fieldSize > reader.GetRemaining())
+			{
+				printf("WARNING: Blackboard checkpoint is truncated \n");
+				return false;
+			}
+
+			const BlackboardLayout::Entry* pEntry = FindLayoutEntry(slot);
+			if (pEntry == nullptr || pEntry->pLoad == nullptr)
+			{
+				printf("WARNING: Slot %u of the Blackboard checkpoint is not in the layout \n", slot);
+			}
+			else
+			{
+				BlackboardReader fieldReader{ pData + reader.GetOffset(), fieldSize };
+				if (!pEntry->pLoad(fieldReader, m_Slots[slot]) || fieldReader.GetRemaining() != 0)
+					printf("WARNING: Data '%s' of the Blackboard checkpoint does not match its type \n", pEntry->name);
+			}
+			reader.Skip(fieldSize);
+		}
+		return true;
+	}
+
+	bool SaveCheckpoint(const std::string& path)
+	{
+		SaveCheckpoint(m_CheckpointBuffer);
+
+		std::ofstream file{ path, std::ios::binary };
+		if (!file.write(m_CheckpointBuffer.data(), m_CheckpointBuffer.size()))
+		{
+			printf("WARNING: Could not write Blackboard checkpoint '%s' \n", path.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	//One read into the checkpoint buffer, which is reused between loads
+	bool LoadCheckpoint(const std::string& path)
+	{
+		std::ifstream file{ path, std::ios::binary | std::ios::ate };
+		if (!file)
+		{
+			printf("WARNING: Could not open Blackboard checkpoint '%s' \n", path.c_str());
+			return false;
+		}
+
+		const std::streamsize size = file.tellg();
+		file.seekg(0);
+		m_CheckpointBuffer.resize(static_cast<size_t>(size));
+		if (!file.read(m_CheckpointBuffer.data(), size))
+		{
+			printf("WARNING: Could not read Blackboard checkpoint '%s' \n", path.c_str());
+			return false;
+		}
+		return LoadCheckpoint(m_CheckpointBuffer.data(), m_CheckpointBuffer.size());
+	}
+
+	//True if the key is bound to data of its type
+	template<typename T> bool HasData(const BlackboardKey<T>& key) const
+	{
+		if (key.id >= m_Slots.size() || m_Slots[key.id] == nullptr)
+			return false;
+		return dynamic_cast<const BlackboardField<T>*>(m_Slots[key.id]) != nullptr;
+	}
+
+	//Version of the data behind the key, 0 if it is not in the blackboard
+	template<typename T> uint32_t GetVersion(const BlackboardKey<T>& key) const
+	{
+		BlackboardField<T>* p = GetField(key);
+		return p != nullptr ? p->GetVersion() : 0;
+	}
+
+	//Same without the type check, for keys that were type-erased
+	uint32_t GetSlotVersion(uint32_t slot) const
+	{
+		return slot < m_Slots.size() && m_Slots[slot] != nullptr ? m_Slots[slot]->GetVersion() : 0;
+	}
+
+	template<typename T> bool HasChangedSince(const BlackboardKey<T>& key, uint32_t version) const
+	{
+		return GetVersion(key) != version;
+	}
+
+	//Fills result if none of the input keys changed since SetCachedResult was called with them
+	//Blackboards without the cache key simply never hit
+	template<typename R, typename... Keys> bool GetCachedResult(const BlackboardKey<BlackboardCache<R, sizeof...(Keys)>>& cacheKey, R& result, const Keys&... inputKeys) const
+	{
+		BlackboardField<BlackboardCache<R, sizeof...(Keys)>>* p = GetField(cacheKey);
+		if (p == nullptr || !p->GetData().isValid)
+			return false;
+
+		const std::array<uint32_t, sizeof...(Keys)> versions{ { GetVersion(inputKeys)... } };
+		if (versions != p->GetData().versions)
+			return false;
+
+		result = p->GetData().result;
+		return true;
+	}
+
+	template<typename R, typename... Keys> void SetCachedResult(const BlackboardKey<BlackboardCache<R, sizeof...(Keys)>>& cacheKey, const R& result, const Keys&... inputKeys)
+	{
+		BlackboardField<BlackboardCache<R, sizeof...(Keys)>>* p = GetField(cacheKey);
+		if (p == nullptr)
+			return;
+
+		BlackboardCache<R, sizeof...(Keys)>& cache = p->GetDataRef();
+		cache.versions = { { GetVersion(inputKeys)... } };
+		cache.result = result;
+		cache.isValid = true;
+	}
+
 private:
 	std::unordered_map<std::string, IBlackBoardField*> m_BlackboardData;
-};
\ No newline at end of file
+	std::vector<IBlackBoardField*> m_Slots; //Indexed by key id, does not own the fields
+
+	struct Subscription
+	{
+		uint32_t id;
+		uint32_t slot;
+		uint32_t lastVersion;
+		BlackboardCallback callback;
+	};
+	std::vector<Subscription> m_Subscriptions{};
+	uint32_t m_LastSubscriptionId = 0;
+
+	static constexpr uint32_t CHECKPOINT_MAGIC = 0x50434242; //"BBCP"
+	static constexpr uint32_t CHECKPOINT_VERSION = 1;
+	std::vector<char> m_CheckpointBuffer{};
+
+	BlackboardLayout m_Layout{};
+	char* m_pArenaMemory = nullptr;
+	char* m_pArena = nullptr; //m_pArenaMemory aligned to a cache line
+
+#if CONFIG_PROFILE_BLACKBOARD
+	mutable BlackboardProfiler m_Profiler{}; //Reads through const views are counted too
+#endif
+
+	template<typename T, typename Fn> static bool CallModifier(Fn& fn, T& data, std::true_type)
+	{
+		return fn(data);
+	}
+	template<typename T, typename Fn> static bool CallModifier(Fn& fn, T& data, std::false_type)
+	{
+		fn(data);
+		return true;
+	}
+
+	bool IsArenaField(uint32_t id) const
+	{
+		if (m_pArena == nullptr || id >= m_Slots.size())
+			return false;
+
+		const char* pField = reinterpret_cast<const char*>(m_Slots[id]);
+		return std::less_equal<const char*>()(m_pArena, pField) && std::less<const char*>()(pField, m_pArena + m_Layout.GetSize());
+	}
+
+	//Slow path for the string API, arena fields are found by name through the layout
+	IBlackBoardField* FindArenaField(const std::string& name) const
+	{
+		for (const auto& entry : m_Layout.GetEntries())
+		{
+			if (strcmp(entry.name, name.c_str()) == 0)
+				return m_Slots[entry.id];
+		}
+		return nullptr;
+	}
+
+	const BlackboardLayout::Entry* FindLayoutEntry(uint32_t id) const
+	{
+		for (const auto& entry : m_Layout.GetEntries())
+		{
+			if (entry.id == id)
+				return &entry;
+		}
+		return nullptr;
+	}
+
+	IBlackBoardField* FindField(const std::string& name) const
+	{
+		auto it = m_BlackboardData.find(name);
+		if (it != m_BlackboardData.end())
+			return it->second;
+		return FindArenaField(name);
+	}
+
+	//Type is guaranteed by the key and validated when it was bound, so no RTTI is needed here
+	template<typename T> BlackboardField<T>* GetField(const BlackboardKey<T>& key) const
+	{
+		if (key.id >= m_Slots.size())
+			return nullptr;
+		return static_cast<BlackboardField<T>*>(m_Slots[key.id]);
+	}
+};
+
+//-----------------------------------------------------------------
+// BLACKBOARD DEPENDENCIES
+//-----------------------------------------------------------------
+//A key some code relies on, with its type erased so keys of different types fit in one list.
+//Checked against a blackboard once, so missing keys show up at startup instead of every frame.
+struct BlackboardDependency
+{
+	template<typename T> BlackboardDependency(const BlackboardKey<T>& key)
+		: id(key.id), name(key.name), typeName(typeid(T).name()), pIsBound(&IsBound<T>)
+	{}
+
+	bool IsBoundIn(const Blackboard& blackboard) const { return pIsBound(blackboard, id, name); }
+	uint32_t GetVersionIn(const Blackboard& blackboard) const { return blackboard.GetSlotVersion(id); }
+
+	uint32_t id;
+	const char* name;
+	const char* typeName;
+
+private:
+	bool (*pIsBound)(const Blackboard& blackboard, uint32_t id, const char* name);
+
+	template<typename T> static bool IsBound(const Blackboard& blackboard, uint32_t id, const char* name)
+	{
+		return blackboard.HasData(BlackboardKey<T>{ id, name });
+	}
+};
+
+//-----------------------------------------------------------------
+// BLACKBOARD VIEW
+//-----------------------------------------------------------------
+//Read-only access to a blackboard for behaviors that run on worker threads while its owner waits.
+//Reads from several threads are safe as long as nothing writes, which the view can not do.
+//Data behind pointer keys is only as read-only as the reader keeps it, and with
+//CONFIG_PROFILE_BLACKBOARD the counted reads race.
+class BlackboardView final
+{
+public:
+	explicit BlackboardView(const Blackboard& blackboard) : m_pBlackboard(&blackboard) {}
+
+	template<typename T> const T& ViewData(const BlackboardKey<T>& key) const { return m_pBlackboard->ViewData(key); }
+	template<typename T> bool HasData(const BlackboardKey<T>& key) const { return m_pBlackboard->HasData(key); }
+	template<typename T> uint32_t GetVersion(const BlackboardKey<T>& key) const { return m_pBlackboard->GetVersion(key); }
+
+private:
+	const Blackboard* m_pBlackboard;
+};
+
+//-----------------------------------------------------------------
+// BLACKBOARD SNAPSHOTS
+//-----------------------------------------------------------------
+//Triple buffered copies of a blackboard, published once per tick by the thread that updates it.
+//Readers get the latest complete tick without locking and without copying, the snapshot they hold
+//is never written to until they acquire again. Supports one writer and one reader thread.
+class BlackboardSnapshots final
+{
+public:
+	explicit BlackboardSnapshots(const BlackboardLayout& layout)
+	{
+		for (auto& pBuffer : m_pBuffers)
+		{
+			pBuffer = new Blackboard(layout);
+		}
+	}
+	~BlackboardSnapshots()
+	{
+		for (auto& pBuffer : m_pBuffers)
+		{
+			delete pBuffer;
+			pBuffer = nullptr;
+		}
+	}
+
+	BlackboardSnapshots(const BlackboardSnapshots& other) = delete;
+	BlackboardSnapshots& operator=(const BlackboardSnapshots& other) = delete;
+	BlackboardSnapshots(BlackboardSnapshots&& other) = delete;
+	BlackboardSnapshots& operator=(BlackboardSnapshots&& other) = delete;
+
+	//Writer, at the end of a tick
+	void Publish(const Blackboard& source)
+	{
+		m_pBuffers[m_WriteIndex]->CopyArenaFrom(source);
+		m_WriteIndex = m_ReadyIndex.exchange(m_WriteIndex | NEW_SNAPSHOT_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+	}
+
+	//Reader, stays valid and unchanged until the next Acquire
+	const Blackboard& Acquire()
+	{
+		if (m_ReadyIndex.load(std::memory_order_acquire) & NEW_SNAPSHOT_BIT)
+			m_ReadIndex = m_ReadyIndex.exchange(m_ReadIndex, std::memory_order_acq_rel) & INDEX_MASK;
+		return *m_pBuffers[m_ReadIndex];
+	}
+
+private:
+	static constexpr uint32_t NEW_SNAPSHOT_BIT = 4;
+	static constexpr uint32_t INDEX_MASK = 3;
+
+	Blackboard* m_pBuffers[3]{};
+	uint32_t m_WriteIndex = 0;
+	std::atomic<uint32_t> m_ReadyIndex{ 1 };
+	uint32_t m_ReadIndex = 2;
+};
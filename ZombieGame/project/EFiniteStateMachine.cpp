@@ -0,0 +1,205 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "EFiniteStateMachine.h"
+
+//-----------------------------------------------------------------
+// FINITE STATE MACHINE
+//-----------------------------------------------------------------
+FiniteStateMachine::FiniteStateMachine(Blackboard* pBlackBoard)
+	: m_pBlackBoard(pBlackBoard)
+{
+}
+
+FiniteStateMachine::~FiniteStateMachine()
+{
+	for (State& state : m_States)
+	{
+		SAFE_DELETE(state.pBehavior);
+	}
+}
+
+FiniteStateMachine::ConditionMask FiniteStateMachine::AddCondition(const char* pName, Condition fpCondition, std::vector<BlackboardDependency> dependencies)
+{
+	if (m_Conditions.size() >= MaxConditions)
+	{
+		printf("WARNING: State machine condition '%s' does not fit the condition mask, the machine will not compile \n", pName);
+		m_HasConditionOverflow = true;
+		return 0;
+	}
+
+	m_Conditions.push_back(fpCondition);
+	m_ConditionNames.push_back(pName);
+	m_ConditionDependencies.push_back(std::move(dependencies));
+	return ConditionMask{ 1 } << (m_Conditions.size() - 1);
+}
+
+uint32_t FiniteStateMachine::AddState(const char* pName, IBehavior* pBehavior, uint32_t parentState)
+{
+	if (pBehavior != nullptr)
+		pBehavior->BindContext(&m_Context);
+	m_States.push_back(State{ pName, pBehavior, parentState < m_States.size() ? parentState : NoState });
+	return static_cast<uint32_t>(m_States.size() - 1);
+}
+
+void FiniteStateMachine::AddTransition(uint32_t fromState, uint32_t toState, ConditionMask required, ConditionMask forbidden)
+{
+	if (fromState >= m_States.size() || toState >= m_States.size())
+	{
+		printf("WARNING: State machine transition between states that do not exist \n");
+		return;
+	}
+
+	m_Transitions.push_back(Transition{ required, forbidden, fromState, toState, 0, 0 });
+}
+
+bool FiniteStateMachine::Compile(uint32_t initialState)
+{
+	const uint32_t stateCount = static_cast<uint32_t>(m_States.size());
+	bool isValid = true;
+	if (m_HasConditionOverflow)
+	{
+		printf("WARNING: State machine has more than %u conditions, transitions using the ones that did not fit would always pass \n", MaxConditions);
+		isValid = false;
+	}
+	for (const Transition& transition : m_Transitions)
+	{
+		if (m_States[transition.toState].pBehavior == nullptr)
+		{
+			printf("WARNING: State machine transition into '%s', which has no behavior to run \n", m_States[transition.toState].pName);
+			isValid = false;
+		}
+	}
+	if (initialState >= stateCount || m_States[initialState].pBehavior == nullptr)
+	{
+		printf("WARNING: State machine can not start in a state without a behavior \n");
+		isValid = false;
+	}
+	if (!isValid)
+	{
+		m_CurrentState = NoState;
+		return false;
+	}
+
+	// Rows list the transitions of the outermost parent first
+	std::vector<std::vector<Transition>> rows(stateCount);
+	std::vector<uint32_t> path{};
+	for (uint32_t stateIndex{}; stateIndex < stateCount; ++stateIndex)
+	{
+		path.clear();
+		for (uint32_t ancestor = stateIndex; ancestor != NoState; ancestor = m_States[ancestor].parentState)
+		{
+			path.push_back(ancestor);
+		}
+		for (auto it = path.rbegin(); it != path.rend(); ++it)
+		{
+			for (const Transition& transition : m_Transitions)
+			{
+				if (transition.fromState == *it)
+					rows[stateIndex].push_back(transition);
+			}
+		}
+	}
+
+	m_RowLength = 0;
+	for (const std::vector<Transition>& row : rows)
+	{
+		m_RowLength = std::max(m_RowLength, static_cast<uint32_t>(row.size()));
+	}
+
+	m_Table.assign(size_t{ stateCount } * m_RowLength, Transition{ 0, 0, NoState, NoState, 0, 0 });
+	m_RowSizes.assign(stateCount, 0);
+	m_TransitionConditions.clear();
+	const uint32_t conditionCount = static_cast<uint32_t>(m_Conditions.size());
+	for (uint32_t stateIndex{}; stateIndex < stateCount; ++stateIndex)
+	{
+		const std::vector<Transition>& row = rows[stateIndex];
+		m_RowSizes[stateIndex] = static_cast<uint32_t>(row.size());
+		for (size_t i{}; i < row.size(); ++i)
+		{
+			Transition transition = row[i];
+			transition.conditionBegin = static_cast<uint32_t>(m_TransitionConditions.size());
+			for (const ConditionMask mask : { transition.required, transition.forbidden })
+			{
+				for (uint32_t conditionIndex{}; conditionIndex < conditionCount; ++conditionIndex)
+				{
+					if (mask & (ConditionMask{ 1 } << conditionIndex))
+						m_TransitionConditions.push_back(static_cast<uint8_t>(conditionIndex));
+				}
+			}
+			transition.conditionEnd = static_cast<uint32_t>(m_TransitionConditions.size());
+			m_Table[size_t{ stateIndex } * m_RowLength + i] = transition;
+		}
+	}
+
+	m_CurrentState = initialState;
+	return true;
+}
+
+void FiniteStateMachine::Update(float deltaTime)
+{
+	//Changes of the previous tick are delivered in one batch before deciding, also when nothing is decided
+	m_pBlackBoard->DispatchNotifications();
+	if (m_CurrentState == NoState)
+	{
+		m_CurrentResult = BehaviorState::Failure;
+		return;
+	}
+
+	m_Context.conditionMemo.NextTick();
+	m_Context.scheduler.Advance(deltaTime);
+
+	// Conditions are evaluated once, the first time a transition of the row needs them
+	ConditionMask known{};
+	ConditionMask values{};
+	const Transition* pRow = m_Table.data() + size_t{ m_CurrentState } * m_RowLength;
+	const uint32_t rowSize = m_RowSizes[m_CurrentState];
+	for (uint32_t i{}; i < rowSize; ++i)
+	{
+		const Transition& transition = pRow[i];
+		bool isMatching = true;
+		for (uint32_t c = transition.conditionBegin; isMatching && c < transition.conditionEnd; ++c)
+		{
+			const uint8_t conditionIndex = m_TransitionConditions[c];
+			const ConditionMask bit = ConditionMask{ 1 } << conditionIndex;
+			if ((known & bit) == 0)
+			{
+				known |= bit;
+				if (m_Conditions[conditionIndex](m_pBlackBoard))
+					values |= bit;
+				++m_EvaluationCount;
+			}
+			isMatching = ((values & bit) != 0) == ((transition.required & bit) != 0);
+		}
+		if (!isMatching || (values & transition.required) != transition.required || (values & transition.forbidden) != 0)
+			continue;
+
+		if (transition.toState != m_CurrentState)
+		{
+			m_States[m_CurrentState].pBehavior->Abort();
+			m_CurrentState = transition.toState;
+			++m_TransitionCount;
+		}
+		break;
+	}
+
+	m_CurrentResult = m_States[m_CurrentState].pBehavior->ExecuteProfiled(m_pBlackBoard);
+}
+
+bool FiniteStateMachine::ValidateDependencies() const
+{
+	bool isValid = true;
+	for (size_t i{}; i < m_Conditions.size(); ++i)
+	{
+		if (!BehaviorLeaf::CheckDependencies(m_pBlackBoard, m_ConditionDependencies[i]))
+		{
+			printf("WARNING: State machine condition '%s' reads keys the blackboard does not have \n", m_ConditionNames[i]);
+			isValid = false;
+		}
+	}
+	for (const State& state : m_States)
+	{
+		if (state.pBehavior != nullptr)
+			isValid &= state.pBehavior->ValidateDependencies(m_pBlackBoard);
+	}
+	return isValid;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "EBehaviorTree.h"
+
+//-----------------------------------------------------------------
+// FINITE STATE MACHINE
+//-----------------------------------------------------------------
+//Hierarchical state machine whose transitions test condition bits.
+//Conditions are numbered, a transition fires when all of its required bits are set and none of its forbidden bits.
+//Transitions of a parent state apply to all of its substates and are checked before their own, in the order they were added.
+//Compile flattens the hierarchy into one dense table of state x transition. A tick walks the row of the current state
+//and evaluates a condition the first time a transition there needs it, a transition stops at its first bit that does not match.
+//States with a behavior run it every tick they are current, states without one only group substates.
+//Like the flat tree, it does not own its blackboard.
+class FiniteStateMachine final : public IDecisionMaking
+{
+public:
+	using Condition = bool(*)(Blackboard*);
+	using ConditionMask = uint64_t;
+
+	static constexpr uint32_t MaxConditions = 64;
+	static constexpr uint32_t NoState = UINT32_MAX;
+
+	explicit FiniteStateMachine(Blackboard* pBlackBoard);
+	~FiniteStateMachine();
+
+	FiniteStateMachine(const FiniteStateMachine& other) = delete;
+	FiniteStateMachine& operator=(const FiniteStateMachine& other) = delete;
+	FiniteStateMachine(FiniteStateMachine&& other) = delete;
+	FiniteStateMachine& operator=(FiniteStateMachine&& other) = delete;
+
+	//Returns the bit of the condition. With MaxConditions already there is no bit left, the warning is followed by
+	//Compile failing, a mask of 0 would let the transitions that use it pass
+	ConditionMask AddCondition(const char* pName, Condition fpCondition, std::vector<BlackboardDependency> dependencies);
+	//Takes ownership of the behavior, nullptr for a state that only groups substates. Returns the index of the state
+	uint32_t AddState(const char* pName, IBehavior* pBehavior, uint32_t parentState = NoState);
+	//A transition to the current state keeps it without checking the transitions after it.
+	//A bit is either required or forbidden, a transition with both never fires
+	void AddTransition(uint32_t fromState, uint32_t toState, ConditionMask required, ConditionMask forbidden = 0);
+	//Builds the table, call once after the last transition. False when a condition did not fit,
+	//or a transition or the initial state has no behavior to run
+	bool Compile(uint32_t initialState);
+
+	virtual void Update(float deltaTime) override;
+	bool ValidateDependencies() const;
+
+	uint32_t GetCurrentState() const { return m_CurrentState; }
+	const char* GetStateName(uint32_t stateIndex) const { return m_States[stateIndex].pName; }
+	//Conditions evaluated and transitions taken since the machine was built
+	size_t GetEvaluationCount() const { return m_EvaluationCount; }
+	size_t GetTransitionCount() const { return m_TransitionCount; }
+	size_t GetConditionCount() const { return m_Conditions.size(); }
+
+private:
+	struct State
+	{
+		const char* pName;
+		IBehavior* pBehavior;
+		uint32_t parentState;
+	};
+
+	struct Transition
+	{
+		ConditionMask required;
+		ConditionMask forbidden;
+		uint32_t fromState;
+		uint32_t toState;
+		uint32_t conditionBegin; //Of the tested conditions in m_TransitionConditions, required ones first
+		uint32_t conditionEnd;
+	};
+
+	Blackboard* m_pBlackBoard = nullptr;
+	BehaviorTreeContext m_Context{};
+
+	std::vector<Condition> m_Conditions{};
+	std::vector<const char*> m_ConditionNames{};
+	std::vector<std::vector<BlackboardDependency>> m_ConditionDependencies{};
+	bool m_HasConditionOverflow = false;
+	std::vector<State> m_States{};
+	std::vector<Transition> m_Transitions{}; //As they were added, Compile orders them per state
+
+	//Compiled, row s of the table holds the transitions of state s in the order they are checked
+	std::vector<Transition> m_Table{};
+	std::vector<uint32_t> m_RowSizes{};
+	uint32_t m_RowLength = 0;
+	std::vector<uint8_t> m_TransitionConditions{};
+
+	uint32_t m_CurrentState = NoState;
+	BehaviorState m_CurrentResult = BehaviorState::Failure;
+	size_t m_EvaluationCount = 0;
+	size_t m_TransitionCount = 0;
+};
@@ -0,0 +1,188 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "EFlatBehaviorTree.h"
+
+//-----------------------------------------------------------------
+// FLAT BEHAVIOR TREE
+//-----------------------------------------------------------------
+FlatBehaviorTree::FlatBehaviorTree(Blackboard* pBlackBoard, const IBehavior* pRootBehavior)
+	: m_pBlackBoard(pBlackBoard)
+{
+	Compile(pRootBehavior);
+}
+
+bool FlatBehaviorTree::Compile(const IBehavior* pRootBehavior)
+{
+	m_Nodes.clear();
+	m_Conditions.clear();
+	m_Actions.clear();
+	m_PartialSequenceIndices.clear();
+	m_Depth = 0;
+	m_MaxDepth = 0;
+
+	if (pRootBehavior == nullptr || !pRootBehavior->Flatten(*this))
+	{
+		printf("WARNING: Behavior tree has nodes without a flat form, it can not be compiled \n");
+		m_Nodes.clear();
+		return false;
+	}
+
+	// Execution never grows the stack past the deepest composite
+	m_Stack.resize(m_MaxDepth);
+	return true;
+}
+
+void FlatBehaviorTree::Update(float)
+{
+	if (m_Nodes.empty())
+	{
+		m_CurrentState = BehaviorState::Failure;
+		return;
+	}
+
+	//Changes of the previous tick are delivered in one batch before deciding
+	m_pBlackBoard->DispatchNotifications();
+
+	m_CurrentState = Execute(m_pBlackBoard);
+}
+
+BehaviorState FlatBehaviorTree::Execute(Blackboard* pBlackBoard)
+{
+	if (m_Nodes.empty())
+		return BehaviorState::Failure;
+
+	// Stack of the composites above the current node, sized to the tree depth when compiling
+	const FlatBehaviorNode* pNodes = m_Nodes.data();
+	uint32_t* pStack = m_Stack.data();
+	int top = -1;
+	uint32_t index = 0;
+	BehaviorState result = BehaviorState::Failure;
+
+	for (;;)
+	{
+		// Descend until a node produces a result
+		const FlatBehaviorNode& node = pNodes[index];
+		switch (node.type)
+		{
+		case FlatBehaviorType::Conditional:
+			result = m_Conditions[node.data](pBlackBoard) ? BehaviorState::Success : BehaviorState::Failure;
+			break;
+		case FlatBehaviorType::NotConditional:
+			result = m_Conditions[node.data](pBlackBoard) ? BehaviorState::Failure : BehaviorState::Success;
+			break;
+		case FlatBehaviorType::Action:
+			result = m_Actions[node.data](pBlackBoard);
+			break;
+		case FlatBehaviorType::Selector:
+		case FlatBehaviorType::Sequence:
+			if (node.childCount == 0)
+			{
+				result = node.type == FlatBehaviorType::Selector ? BehaviorState::Failure : BehaviorState::Success;
+				break;
+			}
+			pStack[++top] = index;
+			++index;
+			continue;
+		case FlatBehaviorType::PartialSequence:
+		{
+			// Runs one child per tick, succeeds on the tick after the last child succeeded
+			uint32_t& resumeIndex = m_PartialSequenceIndices[node.data];
+			if (resumeIndex >= node.childCount)
+			{
+				resumeIndex = 0;
+				result = BehaviorState::Success;
+				break;
+			}
+			pStack[++top] = index;
+			index = GetFirstChild(index, resumeIndex);
+			continue;
+		}
+		}
+
+		// Pass the result of node index up until a composite continues with its next child
+		for (;;)
+		{
+			if (top < 0)
+				return result;
+
+			const uint32_t parentIndex = pStack[top];
+			const FlatBehaviorNode& parent = pNodes[parentIndex];
+			const uint32_t nextChild = pNodes[index].subtreeEnd;
+			if (parent.type == FlatBehaviorType::Selector)
+			{
+				if (result == BehaviorState::Failure && nextChild < parent.subtreeEnd)
+				{
+					index = nextChild;
+					break;
+				}
+			}
+			else if (parent.type == FlatBehaviorType::Sequence)
+			{
+				if (result == BehaviorState::Success && nextChild < parent.subtreeEnd)
+				{
+					index = nextChild;
+					break;
+				}
+			}
+			else if (result == BehaviorState::Failure)
+			{
+				m_PartialSequenceIndices[parent.data] = 0;
+			}
+			else if (result == BehaviorState::Success)
+			{
+				++m_PartialSequenceIndices[parent.data];
+				result = BehaviorState::Running;
+			}
+
+			// A selector that ran out of children failed, a sequence that did succeeded: result already says so
+			index = parentIndex;
+			--top;
+		}
+	}
+}
+
+uint32_t FlatBehaviorTree::BeginComposite(FlatBehaviorType type, uint32_t childCount)
+{
+	uint32_t data{};
+	if (type == FlatBehaviorType::PartialSequence)
+	{
+		data = static_cast<uint32_t>(m_PartialSequenceIndices.size());
+		m_PartialSequenceIndices.push_back(0);
+	}
+
+	m_Nodes.push_back(FlatBehaviorNode{ type, 0, childCount, data });
+
+	++m_Depth;
+	m_MaxDepth = std::max(m_MaxDepth, m_Depth);
+	return static_cast<uint32_t>(m_Nodes.size() - 1);
+}
+
+void FlatBehaviorTree::EndComposite(uint32_t nodeIndex)
+{
+	m_Nodes[nodeIndex].subtreeEnd = static_cast<uint32_t>(m_Nodes.size());
+	--m_Depth;
+}
+
+void FlatBehaviorTree::AddCondition(FlatBehaviorType type, Condition fpCondition)
+{
+	const uint32_t nodeIndex = static_cast<uint32_t>(m_Nodes.size());
+	m_Nodes.push_back(FlatBehaviorNode{ type, nodeIndex + 1, 0, static_cast<uint32_t>(m_Conditions.size()) });
+	m_Conditions.push_back(fpCondition);
+}
+
+void FlatBehaviorTree::AddAction(Action fpAction)
+{
+	const uint32_t nodeIndex = static_cast<uint32_t>(m_Nodes.size());
+	m_Nodes.push_back(FlatBehaviorNode{ FlatBehaviorType::Action, nodeIndex + 1, 0, static_cast<uint32_t>(m_Actions.size()) });
+	m_Actions.push_back(fpAction);
+}
+
+uint32_t FlatBehaviorTree::GetFirstChild(uint32_t nodeIndex, uint32_t childOrdinal) const
+{
+	uint32_t child = nodeIndex + 1;
+	for (uint32_t i{}; i < childOrdinal; ++i)
+	{
+		child = m_Nodes[child].subtreeEnd;
+	}
+	return child;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "EBehaviorTree.h"
+
+//-----------------------------------------------------------------
+// FLAT BEHAVIOR TREE HELPERS
+//-----------------------------------------------------------------
+enum class FlatBehaviorType : uint8_t
+{
+	Selector,
+	Sequence,
+	PartialSequence,
+	Conditional,
+	NotConditional,
+	Action
+};
+
+//Nodes are stored in pre-order, so the children of a node start right after it
+//and every subtree is the index range [node, subtreeEnd)
+struct FlatBehaviorNode
+{
+	FlatBehaviorType type;
+	uint32_t subtreeEnd;
+	uint32_t childCount;
+	uint32_t data; //Function index of a leaf, state index of a partial sequence
+};
+
+//-----------------------------------------------------------------
+// FLAT BEHAVIOR TREE
+//-----------------------------------------------------------------
+//Compiled form of a pointer tree. Executes iteratively over one array of nodes,
+//without recursion, virtual calls or std::function calls.
+//Gives the same results as the tree it was compiled from, which keeps ownership of its blackboard.
+class FlatBehaviorTree final : public IDecisionMaking
+{
+public:
+	using Condition = bool(*)(Blackboard*);
+	using Action = BehaviorState(*)(Blackboard*);
+
+	FlatBehaviorTree() = default;
+	FlatBehaviorTree(Blackboard* pBlackBoard, const IBehavior* pRootBehavior);
+	~FlatBehaviorTree() = default;
+
+	//Replaces the current nodes, false if a node of the tree has no flat form
+	bool Compile(const IBehavior* pRootBehavior);
+
+	virtual void Update(float deltaTime) override;
+	BehaviorState Execute(Blackboard* pBlackBoard);
+
+	const std::vector<FlatBehaviorNode>& GetNodes() const { return m_Nodes; }
+	bool IsCompiled() const { return !m_Nodes.empty(); }
+	Condition GetCondition(uint32_t conditionIndex) const { return m_Conditions[conditionIndex]; }
+	Action GetAction(uint32_t actionIndex) const { return m_Actions[actionIndex]; }
+	uint32_t GetPartialSequenceCount() const { return static_cast<uint32_t>(m_PartialSequenceIndices.size()); }
+
+	//Used by IBehavior::Flatten while compiling
+	uint32_t BeginComposite(FlatBehaviorType type, uint32_t childCount);
+	void EndComposite(uint32_t nodeIndex);
+	void AddCondition(FlatBehaviorType type, Condition fpCondition);
+	void AddAction(Action fpAction);
+
+private:
+	Blackboard* m_pBlackBoard = nullptr;
+	BehaviorState m_CurrentState = BehaviorState::Failure;
+
+	std::vector<FlatBehaviorNode> m_Nodes{};
+	std::vector<Condition> m_Conditions{};
+	std::vector<Action> m_Actions{};
+	std::vector<uint32_t> m_PartialSequenceIndices{}; //Child to resume, per partial sequence
+	std::vector<uint32_t> m_Stack{}; //Composites above the current node, sized to the tree depth when compiling
+
+	uint32_t m_Depth = 0;
+	uint32_t m_MaxDepth = 0;
+
+	uint32_t GetFirstChild(uint32_t nodeIndex, uint32_t childOrdinal) const;
+};
@@ -0,0 +1,272 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "EGoapPlanner.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+	uint32_t CountFacts(GoapState state)
+	{
+		uint32_t count{};
+		for (; state != 0; state &= state - 1)
+		{
+			++count;
+		}
+		return count;
+	}
+}
+
+//-----------------------------------------------------------------
+// GOAP PLANNER
+//-----------------------------------------------------------------
+GoapPlanner::GoapPlanner(Blackboard* pBlackBoard, float budgetMicroseconds)
+	: m_pBlackBoard(pBlackBoard)
+	, m_Budget(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::micro>(budgetMicroseconds)))
+{
+	m_SearchNodes.reserve(MaxSearchNodes);
+	m_OpenNodes.reserve(MaxSearchNodes);
+}
+
+GoapPlanner::~GoapPlanner()
+{
+	for (Action& action : m_Actions)
+	{
+		SAFE_DELETE(action.pBehavior);
+	}
+	SAFE_DELETE(m_pFallback);
+}
+
+GoapState GoapPlanner::AddFact(const char* pName, Fact fpFact, std::vector<BlackboardDependency> dependencies)
+{
+	if (m_Facts.size() >= MaxFacts)
+	{
+		printf("WARNING: GOAP fact '%s' does not fit the world state, it never holds \n", pName);
+		return 0;
+	}
+
+	m_Facts.push_back(fpFact);
+	m_FactNames.push_back(pName);
+	m_FactDependencies.push_back(std::move(dependencies));
+	return GoapState{ 1 } << (m_Facts.size() - 1);
+}
+
+uint32_t GoapPlanner::AddAction(const char* pName, IBehavior* pBehavior, float cost, GoapState required, GoapState forbidden, GoapState added, GoapState removed)
+{
+	if (m_Actions.size() >= MaxActions)
+	{
+		printf("WARNING: GOAP action '%s' does not fit a plan, it is never planned \n", pName);
+		SAFE_DELETE(pBehavior);
+		return NoAction;
+	}
+
+	cost = std::max(cost, 1.f);
+	const uint32_t changedCount = CountFacts(added | removed);
+	if (changedCount > 0)
+		m_CostPerFact = std::min(m_CostPerFact, cost / changedCount);
+
+	pBehavior->BindContext(&m_Context);
+	m_Actions.push_back(Action{ pName, pBehavior, cost, required, forbidden, added, removed });
+	ClearCache();
+	return static_cast<uint32_t>(m_Actions.size() - 1);
+}
+
+uint32_t GoapPlanner::AddGoal(const char* pName, GoapState required, GoapState forbidden)
+{
+	m_Goals.push_back(Goal{ pName, required, forbidden });
+	return static_cast<uint32_t>(m_Goals.size() - 1);
+}
+
+void GoapPlanner::SetFallback(IBehavior* pBehavior)
+{
+	SAFE_DELETE(m_pFallback);
+	m_pFallback = pBehavior;
+	if (m_pFallback != nullptr)
+		m_pFallback->BindContext(&m_Context);
+}
+
+GoapState GoapPlanner::SampleState()
+{
+	GoapState state{};
+	for (size_t i{}; i < m_Facts.size(); ++i)
+	{
+		if (m_Facts[i](m_pBlackBoard))
+			state |= GoapState{ 1 } << i;
+	}
+	return state;
+}
+
+void GoapPlanner::Update(float deltaTime)
+{
+	//Changes of the previous tick are delivered in one batch before deciding
+	m_pBlackBoard->DispatchNotifications();
+	m_Context.conditionMemo.NextTick();
+	m_Context.scheduler.Advance(deltaTime);
+
+	const GoapState state = SampleState();
+
+	// The goals share the budget, a lookup costs next to nothing of it.
+	// Like a selector, a first action that fails gives way to the next goal
+	Clock::duration planningTime{};
+	bool isOverBudget = false;
+	bool isDone = false;
+	for (uint32_t goalIndex{}; !isDone && goalIndex < m_Goals.size(); ++goalIndex)
+	{
+		if (IsMet(state, m_Goals[goalIndex]))
+			continue;
+
+		// After a search ran out of time, lower goals only look up the cache so that search is kept for the next tick
+		const Clock::time_point start = Clock::now();
+		const Plan* pPlan = nullptr;
+		if (!isOverBudget)
+		{
+			pPlan = FindPlan(state, goalIndex, start + m_Budget - planningTime);
+			isOverBudget = pPlan == nullptr;
+		}
+		else
+		{
+			auto foundIt = m_Cache.find(GetKey(state, goalIndex));
+			pPlan = foundIt != m_Cache.end() ? &foundIt->second : nullptr;
+		}
+		planningTime += Clock::now() - start;
+
+		if (pPlan != nullptr && !pPlan->empty())
+			isDone = RunBehavior(m_Actions[pPlan->front()].pBehavior) != BehaviorState::Failure;
+	}
+	if (!isDone)
+		RunBehavior(m_pFallback);
+
+	m_LastPlanningTime = std::chrono::duration<double, std::micro>(planningTime).count();
+	m_MaxPlanningTime = std::max(m_MaxPlanningTime, m_LastPlanningTime);
+	m_TotalPlanningTime += m_LastPlanningTime;
+}
+
+const GoapPlanner::Plan* GoapPlanner::FindPlan(GoapState state, uint32_t goalIndex, Clock::time_point deadline)
+{
+	const uint64_t key = GetKey(state, goalIndex);
+	auto foundIt = m_Cache.find(key);
+	if (foundIt != m_Cache.end())
+	{
+		++m_CacheHitCount;
+		return &foundIt->second;
+	}
+
+	// A different search in progress is dropped, the state it started from is gone
+	if (m_SearchKey != key)
+		StartSearch(state, goalIndex);
+	if (!ContinueSearch(deadline))
+	{
+		++m_OverBudgetCount;
+		return nullptr;
+	}
+
+	return &m_Cache[key];
+}
+
+float GoapPlanner::GetHeuristic(GoapState state, const Goal& goal) const
+{
+	const GoapState wrongFacts = (goal.required & ~state) | (goal.forbidden & state);
+	return CountFacts(wrongFacts) * m_CostPerFact;
+}
+
+void GoapPlanner::StartSearch(GoapState state, uint32_t goalIndex)
+{
+	m_SearchKey = GetKey(state, goalIndex);
+	m_SearchNodes.clear();
+	m_OpenNodes.clear();
+	m_BestCosts.clear();
+
+	m_SearchNodes.push_back(SearchNode{ state, 0.f, UINT32_MAX, NoAction });
+	m_OpenNodes.push_back(OpenNode{ GetHeuristic(state, m_Goals[goalIndex]), 0 });
+	m_BestCosts[state] = 0.f;
+	++m_SearchCount;
+}
+
+bool GoapPlanner::ContinueSearch(Clock::time_point deadline)
+{
+	const Goal& goal = m_Goals[static_cast<uint32_t>(m_SearchKey >> 32)];
+	Plan plan{};
+	while (!m_OpenNodes.empty())
+	{
+		if (Clock::now() >= deadline)
+			return false;
+
+		std::pop_heap(m_OpenNodes.begin(), m_OpenNodes.end(), std::greater<OpenNode>{});
+		const uint32_t nodeIndex = m_OpenNodes.back().node;
+		m_OpenNodes.pop_back();
+		const SearchNode node = m_SearchNodes[nodeIndex];
+
+		// Stale entry, the state was reached cheaper after it was queued
+		if (node.cost > m_BestCosts[node.state])
+			continue;
+
+		if (IsMet(node.state, goal))
+		{
+			for (uint32_t i = nodeIndex; m_SearchNodes[i].action != NoAction; i = m_SearchNodes[i].parentNode)
+			{
+				plan.push_back(static_cast<uint8_t>(m_SearchNodes[i].action));
+			}
+			std::reverse(plan.begin(), plan.end());
+			break;
+		}
+
+		if (m_SearchNodes.size() >= MaxSearchNodes)
+		{
+			printf("WARNING: GOAP search for goal '%s' expanded %zu nodes, the goal is treated as unreachable \n", goal.pName, MaxSearchNodes);
+			break;
+		}
+
+		for (uint32_t actionIndex{}; actionIndex < m_Actions.size(); ++actionIndex)
+		{
+			const Action& action = m_Actions[actionIndex];
+			if ((node.state & action.required) != action.required || (node.state & action.forbidden) != 0)
+				continue;
+
+			const GoapState nextState = (node.state | action.added) & ~action.removed;
+			const float nextCost = node.cost + action.cost;
+			auto bestIt = m_BestCosts.find(nextState);
+			if (bestIt != m_BestCosts.end() && bestIt->second <= nextCost)
+				continue;
+
+			m_BestCosts[nextState] = nextCost;
+			m_SearchNodes.push_back(SearchNode{ nextState, nextCost, nodeIndex, actionIndex });
+			m_OpenNodes.push_back(OpenNode{ nextCost + GetHeuristic(nextState, goal), static_cast<uint32_t>(m_SearchNodes.size() - 1) });
+			std::push_heap(m_OpenNodes.begin(), m_OpenNodes.end(), std::greater<OpenNode>{});
+		}
+	}
+
+	// Done, an empty plan marks the goal as unreachable from this state
+	m_Cache[m_SearchKey] = std::move(plan);
+	m_SearchKey = NoSearch;
+	return true;
+}
+
+BehaviorState GoapPlanner::RunBehavior(IBehavior* pBehavior)
+{
+	if (pBehavior != m_pRunningBehavior && m_pRunningBehavior != nullptr)
+		m_pRunningBehavior->Abort();
+	m_pRunningBehavior = pBehavior;
+
+	return m_pRunningBehavior != nullptr ? m_pRunningBehavior->ExecuteProfiled(m_pBlackBoard) : BehaviorState::Failure;
+}
+
+bool GoapPlanner::ValidateDependencies() const
+{
+	bool isValid = true;
+	for (size_t i{}; i < m_Facts.size(); ++i)
+	{
+		if (!BehaviorLeaf::CheckDependencies(m_pBlackBoard, m_FactDependencies[i]))
+		{
+			printf("WARNING: GOAP fact '%s' reads keys the blackboard does not have \n", m_FactNames[i]);
+			isValid = false;
+		}
+	}
+	for (const Action& action : m_Actions)
+	{
+		isValid &= action.pBehavior->ValidateDependencies(m_pBlackBoard);
+	}
+	if (m_pFallback != nullptr)
+		isValid &= m_pFallback->ValidateDependencies(m_pBlackBoard);
+	return isValid;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <chrono>
+
+#include "EBehaviorTree.h"
+
+//World state of the planner, one bit per fact
+using GoapState = uint32_t;
+
+//-----------------------------------------------------------------
+// GOAP PLANNER
+//-----------------------------------------------------------------
+//Goal oriented action planning. Every tick the facts are sampled into a GoapState, the first goal of the
+//priority list that is not met and has a plan runs the first action of that plan, the fallback runs otherwise.
+//The plan is not followed step by step, the next tick plans again from the new state, which is a cache hit.
+//Plans are found with A* over the preconditions and effects of the actions and cached by state and goal, so once
+//the agent has been in a state the plan is a hash lookup. Searches that run out of the budget of a tick
+//continue on the next one, in the meantime lower goals with a plan or the fallback run.
+//Like the flat tree, it does not own its blackboard.
+class GoapPlanner final : public IDecisionMaking
+{
+public:
+	using Fact = bool(*)(Blackboard*);
+	using Clock = std::chrono::high_resolution_clock;
+	using Plan = std::vector<uint8_t>; //Action indices, empty when the goal can not be reached
+
+	static constexpr uint32_t MaxFacts = 32;
+	static constexpr uint32_t MaxActions = 255;
+	static constexpr size_t MaxSearchNodes = 4096; //A search that expands more gives up on the goal
+
+	GoapPlanner(Blackboard* pBlackBoard, float budgetMicroseconds);
+	~GoapPlanner();
+
+	GoapPlanner(const GoapPlanner& other) = delete;
+	GoapPlanner& operator=(const GoapPlanner& other) = delete;
+	GoapPlanner(GoapPlanner&& other) = delete;
+	GoapPlanner& operator=(GoapPlanner&& other) = delete;
+
+	//Returns the bit of the fact, 0 after a warning when there are MaxFacts already
+	GoapState AddFact(const char* pName, Fact fpFact, std::vector<BlackboardDependency> dependencies);
+	//Takes ownership of the behavior. The action can run when every required fact holds and no forbidden one,
+	//afterwards the added facts hold and the removed ones do not. Cost is at least 1
+	uint32_t AddAction(const char* pName, IBehavior* pBehavior, float cost, GoapState required, GoapState forbidden, GoapState added, GoapState removed);
+	//Goals are checked in the order they were added
+	uint32_t AddGoal(const char* pName, GoapState required, GoapState forbidden);
+	//Takes ownership, runs while no goal has a plan
+	void SetFallback(IBehavior* pBehavior);
+
+	virtual void Update(float deltaTime) override;
+	bool ValidateDependencies() const;
+
+	//The cached plan, or the search continued until the deadline. nullptr while the search is not done
+	const Plan* FindPlan(GoapState state, uint32_t goalIndex, Clock::time_point deadline);
+	void ClearCache() { m_Cache.clear(); m_SearchKey = NoSearch; }
+	GoapState SampleState();
+
+	//Planning statistics since the planner was built, times in microseconds
+	double GetLastPlanningTime() const { return m_LastPlanningTime; }
+	double GetMaxPlanningTime() const { return m_MaxPlanningTime; }
+	double GetTotalPlanningTime() const { return m_TotalPlanningTime; }
+	size_t GetCacheHitCount() const { return m_CacheHitCount; }
+	size_t GetSearchCount() const { return m_SearchCount; }
+	size_t GetOverBudgetCount() const { return m_OverBudgetCount; } //Ticks that left a search for the next one
+	size_t GetCachedPlanCount() const { return m_Cache.size(); }
+	const char* GetActionName(uint32_t actionIndex) const { return m_Actions[actionIndex].pName; }
+	size_t GetFactCount() const { return m_Facts.size(); }
+	size_t GetActionCount() const { return m_Actions.size(); }
+	size_t GetGoalCount() const { return m_Goals.size(); }
+
+private:
+	static constexpr uint64_t NoSearch = UINT64_MAX;
+	static constexpr uint32_t NoAction = UINT32_MAX;
+
+	struct Action
+	{
+		const char* pName;
+		IBehavior* pBehavior;
+		float cost;
+		GoapState required;
+		GoapState forbidden;
+		GoapState added;
+		GoapState removed;
+	};
+
+	struct Goal
+	{
+		const char* pName;
+		GoapState required;
+		GoapState forbidden;
+	};
+
+	struct SearchNode
+	{
+		GoapState state;
+		float cost;
+		uint32_t parentNode;
+		uint32_t action;
+	};
+
+	struct OpenNode
+	{
+		float estimate; //Cost so far plus the heuristic
+		uint32_t node;
+		bool operator>(const OpenNode& other) const { return estimate > other.estimate; }
+	};
+
+	Blackboard* m_pBlackBoard = nullptr;
+	BehaviorTreeContext m_Context{};
+	Clock::duration m_Budget;
+
+	std::vector<Fact> m_Facts{};
+	std::vector<const char*> m_FactNames{};
+	std::vector<std::vector<BlackboardDependency>> m_FactDependencies{};
+	std::vector<Action> m_Actions{};
+	std::vector<Goal> m_Goals{};
+	IBehavior* m_pFallback = nullptr;
+	float m_CostPerFact = 1.f; //Lowest cost of an action over the facts it changes, keeps the heuristic admissible
+
+	//Goal index in the high half of the key, the state in the low half
+	std::unordered_map<uint64_t, Plan> m_Cache{};
+
+	//The search in progress, kept between ticks
+	uint64_t m_SearchKey = NoSearch;
+	std::vector<SearchNode> m_SearchNodes{};
+	std::vector<OpenNode> m_OpenNodes{}; //Min heap on the estimate
+	std::unordered_map<GoapState, float> m_BestCosts{};
+
+	IBehavior* m_pRunningBehavior = nullptr;
+
+	double m_LastPlanningTime = 0.0;
+	double m_MaxPlanningTime = 0.0;
+	double m_TotalPlanningTime = 0.0;
+	size_t m_CacheHitCount = 0;
+	size_t m_SearchCount = 0;
+	size_t m_OverBudgetCount = 0;
+
+	static uint64_t GetKey(GoapState state, uint32_t goalIndex) { return (uint64_t{ goalIndex } << 32) | state; }
+	bool IsMet(GoapState state, const Goal& goal) const { return (state & goal.required) == goal.required && (state & goal.forbidden) == 0; }
+	float GetHeuristic(GoapState state, const Goal& goal) const;
+	void StartSearch(GoapState state, uint32_t goalIndex);
+	//False when the deadline passed before the search was done
+	bool ContinueSearch(Clock::time_point deadline);
+	BehaviorState RunBehavior(IBehavior* pBehavior);
+};
@@ -0,0 +1,206 @@
+#pragma once
+
+#include "EBehaviorTree.h"
+
+//-----------------------------------------------------------------
+// STATIC BEHAVIOR TREE
+//-----------------------------------------------------------------
+//Header-only form of a behavior tree, the whole tree is one type:
+//	Selector<Sequence<Cond<IsZombieInFOV>, Act<Shoot>>, ...>
+//Leaves are template arguments, so a tick compiles into one function without
+//virtual calls or std::function calls. Use the IBehavior classes for trees built at runtime.
+namespace BT_Static
+{
+	using Condition = bool(*)(Blackboard*);
+	using Action = BehaviorState(*)(Blackboard*);
+	using Dependencies = std::vector<BlackboardDependency>(*)();
+
+	inline bool ValidateLeaf(const Blackboard* pBlackBoard, Dependencies fpDependencies)
+	{
+		return fpDependencies == nullptr || BehaviorLeaf::CheckDependencies(pBlackBoard, fpDependencies());
+	}
+
+	//--- LEAVES ---
+	template<Condition fpCondition, Dependencies fpDependencies = nullptr>
+	struct Cond
+	{
+		BehaviorState Execute(Blackboard* pBlackBoard)
+		{
+			return fpCondition(pBlackBoard) ? BehaviorState::Success : BehaviorState::Failure;
+		}
+		bool ValidateDependencies(const Blackboard* pBlackBoard) const { return ValidateLeaf(pBlackBoard, fpDependencies); }
+	};
+
+	template<Condition fpCondition, Dependencies fpDependencies = nullptr>
+	struct NotCond
+	{
+		BehaviorState Execute(Blackboard* pBlackBoard)
+		{
+			return fpCondition(pBlackBoard) ? BehaviorState::Failure : BehaviorState::Success;
+		}
+		bool ValidateDependencies(const Blackboard* pBlackBoard) const { return ValidateLeaf(pBlackBoard, fpDependencies); }
+	};
+
+	template<Action fpAction, Dependencies fpDependencies = nullptr>
+	struct Act
+	{
+		BehaviorState Execute(Blackboard* pBlackBoard)
+		{
+			return fpAction(pBlackBoard);
+		}
+		bool ValidateDependencies(const Blackboard* pBlackBoard) const { return ValidateLeaf(pBlackBoard, fpDependencies); }
+	};
+
+	//--- SELECTOR ---
+	//First child that does not fail decides, fails when every child failed
+	template<typename... Children>
+	struct Selector
+	{
+		BehaviorState Execute(Blackboard*) { return BehaviorState::Failure; }
+		bool ValidateDependencies(const Blackboard*) const { return true; }
+	};
+
+	template<typename First, typename... Rest>
+	struct Selector<First, Rest...>
+	{
+		First first;
+		Selector<Rest...> rest;
+
+		BehaviorState Execute(Blackboard* pBlackBoard)
+		{
+			const BehaviorState state = first.Execute(pBlackBoard);
+			if (state != BehaviorState::Failure)
+				return state;
+			return rest.Execute(pBlackBoard);
+		}
+		bool ValidateDependencies(const Blackboard* pBlackBoard) const
+		{
+			// Keep going after a failure so every missing key gets reported
+			const bool isValid = first.ValidateDependencies(pBlackBoard);
+			return rest.ValidateDependencies(pBlackBoard) && isValid;
+		}
+	};
+
+	//--- SEQUENCE ---
+	//First child that does not succeed decides, succeeds when every child succeeded
+	template<typename... Children>
+	struct Sequence
+	{
+		BehaviorState Execute(Blackboard*) { return BehaviorState::Success; }
+		bool ValidateDependencies(const Blackboard*) const { return true; }
+	};
+
+	template<typename First, typename... Rest>
+	struct Sequence<First, Rest...>
+	{
+		First first;
+		Sequence<Rest...> rest;
+
+		BehaviorState Execute(Blackboard* pBlackBoard)
+		{
+			const BehaviorState state = first.Execute(pBlackBoard);
+			if (state != BehaviorState::Success)
+				return state;
+			return rest.Execute(pBlackBoard);
+		}
+		bool ValidateDependencies(const Blackboard* pBlackBoard) const
+		{
+			const bool isValid = first.ValidateDependencies(pBlackBoard);
+			return rest.ValidateDependencies(pBlackBoard) && isValid;
+		}
+	};
+
+	//--- PARTIAL SEQUENCE ---
+	//Children executed by index, used to resume a partial sequence
+	template<typename... Children>
+	struct ChildList
+	{
+		BehaviorState Execute(uint32_t, Blackboard*) { return BehaviorState::Failure; }
+		bool ValidateDependencies(const Blackboard*) const { return true; }
+	};
+
+	template<typename First, typename... Rest>
+	struct ChildList<First, Rest...>
+	{
+		First first;
+		ChildList<Rest...> rest;
+
+		BehaviorState Execute(uint32_t index, Blackboard* pBlackBoard)
+		{
+			if (index == 0)
+				return first.Execute(pBlackBoard);
+			return rest.Execute(index - 1, pBlackBoard);
+		}
+		bool ValidateDependencies(const Blackboard* pBlackBoard) const
+		{
+			const bool isValid = first.ValidateDependencies(pBlackBoard);
+			return rest.ValidateDependencies(pBlackBoard) && isValid;
+		}
+	};
+
+	//Same as BehaviorPartialSequence: one child per tick, Running until the last child succeeded
+	template<typename... Children>
+	struct PartialSequence
+	{
+		ChildList<Children...> children;
+		uint32_t currentIndex = 0;
+
+		BehaviorState Execute(Blackboard* pBlackBoard)
+		{
+			if (currentIndex == sizeof...(Children))
+			{
+				currentIndex = 0;
+				return BehaviorState::Success;
+			}
+
+			const BehaviorState state = children.Execute(currentIndex, pBlackBoard);
+			switch (state)
+			{
+			case BehaviorState::Failure:
+				currentIndex = 0;
+				return BehaviorState::Failure;
+			case BehaviorState::Success:
+				++currentIndex;
+				return BehaviorState::Running;
+			default:
+				return state;
+			}
+		}
+		bool ValidateDependencies(const Blackboard* pBlackBoard) const { return children.ValidateDependencies(pBlackBoard); }
+	};
+
+	//--- OBSERVER ---
+	//Same results as BehaviorObserver, a static tree never resumes so it only guards its child
+	template<Condition fpCondition, Dependencies fpDependencies, typename Child>
+	using Observer = Sequence<Cond<fpCondition, fpDependencies>, Child>;
+}
+
+//Owns its nodes by value, the blackboard stays owned by the caller
+template<typename RootBehavior>
+class StaticBehaviorTree final : public IDecisionMaking
+{
+public:
+	explicit StaticBehaviorTree(Blackboard* pBlackBoard) : m_pBlackBoard(pBlackBoard) {}
+	~StaticBehaviorTree() = default;
+
+	virtual void Update(float) override
+	{
+		//Changes of the previous tick are delivered in one batch before deciding
+		m_pBlackBoard->DispatchNotifications();
+
+		m_CurrentState = m_RootBehavior.Execute(m_pBlackBoard);
+	}
+	BehaviorState Execute(Blackboard* pBlackBoard)
+	{
+		return m_RootBehavior.Execute(pBlackBoard);
+	}
+	bool ValidateDependencies() const
+	{
+		return m_RootBehavior.ValidateDependencies(m_pBlackBoard);
+	}
+
+private:
+	Blackboard* m_pBlackBoard = nullptr;
+	BehaviorState m_CurrentState = BehaviorState::Failure;
+	RootBehavior m_RootBehavior{};
+};
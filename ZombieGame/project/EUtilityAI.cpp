@@ -0,0 +1,178 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "EUtilityAI.h"
+
+#include <algorithm>
+
+//-----------------------------------------------------------------
+// RESPONSE CURVE
+//-----------------------------------------------------------------
+float ResponseCurve::Evaluate(float x) const
+{
+	float y{};
+	switch (type)
+	{
+	case ResponseCurveType::Linear:
+		y = slope * (x - shift) + offset;
+		break;
+	case ResponseCurveType::Polynomial:
+		y = slope * std::pow(std::abs(x - shift), exponent) + offset;
+		break;
+	case ResponseCurveType::Logistic:
+		y = 1.f / (1.f + std::exp(-slope * (x - shift))) + offset;
+		break;
+	default:
+		break;
+	}
+	return std::min(std::max(y, 0.f), 1.f);
+}
+
+//-----------------------------------------------------------------
+// UTILITY AI
+//-----------------------------------------------------------------
+UtilityAI::UtilityAI(Blackboard* pBlackBoard)
+	: m_pBlackBoard(pBlackBoard)
+{
+}
+
+UtilityAI::~UtilityAI()
+{
+	for (IBehavior* pBehavior : m_ActionBehaviors)
+	{
+		SAFE_DELETE(pBehavior);
+	}
+}
+
+uint32_t UtilityAI::AddInput(const char* pName, Input fpInput, std::vector<BlackboardDependency> dependencies)
+{
+	m_Inputs.push_back(fpInput);
+	m_InputNames.push_back(pName);
+	m_InputDependencies.push_back(std::move(dependencies));
+	m_InputValues.resize(m_Inputs.size());
+	return static_cast<uint32_t>(m_Inputs.size() - 1);
+}
+
+uint32_t UtilityAI::AddAction(const char* pName, IBehavior* pBehavior, float weight)
+{
+	pBehavior->BindContext(&m_Context);
+	m_ActionBehaviors.push_back(pBehavior);
+	m_ActionNames.push_back(pName);
+	m_Weights.push_back(weight);
+	m_Scores.resize(m_ActionBehaviors.size());
+	return static_cast<uint32_t>(m_ActionBehaviors.size() - 1);
+}
+
+void UtilityAI::AddConsideration(uint32_t actionIndex, uint32_t inputIndex, const ResponseCurve& curve)
+{
+	if (actionIndex >= m_ActionBehaviors.size() || inputIndex >= m_Inputs.size() || curve.type >= ResponseCurveType::Count)
+	{
+		printf("WARNING: Consideration of utility action %u uses an action, input or curve that does not exist \n", actionIndex);
+		return;
+	}
+
+	// Appended to the range of its curve type, the ranges after it move up by one
+	const size_t typeIndex = static_cast<size_t>(curve.type);
+	const uint32_t index = m_TypeBegin[typeIndex + 1];
+	m_ConsiderationInputs.insert(m_ConsiderationInputs.begin() + index, inputIndex);
+	m_ConsiderationActions.insert(m_ConsiderationActions.begin() + index, actionIndex);
+	m_Slopes.insert(m_Slopes.begin() + index, curve.slope);
+	m_Exponents.insert(m_Exponents.begin() + index, curve.exponent);
+	m_Shifts.insert(m_Shifts.begin() + index, curve.shift);
+	m_Offsets.insert(m_Offsets.begin() + index, curve.offset);
+	for (size_t i = typeIndex + 1; i < std::extent<decltype(m_TypeBegin)>::value; ++i)
+	{
+		++m_TypeBegin[i];
+	}
+	m_Responses.resize(m_ConsiderationInputs.size());
+}
+
+void UtilityAI::Update(float deltaTime)
+{
+	//Changes of the previous tick are delivered in one batch before deciding
+	m_pBlackBoard->DispatchNotifications();
+	m_Context.conditionMemo.NextTick();
+	m_Context.scheduler.Advance(deltaTime);
+
+	const uint32_t bestAction = Decide();
+	if (bestAction != m_CurrentAction && m_CurrentAction != NoAction)
+		m_ActionBehaviors[m_CurrentAction]->Abort();
+	m_CurrentAction = bestAction;
+
+	m_CurrentState = m_CurrentAction != NoAction ? m_ActionBehaviors[m_CurrentAction]->ExecuteProfiled(m_pBlackBoard) : BehaviorState::Failure;
+}
+
+uint32_t UtilityAI::Decide()
+{
+	if (m_ActionBehaviors.empty())
+		return NoAction;
+
+	const size_t inputCount = m_Inputs.size();
+	for (size_t i{}; i < inputCount; ++i)
+	{
+		m_InputValues[i] = m_Inputs[i](m_pBlackBoard);
+	}
+
+	// Raw pointers and restrict, so each loop below is vectorized without aliasing checks
+	float* __restrict pResponses = m_Responses.data();
+	const float* __restrict pSlopes = m_Slopes.data();
+	const float* __restrict pExponents = m_Exponents.data();
+	const float* __restrict pShifts = m_Shifts.data();
+	const float* __restrict pOffsets = m_Offsets.data();
+	const uint32_t* pInputs = m_ConsiderationInputs.data();
+	const uint32_t considerationCount = static_cast<uint32_t>(m_ConsiderationInputs.size());
+
+	for (uint32_t i{}; i < considerationCount; ++i)
+	{
+		pResponses[i] = m_InputValues[pInputs[i]];
+	}
+
+	const uint32_t linearEnd = m_TypeBegin[static_cast<size_t>(ResponseCurveType::Linear) + 1];
+	for (uint32_t i = m_TypeBegin[static_cast<size_t>(ResponseCurveType::Linear)]; i < linearEnd; ++i)
+	{
+		pResponses[i] = pSlopes[i] * (pResponses[i] - pShifts[i]) + pOffsets[i];
+	}
+	const uint32_t polynomialEnd = m_TypeBegin[static_cast<size_t>(ResponseCurveType::Polynomial) + 1];
+	for (uint32_t i = m_TypeBegin[static_cast<size_t>(ResponseCurveType::Polynomial)]; i < polynomialEnd; ++i)
+	{
+		pResponses[i] = pSlopes[i] * std::pow(std::abs(pResponses[i] - pShifts[i]), pExponents[i]) + pOffsets[i];
+	}
+	const uint32_t logisticEnd = m_TypeBegin[static_cast<size_t>(ResponseCurveType::Logistic) + 1];
+	for (uint32_t i = m_TypeBegin[static_cast<size_t>(ResponseCurveType::Logistic)]; i < logisticEnd; ++i)
+	{
+		pResponses[i] = 1.f / (1.f + std::exp(-pSlopes[i] * (pResponses[i] - pShifts[i]))) + pOffsets[i];
+	}
+	for (uint32_t i{}; i < considerationCount; ++i)
+	{
+		pResponses[i] = std::min(std::max(pResponses[i], 0.f), 1.f);
+	}
+
+	// Products per action, few enough that the scatter does not need to be vectorized
+	std::copy(m_Weights.begin(), m_Weights.end(), m_Scores.begin());
+	for (uint32_t i{}; i < considerationCount; ++i)
+	{
+		m_Scores[m_ConsiderationActions[i]] *= pResponses[i];
+	}
+	if (m_CurrentAction != NoAction && m_CurrentState == BehaviorState::Running)
+		m_Scores[m_CurrentAction] *= 1.f + m_Commitment;
+
+	// The first of equal scores wins, actions are added in order of priority
+	return static_cast<uint32_t>(std::max_element(m_Scores.begin(), m_Scores.end()) - m_Scores.begin());
+}
+
+bool UtilityAI::ValidateDependencies() const
+{
+	bool isValid = true;
+	for (size_t i{}; i < m_Inputs.size(); ++i)
+	{
+		if (!BehaviorLeaf::CheckDependencies(m_pBlackBoard, m_InputDependencies[i]))
+		{
+			printf("WARNING: Utility input '%s' reads keys the blackboard does not have \n", m_InputNames[i]);
+			isValid = false;
+		}
+	}
+	for (const IBehavior* pBehavior : m_ActionBehaviors)
+	{
+		isValid &= pBehavior->ValidateDependencies(m_pBlackBoard);
+	}
+	return isValid;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "EBehaviorTree.h"
+
+//-----------------------------------------------------------------
+// RESPONSE CURVE
+//-----------------------------------------------------------------
+//Maps an input in [0, 1] to a score in [0, 1], results outside are clamped
+enum class ResponseCurveType : uint8_t
+{
+	Linear, //slope * (x - shift) + offset
+	Polynomial, //slope * |x - shift|^exponent + offset
+	Logistic, //1 / (1 + e^(-slope * (x - shift))) + offset, a soft threshold at shift
+	Count
+};
+
+struct ResponseCurve
+{
+	ResponseCurveType type;
+	float slope;
+	float exponent;
+	float shift;
+	float offset;
+
+	static ResponseCurve Linear(float slope = 1.f, float offset = 0.f) { return { ResponseCurveType::Linear, slope, 1.f, 0.f, offset }; }
+	static ResponseCurve Inverted() { return Linear(-1.f, 1.f); }
+	static ResponseCurve Polynomial(float exponent, float slope = 1.f, float shift = 0.f, float offset = 0.f) { return { ResponseCurveType::Polynomial, slope, exponent, shift, offset }; }
+	//Negative steepness falls from 1 to 0 around the midpoint
+	static ResponseCurve Logistic(float steepness, float midpoint) { return { ResponseCurveType::Logistic, steepness, 1.f, midpoint, 0.f }; }
+
+	//One input at a time, the utility AI evaluates its curves in batches instead
+	float Evaluate(float x) const;
+};
+
+//-----------------------------------------------------------------
+// UTILITY AI
+//-----------------------------------------------------------------
+//Scores every action each tick and runs the best one.
+//An action's score is its weight times the response of each of its considerations, an action
+//without considerations always scores its weight. Considerations are kept as arrays per curve type,
+//so each type is one loop without branches over all actions that compilers vectorize.
+//The actions are subtrees, aborted when another action wins. Like the flat tree, it does not own its blackboard.
+class UtilityAI final : public IDecisionMaking
+{
+public:
+	using Input = float(*)(Blackboard*);
+
+	static constexpr uint32_t NoAction = UINT32_MAX;
+
+	explicit UtilityAI(Blackboard* pBlackBoard);
+	~UtilityAI();
+
+	UtilityAI(const UtilityAI& other) = delete;
+	UtilityAI& operator=(const UtilityAI& other) = delete;
+	UtilityAI(UtilityAI&& other) = delete;
+	UtilityAI& operator=(UtilityAI&& other) = delete;
+
+	//An input is read once per tick, however many considerations use it. Returns its index
+	uint32_t AddInput(const char* pName, Input fpInput, std::vector<BlackboardDependency> dependencies);
+	//Takes ownership of the behavior. Returns the index of the action
+	uint32_t AddAction(const char* pName, IBehavior* pBehavior, float weight = 1.f);
+	void AddConsideration(uint32_t actionIndex, uint32_t inputIndex, const ResponseCurve& curve);
+	//Bonus on the score of the running action, so close scores do not swap the action every tick
+	void SetCommitment(float bonus) { m_Commitment = bonus; }
+
+	virtual void Update(float deltaTime) override;
+	//Scores the actions without running them, returns the best or NoAction when there are none
+	uint32_t Decide();
+	bool ValidateDependencies() const;
+
+	size_t GetActionCount() const { return m_ActionBehaviors.size(); }
+	const char* GetActionName(uint32_t actionIndex) const { return m_ActionNames[actionIndex]; }
+	const std::vector<float>& GetScores() const { return m_Scores; }
+	uint32_t GetCurrentAction() const { return m_CurrentAction; }
+	BehaviorState GetCurrentState() const { return m_CurrentState; }
+
+private:
+	Blackboard* m_pBlackBoard = nullptr;
+	BehaviorTreeContext m_Context{};
+	float m_Commitment = 0.1f;
+
+	//Inputs
+	std::vector<Input> m_Inputs{};
+	std::vector<const char*> m_InputNames{};
+	std::vector<std::vector<BlackboardDependency>> m_InputDependencies{};
+
+	//Actions
+	std::vector<IBehavior*> m_ActionBehaviors{};
+	std::vector<const char*> m_ActionNames{};
+	std::vector<float> m_Weights{};
+	uint32_t m_CurrentAction = NoAction;
+	BehaviorState m_CurrentState = BehaviorState::Failure;
+
+	//Considerations, sorted by curve type. Curve type t owns [m_TypeBegin[t], m_TypeBegin[t + 1])
+	std::vector<uint32_t> m_ConsiderationInputs{};
+	std::vector<uint32_t> m_ConsiderationActions{};
+	std::vector<float> m_Slopes{};
+	std::vector<float> m_Exponents{};
+	std::vector<float> m_Shifts{};
+	std::vector<float> m_Offsets{};
+	uint32_t m_TypeBegin[static_cast<size_t>(ResponseCurveType::Count) + 1]{};
+
+	//Per tick, sized when the AI is built
+	std::vector<float> m_InputValues{};
+	std::vector<float> m_Responses{};
+	std::vector<float> m_Scores{};
+};
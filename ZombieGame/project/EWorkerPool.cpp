@@ -0,0 +1,120 @@
+//=== General Includes ===
+#include "stdafx.h"
+#include "EWorkerPool.h"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(size_t workerCount)
+{
+	m_Workers.reserve(workerCount);
+	for (size_t i{}; i < workerCount; ++i)
+	{
+		m_Workers.emplace_back(&WorkerPool::WorkerLoop, this);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_IsStopping = true;
+	}
+	m_JobReady.notify_all();
+
+	for (auto& worker : m_Workers)
+	{
+		worker.join();
+	}
+}
+
+void WorkerPool::ParallelFor(size_t taskCount, const std::function<void(size_t)>& task, size_t grainSize)
+{
+	if (taskCount == 0)
+		return;
+
+	// Nothing to share, or nobody to share it with. Exceptions reach the caller directly
+	grainSize = std::max(grainSize, size_t{ 1 });
+	if (taskCount <= grainSize || m_Workers.empty())
+	{
+		for (size_t i{}; i < taskCount; ++i)
+		{
+			task(i);
+		}
+		return;
+	}
+
+	std::shared_ptr<Job> pJob = std::make_shared<Job>();
+	pJob->pTask = &task;
+	pJob->taskCount = taskCount;
+	pJob->grainSize = grainSize;
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_pJob = pJob;
+		++m_JobCount;
+	}
+	m_JobReady.notify_all();
+
+	RunTasks(*pJob);
+
+	std::unique_lock<std::mutex> lock{ m_Mutex };
+	m_JobDone.wait(lock, [&pJob]() { return pJob->finishedCount.load(std::memory_order_acquire) == pJob->taskCount; });
+	m_pJob = nullptr;
+
+	if (pJob->pException != nullptr)
+		std::rethrow_exception(pJob->pException);
+}
+
+void WorkerPool::WorkerLoop()
+{
+	uint64_t lastJob{};
+	for (;;)
+	{
+		std::shared_ptr<Job> pJob{};
+		{
+			std::unique_lock<std::mutex> lock{ m_Mutex };
+			m_JobReady.wait(lock, [this, lastJob]() { return m_IsStopping || m_JobCount != lastJob; });
+			if (m_IsStopping)
+				return;
+
+			lastJob = m_JobCount;
+			pJob = m_pJob;
+		}
+
+		// The job can already be finished by the time this worker woke up
+		if (pJob != nullptr)
+			RunTasks(*pJob);
+	}
+}
+
+void WorkerPool::RunTasks(Job& job)
+{
+	for (size_t begin = job.nextTask.fetch_add(job.grainSize, std::memory_order_relaxed); begin < job.taskCount; begin = job.nextTask.fetch_add(job.grainSize, std::memory_order_relaxed))
+	{
+		const size_t end = std::min(begin + job.grainSize, job.taskCount);
+		if (!job.hasFailed.load(std::memory_order_relaxed))
+		{
+			// A task that throws must still be counted, or ParallelFor would wait forever
+			try
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					(*job.pTask)(i);
+				}
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock{ m_Mutex };
+				if (job.pException == nullptr)
+					job.pException = std::current_exception();
+				job.hasFailed.store(true, std::memory_order_relaxed);
+			}
+		}
+
+		if (job.finishedCount.fetch_add(end - begin, std::memory_order_acq_rel) + (end - begin) == job.taskCount)
+		{
+			// Taking the lock makes sure ParallelFor is either waiting or has not checked yet
+			std::lock_guard<std::mutex> lock{ m_Mutex };
+			m_JobDone.notify_one();
+		}
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <exception>
+
+//-----------------------------------------------------------------
+// WORKER POOL
+//-----------------------------------------------------------------
+//A few threads that wait for fork-join work, started once and reused every tick.
+//ParallelFor hands out the tasks and returns when every task finished, the calling thread runs tasks as well.
+//An exception of a task is rethrown by ParallelFor after the join, the tasks that did not start yet are skipped.
+//Only one thread may call ParallelFor at a time.
+class WorkerPool final
+{
+public:
+	explicit WorkerPool(size_t workerCount);
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool& other) = delete;
+	WorkerPool& operator=(const WorkerPool& other) = delete;
+	WorkerPool(WorkerPool&& other) = delete;
+	WorkerPool& operator=(WorkerPool&& other) = delete;
+
+	//Calls task(i) once for every i in [0, taskCount). A thread takes grainSize tasks at a time,
+	//no more than grainSize tasks run on the calling thread without waking the workers
+	void ParallelFor(size_t taskCount, const std::function<void(size_t)>& task, size_t grainSize = 1);
+	size_t GetWorkerCount() const { return m_Workers.size(); }
+
+private:
+	//One call of ParallelFor, workers that wake up late only find its tasks taken
+	struct Job
+	{
+		const std::function<void(size_t)>* pTask;
+		size_t taskCount;
+		size_t grainSize;
+		std::atomic<size_t> nextTask{ 0 };
+		std::atomic<size_t> finishedCount{ 0 };
+		std::atomic<bool> hasFailed{ false };
+		std::exception_ptr pException = nullptr; //First exception of a task, written under m_Mutex
+	};
+
+	std::vector<std::thread> m_Workers{};
+	std::mutex m_Mutex{};
+	std::condition_variable m_JobReady{};
+	std::condition_variable m_JobDone{};
+	std::shared_ptr<Job> m_pJob = nullptr;
+	uint64_t m_JobCount = 0;
+	bool m_IsStopping = false;
+
+	void WorkerLoop();
+	void RunTasks(Job& job);
+};
@@ -3,11 +3,30 @@
 #include "IExamInterface.h"
 #include "EBlackboard.h"
 #include "EBehaviorTree.h"
+#include "EFlatBehaviorTree.h"
+#include "EStaticBehaviorTree.h"
+#include "EUtilityAI.h"
+#include "EFiniteStateMachine.h"
+#include "EGoapPlanner.h"
+#include "EWorkerPool.h"
 #include "Behaviors.h"
 #include "Structs.h"
+#include "BlackboardKeys.h"
+#include "Benchmarks.h"
 
 using namespace std;
 
+//ENTRY
+//This is the first function that is called by the host program
+//The plugin returned by this function is also the plugin used by the host program
+extern "C"
+{
+	__declspec (dllexport) IPluginBase* Register()
+	{
+		return new Plugin();
+	}
+}
+
 //Called only once, during initialization
 void Plugin::Initialize(IBaseInterface* pInterface, PluginInfo& info)
 {
@@ -24,262 +43,642 @@ void Plugin::Initialize(IBaseInterface* pInterface, PluginInfo& info)
 
 	// Blackboard creation
 
-	m_pBlackboard = new Blackboard();
-	m_pBlackboard->AddData(P_PLAYERINFO, m_pInterface->Agent_GetInfo());
-	m_pBlackboard->AddData(P_WORLDINFO, m_pInterface->World_GetInfo());
-	m_pBlackboard->AddData(P_TARGETINFO, Elite::Vector2{ 0, 0 });
-	m_pBlackboard->AddData(P_INTERFACE, m_pInterface);
-	m_pBlackboard->AddData(P_SHOULDEXPLORE, m_ShouldExplore);
-	m_pBlackboard->AddData(P_HOUSES_IN_FOV, m_HousesInFOV);
-	m_pBlackboard->AddData(P_ENEMIES_IN_FOV, &m_EnemiesInFOV);
-	m_pBlackboard->AddData(P_ITEMS_IN_FOV, &m_ItemsInFOV);
-	m_pBlackboard->AddData(P_STEERING, SteeringPlugin_Output{});
-	m_pBlackboard->AddData(P_LAST_POSITION, m_LastPosition);
-	m_pBlackboard->AddData(P_ACTIVE_HOUSE, HouseInfo{});
-	m_pBlackboard->AddData(P_KNOWN_HOUSES, std::vector<KnownHouse>());
+	m_pBlackboard = new Blackboard(BB_Keys::CreateLayout());
+	m_pSnapshots = new BlackboardSnapshots(BB_Keys::CreateLayout());
+	m_pBlackboard->AddData(BB_Keys::PlayerInfo, m_pInterface->Agent_GetInfo());
+	m_pBlackboard->AddData(BB_Keys::WorldInfo, m_pInterface->World_GetInfo());
+	m_pBlackboard->AddData(BB_Keys::TargetInfo, Elite::Vector2{ 0, 0 });
+	m_pBlackboard->AddData(BB_Keys::Interface, m_pInterface);
+	m_pBlackboard->AddData(BB_Keys::ShouldExplore, m_ShouldExplore);
+	m_pBlackboard->AddData(BB_Keys::HousesInFOV, m_HousesInFOV);
+	m_pBlackboard->AddData(BB_Keys::EnemiesInFOV, &m_EnemiesInFOV);
+	m_pBlackboard->AddData(BB_Keys::ItemsInFOV, &m_ItemsInFOV);
+	m_pBlackboard->AddData(BB_Keys::Steering, SteeringPlugin_Output{});
+	m_pBlackboard->AddData(BB_Keys::LastPosition, m_LastPosition);
+	m_pBlackboard->AddData(BB_Keys::ActiveHouse, HouseInfo{});
+	m_pBlackboard->AddData(BB_Keys::KnownHouses, std::vector<KnownHouse>());
+	m_pBlackboard->AddData(BB_Keys::KnownHouseSweepTimers, std::vector<float>());
 	
 	
-	m_pBlackboard->AddData(P_IS_GOING_FOR_HOUSE, false);
-	m_pBlackboard->AddData(P_INVENTORY, Inventory{});
-	m_pBlackboard->AddData(P_HOUSE_TO_SWEEP, SweepHouse{});
-	m_pBlackboard->AddData(P_ZOMBIE_TARGET, Elite::Vector2{});
-	m_pBlackboard->AddData(P_PLAYER_WAS_BITTEN, false);
-	m_pBlackboard->AddData(P_IS_IN_HOUSE, false);
+	m_pBlackboard->AddData(BB_Keys::IsGoingForHouse, false);
+	m_pBlackboard->AddData(BB_Keys::Inventory, Inventory{});
+	m_pBlackboard->AddData(BB_Keys::HouseToSweep, SweepHouse{});
+	m_pBlackboard->AddData(BB_Keys::ZombieTarget, Elite::Vector2{});
+	m_pBlackboard->AddData(BB_Keys::PlayerWasBitten, false);
+	m_pBlackboard->AddData(BB_Keys::IsInHouse, false);
 
 	// Exploration
-	m_pBlackboard->AddData(P_EXPLORE_LOCATIONS_TO_VISIT, m_RandomLocationsToVisit);
-	m_pBlackboard->AddData(P_EXPLORE_LOCATIONS_VISITED, m_RandomLocationsVisited);
-	m_pBlackboard->AddData(P_DESTINATION, Elite::Vector2{});
-	m_pBlackboard->AddData(P_DESTINATION_REACHED, false);
+	m_pBlackboard->AddData(BB_Keys::ExploreLocationsToVisit, m_RandomLocationsToVisit);
+	m_pBlackboard->AddData(BB_Keys::ExploreLocationsVisited, m_RandomLocationsVisited);
+	m_pBlackboard->AddData(BB_Keys::Destination, Elite::Vector2{});
+	m_pBlackboard->AddData(BB_Keys::DestinationReached, false);
+
+	// Subscriptions, delivered once at the start of the next tick
+	m_pBlackboard->Subscribe(BB_Keys::PlayerWasBitten, [this](Blackboard*) {
+		// A new bite or the bite being forgotten both restart the remember window
+		m_BittenTimer = 0.f;
+	});
 
 	// Tree creation
-	m_pBehaviorTree = new BehaviorTree(m_pBlackboard,
-		new BehaviorSelector{ {
+#if CONFIG_LOAD_BEHAVIOR_TREE
+	const BehaviorRegistry registry = BT_Registry::Create();
+	IBehavior* pRootBehavior = BehaviorTreeLoader{ registry }.LoadFile(CONFIG_BEHAVIOR_TREE_FILE);
+	if (pRootBehavior == nullptr)
+	{
+		printf("WARNING: Running the built-in behavior tree instead \n");
+		pRootBehavior = CreateRootBehavior();
+	}
+#else
+	IBehavior* pRootBehavior = CreateRootBehavior();
+#endif
+	m_pBehaviorTree = new BehaviorTree(m_pBlackboard, pRootBehavior);
+	m_pBehaviorTree->SetResumeRunning(CONFIG_RESUME_RUNNING_BEHAVIOR);
+#if CONFIG_MEMOIZE_PURE_CONDITIONS
+	m_pBehaviorTree->SetPureConditions(BT_PureConditions::PerTick());
+#endif
+#if CONFIG_BEHAVIOR_WORKER_COUNT > 0
+	m_pWorkerPool = new WorkerPool(CONFIG_BEHAVIOR_WORKER_COUNT);
+	m_pBehaviorTree->SetWorkerPool(m_pWorkerPool);
+#endif
+#if CONFIG_TRACE_BEHAVIOR_TREE && CONFIG_DRAIN_BEHAVIOR_TRACE
+	m_pBehaviorTree->GetTrace().StartDrain("BehaviorTrace.csv");
+#endif
+#if CONFIG_USE_FLAT_BEHAVIOR_TREE
+	m_pFlatBehaviorTree = new FlatBehaviorTree(m_pBlackboard, m_pBehaviorTree->GetRootBehavior());
+	m_pDecisionMaking = m_pFlatBehaviorTree->IsCompiled() ? static_cast<IDecisionMaking*>(m_pFlatBehaviorTree) : m_pBehaviorTree;
+#else
+	m_pDecisionMaking = m_pBehaviorTree;
+#endif
+
+	// Every key a leaf declared is checked once here, leaves do not look anything up by name
+	bool isTreeValid = m_pBehaviorTree->ValidateDependencies();
+#if CONFIG_USE_STATIC_BEHAVIOR_TREE
+	auto pStaticBehaviorTree = new StaticBehaviorTree<BT_Static::AgentRootBehavior>(m_pBlackboard);
+	isTreeValid &= pStaticBehaviorTree->ValidateDependencies();
+	m_pStaticBehaviorTree = pStaticBehaviorTree;
+	m_pDecisionMaking = m_pStaticBehaviorTree;
+#endif
+#if CONFIG_USE_UTILITY_AI
+	m_pUtilityAI = CreateUtilityAI(m_pBlackboard);
+	isTreeValid &= m_pUtilityAI->ValidateDependencies();
+	m_pDecisionMaking = m_pUtilityAI;
+#endif
+#if CONFIG_USE_STATE_MACHINE
+	m_pStateMachine = CreateStateMachine(m_pBlackboard);
+	isTreeValid &= m_pStateMachine->ValidateDependencies();
+	m_pDecisionMaking = m_pStateMachine;
+#endif
+#if CONFIG_USE_GOAP_PLANNER
+	m_pGoapPlanner = CreateGoapPlanner(m_pBlackboard);
+	isTreeValid &= m_pGoapPlanner->ValidateDependencies();
+	m_pDecisionMaking = m_pGoapPlanner;
+#endif
+	if (!isTreeValid)
+	{
+		printf("ERROR: Behavior tree does not match the Blackboard, shutting down \n");
+		m_pInterface->RequestShutdown();
+	}
+
+	std::random_device rd;
+	m_Rng = std::mt19937(rd());
+
+	Elite::Vector2 dim = m_pInterface->World_GetInfo().Dimensions;
+	Elite::Vector2 org = m_pInterface->World_GetInfo().Center;
+
+
+	m_LocationPicker = std::uniform_real_distribution<float>(0, CONFIG_RANDOM_LOCATION_COUNT);
+	m_Norm = std::uniform_real_distribution<float>(0.f, 1.f);
+
+	//
+	GenerateRandomVisitLocations();
+}
+
+//Bookkeeping branches do not need the frame rate, combat and steering keep it. A tick rate of 0 runs them every frame
+static IBehavior* AtBookkeepingRate(float tickRate, IBehavior* pBehavior)
+{
+	if (tickRate <= 0.f)
+		return pBehavior;
+	return new BehaviorTickRate(1.f / tickRate, pBehavior);
+}
+
+//Picks up, consumes or destroys the item in view, the body of the "Items" branch
+static IBehavior* CreateItemBehavior()
+{
+	return new BehaviorSelector{{
+		// Consume food before picking up more
+		new BehaviorSequence{{
+			new BehaviorConditional(BT_Conditions::IsItemFood, BT_ConditionKeys::IsItemFood()),
+			new BehaviorConditional(BT_Conditions::IsPlayerInGrabRange, BT_ConditionKeys::IsPlayerInGrabRange()),
+			new BehaviorConditional(BT_Conditions::CanPlayerEat, BT_ConditionKeys::CanPlayerEat()),
+			new BehaviorAction(BT_Actions::Eat, BT_ActionKeys::Eat())
+		}},
+		// Consume medkit if hurt and on ground
+		new BehaviorSequence{{
+			new BehaviorConditional(BT_Conditions::IsItemMedkit, BT_ConditionKeys::IsItemMedkit()),
+			new BehaviorConditional(BT_Conditions::IsPlayerInGrabRange, BT_ConditionKeys::IsPlayerInGrabRange()),
+			new BehaviorConditional(BT_Conditions::CanPlayerHeal, BT_ConditionKeys::CanPlayerHeal()),
+			new BehaviorAction(BT_Actions::Heal, BT_ActionKeys::Heal())
+		}},
+		// Checks if pistol is worth it 
+		new BehaviorSequence{{
+			new BehaviorConditional(BT_Conditions::IsItemPistol, BT_ConditionKeys::IsItemPistol()),
+			new BehaviorConditional(BT_Conditions::IsPlayerInGrabRange, BT_ConditionKeys::IsPlayerInGrabRange()),
+			new BehaviorSelector{{
+				new BehaviorSequence{{
+					// If has no pistol pick up
+					new BehaviorNotConditional(BT_Conditions::HasPistol, BT_ConditionKeys::HasPistol()),
+					new BehaviorAction(BT_Actions::PickupItem, BT_ActionKeys::PickupItem()),
+				}},
+				new BehaviorSequence{{
+					// If has pistol but new one is better drop old pick up new
+					new BehaviorConditional(BT_Conditions::IsNewGunBetter, BT_ConditionKeys::IsNewGunBetter()),
+					new BehaviorAction(BT_Actions::DropOldGun, BT_ActionKeys::DropOldGun()),
+					new BehaviorAction(BT_Actions::PickupItem, BT_ActionKeys::PickupItem()),
+				}},
+				new BehaviorSequence{{
+					// Destroy less-value gun
+					new BehaviorAction(BT_Actions::DestroyGun, BT_ActionKeys::DestroyGun())
+				}}
+			}}
+		}},
+		// Checks if shotgun is worth it
+		new BehaviorSequence{{
+			new BehaviorConditional(BT_Conditions::IsItemShotgun, BT_ConditionKeys::IsItemShotgun()),
+			new BehaviorConditional(BT_Conditions::IsPlayerInGrabRange, BT_ConditionKeys::IsPlayerInGrabRange()),
+			new BehaviorSelector{{
+				new BehaviorSequence{{
+					// If has no pistol pick up
+					new BehaviorNotConditional(BT_Conditions::HasShotgun, BT_ConditionKeys::HasShotgun()),
+					new BehaviorAction(BT_Actions::PickupItem, BT_ActionKeys::PickupItem()),
+				}},
+				new BehaviorSequence{{
+					// If has pistol but new one is better drop old pick up new
+					new BehaviorConditional(BT_Conditions::IsNewGunBetter, BT_ConditionKeys::IsNewGunBetter()),
+					new BehaviorAction(BT_Actions::DropOldGun, BT_ActionKeys::DropOldGun()),
+					new BehaviorAction(BT_Actions::PickupItem, BT_ActionKeys::PickupItem()),
+				}},
+				new BehaviorSequence{{
+					// Destroy less-value gun
+					new BehaviorAction(BT_Actions::DestroyGun, BT_ActionKeys::DestroyGun())
+				}}
+			}}
+		}},
+		// Pick item if has inventory slot and in range
+		new BehaviorSequence{{
+			new BehaviorConditional(BT_Conditions::IsPlayerInGrabRange, BT_ConditionKeys::IsPlayerInGrabRange()),
+			new BehaviorConditional(BT_Conditions::HasInventorySlot, BT_ConditionKeys::HasInventorySlot()),
+			new BehaviorAction(BT_Actions::PickupItem, BT_ActionKeys::PickupItem()),
+		}},
+		// Set seen item as target and seek
+		new BehaviorSequence{{
+			new BehaviorNotConditional(BT_Conditions::IsPlayerInGrabRange, BT_ConditionKeys::IsPlayerInGrabRange()),
+			new BehaviorAction(BT_Actions::SetItemAsTarget, BT_ActionKeys::SetItemAsTarget()),
+			new BehaviorAction(BT_Actions::Seek, BT_ActionKeys::Seek())
+		}}
+	}};
+}
+
+//Walks the random explore locations, the body of the "Exploration" branch
+static IBehavior* CreateExplorationBehavior(float bookkeepingTickRate)
+{
+	return new BehaviorSequence{{
+		new BehaviorSelector{{
+			AtBookkeepingRate(bookkeepingTickRate, new BehaviorObserver(BT_Conditions::HasVisitedAllLocations, BT_ConditionKeys::HasVisitedAllLocations(),
+				new BehaviorAction(BT_Actions::RandomizeVisitLocations, BT_ActionKeys::RandomizeVisitLocations())
+			)),
+			AtBookkeepingRate(bookkeepingTickRate, new BehaviorObserver(BT_Conditions::HasReachedExploreLocation, BT_ConditionKeys::HasReachedExploreLocation(), new BehaviorSequence{{
+				new BehaviorAction(BT_Actions::UpdateExplorationList, BT_ActionKeys::UpdateExplorationList()),
+				new BehaviorAction(BT_Actions::SetNewExploreDestination, BT_ActionKeys::SetNewExploreDestination())
+			}})),
+			new BehaviorObserver(BT_Conditions::ShouldExplore, BT_ConditionKeys::ShouldExplore(), new BehaviorSequence{{
+				new BehaviorAction(BT_Actions::Explore, BT_ActionKeys::Explore()),
+				new BehaviorAction(BT_Actions::SeekToTarget, BT_ActionKeys::SeekToTarget())
+			}}),
+		}},
+	}};
+}
+
+//The agent's behavior, a new tree on every call.
+//Branches are guarded by observers, so a resuming tree still gives way to a higher priority branch
+//Keep in sync with AgentBehavior.json, the loading benchmark compares both
+IBehavior* Plugin::CreateRootBehavior(float bookkeepingTickRate)
+{
+	return NameBehavior("Agent", new BehaviorSelector{ {
 				/************************************************************************/
 				/* Combat                                                               */
 				/************************************************************************/
-				new BehaviorSelector{{
-					new BehaviorSequence{{
-						new BehaviorConditional(BT_Conditions::IsZombieInFOV),
-						new BehaviorConditional(BT_Conditions::IsPlayerArmed),
+				NameBehavior("Combat", new BehaviorSelector{{
+					new BehaviorObserver(BT_Conditions::IsZombieInFOV, BT_ConditionKeys::IsZombieInFOV(), new BehaviorObserver(BT_Conditions::IsPlayerArmed, BT_ConditionKeys::IsPlayerArmed(),
 						new BehaviorSelector{{
 							new BehaviorSequence{{
-								new BehaviorConditional(BT_Conditions::IsFacingEnemy),
-								/*new BehaviorAction(BT_Actions::FaceZombie),*/
-								new BehaviorAction(BT_Actions::Shoot)
+								new BehaviorConditional(BT_Conditions::IsFacingEnemy, BT_ConditionKeys::IsFacingEnemy()),
+								/*new BehaviorAction(BT_Actions::FaceZombie, BT_ActionKeys::FaceZombie()),*/
+								new BehaviorAction(BT_Actions::Shoot, BT_ActionKeys::Shoot())
 							}},
 							new BehaviorSequence{{
-								new BehaviorConditional(BT_Conditions::IsNotFacingEnemy),
-								new BehaviorAction(BT_Actions::SetAsTarget),
-								new BehaviorAction(BT_Actions::Face)
+								new BehaviorConditional(BT_Conditions::IsNotFacingEnemy, BT_ConditionKeys::IsNotFacingEnemy()),
+								new BehaviorAction(BT_Actions::SetAsTarget, BT_ActionKeys::SetAsTarget()),
+								new BehaviorAction(BT_Actions::Face, BT_ActionKeys::Face())
 							}},
-						}},
-					}},
-					new BehaviorSequence{{
-						new BehaviorConditional(BT_Conditions::IsZombieInFOV),
-						new BehaviorConditional(BT_Conditions::IsInHouse),
-						new BehaviorConditional(BT_Conditions::IsPlayerNOTArmed),
-						new BehaviorAction(BT_Actions::AddHouseToVisited),
-						new BehaviorAction(BT_Actions::SetRunAsTarget),
-						new BehaviorAction(BT_Actions::RunForestRun)
-					}},
-					new BehaviorSequence{{
-						new BehaviorConditional(BT_Conditions::IsPlayerBitten),
-						new BehaviorConditional(BT_Conditions::IsPlayerArmed),
-						new BehaviorAction(BT_Actions::Turn)
-					}},
-					new BehaviorSequence{{
-						new BehaviorConditional(BT_Conditions::IsPlayerBitten),
-						new BehaviorAction(BT_Actions::RunForestRun)
-					}},
-				}},
+						}}
+					)),
+					new BehaviorObserver(BT_Conditions::IsZombieInFOV, BT_ConditionKeys::IsZombieInFOV(), new BehaviorSequence{{
+						new BehaviorConditional(BT_Conditions::IsInHouse, BT_ConditionKeys::IsInHouse()),
+						new BehaviorConditional(BT_Conditions::IsPlayerNOTArmed, BT_ConditionKeys::IsPlayerNOTArmed()),
+						new BehaviorAction(BT_Actions::AddHouseToVisited, BT_ActionKeys::AddHouseToVisited()),
+						new BehaviorAction(BT_Actions::SetRunAsTarget, BT_ActionKeys::SetRunAsTarget()),
+						new BehaviorAction(BT_Actions::RunForestRun, BT_ActionKeys::RunForestRun())
+					}}),
+					new BehaviorObserver(BT_Conditions::IsPlayerBitten, BT_ConditionKeys::IsPlayerBitten(), new BehaviorObserver(BT_Conditions::IsPlayerArmed, BT_ConditionKeys::IsPlayerArmed(),
+						new BehaviorAction(BT_Actions::Turn, BT_ActionKeys::Turn())
+					)),
+					new BehaviorObserver(BT_Conditions::IsPlayerBitten, BT_ConditionKeys::IsPlayerBitten(),
+						new BehaviorAction(BT_Actions::RunForestRun, BT_ActionKeys::RunForestRun())
+					),
+				}}),
 		/************************************************************************/
 		/* Item consumption														*/
 		/************************************************************************/
-		new BehaviorSequence{{
-			new BehaviorConditional(BT_Conditions::IsPlayerLowHealth),
-			new BehaviorConditional(BT_Conditions::CanPlayerHeal),
-			new BehaviorAction(BT_Actions::Heal)
-		}},
-		new BehaviorSequence{{
-			new BehaviorConditional(BT_Conditions::IsPlayerLowStamina),
-			new BehaviorConditional(BT_Conditions::CanPlayerEat),
-			new BehaviorAction(BT_Actions::Eat)
-		}},
+		// The item is an observer of its own, so finding one takes over while the stat stays low
+		NameBehavior("Heal", new BehaviorObserver(BT_Conditions::IsPlayerLowHealth, BT_ConditionKeys::IsPlayerLowHealth(), new BehaviorObserver(BT_Conditions::CanPlayerHeal, BT_ConditionKeys::CanPlayerHeal(),
+			new BehaviorAction(BT_Actions::Heal, BT_ActionKeys::Heal())
+		))),
+		NameBehavior("Eat", new BehaviorObserver(BT_Conditions::IsPlayerLowStamina, BT_ConditionKeys::IsPlayerLowStamina(), new BehaviorObserver(BT_Conditions::CanPlayerEat, BT_ConditionKeys::CanPlayerEat(),
+			new BehaviorAction(BT_Actions::Eat, BT_ActionKeys::Eat())
+		))),
 
 
 
 		/************************************************************************/
 		/* Garbage																*/
 		/************************************************************************/
-		new BehaviorSelector{{
-			new BehaviorSequence{{
-				new BehaviorConditional(BT_Conditions::SeesGarbage),
+		NameBehavior("Garbage", new BehaviorSelector{{
+			new BehaviorObserver(BT_Conditions::SeesGarbage, BT_ConditionKeys::SeesGarbage(),
 				new BehaviorSelector{{
 					new BehaviorSequence{{
-						new BehaviorConditional(BT_Conditions::IsPlayerInGrabRange),
-						new BehaviorAction(BT_Actions::DestroyGarbage)
+						new BehaviorConditional(BT_Conditions::IsPlayerInGrabRange, BT_ConditionKeys::IsPlayerInGrabRange()),
+						new BehaviorAction(BT_Actions::DestroyGarbage, BT_ActionKeys::DestroyGarbage())
 					}},
 					new BehaviorSequence{{
-						new BehaviorAction(BT_Actions::SetItemAsTarget),
-						new BehaviorAction(BT_Actions::Seek),
+						new BehaviorAction(BT_Actions::SetItemAsTarget, BT_ActionKeys::SetItemAsTarget()),
+						new BehaviorAction(BT_Actions::Seek, BT_ActionKeys::Seek()),
 					}},
-				}},
-			}},
-		}},
+				}}
+			),
+		}}),
 		/************************************************************************/
 		/* Items																*/
 		/************************************************************************/
-		new BehaviorSequence{{
-			new BehaviorConditional(BT_Conditions::SeesItem),
-			new BehaviorSelector{{
-					// Consume food before picking up more
-					new BehaviorSequence{{
-						new BehaviorConditional(BT_Conditions::IsItemFood),
-						new BehaviorConditional(BT_Conditions::IsPlayerInGrabRange),
-						new BehaviorConditional(BT_Conditions::CanPlayerEat),
-						new BehaviorAction(BT_Actions::Eat)
-					}},
-					// Consume medkit if hurt and on ground
-					new BehaviorSequence{{
-						new BehaviorConditional(BT_Conditions::IsItemMedkit),
-						new BehaviorConditional(BT_Conditions::IsPlayerInGrabRange),
-						new BehaviorConditional(BT_Conditions::CanPlayerHeal),
-						new BehaviorAction(BT_Actions::Heal)
-					}},
-					// Checks if pistol is worth it 
-					new BehaviorSequence{{
-						new BehaviorConditional(BT_Conditions::IsItemPistol),
-						new BehaviorConditional(BT_Conditions::IsPlayerInGrabRange),
-						new BehaviorSelector{{
-							new BehaviorSequence{{
-								// If has no pistol pick up
-								new BehaviorNotConditional(BT_Conditions::HasPistol),
-								new BehaviorAction(BT_Actions::PickupItem),
-							}},
-							new BehaviorSequence{{
-								// If has pistol but new one is better drop old pick up new
-								new BehaviorConditional(BT_Conditions::IsNewGunBetter),
-								new BehaviorAction(BT_Actions::DropOldGun),
-								new BehaviorAction(BT_Actions::PickupItem),
-							}},
-							new BehaviorSequence{{
-								// Destroy less-value gun
-								new BehaviorAction(BT_Actions::DestroyGun)
-							}}
-						}}
-					}},
-					// Checks if shotgun is worth it
-					new BehaviorSequence{{
-						new BehaviorConditional(BT_Conditions::IsItemShotgun),
-						new BehaviorConditional(BT_Conditions::IsPlayerInGrabRange),
-						new BehaviorSelector{{
-							new BehaviorSequence{{
-								// If has no pistol pick up
-								new BehaviorNotConditional(BT_Conditions::HasShotgun),
-								new BehaviorAction(BT_Actions::PickupItem),
-							}},
-							new BehaviorSequence{{
-								// If has pistol but new one is better drop old pick up new
-								new BehaviorConditional(BT_Conditions::IsNewGunBetter),
-								new BehaviorAction(BT_Actions::DropOldGun),
-								new BehaviorAction(BT_Actions::PickupItem),
-							}},
-							new BehaviorSequence{{
-								// Destroy less-value gun
-								new BehaviorAction(BT_Actions::DestroyGun)
-							}}
-						}}
-					}},
-					// Pick item if has inventory slot and in range
-					new BehaviorSequence{{
-						new BehaviorConditional(BT_Conditions::IsPlayerInGrabRange),
-						new BehaviorConditional(BT_Conditions::HasInventorySlot),
-						new BehaviorAction(BT_Actions::PickupItem),
-					}},
-					// Set seen item as target and seek
-					new BehaviorSequence{{
-						new BehaviorNotConditional(BT_Conditions::IsPlayerInGrabRange),
-						new BehaviorAction(BT_Actions::SetItemAsTarget),
-						new BehaviorAction(BT_Actions::Seek)
-					}}
-				}},
-			}},
+		NameBehavior("Items", new BehaviorObserver(BT_Conditions::SeesItem, BT_ConditionKeys::SeesItem(),
+			CreateItemBehavior()
+			)),
 			
 			/************************************************************************/
 			/* Sweeping house														*/
 			/************************************************************************/
-			new BehaviorSequence{{
-				new BehaviorConditional(BT_Conditions::IsInHouse),
+			NameBehavior("Sweep", new BehaviorObserver(BT_Conditions::IsInHouse, BT_ConditionKeys::IsInHouse(),
 				new BehaviorSelector{{
 					new BehaviorSequence{{
-						new BehaviorConditional(BT_Conditions::ShouldSweepHouse),
-						new BehaviorAction(BT_Actions::Sweep)
+						new BehaviorConditional(BT_Conditions::ShouldSweepHouse, BT_ConditionKeys::ShouldSweepHouse()),
+						new BehaviorAction(BT_Actions::Sweep, BT_ActionKeys::Sweep())
 					}},
 					new BehaviorSequence{{
-						new BehaviorAction(BT_Actions::ExitHouse)
+						new BehaviorAction(BT_Actions::ExitHouse, BT_ActionKeys::ExitHouse())
 					}},
-				}},
-			}},
+				}}
+			)),
 			/************************************************************************/
 			/* House detection														*/
 			/************************************************************************/
-			new BehaviorSelector{{
-				new BehaviorSequence{{
-					new BehaviorConditional(BT_Conditions::IsGoingToHouse),
-					new BehaviorAction(BT_Actions::Seek)
-				}},
-				new BehaviorSequence{{
-					new BehaviorConditional(BT_Conditions::IsHouseInFOV),
-					new BehaviorAction(BT_Actions::SetHouseAsActive),
-				}},
-			}},
+			NameBehavior("House", new BehaviorSelector{{
+				new BehaviorObserver(BT_Conditions::IsGoingToHouse, BT_ConditionKeys::IsGoingToHouse(),
+					new BehaviorAction(BT_Actions::SeekToTarget, BT_ActionKeys::SeekToTarget())
+				),
+				AtBookkeepingRate(bookkeepingTickRate, new BehaviorObserver(BT_Conditions::IsHouseInFOV, BT_ConditionKeys::IsHouseInFOV(),
+					new BehaviorAction(BT_Actions::SetHouseAsActive, BT_ActionKeys::SetHouseAsActive())
+				)),
+			}}),
 
 			/************************************************************************/
 			/* Exploration                                                          */
 			/************************************************************************/
+			NameBehavior("Exploration", CreateExplorationBehavior(bookkeepingTickRate)),
+		}});
+}
+
+//Faces the zombie in view and shoots it, turns around after a bite from behind
+static IBehavior* CreateFightBehavior()
+{
+	return new BehaviorSelector{{
+		new BehaviorObserver(BT_Conditions::IsZombieInFOV, BT_ConditionKeys::IsZombieInFOV(), new BehaviorSelector{{
 			new BehaviorSequence{{
-				new BehaviorSelector{{
-					new BehaviorSequence{{
-						new BehaviorConditional(BT_Conditions::HasVisitedAllLocations),
-						new BehaviorAction(BT_Actions::RandomizeVisitLocations)
-					}},
-					new BehaviorSequence{{
-						new BehaviorConditional(BT_Conditions::HasReachedExploreLocation),
-						new BehaviorAction(BT_Actions::UpdateExplorationList),
-						new BehaviorAction(BT_Actions::SetNewExploreDestination)
-					}},
-					new BehaviorSequence{{
-						new BehaviorConditional(BT_Conditions::ShouldExplore),
-						new BehaviorAction(BT_Actions::Explore),
-						new BehaviorAction(BT_Actions::Seek)
-					}},
-				}},
+				new BehaviorConditional(BT_Conditions::IsFacingEnemy, BT_ConditionKeys::IsFacingEnemy()),
+				new BehaviorAction(BT_Actions::Shoot, BT_ActionKeys::Shoot())
+			}},
+			new BehaviorSequence{{
+				new BehaviorConditional(BT_Conditions::IsNotFacingEnemy, BT_ConditionKeys::IsNotFacingEnemy()),
+				new BehaviorAction(BT_Actions::SetAsTarget, BT_ActionKeys::SetAsTarget()),
+				new BehaviorAction(BT_Actions::Face, BT_ActionKeys::Face())
+			}},
+		}}),
+		new BehaviorAction(BT_Actions::Turn, BT_ActionKeys::Turn())
+	}};
+}
+
+//Out of the house first, a house is a trap without a gun
+static IBehavior* CreateFleeBehavior()
+{
+	return new BehaviorSelector{{
+		new BehaviorSequence{{
+			new BehaviorConditional(BT_Conditions::IsInHouse, BT_ConditionKeys::IsInHouse()),
+			new BehaviorAction(BT_Actions::AddHouseToVisited, BT_ActionKeys::AddHouseToVisited()),
+			new BehaviorAction(BT_Actions::SetRunAsTarget, BT_ActionKeys::SetRunAsTarget()),
+			new BehaviorAction(BT_Actions::RunForestRun, BT_ActionKeys::RunForestRun())
+		}},
+		new BehaviorAction(BT_Actions::RunForestRun, BT_ActionKeys::RunForestRun())
+	}};
+}
+
+//Garbage in view is destroyed, items are picked up or consumed
+static IBehavior* CreateLootBehavior()
+{
+	return new BehaviorSelector{{
+		new BehaviorObserver(BT_Conditions::SeesGarbage, BT_ConditionKeys::SeesGarbage(), new BehaviorSelector{{
+			new BehaviorSequence{{
+				new BehaviorConditional(BT_Conditions::IsPlayerInGrabRange, BT_ConditionKeys::IsPlayerInGrabRange()),
+				new BehaviorAction(BT_Actions::DestroyGarbage, BT_ActionKeys::DestroyGarbage())
 			}},
+			new BehaviorSequence{{
+				new BehaviorAction(BT_Actions::SetItemAsTarget, BT_ActionKeys::SetItemAsTarget()),
+				new BehaviorAction(BT_Actions::Seek, BT_ActionKeys::Seek()),
+			}},
+		}}),
+		new BehaviorObserver(BT_Conditions::SeesItem, BT_ConditionKeys::SeesItem(), CreateItemBehavior())
+	}};
+}
+
+static IBehavior* CreateSweepBehavior()
+{
+	return new BehaviorSelector{{
+		new BehaviorSequence{{
+			new BehaviorConditional(BT_Conditions::ShouldSweepHouse, BT_ConditionKeys::ShouldSweepHouse()),
+			new BehaviorAction(BT_Actions::Sweep, BT_ActionKeys::Sweep())
+		}},
+		new BehaviorAction(BT_Actions::ExitHouse, BT_ActionKeys::ExitHouse())
+	}};
+}
+
+//Heads for a house in view, explores otherwise
+static IBehavior* CreateExploreBehavior(float bookkeepingTickRate)
+{
+	return new BehaviorSelector{{
+		new BehaviorObserver(BT_Conditions::IsGoingToHouse, BT_ConditionKeys::IsGoingToHouse(),
+			new BehaviorAction(BT_Actions::SeekToTarget, BT_ActionKeys::SeekToTarget())
+		),
+		AtBookkeepingRate(bookkeepingTickRate, new BehaviorObserver(BT_Conditions::IsHouseInFOV, BT_ConditionKeys::IsHouseInFOV(),
+			new BehaviorAction(BT_Actions::SetHouseAsActive, BT_ActionKeys::SetHouseAsActive())
+		)),
+		CreateExplorationBehavior(bookkeepingTickRate)
+	}};
+}
+
+//The agent's actions scored by a utility AI, a new one on every call.
+//Actions reuse the branches of CreateRootBehavior, the inputs decide which one runs instead of the branch order
+UtilityAI* Plugin::CreateUtilityAI(Blackboard* pBlackboard)
+{
+	UtilityAI* pUtilityAI = new UtilityAI(pBlackboard);
+
+	const uint32_t health = pUtilityAI->AddInput("Health", UT_Inputs::Health, UT_InputKeys::Health());
+	const uint32_t energy = pUtilityAI->AddInput("Energy", UT_Inputs::Energy, UT_InputKeys::Energy());
+	const uint32_t hasMedkit = pUtilityAI->AddInput("HasMedkit", UT_Inputs::HasMedkit, UT_InputKeys::HasMedkit());
+	const uint32_t hasFood = pUtilityAI->AddInput("HasFood", UT_Inputs::HasFood, UT_InputKeys::HasFood());
+	const uint32_t isArmed = pUtilityAI->AddInput("IsArmed", UT_Inputs::IsArmed, UT_InputKeys::IsArmed());
+	const uint32_t threat = pUtilityAI->AddInput("Threat", UT_Inputs::Threat, UT_InputKeys::Threat());
+	const uint32_t seesLoot = pUtilityAI->AddInput("SeesLoot", UT_Inputs::SeesLoot, UT_InputKeys::SeesLoot());
+	const uint32_t isInHouse = pUtilityAI->AddInput("IsInHouse", UT_Inputs::IsInHouse, UT_InputKeys::IsInHouse());
+
+	/************************************************************************/
+	/* Item consumption														*/
+	/************************************************************************/
+	// Half the weight at CONFIG_MIN_ALLOWED_HEALTH and CONFIG_MIN_ALLOWED_STAMINA, where the tree heals and eats
+	const uint32_t heal = pUtilityAI->AddAction("Heal", new BehaviorAction(BT_Actions::Heal, BT_ActionKeys::Heal()), 0.95f);
+	pUtilityAI->AddConsideration(heal, health, ResponseCurve::Logistic(-40.f, 0.2f));
+	pUtilityAI->AddConsideration(heal, hasMedkit, ResponseCurve::Linear());
+
+	const uint32_t eat = pUtilityAI->AddAction("Eat", new BehaviorAction(BT_Actions::Eat, BT_ActionKeys::Eat()), 0.9f);
+	pUtilityAI->AddConsideration(eat, energy, ResponseCurve::Logistic(-40.f, 0.2f));
+	pUtilityAI->AddConsideration(eat, hasFood, ResponseCurve::Linear());
+
+	/************************************************************************/
+	/* Combat                                                               */
+	/************************************************************************/
+	const uint32_t shoot = pUtilityAI->AddAction("Shoot", CreateFightBehavior(), 1.f);
+	pUtilityAI->AddConsideration(shoot, threat, ResponseCurve::Linear());
+	pUtilityAI->AddConsideration(shoot, isArmed, ResponseCurve::Linear());
+
+	const uint32_t flee = pUtilityAI->AddAction("Flee", CreateFleeBehavior(), 1.f);
+	pUtilityAI->AddConsideration(flee, threat, ResponseCurve::Linear());
+	pUtilityAI->AddConsideration(flee, isArmed, ResponseCurve::Inverted());
+
+	/************************************************************************/
+	/* Items and garbage													*/
+	/************************************************************************/
+	const uint32_t loot = pUtilityAI->AddAction("Loot", CreateLootBehavior(), 0.6f);
+	pUtilityAI->AddConsideration(loot, seesLoot, ResponseCurve::Linear());
+	// Loot is worth more the less health is left
+	pUtilityAI->AddConsideration(loot, health, ResponseCurve::Polynomial(2.f, 0.5f, 1.f, 0.5f));
+
+	/************************************************************************/
+	/* Sweeping house														*/
+	/************************************************************************/
+	const uint32_t sweep = pUtilityAI->AddAction("Sweep", CreateSweepBehavior(), 0.25f);
+	pUtilityAI->AddConsideration(sweep, isInHouse, ResponseCurve::Linear());
+
+	/************************************************************************/
+	/* House detection and exploration										*/
+	/************************************************************************/
+	// Always possible, wins when nothing else scores
+	pUtilityAI->AddAction("Explore", CreateExploreBehavior(CONFIG_BOOKKEEPING_TICK_RATE), 0.2f);
+
+	return pUtilityAI;
+}
+
+//The agent's states and their transitions, a new machine on every call.
+//States run the same branches as the utility AI, only the conditions of the current state are checked
+FiniteStateMachine* Plugin::CreateStateMachine(Blackboard* pBlackboard)
+{
+	using Mask = FiniteStateMachine::ConditionMask;
+	FiniteStateMachine* pStateMachine = new FiniteStateMachine(pBlackboard);
+
+	const Mask zombieInFOV = pStateMachine->AddCondition("IsZombieInFOV", BT_Conditions::IsZombieInFOV, BT_ConditionKeys::IsZombieInFOV());
+	const Mask bitten = pStateMachine->AddCondition("IsPlayerBitten", BT_Conditions::IsPlayerBitten, BT_ConditionKeys::IsPlayerBitten());
+	const Mask armed = pStateMachine->AddCondition("IsPlayerArmed", BT_Conditions::IsPlayerArmed, BT_ConditionKeys::IsPlayerArmed());
+	const Mask lowHealth = pStateMachine->AddCondition("IsPlayerLowHealth", BT_Conditions::IsPlayerLowHealth, BT_ConditionKeys::IsPlayerLowHealth());
+	const Mask canHeal = pStateMachine->AddCondition("CanPlayerHeal", BT_Conditions::CanPlayerHeal, BT_ConditionKeys::CanPlayerHeal());
+	const Mask lowStamina = pStateMachine->AddCondition("IsPlayerLowStamina", BT_Conditions::IsPlayerLowStamina, BT_ConditionKeys::IsPlayerLowStamina());
+	const Mask canEat = pStateMachine->AddCondition("CanPlayerEat", BT_Conditions::CanPlayerEat, BT_ConditionKeys::CanPlayerEat());
+	const Mask seesItem = pStateMachine->AddCondition("SeesItem", BT_Conditions::SeesItem, BT_ConditionKeys::SeesItem());
+	const Mask seesGarbage = pStateMachine->AddCondition("SeesGarbage", BT_Conditions::SeesGarbage, BT_ConditionKeys::SeesGarbage());
+	const Mask inHouse = pStateMachine->AddCondition("IsInHouse", BT_Conditions::IsInHouse, BT_ConditionKeys::IsInHouse());
+
+	const uint32_t agent = pStateMachine->AddState("Agent", nullptr);
+	const uint32_t survive = pStateMachine->AddState("Survive", nullptr, agent);
+	const uint32_t fight = pStateMachine->AddState("Fight", CreateFightBehavior(), survive);
+	const uint32_t flee = pStateMachine->AddState("Flee", CreateFleeBehavior(), survive);
+	const uint32_t consume = pStateMachine->AddState("Consume", new BehaviorSelector{{
+		new BehaviorSequence{{
+			new BehaviorConditional(BT_Conditions::IsPlayerLowHealth, BT_ConditionKeys::IsPlayerLowHealth()),
+			new BehaviorConditional(BT_Conditions::CanPlayerHeal, BT_ConditionKeys::CanPlayerHeal()),
+			new BehaviorAction(BT_Actions::Heal, BT_ActionKeys::Heal())
+		}},
+		new BehaviorSequence{{
+			new BehaviorConditional(BT_Conditions::IsPlayerLowStamina, BT_ConditionKeys::IsPlayerLowStamina()),
+			new BehaviorConditional(BT_Conditions::CanPlayerEat, BT_ConditionKeys::CanPlayerEat()),
+			new BehaviorAction(BT_Actions::Eat, BT_ActionKeys::Eat())
 		}}
-	);
+	}}, survive);
+	const uint32_t scavenge = pStateMachine->AddState("Scavenge", nullptr, agent);
+	const uint32_t explore = pStateMachine->AddState("Explore", CreateExploreBehavior(CONFIG_BOOKKEEPING_TICK_RATE), scavenge);
+	const uint32_t lootHouse = pStateMachine->AddState("LootHouse", CreateLootBehavior(), scavenge);
+	const uint32_t sweep = pStateMachine->AddState("Sweep", CreateSweepBehavior(), scavenge);
 
-	std::random_device rd;
-	m_Rng = std::mt19937(rd());
+	/************************************************************************/
+	/* Every state, in the priority order of CreateRootBehavior				*/
+	/************************************************************************/
+	pStateMachine->AddTransition(agent, fight, zombieInFOV | armed);
+	pStateMachine->AddTransition(agent, flee, zombieInFOV, armed);
+	pStateMachine->AddTransition(agent, fight, bitten | armed);
+	pStateMachine->AddTransition(agent, flee, bitten, armed);
+	pStateMachine->AddTransition(agent, consume, lowHealth | canHeal);
+	pStateMachine->AddTransition(agent, consume, lowStamina | canEat);
 
-	Elite::Vector2 dim = m_pInterface->World_GetInfo().Dimensions;
-	Elite::Vector2 org = m_pInterface->World_GetInfo().Center;
+	/************************************************************************/
+	/* Survive, back to scavenging once nothing is left to do				*/
+	/************************************************************************/
+	pStateMachine->AddTransition(survive, explore, 0, zombieInFOV | bitten);
 
+	/************************************************************************/
+	/* Scavenge																*/
+	/************************************************************************/
+	pStateMachine->AddTransition(scavenge, lootHouse, seesGarbage);
+	pStateMachine->AddTransition(scavenge, lootHouse, seesItem);
+	pStateMachine->AddTransition(explore, sweep, inHouse);
+	pStateMachine->AddTransition(lootHouse, sweep, inHouse);
+	pStateMachine->AddTransition(lootHouse, explore, 0);
+	pStateMachine->AddTransition(sweep, explore, 0, inHouse);
+
+	pStateMachine->Compile(explore);
+	return pStateMachine;
+}
 
-	m_LocationPicker = std::uniform_real_distribution<float>(0, CONFIG_RANDOM_LOCATION_COUNT);
-	m_Norm = std::uniform_real_distribution<float>(0.f, 1.f);
+//The agent's actions with their preconditions and effects, a new planner on every call.
+//Goals follow the priority order of CreateRootBehavior, exploring is the fallback while none of them has a plan
+GoapPlanner* Plugin::CreateGoapPlanner(Blackboard* pBlackboard)
+{
+	GoapPlanner* pPlanner = new GoapPlanner(pBlackboard, CONFIG_GOAP_PLANNING_BUDGET);
+
+	const GoapState threat = pPlanner->AddFact("Threat", GP_Facts::Threat, GP_FactKeys::Threat());
+	const GoapState armed = pPlanner->AddFact("IsPlayerArmed", BT_Conditions::IsPlayerArmed, BT_ConditionKeys::IsPlayerArmed());
+	const GoapState lowHealth = pPlanner->AddFact("IsPlayerLowHealth", BT_Conditions::IsPlayerLowHealth, BT_ConditionKeys::IsPlayerLowHealth());
+	const GoapState canHeal = pPlanner->AddFact("CanPlayerHeal", BT_Conditions::CanPlayerHeal, BT_ConditionKeys::CanPlayerHeal());
+	const GoapState lowStamina = pPlanner->AddFact("IsPlayerLowStamina", BT_Conditions::IsPlayerLowStamina, BT_ConditionKeys::IsPlayerLowStamina());
+	const GoapState canEat = pPlanner->AddFact("CanPlayerEat", BT_Conditions::CanPlayerEat, BT_ConditionKeys::CanPlayerEat());
+	const GoapState seesGarbage = pPlanner->AddFact("SeesGarbage", BT_Conditions::SeesGarbage, BT_ConditionKeys::SeesGarbage());
+	const GoapState seesItem = pPlanner->AddFact("SeesItem", BT_Conditions::SeesItem, BT_ConditionKeys::SeesItem());
+	const GoapState itemInGrabRange = pPlanner->AddFact("ItemInGrabRange", GP_Facts::ItemInGrabRange, GP_FactKeys::ItemInGrabRange());
+	const GoapState inHouse = pPlanner->AddFact("IsInHouse", BT_Conditions::IsInHouse, BT_ConditionKeys::IsInHouse());
+	const GoapState shouldSweep = pPlanner->AddFact("ShouldSweep", GP_Facts::ShouldSweep, GP_FactKeys::ShouldSweep());
 
-	//
-	GenerateRandomVisitLocations();
+	/************************************************************************/
+	/* Combat                                                               */
+	/************************************************************************/
+	pPlanner->AddAction("Shoot", CreateFightBehavior(), 1.f, threat | armed, 0, 0, threat);
+	// Running also leaves the house, a house is a trap without a gun
+	pPlanner->AddAction("Flee", CreateFleeBehavior(), 3.f, threat, armed, 0, threat | inHouse);
+
+	/************************************************************************/
+	/* Item consumption														*/
+	/************************************************************************/
+	pPlanner->AddAction("Heal", new BehaviorAction(BT_Actions::Heal, BT_ActionKeys::Heal()), 1.f, canHeal, 0, 0, lowHealth);
+	pPlanner->AddAction("Eat", new BehaviorAction(BT_Actions::Eat, BT_ActionKeys::Eat()), 1.f, canEat, 0, 0, lowStamina);
+
+	/************************************************************************/
+	/* Items and garbage													*/
+	/************************************************************************/
+	pPlanner->AddAction("Seek", new BehaviorSequence{{
+		new BehaviorAction(BT_Actions::SetItemAsTarget, BT_ActionKeys::SetItemAsTarget()),
+		new BehaviorAction(BT_Actions::Seek, BT_ActionKeys::Seek())
+	}}, 2.f, seesItem, itemInGrabRange, itemInGrabRange, 0);
+	// The item branch of the tree, it compares guns and consumes on the spot before picking up
+	pPlanner->AddAction("PickupItem", CreateItemBehavior(), 1.f, seesItem | itemInGrabRange, 0, 0, seesItem | itemInGrabRange);
+	pPlanner->AddAction("DestroyGarbage", CreateLootBehavior(), 2.f, seesGarbage, 0, 0, seesGarbage);
+
+	/************************************************************************/
+	/* Sweeping house														*/
+	/************************************************************************/
+	pPlanner->AddAction("Sweep", new BehaviorAction(BT_Actions::Sweep, BT_ActionKeys::Sweep()), 2.f, inHouse | shouldSweep, 0, 0, shouldSweep);
+	pPlanner->AddAction("ExitHouse", new BehaviorAction(BT_Actions::ExitHouse, BT_ActionKeys::ExitHouse()), 2.f, inHouse, shouldSweep, 0, inHouse);
+
+	pPlanner->AddGoal("Safe", 0, threat);
+	pPlanner->AddGoal("Healthy", 0, lowHealth);
+	pPlanner->AddGoal("Fed", 0, lowStamina);
+	pPlanner->AddGoal("Looted", 0, seesItem | seesGarbage);
+	pPlanner->AddGoal("Outside", 0, inHouse);
+
+	/************************************************************************/
+	/* House detection and exploration										*/
+	/************************************************************************/
+	pPlanner->SetFallback(CreateExploreBehavior(CONFIG_BOOKKEEPING_TICK_RATE));
+
+	return pPlanner;
 }
 
 void Plugin::DllInit()
 {
-
+#if CONFIG_COMPILE_BEHAVIOR_TREE
+	// Before Initialize, which loads the compiled tree
+	const BehaviorRegistry registry = BT_Registry::Create();
+	if (BehaviorTreeLoader{ registry }.CompileFile(CONFIG_BEHAVIOR_TREE_JSON, CONFIG_BEHAVIOR_TREE_FILE))
+		printf("Compiled %s to %s \n", CONFIG_BEHAVIOR_TREE_JSON, CONFIG_BEHAVIOR_TREE_FILE);
+#endif
+#if CONFIG_OPTIMIZE_BEHAVIOR_TREE
+	// The profile names unnamed nodes by their position, it has to be of the tree as it was compiled
+	BehaviorTreeOptimizer::OptimizeFile(CONFIG_BEHAVIOR_TREE_FILE, CONFIG_BEHAVIOR_TREE_PROFILE, CONFIG_OPTIMIZE_BEHAVIOR_TREE > 1);
+#endif
+#if CONFIG_RUN_BENCHMARKS
+	Benchmarks::RunAll();
+#endif
 }
 
 void Plugin::DllShutdown()
 {
+#if CONFIG_PROFILE_BLACKBOARD
+	m_pBlackboard->GetProfiler().WriteCsv("BlackboardProfile.csv");
+#endif
+#if CONFIG_PROFILE_BEHAVIOR_TREE
+	m_pBehaviorTree->GetProfiler().WriteCollapsedStacks("BehaviorTreeProfile.folded");
+#endif
+#if CONFIG_OPTIMIZE_BEHAVIOR_TREE && CONFIG_PROFILE_BEHAVIOR_TREE
+	m_pBehaviorTree->GetProfiler().CreateProfile().Write(CONFIG_BEHAVIOR_TREE_PROFILE);
+#elif CONFIG_OPTIMIZE_BEHAVIOR_TREE && CONFIG_TRACE_BEHAVIOR_TREE
+	// Counts of the last records only, the optimizer ranks the conditions by their rates alone
+	m_pBehaviorTree->GetTrace().CreateProfile().Write(CONFIG_BEHAVIOR_TREE_PROFILE);
+#endif
+#if CONFIG_MEMOIZE_PURE_CONDITIONS
+	const ConditionMemo& conditionMemo = m_pBehaviorTree->GetConditionMemo();
+	printf("Pure conditions: %zu evaluated, %zu answered from the memo \n", conditionMemo.GetEvaluationCount(), conditionMemo.GetSavedCount());
+#endif
+#if CONFIG_TRACE_BEHAVIOR_TREE
+	m_pBehaviorTree->GetTrace().StopDrain();
+#endif
+	// The flat tree was compiled from the root of m_pBehaviorTree, it goes before anything that frees the root
+	SAFE_DELETE(m_pFlatBehaviorTree);
+	SAFE_DELETE(m_pSnapshots);
+	SAFE_DELETE(m_pStaticBehaviorTree);
+	SAFE_DELETE(m_pUtilityAI);
+	SAFE_DELETE(m_pStateMachine);
+	SAFE_DELETE(m_pGoapPlanner);
+	SAFE_DELETE(m_pWorkerPool);
 
 }
 
@@ -307,6 +706,16 @@ void Plugin::InitGameDebugParams(GameDebugParams& params)
 //(=Use only for Debug Purposes)
 void Plugin::Update(float dt)
 {
+	// Blackboard checkpoints, to continue a run from an interesting moment
+	if (m_pInterface->Input_IsKeyboardKeyUp(Elite::eScancode_F5))
+	{
+		m_pBlackboard->SaveCheckpoint(std::string{ CONFIG_CHECKPOINT_FILE });
+	}
+	else if (m_pInterface->Input_IsKeyboardKeyUp(Elite::eScancode_F9))
+	{
+		m_pBlackboard->LoadCheckpoint(std::string{ CONFIG_CHECKPOINT_FILE });
+	}
+
 	//Demo Event Code
 	//In the end your AI should be able to walk around without external input
 	//if (m_pInterface->Input_IsMouseButtonUp(Elite::InputMouseButton::eLeft))
@@ -370,50 +779,73 @@ void Plugin::Update(float dt)
 //This function calculates the new SteeringOutput, called once per frame
 SteeringPlugin_Output Plugin::UpdateSteering(float dt)
 {
-	// Clear data
-	m_HousesInFOV.clear();
+	// Clear data, last frame's entities are kept to detect changes
+	m_EnemiesInFOV.swap(m_PreviousEnemiesInFOV);
+	m_ItemsInFOV.swap(m_PreviousItemsInFOV);
 	m_EnemiesInFOV.clear();
 	m_ItemsInFOV.clear();
 
-	// update houses
-	m_HousesInFOV = GetHousesInFOV();
-	m_pBlackboard->ChangeData(P_HOUSES_IN_FOV, m_HousesInFOV);
+	// update houses, only different houses get a new buffer and version
+	std::vector<HouseInfo> housesInFOV = GetHousesInFOV();
+	if (!IsSameBlackboardData(housesInFOV, m_pBlackboard->ViewData(BB_Keys::HousesInFOV).Get()))
+		m_pBlackboard->ChangeData(BB_Keys::HousesInFOV, CowVector<HouseInfo>{ std::move(housesInFOV) });
 
-	std::vector<HouseInfo> houses{};
-	m_pBlackboard->GetData(P_HOUSES_IN_FOV, houses);
-
-	// Set items and enemies in fov
+	// Set items and enemies in fov, the blackboard only holds pointers so changes are reported by hand
 	SeperateFOVEntities();
+	if (!IsSameBlackboardData(m_EnemiesInFOV, m_PreviousEnemiesInFOV))
+		m_pBlackboard->MarkChanged(BB_Keys::EnemiesInFOV);
+	if (!IsSameBlackboardData(m_ItemsInFOV, m_PreviousItemsInFOV))
+		m_pBlackboard->MarkChanged(BB_Keys::ItemsInFOV);
 
 	// spinning should be false by default
-	m_pBlackboard->ChangeData(P_IS_IN_HOUSE, false);
+	m_pBlackboard->ChangeData(BB_Keys::IsInHouse, false);
 
 	SteeringPlugin_Output steering{};
 
 	auto agentInfo = m_pInterface->Agent_GetInfo();
-	m_pBlackboard->ChangeData(P_PLAYERINFO, agentInfo);
+	m_pBlackboard->ChangeData(BB_Keys::PlayerInfo, agentInfo);
+
+	m_pDecisionMaking->Update(dt);
+	m_pBlackboard->GetData(BB_Keys::Steering, steering);
 
-	m_pBehaviorTree->Update(dt);
-	m_pBlackboard->GetData(P_STEERING, steering);
+#if CONFIG_TRACE_BEHAVIOR_TREE
+	// The decisions that led up to the death, written once
+	if (agentInfo.Death && !m_IsDeathTraceWritten)
+		m_IsDeathTraceWritten = m_pBehaviorTree->GetTrace().WriteLastSeconds(CONFIG_TRACE_DEATH_SECONDS, "BehaviorTraceDeath.csv");
+#endif
 
 	m_GrabItem = false;
 	m_UseItem = false;
 	m_RemoveItem = false;
 
-	// Update house sweep timer
-	std::vector<KnownHouse> knownHouses{};
-	m_pBlackboard->GetData(P_KNOWN_HOUSES, knownHouses);
-
-	for (KnownHouse house : knownHouses)
+	// Update house sweep timers, written every tick under their own key so the known houses
+	// only change when a timer passes the timeout, which is all their readers compare
+	bool hasTimedOut{};
+	m_pBlackboard->ModifyData(BB_Keys::KnownHouseSweepTimers, [dt, &hasTimedOut](std::vector<float>& timers) {
+		for (float& timer : timers)
+		{
+			hasTimedOut |= timer < CONFIG_SWEEP_MAX_TIMEOUT && timer + dt >= CONFIG_SWEEP_MAX_TIMEOUT;
+			timer += dt;
+		}
+	});
+	if (hasTimedOut)
 	{
-		house.lastSweepTime += dt;
+		const std::vector<float>& timers = m_pBlackboard->ViewData(BB_Keys::KnownHouseSweepTimers);
+		m_pBlackboard->ModifyData(BB_Keys::KnownHouses, [&timers](std::vector<KnownHouse>& knownHouses) {
+			for (size_t i{}; i < knownHouses.size() && i < timers.size(); ++i)
+			{
+				knownHouses[i].isSweepDue = timers[i] >= CONFIG_SWEEP_MAX_TIMEOUT;
+			}
+		});
 	}
 
-	m_pBlackboard->ChangeData(P_KNOWN_HOUSES, knownHouses);
-
 
 	//SweepFullMap();
 	ManageBittenTimer(dt);
+
+	// Render and debug readers only see completed ticks
+	m_pSnapshots->Publish(*m_pBlackboard);
+	BLACKBOARD_PROFILE(m_pBlackboard->GetProfiler().EndFrame());
 	
 	return steering;
 }
@@ -421,7 +853,7 @@ SteeringPlugin_Output Plugin::UpdateSteering(float dt)
 void Plugin::ManageBittenTimer(float dt)
 {
 	bool wasBitten{};
-	m_pBlackboard->GetData(P_PLAYER_WAS_BITTEN, wasBitten);
+	m_pBlackboard->GetData(BB_Keys::PlayerWasBitten, wasBitten);
 	if (wasBitten)
 	{
 		m_BittenTimer += dt;
@@ -429,10 +861,10 @@ void Plugin::ManageBittenTimer(float dt)
 
 
 
+	// Timer is reset by the PlayerWasBitten subscription
 	if (m_BittenTimer > CONFIG_BITTEN_REMEMBER_TIME)
 	{
-		m_pBlackboard->ChangeData(P_PLAYER_WAS_BITTEN, false);
-		m_BittenTimer = 0.f;
+		m_pBlackboard->ChangeData(BB_Keys::PlayerWasBitten, false);
 	}
 
 }
@@ -445,12 +877,12 @@ void Plugin::SweepFullMap()
 	Elite::Vector2 destination{};
 
 	bool dataFound =
-		m_pBlackboard->GetData(P_DESTINATION, destination);
+		m_pBlackboard->GetData(BB_Keys::Destination, destination);
 
 	if (Elite::Distance(agentInfo.Position, destination) <= 5.f)
 	{
 		// Pick random location
-		m_pBlackboard->ChangeData(P_DESTINATION, m_RandomLocationsToVisit[m_LocationPicker(m_Rng)]);
+		m_pBlackboard->ChangeData(BB_Keys::Destination, m_RandomLocationsToVisit[m_LocationPicker(m_Rng)]);
 	}
 }
 
@@ -509,47 +941,41 @@ void Plugin::GenerateRandomVisitLocations()
 	m_RandomLocationsVisited.reserve(m_RandomLocationsToVisit.size());
 
 	// Set blackboard data
-	m_pBlackboard->ChangeData(P_DESTINATION, m_RandomLocationsToVisit[0]);
-	m_pBlackboard->ChangeData(P_EXPLORE_LOCATIONS_TO_VISIT, m_RandomLocationsToVisit);
-	m_pBlackboard->ChangeData(P_EXPLORE_LOCATIONS_VISITED, m_RandomLocationsVisited);
+	m_pBlackboard->ChangeData(BB_Keys::Destination, m_RandomLocationsToVisit[0]);
+	m_pBlackboard->ChangeData(BB_Keys::ExploreLocationsToVisit, m_RandomLocationsToVisit);
+	m_pBlackboard->ChangeData(BB_Keys::ExploreLocationsVisited, m_RandomLocationsVisited);
 }
 
 //This function should only be used for rendering debug elements
 void Plugin::Render(float dt) const
 {
-	Elite::Vector2 targetPos{};
-	Elite::Vector2 destPos{};
-	AgentInfo agentInfo{};
-	HouseInfo houseInfo{};
-	std::vector<Elite::Vector2> locationsToVisit{};
-	std::vector<Elite::Vector2> locationsVisited{};
-
-	// explore debug
-	m_pBlackboard->GetData(P_EXPLORE_LOCATIONS_TO_VISIT, locationsToVisit);
-	m_pBlackboard->GetData(P_EXPLORE_LOCATIONS_VISITED, locationsVisited);
-	m_pBlackboard->GetData(P_TARGETINFO, targetPos);
-	m_pBlackboard->GetData(P_ACTIVE_HOUSE, houseInfo);
-	m_pBlackboard->GetData(P_DESTINATION, destPos);
-	m_pBlackboard->GetData(P_PLAYERINFO, agentInfo);
+	// explore debug, views into the last published tick so nothing is copied while drawing
+	const Blackboard& snapshot = m_pSnapshots->Acquire();
+	const std::vector<Elite::Vector2>& locationsToVisit = snapshot.ViewData(BB_Keys::ExploreLocationsToVisit);
+	const Elite::Vector2& targetPos = snapshot.ViewData(BB_Keys::TargetInfo);
+	const HouseInfo& houseInfo = snapshot.ViewData(BB_Keys::ActiveHouse);
+	const Elite::Vector2& destPos = snapshot.ViewData(BB_Keys::Destination);
+	const AgentInfo& agentInfo = snapshot.ViewData(BB_Keys::PlayerInfo);
 
 	m_pInterface->Draw_Segment(agentInfo.Position, targetPos, { 0,0,0 });
 	m_pInterface->Draw_SolidCircle(houseInfo.Center, .7f, { 0,0 }, { 1, 0, 1 });
 	m_pInterface->Draw_SolidCircle(destPos, 2.f, { 0,0 }, { 1, 1, 1 });
 
-	for (auto loc : locationsToVisit)
+	for (const auto& loc : locationsToVisit)
 	{
 		m_pInterface->Draw_Segment(loc, {0,0}, { 0,0,0 });
 		m_pInterface->Draw_Circle(loc, 10.f, { 1,0,1 });
 	}
 
-	SweepHouse sweepHouse{};
-
-	m_pBlackboard->GetData(P_HOUSE_TO_SWEEP, sweepHouse);
+	const SweepHouse& sweepHouse = snapshot.ViewData(BB_Keys::HouseToSweep);
 
-	for (auto loc : sweepHouse.sweepLocations)
+	for (const auto& loc : sweepHouse.sweepLocations)
 	{
 		m_pInterface->Draw_SolidCircle(loc, .7f, { 0,0 }, { 0, 0, 1 });
 	}
+
+	BLACKBOARD_PROFILE(m_pBlackboard->GetProfiler().RenderImGui("Blackboard profiler"));
+	BEHAVIOR_PROFILE(m_pBehaviorTree->GetProfiler().RenderImGui("Behavior tree profiler"));
 }
 
 vector<HouseInfo> Plugin::GetHousesInFOV() const
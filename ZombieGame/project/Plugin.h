@@ -19,6 +19,7 @@
 #define P_LAST_POSITION "lastPosition"
 #define P_ACTIVE_HOUSE "activeHouse"
 #define P_KNOWN_HOUSES "knownHouses"
+#define P_KNOWN_HOUSE_SWEEP_TIMERS "knownHouseSweepTimers"
 #define P_DESTINATION_REACHED "destinationReached"
 #define P_DESTINATION "destination"
 #define P_IS_GOING_FOR_HOUSE "isGoingForHouse"
@@ -31,6 +32,9 @@
 #define P_IS_IN_HOUSE "isInHouse"
 #define P_EXPLORE_LOCATIONS_TO_VISIT "exploreLocationsToVisit"
 #define P_EXPLORE_LOCATIONS_VISITED "exploreLocationsVisited"
+#define P_CACHE_IS_HOUSE_IN_FOV "cacheIsHouseInFOV"
+#define P_CACHE_IS_IN_HOUSE "cacheIsInHouse"
+#define P_CACHE_SHOULD_SWEEP_HOUSE "cacheShouldSweepHouse"
 
 #define CONFIG_SWEEP_MAX_TIMEOUT 50
 #define CONFIG_WANDER_ANGLE 45
@@ -42,16 +46,45 @@
 #define CONFIG_TURN_SPEED 50
 #define CONFIG_BITTEN_REMEMBER_TIME 5
 #define CONFIG_HAS_REACHED_DESTINATION 5
+#define CONFIG_CHECKPOINT_FILE "Blackboard.checkpoint" // F5 saves, F9 restores
+#define CONFIG_USE_FLAT_BEHAVIOR_TREE 0 // Runs the compiled form of the tree, same decisions. Needs CONFIG_BOOKKEEPING_TICK_RATE 0
+#define CONFIG_RESUME_RUNNING_BEHAVIOR 1 // The pointer tree continues its running branch instead of walking from the root
+#define CONFIG_MEMOIZE_PURE_CONDITIONS 1 // BT_PureConditions run once per tick in the pointer tree
+#define CONFIG_BOOKKEEPING_TICK_RATE 5 // Hz of the exploration and house bookkeeping branches, 0 runs them every frame
+#define CONFIG_BEHAVIOR_WORKER_COUNT 0 // Threads the BehaviorParallel nodes of the tree run on, 0 runs their children in turn
+#define CONFIG_BEHAVIOR_TREE_JSON "AgentBehavior.json" // CreateRootBehavior as data, copied next to the executable by the build
+#define CONFIG_BEHAVIOR_TREE_FILE "AgentBehavior.bt" // Compiled or JSON tree that CONFIG_LOAD_BEHAVIOR_TREE runs
+#define CONFIG_COMPILE_BEHAVIOR_TREE 0 // DllInit compiles CONFIG_BEHAVIOR_TREE_JSON to CONFIG_BEHAVIOR_TREE_FILE
+#define CONFIG_LOAD_BEHAVIOR_TREE 0 // Builds the tree from CONFIG_BEHAVIOR_TREE_FILE instead of CreateRootBehavior
+#define CONFIG_BEHAVIOR_TREE_PROFILE "BehaviorTreeProfile.txt" // Node counts written on DllShutdown while CONFIG_OPTIMIZE_BEHAVIOR_TREE is on, with times when the profiler is enabled
+#define CONFIG_OPTIMIZE_BEHAVIOR_TREE 0 // DllInit reorders the conditions of CONFIG_BEHAVIOR_TREE_FILE by CONFIG_BEHAVIOR_TREE_PROFILE, 1 prints the reorders, 2 also applies them
+#define CONFIG_TRACE_DEATH_SECONDS 10 // Seconds of the behavior trace written to BehaviorTraceDeath.csv when the agent dies
+#define CONFIG_DRAIN_BEHAVIOR_TRACE 0 // A background thread appends the whole behavior trace to BehaviorTrace.csv
+#define CONFIG_USE_STATIC_BEHAVIOR_TREE 0 // Runs BT_Static::AgentRootBehavior instead, which has no tick rate and runs the bookkeeping every frame. Same decisions with CONFIG_BOOKKEEPING_TICK_RATE 0
+#define CONFIG_USE_UTILITY_AI 0 // Runs Plugin::CreateUtilityAI instead, scores the actions every tick
+#define CONFIG_USE_STATE_MACHINE 0 // Runs Plugin::CreateStateMachine instead, checks only the transitions of the current state
+#define CONFIG_USE_GOAP_PLANNER 0 // Runs Plugin::CreateGoapPlanner instead, plans towards the first goal that is not met
+#define CONFIG_GOAP_PLANNING_BUDGET 100.f // Microseconds the planner may search per tick, a longer search continues next tick
+#define CONFIG_RUN_BENCHMARKS 0 // Prints the micro benchmarks from Benchmarks.cpp on DllInit
 
 class IBaseInterface;
 class IExamInterface;
 class Blackboard;
+class BlackboardSnapshots;
 class BehaviorTree;
-
+class FlatBehaviorTree;
+class IDecisionMaking;
+class IBehavior;
+class WorkerPool;
+class UtilityAI;
+class FiniteStateMachine;
+class GoapPlanner;
+
+//The timer itself is in KnownHouseSweepTimers, it changes every tick while this only changes when it passes the timeout
 struct KnownHouse
 {
 	Elite::Vector2 housePosition{};
-	float lastSweepTime{};
+	bool isSweepDue{}; //Not swept for CONFIG_SWEEP_MAX_TIMEOUT
 };
 
 class Plugin :public IExamPlugin
@@ -70,6 +103,12 @@ public:
 	SteeringPlugin_Output UpdateSteering(float dt) override;
 	void Render(float dt) const override;
 
+	//The bookkeeping branches only flatten at a tick rate of 0
+	static IBehavior* CreateRootBehavior(float bookkeepingTickRate = CONFIG_BOOKKEEPING_TICK_RATE);
+	static UtilityAI* CreateUtilityAI(Blackboard* pBlackboard);
+	static FiniteStateMachine* CreateStateMachine(Blackboard* pBlackboard);
+	static GoapPlanner* CreateGoapPlanner(Blackboard* pBlackboard);
+
 private:
 	//Interface, used to request data from/perform actions with the AI Framework
 	IExamInterface* m_pInterface = nullptr;
@@ -87,10 +126,19 @@ private:
 	/* Custom properties													 */
 	/************************************************************************/
 	BehaviorTree* m_pBehaviorTree;
+	FlatBehaviorTree* m_pFlatBehaviorTree = nullptr;
+	IDecisionMaking* m_pStaticBehaviorTree = nullptr;
+	UtilityAI* m_pUtilityAI = nullptr;
+	FiniteStateMachine* m_pStateMachine = nullptr;
+	GoapPlanner* m_pGoapPlanner = nullptr;
+	IDecisionMaking* m_pDecisionMaking = nullptr; //The tree, its flat form, its static form, the utility AI, the state machine or the planner
+	WorkerPool* m_pWorkerPool = nullptr;
 	Blackboard* m_pBlackboard;
+	BlackboardSnapshots* m_pSnapshots = nullptr;
 
 	bool m_ShouldExplore{ true };
 	float m_BittenTimer{};
+	bool m_IsDeathTraceWritten{ false };
 
 	Elite::Vector2 m_LastPosition{};
 
@@ -102,6 +150,8 @@ private:
 	std::vector<HouseInfo> m_HousesInFOV{};
 	std::vector<EnemyInfo> m_EnemiesInFOV{};
 	std::vector<EntityInfo> m_ItemsInFOV{};
+	std::vector<EnemyInfo> m_PreviousEnemiesInFOV{};
+	std::vector<EntityInfo> m_PreviousItemsInFOV{};
 
 	std::vector<Elite::Vector2> m_RandomLocationsToVisit{};
 	std::vector<Elite::Vector2> m_RandomLocationsVisited{};
@@ -116,14 +166,3 @@ private:
 
 	UINT m_InventorySlot = 0;
 };
-
-//ENTRY
-//This is the first function that is called by the host program
-//The plugin returned by this function is also the plugin used by the host program
-extern "C"
-{
-	__declspec (dllexport) IPluginBase* Register()
-	{
-		return new Plugin();
-	}
-}
\ No newline at end of file